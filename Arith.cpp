@@ -0,0 +1,11 @@
+﻿// Arith.cpp
+#include "Arith.h"
+
+std::vector<wxString> MuxComp::InputLabels() const
+{
+    std::vector<wxString> v;
+    v.reserve(Ways() + 1);
+    for (int k = 0; k < Ways(); ++k) v.push_back(wxString::Format("D%d", k));
+    v.push_back("S");
+    return v;
+}
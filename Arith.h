@@ -0,0 +1,42 @@
+﻿// Arith.h
+#pragma once
+#include <vector>
+#include "Sequential.h"   // BlockComponent
+
+// ==========================================================
+//  运算块：数据选择器、加法器、比较器
+//  一个元件对应 LogicKernel 里的一个整字求值分支，代替由基本门搭出的整片电路
+//  数据引脚按 Component::width 位宽（> 1 时接总线），选择器路数见 Component::inputs
+// ==========================================================
+
+// ---------- 数据选择器：D0..Dn-1, S → Y ----------
+class MuxComp : public BlockComponent {
+public:
+    static constexpr int MAX_INPUTS = 16;
+    MuxComp(wxPoint center, int ways, int bits) : BlockComponent(center, MUX, 25.0) { inputs = ways; width = bits; UpdateGeometry(); }
+    int Ways() const { return inputs < 2 ? 2 : (inputs > MAX_INPUTS ? MAX_INPUTS : inputs); }
+protected:
+    wxString Title() const override { return "MUX"; }
+    std::vector<wxString> InputLabels() const override;    // D0..Dn-1, S
+    std::vector<wxString> OutputLabels() const override { return { "Y" }; }
+};
+
+// ---------- 加法器：A, B, CIN → S, COUT（1 位即全加器，多位为整字行波加法） ----------
+class AdderComp : public BlockComponent {
+public:
+    AdderComp(wxPoint center, int bits) : BlockComponent(center, ADDER, 30.0) { width = bits; UpdateGeometry(); }
+protected:
+    wxString Title() const override { return width > 1 ? wxString::Format("ADD%d", width) : wxString("FA"); }
+    std::vector<wxString> InputLabels() const override { return { "A", "B", "Ci" }; }
+    std::vector<wxString> OutputLabels() const override { return { "S", "Co" }; }
+};
+
+// ---------- 无符号比较器：A, B → LT, EQ, GT ----------
+class ComparatorComp : public BlockComponent {
+public:
+    ComparatorComp(wxPoint center, int bits) : BlockComponent(center, COMPARATOR, 30.0) { width = bits; UpdateGeometry(); }
+protected:
+    wxString Title() const override { return wxString::Format("CMP%d", width); }
+    std::vector<wxString> InputLabels() const override { return { "A", "B" }; }
+    std::vector<wxString> OutputLabels() const override { return { "<", "=", ">" }; }
+};
@@ -1,13 +1,104 @@
 ﻿#include "BookShelfExporter.h"
+#include <algorithm>
 #include <fstream>
-#include <iomanip>
 #include <stdexcept>
 #include <unordered_set>
+#include <charconv>
+#include <string_view>
+#include <cstring>
 
 using namespace std;
 
 namespace bookshelf {
 
+    namespace {
+
+        // 输出缓冲：字段先格式化进大块内存，满了再整块写出
+        // 数字用 to_chars，结果与 ofstream << fixed << setprecision 逐字节一致，但不受 locale 影响
+        class BufferedWriter {
+        public:
+            static constexpr size_t BUF_BYTES = 1u << 20;
+
+            explicit BufferedWriter(const filesystem::path& file) : m_path(file) {
+                m_buf.resize(BUF_BYTES + 512); // 尾部留出一个数字的余量
+                // 文本模式打开，换行处理与原来的 ofstream 相同
+                m_ofs.open(file);
+                if (!m_ofs) throw runtime_error("Cannot open file: " + file.string());
+            }
+
+            ~BufferedWriter() {
+                // 正常路径应显式调用 Close() 以便报告错误；这里只做兜底
+                try { Close(); }
+                catch (...) {}
+            }
+
+            BufferedWriter& operator<<(string_view s) {
+                if (m_len + s.size() > BUF_BYTES) {
+                    Flush();
+                    if (s.size() > BUF_BYTES) { WriteBlock(s.data(), s.size()); return *this; }
+                }
+                memcpy(m_buf.data() + m_len, s.data(), s.size());
+                m_len += s.size();
+                return *this;
+            }
+
+            BufferedWriter& operator<<(char c) {
+                if (m_len + 1 > BUF_BYTES) Flush();
+                m_buf[m_len++] = c;
+                return *this;
+            }
+
+            BufferedWriter& operator<<(size_t v) {
+                if (m_len > BUF_BYTES) Flush();
+                auto r = to_chars(m_buf.data() + m_len, m_buf.data() + m_buf.size(), v);
+                m_len = size_t(r.ptr - m_buf.data());
+                return *this;
+            }
+
+            // 等价于 fixed << setprecision(precision) << v
+            void Fixed(double v, int precision) {
+                if (m_len > BUF_BYTES) Flush();
+                char* first = m_buf.data() + m_len;
+                char* last = m_buf.data() + m_buf.size();
+                auto r = to_chars(first, last, v, chars_format::fixed, precision);
+                if (r.ec != errc()) {
+                    // 极大的数（>1e300 级）可能放不下余量，退到临时缓冲
+                    string tmp(400 + size_t(precision), '\0');
+                    auto r2 = to_chars(tmp.data(), tmp.data() + tmp.size(), v, chars_format::fixed, precision);
+                    *this << string_view(tmp.data(), size_t(r2.ptr - tmp.data()));
+                    return;
+                }
+                m_len = size_t(r.ptr - m_buf.data());
+            }
+
+            void Close() {
+                Flush();
+                if (m_ofs.is_open()) {
+                    m_ofs.close();
+                    if (!m_ofs) throw runtime_error("Write failed: " + m_path.string());
+                }
+            }
+
+        private:
+            void Flush() {
+                if (m_len == 0) return;
+                WriteBlock(m_buf.data(), m_len);
+                m_len = 0;
+            }
+
+            void WriteBlock(const char* p, size_t n) {
+                m_ofs.write(p, (streamsize)n);
+                if (!m_ofs) throw runtime_error("Write failed: " + m_path.string());
+            }
+
+            filesystem::path m_path;
+            ofstream m_ofs;
+            vector<char> m_buf;
+            size_t m_len = 0;
+        };
+
+    } // namespace
+
     static void EnsureDir(const std::filesystem::path& dir, bool create) {
         if (std::filesystem::exists(dir)) {
             if (!std::filesystem::is_directory(dir))
@@ -45,18 +136,20 @@ namespace bookshelf {
         size_t numTerms = 0;
         for (auto& n : nodes) if (n.terminal) ++numTerms;
 
-        ofstream ofs(file);
-        if (!ofs) throw runtime_error("Cannot open file: " + file.string());
-        ofs << "UCLA nodes 1.0\n";
-        ofs << "NumNodes : " << numNodes << "\n";
-        ofs << "NumTerminals : " << numTerms << "\n\n";
+        BufferedWriter out(file);
+        out << "UCLA nodes 1.0\n";
+        out << "NumNodes : " << numNodes << "\n";
+        out << "NumTerminals : " << numTerms << "\n\n";
 
-        ofs << fixed << setprecision(precision);
         for (const auto& n : nodes) {
-            ofs << n.name << " " << n.width << " " << n.height;
-            if (n.terminal) ofs << " terminal";
-            ofs << "\n";
+            out << n.name << ' ';
+            out.Fixed(n.width, precision);
+            out << ' ';
+            out.Fixed(n.height, precision);
+            if (n.terminal) out << " terminal";
+            out << '\n';
         }
+        out.Close();
     }
 
     static void WriteNets(const filesystem::path& file,
@@ -64,24 +157,81 @@ namespace bookshelf {
         size_t totalPins = 0;
         for (const auto& net : nets) totalPins += net.pins.size();
 
-        ofstream ofs(file);
-        if (!ofs) throw runtime_error("Cannot open file: " + file.string());
-        ofs << "UCLA nets 1.0\n";
-        ofs << "NumNets : " << nets.size() << "\n";
-        ofs << "NumPins : " << totalPins << "\n\n";
+        BufferedWriter out(file);
+        out << "UCLA nets 1.0\n";
+        out << "NumNets : " << nets.size() << "\n";
+        out << "NumPins : " << totalPins << "\n\n";
 
-        ofs << fixed << setprecision(precision);
+        char autoName[32];
         for (size_t i = 0; i < nets.size(); ++i) {
             const auto& net = nets[i];
-            const string netName = !net.name.empty() ? net.name : ("n" + to_string(i));
-            ofs << "NetDegree : " << net.pins.size() << " " << netName << "\n";
+            out << "NetDegree : " << net.pins.size() << ' ';
+            if (!net.name.empty()) out << net.name;
+            else {
+                autoName[0] = 'n';
+                auto r = to_chars(autoName + 1, autoName + sizeof(autoName), i);
+                out << string_view(autoName, size_t(r.ptr - autoName));
+            }
+            out << '\n';
             for (const auto& p : net.pins) {
-                const string pinName = p.pinName.empty() ? "P" : p.pinName;
-                ofs << " " << p.cellName << " " << pinName << " : "
-                    << p.dx << " " << p.dy << "\n";
+                out << ' ' << p.cellName << ' ';
+                if (p.pinName.empty()) out << 'P';
+                else out << p.pinName;
+                out << " : ";
+                out.Fixed(p.dx, precision);
+                out << ' ';
+                out.Fixed(p.dy, precision);
+                out << '\n';
             }
-            ofs << "\n";
+            out << '\n';
+        }
+        out.Close();
+    }
+
+    static void WritePl(const filesystem::path& file,
+        const vector<Node>& nodes, int precision) {
+        BufferedWriter out(file);
+        out << "UCLA pl 1.0\n\n";
+
+        for (const auto& n : nodes) {
+            out << n.name << ' ';
+            out.Fixed(n.x, precision);
+            out << ' ';
+            out.Fixed(n.y, precision);
+            out << " : N";
+            if (n.fixed) out << " /FIXED";
+            out << '\n';
         }
+        out.Close();
+    }
+
+    static void WriteScl(const filesystem::path& file,
+        const vector<Row>& rows, int precision) {
+        BufferedWriter out(file);
+        out << "UCLA scl 1.0\n\n";
+        out << "NumRows : " << rows.size() << "\n\n";
+
+        for (const auto& r : rows) {
+            out << "CoreRow Horizontal\n";
+            out << "  Coordinate : "; out.Fixed(r.y, precision); out << '\n';
+            out << "  Height : "; out.Fixed(r.height, precision); out << '\n';
+            out << "  Sitewidth : "; out.Fixed(r.siteWidth, precision); out << '\n';
+            out << "  Sitespacing : "; out.Fixed(r.siteSpacing, precision); out << '\n';
+            out << "  Siteorient : N\n";
+            out << "  Sitesymmetry : Y\n";
+            out << "  SubrowOrigin : "; out.Fixed(r.x, precision);
+            out << " NumSites : " << (size_t)std::max(0, r.numSites) << '\n';
+            out << "End\n";
+        }
+        out.Close();
+    }
+
+    static void WriteAux(const filesystem::path& file, const vector<filesystem::path>& listed) {
+        BufferedWriter out(file);
+        out << "RowBasedPlacement :";
+        for (const auto& p : listed) out << ' ' << p.filename().u8string();
+        out << '\n';
+        out.Close();
     }
 
     std::pair<std::filesystem::path, std::filesystem::path>
@@ -93,11 +243,29 @@ namespace bookshelf {
         Validate(nodes, nets);
         EnsureDir(opt.outDir, opt.forceCreateDir);
 
-        const auto nodesPath = std::filesystem::absolute(opt.outDir / (projectName + ".nodes"));
-        const auto netsPath = std::filesystem::absolute(opt.outDir / (projectName + ".nets"));
+        auto pathOf = [&](const char* ext) {
+            return std::filesystem::absolute(opt.outDir / (projectName + ext));
+            };
+        const auto nodesPath = pathOf(".nodes");
+        const auto netsPath = pathOf(".nets");
 
         WriteNodes(nodesPath, nodes, opt.floatPrecision);
         WriteNets(netsPath, nets, opt.floatPrecision);
+
+        vector<filesystem::path> listed{ nodesPath, netsPath };
+        if (opt.writePl) {
+            const auto plPath = pathOf(".pl");
+            WritePl(plPath, nodes, opt.floatPrecision);
+            listed.push_back(plPath);
+        }
+        if (!opt.rows.empty()) {
+            const auto sclPath = pathOf(".scl");
+            WriteScl(sclPath, opt.rows, opt.floatPrecision);
+            listed.push_back(sclPath);
+        }
+        if (opt.writeAux) {
+            WriteAux(std::filesystem::absolute(opt.outDir / (projectName + ".aux")), listed);
+        }
         return { nodesPath, netsPath };
     }
 
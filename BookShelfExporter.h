@@ -10,6 +10,9 @@ namespace bookshelf {
         double width;        // 像素/任意单位
         double height;       // 同上
         bool terminal = false; // 终端(IO)则 true
+        double x = 0.0;        // .pl 左下角坐标
+        double y = 0.0;
+        bool fixed = false;    // .pl 中标记 /FIXED
     };
 
     struct Pin {
@@ -24,12 +27,27 @@ namespace bookshelf {
         std::vector<Pin> pins;
     };
 
+    // .scl 中的一行 CoreRow
+    struct Row {
+        double y = 0.0;           // Coordinate
+        double height = 0.0;
+        double siteWidth = 1.0;
+        double siteSpacing = 1.0;
+        double x = 0.0;           // SubrowOrigin
+        int numSites = 0;
+    };
+
     struct ExportOptions {
         std::filesystem::path outDir = "output";
         bool forceCreateDir = true;
         int floatPrecision = 6;
+        bool writePl = true;      // 同时写 <project>.pl
+        bool writeAux = true;     // 同时写 <project>.aux（列出实际写出的文件）
+        std::vector<Row> rows;    // 非空时写 <project>.scl
     };
 
+    /// 返回 .nodes 与 .nets 路径；.pl/.scl/.aux 与其同目录同名
+    /// 内部按块缓冲、用 to_chars 格式化数字，不受全局 locale 影响
     std::pair<std::filesystem::path, std::filesystem::path>
         ExportBookShelf(const std::string& projectName,
             const std::vector<Node>& nodes,
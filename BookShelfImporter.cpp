@@ -1,126 +1,612 @@
 ﻿#include "BookShelfImporter.h"
 #include <fstream>
-#include <sstream>
 #include <stdexcept>
+#include <cstring>
+#include <charconv>
+#include <string_view>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <thread>
+#include <exception>
+#include <iterator>
 #include <cctype>
 
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 
 namespace bookshelf {
 
-    static inline string trim(const string& s) {
-        size_t b = s.find_first_not_of(" \t\r\n");
-        if (b == string::npos) return "";
-        size_t e = s.find_last_not_of(" \t\r\n");
-        return s.substr(b, e - b + 1);
-    }
+    namespace {
+
+        // —— 只读内存映射：整个文件一次映射，解析全程零拷贝 ——
+        class MappedFile {
+        public:
+            explicit MappedFile(const filesystem::path& p) {
+#ifdef _WIN32
+                m_file = CreateFileW(p.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+                if (m_file == INVALID_HANDLE_VALUE) return;
+                LARGE_INTEGER sz{};
+                if (!GetFileSizeEx(m_file, &sz)) return;
+                m_size = (size_t)sz.QuadPart;
+                m_ok = true;
+                if (m_size == 0) return; // 空文件无法建映射，但属于合法输入
+                m_map = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (!m_map) { m_ok = false; return; }
+                m_data = static_cast<const char*>(MapViewOfFile(m_map, FILE_MAP_READ, 0, 0, 0));
+                if (!m_data) m_ok = false;
+#else
+                m_fd = ::open(p.c_str(), O_RDONLY);
+                if (m_fd < 0) return;
+                struct stat st {};
+                if (::fstat(m_fd, &st) != 0) return;
+                m_size = (size_t)st.st_size;
+                m_ok = true;
+                if (m_size == 0) return;
+                void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+                if (addr == MAP_FAILED) { m_ok = false; return; }
+                ::madvise(addr, m_size, MADV_SEQUENTIAL);
+                m_data = static_cast<const char*>(addr);
+#endif
+            }
+
+            ~MappedFile() {
+#ifdef _WIN32
+                if (m_data) UnmapViewOfFile(m_data);
+                if (m_map) CloseHandle(m_map);
+                if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+#else
+                if (m_data) ::munmap(const_cast<char*>(m_data), m_size);
+                if (m_fd >= 0) ::close(m_fd);
+#endif
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            bool ok() const { return m_ok; }
+            string_view view() const { return m_data ? string_view(m_data, m_size) : string_view(); }
+
+        private:
+            const char* m_data = nullptr;
+            size_t m_size = 0;
+            bool m_ok = false;
+#ifdef _WIN32
+            HANDLE m_file = INVALID_HANDLE_VALUE;
+            HANDLE m_map = nullptr;
+#else
+            int m_fd = -1;
+#endif
+        };
+
+        // 与 istream >> 相同的空白集合
+        inline bool IsSpace(char c) {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+        }
+
+        inline string_view TrimView(string_view s) {
+            size_t b = 0, e = s.size();
+            while (b < e && IsSpace(s[b])) ++b;
+            while (e > b && IsSpace(s[e - 1])) --e;
+            return s.substr(b, e - b);
+        }
+
+        inline bool StartsWith(string_view s, string_view prefix) {
+            return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+        }
+
+        // 弹出下一个空白分隔的 token；没有则返回空
+        inline string_view NextToken(string_view& s) {
+            size_t b = 0;
+            while (b < s.size() && IsSpace(s[b])) ++b;
+            size_t e = b;
+            while (e < s.size() && !IsSpace(s[e])) ++e;
+            string_view tok = s.substr(b, e - b);
+            s.remove_prefix(e);
+            return tok;
+        }
+
+        // from_chars 不接受前导 '+'，这里与 istream 保持一致地放行
+        template <class T>
+        inline bool ParseNumber(string_view tok, T& out) {
+            if (!tok.empty() && tok.front() == '+') tok.remove_prefix(1);
+            if (tok.empty()) return false;
+            auto [ptr, ec] = from_chars(tok.data(), tok.data() + tok.size(), out);
+            return ec == errc() && ptr != tok.data();
+        }
+
+        // 逐行切分（不拷贝），返回去掉首尾空白后的行
+        class LineCursor {
+        public:
+            explicit LineCursor(string_view buf) : m_p(buf.data()), m_end(buf.data() + buf.size()) {}
+            bool Next(string_view& line) {
+                if (m_p >= m_end) return false;
+                const char* nl = static_cast<const char*>(memchr(m_p, '\n', size_t(m_end - m_p)));
+                const char* lineEnd = nl ? nl : m_end;
+                line = TrimView(string_view(m_p, size_t(lineEnd - m_p)));
+                m_p = nl ? nl + 1 : m_end;
+                return true;
+            }
+        private:
+            const char* m_p;
+            const char* m_end;
+        };
+
+        inline bool IsCommentOrHeader(string_view line) {
+            return line.empty() || line[0] == '#' || StartsWith(line, "UCLA");
+        }
+
+    } // namespace
+
+    // 单元名 → nodes 下标；开放寻址平铺表，键直接指向映射中的 .nodes 文本
+    // .nets 里每个引脚都要查一次，std::unordered_map 的节点跳转在百万级引脚下是主要开销
+    class NodeLookup {
+    public:
+        // 重名时以最后一次为准
+        void Insert(string_view key, uint32_t id) {
+            if ((m_keys.size() + 1) * 2 > m_slots.size()) Grow();
+            const uint32_t h = Hash(key);
+            size_t i = h & (m_slots.size() - 1);
+            for (;; i = (i + 1) & (m_slots.size() - 1)) {
+                Slot& s = m_slots[i];
+                if (s.id == kNoNode) {
+                    s = Slot{ h, id, (uint32_t)m_keys.size() };
+                    m_keys.push_back(key);
+                    return;
+                }
+                if (s.hash == h && m_keys[s.key] == key) { s.id = id; return; }
+            }
+        }
+
+        uint32_t Find(string_view key) const {
+            if (m_slots.empty()) return kNoNode;
+            const uint32_t h = Hash(key);
+            for (size_t i = h & (m_slots.size() - 1);; i = (i + 1) & (m_slots.size() - 1)) {
+                const Slot& s = m_slots[i];
+                if (s.id == kNoNode) return kNoNode;
+                if (s.hash == h && m_keys[s.key] == key) return s.id;
+            }
+        }
+
+    private:
+        struct Slot {
+            uint32_t hash = 0;
+            uint32_t id = kNoNode;   // kNoNode 表示空槽
+            uint32_t key = 0;        // m_keys 下标
+        };
+
+        static uint32_t Hash(string_view s) {
+            uint32_t h = 2166136261u;  // FNV-1a
+            for (char c : s) { h ^= (unsigned char)c; h *= 16777619u; }
+            return h;
+        }
+
+        void Grow() {
+            vector<Slot> old = std::move(m_slots);
+            m_slots.assign(std::max<size_t>(16, old.size() * 2), Slot{});
+            for (const Slot& s : old) {
+                if (s.id == kNoNode) continue;
+                size_t i = s.hash & (m_slots.size() - 1);
+                while (m_slots[i].id != kNoNode) i = (i + 1) & (m_slots.size() - 1);
+                m_slots[i] = s;
+            }
+        }
+
+        vector<Slot> m_slots;
+        vector<string_view> m_keys;
+    };
 
-    static void ParseNodes(const filesystem::path& p, BSDesign& d) {
-        ifstream ifs(p);
-        if (!ifs) throw runtime_error("Cannot open .nodes: " + p.string());
-        string line;
-        while (getline(ifs, line)) {
-            line = trim(line);
-            if (line.empty()) continue;
-            if (line[0] == '#') continue;
-            if (line.rfind("UCLA", 0) == 0) continue;
-            if (line.rfind("NumNodes", 0) == 0) continue;
-            if (line.rfind("NumTerminals", 0) == 0) continue;
+    static void ParseNodes(string_view buf, BSDesign& d, NodeLookup& lookup) {
+        LineCursor cur(buf);
+        string_view line;
+        while (cur.Next(line)) {
+            if (IsCommentOrHeader(line)) continue;
+            if (StartsWith(line, "NumNodes")) continue;
+            if (StartsWith(line, "NumTerminals")) continue;
 
             // 形如： name width height [terminal]
-            istringstream ss(line);
+            string_view rest = line;
+            string_view name = NextToken(rest);
+            if (name.empty()) continue;
+
             BSNode n;
-            ss >> n.name >> n.width >> n.height;
-            string word;
-            if (ss >> word) {
+            n.name.assign(name.data(), name.size());
+            if (ParseNumber(NextToken(rest), n.width) && ParseNumber(NextToken(rest), n.height)) {
+                string_view word = NextToken(rest);
                 if (word == "terminal" || word == "terminal:") n.terminal = true;
             }
-            if (!n.name.empty()) {
-                d.nodeIndexByName[n.name] = d.nodes.size();
-                d.nodes.push_back(n);
-            }
+            lookup.Insert(name, (uint32_t)d.nodes.size());
+            d.nodes.push_back(std::move(n));
         }
     }
 
-    static void ParseNets(const filesystem::path& p, BSDesign& d) {
-        ifstream ifs(p);
-        if (!ifs) throw runtime_error("Cannot open .nets: " + p.string());
-        string line;
+    // 一段 .nets 的解析结果；引脚名 id 是段内局部编号，合并时再映射到全局表
+    struct NetsChunk {
+        vector<BSNet> nets;              // firstPin 为段内偏移
+        vector<BSPin> pins;
+        vector<string_view> pinNames;    // 局部 id → 名字（指向映射缓冲区）
+        size_t unresolvedPins = 0;
+    };
+
+    // 解析一段 .nets 文本，结果按出现顺序写入 out
+    // 段的起点必须是文件开头或某个 NetDegree 行，这样各段互不依赖
+    static void ParseNetsChunk(string_view buf, const NodeLookup& nodes, NetsChunk& out) {
+        // 引脚名通常只有 I/O/P0.. 寥寥几种：少于 SMALL_NAMES 时线性比较，比哈希快；多了再建表
+        constexpr size_t SMALL_NAMES = 16;
+        unordered_map<string_view, uint32_t> pinNameIds;
+        auto internPinName = [&](string_view nm) -> uint32_t {
+            if (out.pinNames.size() <= SMALL_NAMES) {
+                for (uint32_t k = 0; k < (uint32_t)out.pinNames.size(); ++k) {
+                    if (out.pinNames[k] == nm) return k;
+                }
+                out.pinNames.push_back(nm);
+                if (out.pinNames.size() > SMALL_NAMES) {
+                    for (uint32_t k = 0; k < (uint32_t)out.pinNames.size(); ++k) pinNameIds.emplace(out.pinNames[k], k);
+                }
+                return (uint32_t)out.pinNames.size() - 1;
+            }
+            auto [it, inserted] = pinNameIds.try_emplace(nm, (uint32_t)out.pinNames.size());
+            if (inserted) out.pinNames.push_back(nm);
+            return it->second;
+            };
         BSNet current;
         int expectPins = -1;
+        size_t unresolved = 0;   // 当前网里找不到单元的引脚
 
         auto flush = [&]() {
-            if (!current.name.empty() && !current.pins.empty()) {
-                d.nets.push_back(current);
+            if (!current.name.empty() && current.numPins > 0) {
+                out.nets.push_back(std::move(current));
+                out.unresolvedPins += unresolved;
+            }
+            else {
+                out.pins.resize(current.firstPin);   // 丢弃不成网的引脚
             }
             current = BSNet{};
+            current.firstPin = (uint32_t)out.pins.size();
             expectPins = -1;
+            unresolved = 0;
             };
 
-        while (getline(ifs, line)) {
-            line = trim(line);
-            if (line.empty()) continue;
-            if (line[0] == '#') continue;
-            if (line.rfind("UCLA", 0) == 0) continue;
-            if (line.rfind("NumNets", 0) == 0) continue;
-            if (line.rfind("NumPins", 0) == 0) continue;
+        LineCursor cur(buf);
+        string_view line;
+        while (cur.Next(line)) {
+            if (IsCommentOrHeader(line)) continue;
+            if (StartsWith(line, "NumNets")) continue;
+            if (StartsWith(line, "NumPins")) continue;
 
-            if (line.rfind("NetDegree", 0) == 0) {
-                // NetDegree : <k> <name>
+            if (StartsWith(line, "NetDegree")) {
+                // NetDegree : <k> <name>（冒号可能紧贴关键字或数字）
                 flush();
-                istringstream ss(line);
-                string token, colon;
-                ss >> token >> colon; // NetDegree :
-                ss >> expectPins >> current.name;
-                if (current.name.empty()) current.name = "net";
+                string_view rest = line.substr(9);
+                rest = TrimView(rest);
+                if (!rest.empty() && rest.front() == ':') rest.remove_prefix(1);
+                if (!ParseNumber(NextToken(rest), expectPins)) expectPins = -1;
+                string_view name = NextToken(rest);
+                if (name.empty()) current.name = "net";
+                else current.name.assign(name.data(), name.size());
                 continue;
             }
 
             // 引脚行： <cell> <pin> : dx dy
             // pin 可能紧挨着冒号或中间有空格，兼容处理
             // 例：O441 I : -0.5 -6.0  或  o441 I:-0.5 -6.0
-            {
-                BSPin pin;
-                // 先拆出 cell 与剩余
-                istringstream ss(line);
-                ss >> pin.cellName;
-                string rest; getline(ss, rest);
-                rest = trim(rest);
-
-                // 找到 ':' 位置
-                auto posColon = rest.find(':');
-                if (posColon == string::npos) continue;
-                string left = trim(rest.substr(0, posColon));  // 可能是 "I" 或 "I " 或 "I"
-                string right = trim(rest.substr(posColon + 1)); // dx dy
-
-                // pinName 可能写成 I 或 I
-                // 也可能是 I:-0.5 这种被我们切开了
-                {
-                    // left 末尾若有空格，去掉
-                    if (!left.empty() && left.back() == ' ') left.pop_back();
-                    pin.pinName = left;
-                }
-                {
-                    istringstream rs(right);
-                    rs >> pin.dx >> pin.dy;
-                }
-                current.pins.push_back(pin);
+            string_view rest = line;
+            string_view cell = NextToken(rest);
+            size_t posColon = rest.find(':');
+            if (posColon == string_view::npos) continue;
 
-                if ((int)current.pins.size() == expectPins) {
-                    flush();
-                }
+            BSPin& pin = out.pins.emplace_back();
+            pin.nodeId = nodes.Find(cell);
+            if (pin.nodeId == kNoNode) ++unresolved;
+
+            string_view pinName = TrimView(rest.substr(0, posColon));
+            pin.pinNameId = internPinName(pinName);
+
+            string_view right = rest.substr(posColon + 1);
+            if (ParseNumber(NextToken(right), pin.dx)) {
+                ParseNumber(NextToken(right), pin.dy);
+            }
+
+            if ((int)++current.numPins == expectPins) {
+                flush();
             }
         }
         flush();
     }
 
+    // 从 pos 起找到下一个以 NetDegree 开头的行首；找不到返回 buf.size()
+    static size_t FindNextNetDegree(string_view buf, size_t pos) {
+        // 先对齐到行首
+        if (pos > 0 && buf[pos - 1] != '\n') {
+            size_t nl = buf.find('\n', pos);
+            if (nl == string_view::npos) return buf.size();
+            pos = nl + 1;
+        }
+        while (pos < buf.size()) {
+            size_t b = pos;
+            while (b < buf.size() && (buf[b] == ' ' || buf[b] == '\t')) ++b;
+            if (StartsWith(buf.substr(b), "NetDegree")) return pos;
+            size_t nl = buf.find('\n', pos);
+            if (nl == string_view::npos) return buf.size();
+            pos = nl + 1;
+        }
+        return buf.size();
+    }
+
+    // 按 NetDegree 边界切块并行解析，再按块顺序合并，结果与顺序解析逐项一致
+    static void ParseNets(string_view buf, const NodeLookup& nodes, BSDesign& d, unsigned numThreads) {
+        constexpr size_t MIN_CHUNK_BYTES = 4u << 20; // 小于 4MB 的块不值得开线程
+        if (numThreads == 0) numThreads = std::max(1u, thread::hardware_concurrency());
+        const size_t maxChunks = std::max<size_t>(1, buf.size() / MIN_CHUNK_BYTES);
+        const size_t numChunks = std::min<size_t>(numThreads, maxChunks);
+
+        // 1) 切块：目标位置向后对齐到 NetDegree 行
+        vector<size_t> bounds{ 0 };
+        for (size_t i = 1; i < numChunks; ++i) {
+            size_t b = FindNextNetDegree(buf, buf.size() * i / numChunks);
+            if (b > bounds.back() && b < buf.size()) bounds.push_back(b);
+        }
+        bounds.push_back(buf.size());
+
+        // 2) 并行解析；第 0 块在当前线程做
+        const size_t n = bounds.size() - 1;
+        vector<NetsChunk> parts(n);
+        vector<exception_ptr> errors(n);
+        vector<thread> workers;
+        workers.reserve(n - 1);
+        for (size_t i = 1; i < n; ++i) {
+            workers.emplace_back([&, i]() {
+                try { ParseNetsChunk(buf.substr(bounds[i], bounds[i + 1] - bounds[i]), nodes, parts[i]); }
+                catch (...) { errors[i] = current_exception(); }
+                });
+        }
+        try { ParseNetsChunk(buf.substr(bounds[0], bounds[1] - bounds[0]), nodes, parts[0]); }
+        catch (...) { errors[0] = current_exception(); }
+        for (auto& t : workers) t.join();
+        for (auto& e : errors) if (e) rethrow_exception(e);
+
+        // 3) 按顺序合并：引脚名按首次出现顺序进全局表，引脚区间整体平移
+        size_t totalNets = d.nets.size(), totalPins = d.pins.size();
+        for (const auto& p : parts) { totalNets += p.nets.size(); totalPins += p.pins.size(); }
+        if (totalPins > 0xFFFFFFFFull) throw runtime_error("Too many pins in .nets");
+        d.nets.reserve(totalNets);
+        d.pins.reserve(totalPins);
+
+        unordered_map<string_view, uint32_t> globalNames;
+        for (uint32_t i = 0; i < (uint32_t)d.pinNames.size(); ++i) globalNames.emplace(d.pinNames[i], i);
+
+        vector<uint32_t> remap;
+        for (auto& p : parts) {
+            remap.resize(p.pinNames.size());
+            for (size_t k = 0; k < p.pinNames.size(); ++k) {
+                auto [it, inserted] = globalNames.try_emplace(p.pinNames[k], (uint32_t)d.pinNames.size());
+                if (inserted) d.pinNames.emplace_back(p.pinNames[k]);
+                remap[k] = it->second;
+            }
+
+            const uint32_t base = (uint32_t)d.pins.size();
+            for (BSPin pin : p.pins) {
+                pin.pinNameId = remap[pin.pinNameId];
+                d.pins.push_back(pin);
+            }
+            for (auto& net : p.nets) {
+                net.firstPin += base;
+                d.nets.push_back(std::move(net));
+            }
+            d.unresolvedPins += p.unresolvedPins;
+            p = NetsChunk{};   // 尽早释放段内缓冲
+        }
+    }
+
     BSDesign ParseBookShelf(const filesystem::path& nodesPath,
-        const filesystem::path& netsPath)
+        const filesystem::path& netsPath, unsigned numThreads)
     {
+        MappedFile nodesFile(nodesPath);
+        if (!nodesFile.ok()) throw runtime_error("Cannot open .nodes: " + nodesPath.string());
+        MappedFile netsFile(netsPath);
+        if (!netsFile.ok()) throw runtime_error("Cannot open .nets: " + netsPath.string());
+
         BSDesign d;
-        ParseNodes(nodesPath, d);
-        ParseNets(netsPath, d);
+        NodeLookup lookup;
+        ParseNodes(nodesFile.view(), d, lookup);
+        ParseNets(netsFile.view(), lookup, d, numThreads);
         return d;
     }
 
+    // ============ .pl / .scl / .aux ============
+
+    void ParsePlacement(const filesystem::path& plPath, BSDesign& d) {
+        MappedFile plFile(plPath);
+        if (!plFile.ok()) throw runtime_error("Cannot open .pl: " + plPath.string());
+
+        // 键指向 d.nodes 里的名字；此处不会增删节点，视图一直有效
+        NodeLookup lookup;
+        for (uint32_t i = 0; i < (uint32_t)d.nodes.size(); ++i) lookup.Insert(d.nodes[i].name, i);
+
+        LineCursor cur(plFile.view());
+        string_view line;
+        while (cur.Next(line)) {
+            if (IsCommentOrHeader(line)) continue;
+
+            // 形如： name x y : N [/FIXED | /FIXED_NI]
+            string_view rest = line;
+            const uint32_t id = lookup.Find(NextToken(rest));
+            if (id == kNoNode) continue;
+
+            double x = 0, y = 0;
+            if (!ParseNumber(NextToken(rest), x) || !ParseNumber(NextToken(rest), y)) continue;
+
+            BSNode& n = d.nodes[id];
+            if (!n.placed) ++d.placedNodes;
+            n.x = x;
+            n.y = y;
+            n.placed = true;
+            n.fixed = rest.find("/FIXED") != string_view::npos;
+        }
+    }
+
+    void ParseRows(const filesystem::path& sclPath, BSDesign& d) {
+        MappedFile sclFile(sclPath);
+        if (!sclFile.ok()) throw runtime_error("Cannot open .scl: " + sclPath.string());
+
+        auto keyIs = [](string_view key, string_view want) {
+            if (key.size() != want.size()) return false;
+            for (size_t i = 0; i < key.size(); ++i) {
+                if (tolower((unsigned char)key[i]) != tolower((unsigned char)want[i])) return false;
+            }
+            return true;
+            };
+
+        BSRow row;
+        bool inRow = false;
+        LineCursor cur(sclFile.view());
+        string_view line;
+        while (cur.Next(line)) {
+            if (IsCommentOrHeader(line)) continue;
+            if (StartsWith(line, "NumRows")) continue;
+            if (StartsWith(line, "CoreRow")) { row = BSRow{}; inRow = true; continue; }
+            if (StartsWith(line, "End")) {
+                if (inRow) d.rows.push_back(row);
+                inRow = false;
+                continue;
+            }
+            if (!inRow) continue;
+
+            // 一行里可能有多组 "Key : value"（SubrowOrigin : 0 NumSites : 100）
+            string_view rest = line;
+            while (!rest.empty()) {
+                string_view key = NextToken(rest);
+                if (key.empty()) break;
+                if (key.back() == ':') key.remove_suffix(1);
+                else {
+                    string_view colon = NextToken(rest);
+                    if (colon != ":") break;
+                }
+                string_view val = NextToken(rest);
+                if (keyIs(key, "Coordinate")) ParseNumber(val, row.y);
+                else if (keyIs(key, "Height")) ParseNumber(val, row.height);
+                else if (keyIs(key, "Sitewidth")) ParseNumber(val, row.siteWidth);
+                else if (keyIs(key, "Sitespacing")) ParseNumber(val, row.siteSpacing);
+                else if (keyIs(key, "SubrowOrigin")) ParseNumber(val, row.x);
+                else if (keyIs(key, "NumSites")) ParseNumber(val, row.numSites);
+            }
+        }
+    }
+
+    BSAuxFiles ParseAux(const filesystem::path& auxPath) {
+        MappedFile auxFile(auxPath);
+        if (!auxFile.ok()) throw runtime_error("Cannot open .aux: " + auxPath.string());
+
+        // 形如： RowBasedPlacement : a.nodes a.nets a.wts a.pl a.scl
+        BSAuxFiles files;
+        const filesystem::path dir = auxPath.parent_path();
+        LineCursor cur(auxFile.view());
+        string_view line;
+        while (cur.Next(line)) {
+            if (IsCommentOrHeader(line)) continue;
+            size_t colon = line.find(':');
+            string_view rest = colon == string_view::npos ? line : line.substr(colon + 1);
+            for (string_view tok = NextToken(rest); !tok.empty(); tok = NextToken(rest)) {
+                const filesystem::path f = dir / filesystem::u8path(string(tok));
+                const string ext = f.extension().string();
+                if (ext == ".nodes") files.nodes = f;
+                else if (ext == ".nets") files.nets = f;
+                else if (ext == ".pl") files.pl = f;
+                else if (ext == ".scl") files.scl = f;
+                else if (ext == ".wts") files.wts = f;
+            }
+        }
+        if (files.nodes.empty() || files.nets.empty())
+            throw runtime_error(".aux does not list both .nodes and .nets: " + auxPath.string());
+        return files;
+    }
+
+    BSDesign ParseBookShelfAux(const filesystem::path& auxPath, unsigned numThreads) {
+        const BSAuxFiles files = ParseAux(auxPath);
+        BSDesign d = ParseBookShelf(files.nodes, files.nets, numThreads);
+        if (!files.pl.empty() && filesystem::exists(files.pl)) ParsePlacement(files.pl, d);
+        if (!files.scl.empty() && filesystem::exists(files.scl)) ParseRows(files.scl, d);
+        return d;
+    }
+
+    // ============ 吞吐量基准 ============
+
+    std::pair<filesystem::path, filesystem::path>
+        WriteSyntheticBookShelf(const filesystem::path& outDir, const string& stem,
+            size_t numCells, size_t numNets, int pinsPerNet, unsigned seed)
+    {
+        if (numCells == 0) throw runtime_error("Synthetic design needs at least one cell");
+        filesystem::create_directories(outDir);
+        const auto nodesPath = outDir / (stem + ".nodes");
+        const auto netsPath = outDir / (stem + ".nets");
+
+        mt19937 rng(seed);
+        uniform_int_distribution<size_t> pickCell(0, numCells - 1);
+
+        string buf;
+        buf.reserve(1 << 20);
+        auto drain = [&](ofstream& ofs, bool force) {
+            if (force || buf.size() >= (1u << 20)) { ofs.write(buf.data(), (streamsize)buf.size()); buf.clear(); }
+            };
+
+        {
+            ofstream ofs(nodesPath, ios::binary);
+            if (!ofs) throw runtime_error("Cannot open file: " + nodesPath.string());
+            buf += "UCLA nodes 1.0\nNumNodes : " + to_string(numCells) + "\nNumTerminals : 0\n\n";
+            for (size_t i = 0; i < numCells; ++i) {
+                buf += "AND_" + to_string(i) + " 100.000000 40.000000\n";
+                drain(ofs, false);
+            }
+            drain(ofs, true);
+        }
+        {
+            ofstream ofs(netsPath, ios::binary);
+            if (!ofs) throw runtime_error("Cannot open file: " + netsPath.string());
+            buf += "UCLA nets 1.0\nNumNets : " + to_string(numNets) +
+                "\nNumPins : " + to_string(numNets * (size_t)pinsPerNet) + "\n\n";
+            for (size_t n = 0; n < numNets; ++n) {
+                buf += "NetDegree : " + to_string(pinsPerNet) + " net_" + to_string(n) + "\n";
+                for (int k = 0; k < pinsPerNet; ++k) {
+                    buf += " AND_" + to_string(pickCell(rng));
+                    buf += (k == 0) ? " O : 60.000000 0.000000\n" : " I : -40.000000 -10.000000\n";
+                }
+                drain(ofs, false);
+            }
+            drain(ofs, true);
+        }
+        return { nodesPath, netsPath };
+    }
+
+    ParseThroughput MeasureParseThroughput(const filesystem::path& nodesPath,
+        const filesystem::path& netsPath, int repeat, unsigned numThreads)
+    {
+        ParseThroughput r;
+        r.bytes = (size_t)(filesystem::file_size(nodesPath) + filesystem::file_size(netsPath));
+        for (int i = 0; i < std::max(1, repeat); ++i) {
+            const auto t0 = chrono::steady_clock::now();
+            BSDesign d = ParseBookShelf(nodesPath, netsPath, numThreads);
+            const double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+            if (i == 0 || sec < r.bestSeconds) r.bestSeconds = sec;
+            r.nodes = d.nodes.size();
+            r.nets = d.nets.size();
+            r.pins = d.pins.size();
+        }
+        return r;
+    }
+
 } // namespace bookshelf
@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -10,27 +11,91 @@ namespace bookshelf {
         std::string name;
         double width = 0, height = 0;
         bool terminal = false;
+        // 来自 .pl：左下角坐标（未出现在 .pl 中则 placed = false）
+        double x = 0, y = 0;
+        bool placed = false;
+        bool fixed = false;          // /FIXED 或 /FIXED_NI
     };
 
+    // 来自 .scl 的一行 CoreRow
+    struct BSRow {
+        double y = 0;                // Coordinate
+        double height = 0;
+        double siteWidth = 1;
+        double siteSpacing = 1;
+        double x = 0;                // SubrowOrigin
+        int numSites = 0;
+    };
+
+    // 引用了 .nodes 中不存在的单元
+    constexpr uint32_t kNoNode = 0xFFFFFFFFu;
+
+    // 紧凑引脚记录：单元名在解析时即解析成 nodes 下标，引脚名驻留到 pinNames 小表
     struct BSPin {
-        std::string cellName;
-        std::string pinName; // 可能是 I/O 或 P0/P1...
-        double dx = 0.0, dy = 0.0; // 相对 cell 中心
+        uint32_t nodeId = kNoNode;   // BSDesign::nodes 下标
+        uint32_t pinNameId = 0;      // BSDesign::pinNames 下标（I/O 或 P0/P1...）
+        float dx = 0.0f, dy = 0.0f;  // 相对 cell 中心
     };
 
+    // 网只记录自己在 BSDesign::pins 中的区间
     struct BSNet {
         std::string name;
-        std::vector<BSPin> pins;
+        uint32_t firstPin = 0;
+        uint32_t numPins = 0;
     };
 
     struct BSDesign {
         std::vector<BSNode> nodes;
         std::vector<BSNet> nets;
-        std::unordered_map<std::string, size_t> nodeIndexByName;
+        std::vector<BSPin> pins;               // 所有网的引脚，按网顺序平铺
+        std::vector<std::string> pinNames;     // 引脚名驻留表
+        size_t unresolvedPins = 0;             // 单元名不在 .nodes 中的引脚数
+        std::vector<BSRow> rows;               // .scl（可选）
+        size_t placedNodes = 0;                // .pl 中给出坐标的节点数
+
+        const BSPin* PinsBegin(const BSNet& n) const { return pins.data() + n.firstPin; }
+        const BSPin* PinsEnd(const BSNet& n) const { return pins.data() + n.firstPin + n.numPins; }
+        const std::string& PinName(const BSPin& p) const { return pinNames[p.pinNameId]; }
     };
 
     /// 解析 .nodes 与 .nets（UTF-8 文本）
+    /// 文件整体内存映射后按行切 string_view，数字用 from_chars，不再逐行构造 istringstream
+    /// .nets 按 NetDegree 边界切块多线程解析（numThreads = 0 取硬件线程数，1 为纯顺序）
     BSDesign ParseBookShelf(const std::filesystem::path& nodesPath,
-        const std::filesystem::path& netsPath);
+        const std::filesystem::path& netsPath, unsigned numThreads = 0);
+
+    /// 读取 .pl，把坐标写回 d.nodes（按名字匹配，.nodes 中没有的名字忽略）
+    void ParsePlacement(const std::filesystem::path& plPath, BSDesign& d);
+
+    /// 读取 .scl 的 CoreRow 列表到 d.rows
+    void ParseRows(const std::filesystem::path& sclPath, BSDesign& d);
+
+    // .aux 中列出的文件（按扩展名归类，路径相对 .aux 所在目录；没有的留空）
+    struct BSAuxFiles {
+        std::filesystem::path nodes, nets, pl, scl, wts;
+    };
+    BSAuxFiles ParseAux(const std::filesystem::path& auxPath);
+
+    /// 按 .aux 一次读入 .nodes/.nets，以及存在时的 .pl/.scl
+    BSDesign ParseBookShelfAux(const std::filesystem::path& auxPath, unsigned numThreads = 0);
+
+    // ===== 解析吞吐量基准 =====
+    struct ParseThroughput {
+        size_t bytes = 0;        // .nodes + .nets 总字节数
+        size_t nodes = 0;
+        size_t nets = 0;
+        size_t pins = 0;
+        double bestSeconds = 0;  // 多次重复中最快的一次
+        double MBps() const { return bestSeconds > 0 ? bytes / (1024.0 * 1024.0) / bestSeconds : 0.0; }
+    };
+
+    /// 生成合成设计（numCells 个单元、numNets 个网，每网 pinsPerNet 个引脚），固定种子可复现
+    std::pair<std::filesystem::path, std::filesystem::path>
+        WriteSyntheticBookShelf(const std::filesystem::path& outDir, const std::string& stem,
+            size_t numCells, size_t numNets, int pinsPerNet, unsigned seed = 1);
+
+    /// 重复解析 repeat 次，返回最快一次的吞吐量
+    ParseThroughput MeasureParseThroughput(const std::filesystem::path& nodesPath,
+        const std::filesystem::path& netsPath, int repeat = 3, unsigned numThreads = 0);
 
 } // namespace bookshelf
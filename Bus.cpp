@@ -0,0 +1,18 @@
+﻿// Bus.cpp
+#include "Bus.h"
+#include "LogicKernel.h"
+
+#include <algorithm>
+
+int BusComponent::Bits() const
+{
+    return std::max(1, std::min(width, logic::kMaxBusWidth));
+}
+
+std::vector<wxString> BusComponent::BitLabels() const
+{
+    std::vector<wxString> v;
+    v.reserve(Bits());
+    for (int b = 0; b < Bits(); ++b) v.push_back(wxString::Format("%d", b));
+    return v;
+}
@@ -0,0 +1,39 @@
+﻿// Bus.h
+#pragma once
+#include <vector>
+#include "Sequential.h"   // BlockComponent
+
+// ==========================================================
+//  总线拆合：分线器把一根 N 位总线拆成 N 根单线，合线器反之
+//  画法沿用方框元件：总线引脚在一侧居中，单线引脚在另一侧，位 0 在上
+//  位宽存于 Component::width（上限 logic::kMaxBusWidth）
+// ==========================================================
+
+class BusComponent : public BlockComponent {
+public:
+    BusComponent(wxPoint center, ComponentType type, int bits) : BlockComponent(center, type, 20.0) { width = bits; }
+    int Bits() const;
+protected:
+    wxString BusLabel() const { return wxString::Format("[%d:0]", Bits() - 1); }
+    std::vector<wxString> BitLabels() const;   // "0".."n-1"
+};
+
+// ---------- 分线器：总线 → 位 0..n-1 ----------
+class SplitterComp : public BusComponent {
+public:
+    SplitterComp(wxPoint center, int bits) : BusComponent(center, SPLITTER, bits) { UpdateGeometry(); }
+protected:
+    wxString Title() const override { return ""; }
+    std::vector<wxString> InputLabels() const override { return { BusLabel() }; }
+    std::vector<wxString> OutputLabels() const override { return BitLabels(); }
+};
+
+// ---------- 合线器：位 0..n-1 → 总线 ----------
+class MergerComp : public BusComponent {
+public:
+    MergerComp(wxPoint center, int bits) : BusComponent(center, MERGER, bits) { UpdateGeometry(); }
+protected:
+    wxString Title() const override { return ""; }
+    std::vector<wxString> InputLabels() const override { return BitLabels(); }
+    std::vector<wxString> OutputLabels() const override { return { BusLabel() }; }
+};
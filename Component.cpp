@@ -1,7 +1,40 @@
 ﻿#include <wx/graphics.h>
+#include <algorithm>
 #include <cmath>
 #include "Component.h"
 
+// ============ 多输入门公共部分 ============
+void Gate::AppendInputPins(std::vector<wxPoint>& pins, double pinDx) const {
+    for (int k = 0; k < Inputs(); ++k)
+        pins.push_back(wxPoint(m_center.x + pinDx * scale, m_center.y + InputDy(k) * scale));   // 与单点构造同样截断取整
+}
+
+void Gate::AddInputStubs(wxGraphicsPath& path, double pinDx, bool curvedBack) const {
+    for (int k = 0; k < Inputs(); ++k) {
+        const double dy = InputDy(k);
+        double bodyX = -20.0;
+        if (curvedBack && std::abs(dy) < 20.0) {
+            // 或门后缘为 (-20,-20)→(0,0)→(-20,20) 的二次曲线，按 dy 求曲线上的 x
+            const double t = (dy / 20.0 + 1.0) / 2.0;
+            bodyX = -20.0 * (1.0 - 2.0 * t + 2.0 * t * t);
+        }
+        path.MoveToPoint(m_center.x + pinDx * scale, m_center.y + dy * scale);
+        path.AddLineToPoint(m_center.x + bodyX * scale, m_center.y + dy * scale);
+    }
+    // 输入跨度超出门体时，沿后缘向上下补竖线（宽门画法）
+    const double span = std::abs(InputDy(0));
+    if (span > 20.0) {
+        path.MoveToPoint(m_center.x - 20 * scale, m_center.y - span * scale);
+        path.AddLineToPoint(m_center.x - 20 * scale, m_center.y - 20 * scale);
+        path.MoveToPoint(m_center.x - 20 * scale, m_center.y + 20 * scale);
+        path.AddLineToPoint(m_center.x - 20 * scale, m_center.y + span * scale);
+    }
+}
+
+double Gate::HalfH(double minHalf) const {
+    return std::max(minHalf, std::abs(InputDy(0)) + 2.0);
+}
+
 // ============ AND ============
 void ANDGate::drawSelf(wxMemoryDC& memDC) {
     wxGraphicsContext* gc = wxGraphicsContext::Create(memDC);
@@ -17,11 +50,8 @@ void ANDGate::drawSelf(wxMemoryDC& memDC) {
     path.AddLineToPoint(m_center.x + 20 * scale, m_center.y + 20 * scale);
     path.AddArc(m_center.x + 20 * scale, m_center.y, 20 * scale, M_PI / 2, -M_PI / 2, false);
 
-    // 输入两根
-    path.MoveToPoint(m_center.x - 40 * scale, m_center.y + 10 * scale);
-    path.AddLineToPoint(m_center.x - 20 * scale, m_center.y + 10 * scale);
-    path.MoveToPoint(m_center.x - 40 * scale, m_center.y - 10 * scale);
-    path.AddLineToPoint(m_center.x - 20 * scale, m_center.y - 10 * scale);
+    // 输入两根（多输入时沿后缘延长）
+    AddInputStubs(path, -40, false);
 
     // 输出
     path.MoveToPoint(m_center.x + 40 * scale, m_center.y);
@@ -49,10 +79,10 @@ bool ANDGate::Isinside(const wxPoint& point) const {
 }
 
 void ANDGate::UpdateGeometry() {
-    m_BoundaryPoints[0] = wxPoint(m_center.x - 40 * scale, m_center.y - 20 * scale); // 左上
-    m_BoundaryPoints[1] = wxPoint(m_center.x - 40 * scale, m_center.y + 20 * scale); // 左下
-    m_BoundaryPoints[2] = wxPoint(m_center.x + 60 * scale, m_center.y - 20 * scale); // 右上
-    m_BoundaryPoints[3] = wxPoint(m_center.x + 60 * scale, m_center.y + 20 * scale); // 右下
+    m_BoundaryPoints[0] = wxPoint(m_center.x - 40 * scale, m_center.y - HalfH(20) * scale); // 左上
+    m_BoundaryPoints[1] = wxPoint(m_center.x - 40 * scale, m_center.y + HalfH(20) * scale); // 左下
+    m_BoundaryPoints[2] = wxPoint(m_center.x + 60 * scale, m_center.y - HalfH(20) * scale); // 右上
+    m_BoundaryPoints[3] = wxPoint(m_center.x + 60 * scale, m_center.y + HalfH(20) * scale); // 右下
     pout = wxPoint(m_center.x + 60 * scale, m_center.y);
 }
 
@@ -72,11 +102,8 @@ void ORGate::drawSelf(wxMemoryDC& memDC) {
     path.AddQuadCurveToPoint(m_center.x + 20 * scale, m_center.y + 20 * scale, m_center.x + 40 * scale, m_center.y);
     path.AddQuadCurveToPoint(m_center.x + 20 * scale, m_center.y - 20 * scale, m_center.x, m_center.y - 20 * scale);
 
-    // 输入两根
-    path.MoveToPoint(m_center.x - 40 * scale, m_center.y + 10 * scale);
-    path.AddLineToPoint(m_center.x - 13 * scale, m_center.y + 10 * scale);
-    path.MoveToPoint(m_center.x - 40 * scale, m_center.y - 10 * scale);
-    path.AddLineToPoint(m_center.x - 13 * scale, m_center.y - 10 * scale);
+    // 输入两根（多输入时沿后缘延长）
+    AddInputStubs(path, -40, true);
 
     // 输出
     path.MoveToPoint(m_center.x + 40 * scale, m_center.y);
@@ -103,10 +130,10 @@ bool ORGate::Isinside(const wxPoint& point) const {
 }
 
 void ORGate::UpdateGeometry() {
-    m_BoundaryPoints[0] = wxPoint(m_center.x - 40 * scale, m_center.y - 22 * scale);
-    m_BoundaryPoints[1] = wxPoint(m_center.x - 40 * scale, m_center.y + 22 * scale);
-    m_BoundaryPoints[2] = wxPoint(m_center.x + 60 * scale, m_center.y - 22 * scale);
-    m_BoundaryPoints[3] = wxPoint(m_center.x + 60 * scale, m_center.y + 22 * scale);
+    m_BoundaryPoints[0] = wxPoint(m_center.x - 40 * scale, m_center.y - HalfH(22) * scale);
+    m_BoundaryPoints[1] = wxPoint(m_center.x - 40 * scale, m_center.y + HalfH(22) * scale);
+    m_BoundaryPoints[2] = wxPoint(m_center.x + 60 * scale, m_center.y - HalfH(22) * scale);
+    m_BoundaryPoints[3] = wxPoint(m_center.x + 60 * scale, m_center.y + HalfH(22) * scale);
     pout = wxPoint(m_center.x + 60 * scale, m_center.y);
 }
 
@@ -178,11 +205,8 @@ void NANDGate::drawSelf(wxMemoryDC& memDC) {
     path.AddLineToPoint(m_center.x + 20 * scale, m_center.y + 20 * scale);
     path.AddArc(m_center.x + 20 * scale, m_center.y, 20 * scale, M_PI / 2, -M_PI / 2, false);
 
-    // 输入
-    path.MoveToPoint(m_center.x - 40 * scale, m_center.y + 10 * scale);
-    path.AddLineToPoint(m_center.x - 20 * scale, m_center.y + 10 * scale);
-    path.MoveToPoint(m_center.x - 40 * scale, m_center.y - 10 * scale);
-    path.AddLineToPoint(m_center.x - 20 * scale, m_center.y - 10 * scale);
+    // 输入（多输入时沿后缘延长）
+    AddInputStubs(path, -40, false);
 
     // 反相气泡：略右移 & 略小，避免与 AND 半圆描边重合
     path.AddCircle(m_center.x + 47 * scale, m_center.y, 4 * scale);
@@ -211,10 +235,10 @@ bool NANDGate::Isinside(const wxPoint& point) const {
 }
 
 void NANDGate::UpdateGeometry() {
-    m_BoundaryPoints[0] = wxPoint(m_center.x - 40 * scale, m_center.y - 22 * scale);
-    m_BoundaryPoints[1] = wxPoint(m_center.x - 40 * scale, m_center.y + 22 * scale);
-    m_BoundaryPoints[2] = wxPoint(m_center.x + 66 * scale, m_center.y - 22 * scale); // 65 -> 66
-    m_BoundaryPoints[3] = wxPoint(m_center.x + 66 * scale, m_center.y + 22 * scale); // 65 -> 66
+    m_BoundaryPoints[0] = wxPoint(m_center.x - 40 * scale, m_center.y - HalfH(22) * scale);
+    m_BoundaryPoints[1] = wxPoint(m_center.x - 40 * scale, m_center.y + HalfH(22) * scale);
+    m_BoundaryPoints[2] = wxPoint(m_center.x + 66 * scale, m_center.y - HalfH(22) * scale); // 65 -> 66
+    m_BoundaryPoints[3] = wxPoint(m_center.x + 66 * scale, m_center.y + HalfH(22) * scale); // 65 -> 66
     pout = wxPoint(m_center.x + 66 * scale, m_center.y);
 }
 
@@ -235,11 +259,8 @@ void NORGate::drawSelf(wxMemoryDC& memDC) {
     path.AddQuadCurveToPoint(m_center.x + 20 * scale, m_center.y + 20 * scale, m_center.x + 40 * scale, m_center.y);
     path.AddQuadCurveToPoint(m_center.x + 20 * scale, m_center.y - 20 * scale, m_center.x, m_center.y - 20 * scale);
 
-    // 输入
-    path.MoveToPoint(m_center.x - 40 * scale, m_center.y + 10 * scale);
-    path.AddLineToPoint(m_center.x - 13 * scale, m_center.y + 10 * scale);
-    path.MoveToPoint(m_center.x - 40 * scale, m_center.y - 10 * scale);
-    path.AddLineToPoint(m_center.x - 13 * scale, m_center.y - 10 * scale);
+    // 输入（多输入时沿后缘延长）
+    AddInputStubs(path, -40, true);
 
     // 输出气泡
     path.AddCircle(m_center.x + 45 * scale, m_center.y, 5 * scale);
@@ -269,10 +290,10 @@ bool NORGate::Isinside(const wxPoint& point) const {
 }
 
 void NORGate::UpdateGeometry() {
-    m_BoundaryPoints[0] = wxPoint(m_center.x - 40 * scale, m_center.y - 22 * scale);
-    m_BoundaryPoints[1] = wxPoint(m_center.x - 40 * scale, m_center.y + 22 * scale);
-    m_BoundaryPoints[2] = wxPoint(m_center.x + 65 * scale, m_center.y - 22 * scale);
-    m_BoundaryPoints[3] = wxPoint(m_center.x + 65 * scale, m_center.y + 22 * scale);
+    m_BoundaryPoints[0] = wxPoint(m_center.x - 40 * scale, m_center.y - HalfH(22) * scale);
+    m_BoundaryPoints[1] = wxPoint(m_center.x - 40 * scale, m_center.y + HalfH(22) * scale);
+    m_BoundaryPoints[2] = wxPoint(m_center.x + 65 * scale, m_center.y - HalfH(22) * scale);
+    m_BoundaryPoints[3] = wxPoint(m_center.x + 65 * scale, m_center.y + HalfH(22) * scale);
     pout = wxPoint(m_center.x + 65 * scale, m_center.y);
 }
 
@@ -298,11 +319,8 @@ void XORGate::drawSelf(wxMemoryDC& memDC) {
     path.AddLineToPoint(m_center.x - 20 * scale - offset, m_center.y - 20 * scale);
     path.AddQuadCurveToPoint(m_center.x - offset, m_center.y, m_center.x - 20 * scale - offset, m_center.y + 20 * scale);
 
-    // 输入两根
-    path.MoveToPoint(m_center.x - 40 * scale, m_center.y + 10 * scale);
-    path.AddLineToPoint(m_center.x - 13 * scale, m_center.y + 10 * scale);
-    path.MoveToPoint(m_center.x - 40 * scale, m_center.y - 10 * scale);
-    path.AddLineToPoint(m_center.x - 13 * scale, m_center.y - 10 * scale);
+    // 输入两根（多输入时沿后缘延长）
+    AddInputStubs(path, -40, true);
 
     // 输出
     path.MoveToPoint(m_center.x + 40 * scale, m_center.y);
@@ -329,28 +347,28 @@ bool XORGate::Isinside(const wxPoint& point) const {
 }
 
 void XORGate::UpdateGeometry() {
-    m_BoundaryPoints[0] = wxPoint(m_center.x - 46 * scale, m_center.y - 22 * scale); // 比 OR 再往左一点，为前缘双曲线预留空间
-    m_BoundaryPoints[1] = wxPoint(m_center.x - 46 * scale, m_center.y + 22 * scale);
-    m_BoundaryPoints[2] = wxPoint(m_center.x + 60 * scale, m_center.y - 22 * scale);
-    m_BoundaryPoints[3] = wxPoint(m_center.x + 60 * scale, m_center.y + 22 * scale);
+    m_BoundaryPoints[0] = wxPoint(m_center.x - 46 * scale, m_center.y - HalfH(22) * scale); // 比 OR 再往左一点，为前缘双曲线预留空间
+    m_BoundaryPoints[1] = wxPoint(m_center.x - 46 * scale, m_center.y + HalfH(22) * scale);
+    m_BoundaryPoints[2] = wxPoint(m_center.x + 60 * scale, m_center.y - HalfH(22) * scale);
+    m_BoundaryPoints[3] = wxPoint(m_center.x + 60 * scale, m_center.y + HalfH(22) * scale);
     pout = wxPoint(m_center.x + 60 * scale, m_center.y);
 }
 
 // Component.cpp 末尾新增：返回每个门的可连接引脚（输入 + 输出），顺序随意
 std::vector<wxPoint> ANDGate::GetPins() const {
-    return {
-        wxPoint(m_center.x - 40 * scale, m_center.y - 10 * scale), // IN1
-        wxPoint(m_center.x - 40 * scale, m_center.y + 10 * scale), // IN2
-        wxPoint(m_center.x + 60 * scale, m_center.y)               // OUT
-    };
+    std::vector<wxPoint> pins;
+    pins.reserve(Inputs() + 1);
+    AppendInputPins(pins, -40);                                     // IN1..INn
+    pins.push_back(wxPoint(m_center.x + 60 * scale, m_center.y));   // OUT
+    return pins;
 }
 
 std::vector<wxPoint> ORGate::GetPins() const {
-    return {
-        wxPoint(m_center.x - 40 * scale, m_center.y - 10 * scale),
-        wxPoint(m_center.x - 40 * scale, m_center.y + 10 * scale),
-        wxPoint(m_center.x + 60 * scale, m_center.y)
-    };
+    std::vector<wxPoint> pins;
+    pins.reserve(Inputs() + 1);
+    AppendInputPins(pins, -40);
+    pins.push_back(wxPoint(m_center.x + 60 * scale, m_center.y));
+    return pins;
 }
 
 std::vector<wxPoint> NOTGate::GetPins() const {
@@ -361,27 +379,27 @@ std::vector<wxPoint> NOTGate::GetPins() const {
 }
 
 std::vector<wxPoint> NANDGate::GetPins() const {
-    return {
-        wxPoint(m_center.x - 40 * scale, m_center.y - 10 * scale),
-        wxPoint(m_center.x - 40 * scale, m_center.y + 10 * scale),
-        wxPoint(m_center.x + 66 * scale, m_center.y)               // OUT（注意 66）
-    };
+    std::vector<wxPoint> pins;
+    pins.reserve(Inputs() + 1);
+    AppendInputPins(pins, -40);
+    pins.push_back(wxPoint(m_center.x + 66 * scale, m_center.y));   // OUT（注意 66）
+    return pins;
 }
 
 std::vector<wxPoint> NORGate::GetPins() const {
-    return {
-        wxPoint(m_center.x - 40 * scale, m_center.y - 10 * scale),
-        wxPoint(m_center.x - 40 * scale, m_center.y + 10 * scale),
-        wxPoint(m_center.x + 65 * scale, m_center.y)               // OUT（注意 65）
-    };
+    std::vector<wxPoint> pins;
+    pins.reserve(Inputs() + 1);
+    AppendInputPins(pins, -40);
+    pins.push_back(wxPoint(m_center.x + 65 * scale, m_center.y));   // OUT（注意 65）
+    return pins;
 }
 
 std::vector<wxPoint> XORGate::GetPins() const {
-    return {
-        wxPoint(m_center.x - 40 * scale, m_center.y - 10 * scale),
-        wxPoint(m_center.x - 40 * scale, m_center.y + 10 * scale),
-        wxPoint(m_center.x + 60 * scale, m_center.y)
-    };
+    std::vector<wxPoint> pins;
+    pins.reserve(Inputs() + 1);
+    AppendInputPins(pins, -40);
+    pins.push_back(wxPoint(m_center.x + 60 * scale, m_center.y));
+    return pins;
 }
 
 // ===================== Nodes =====================
@@ -556,11 +574,8 @@ void XNORGate::drawSelf(wxMemoryDC& memDC) {
     path.AddLineToPoint(m_center.x - 20 * scale - offset, m_center.y - 20 * scale);
     path.AddQuadCurveToPoint(m_center.x - offset, m_center.y, m_center.x - 20 * scale - offset, m_center.y + 20 * scale);
 
-    // 输入
-    path.MoveToPoint(m_center.x - 40 * scale, m_center.y + 10 * scale);
-    path.AddLineToPoint(m_center.x - 13 * scale, m_center.y + 10 * scale);
-    path.MoveToPoint(m_center.x - 40 * scale, m_center.y - 10 * scale);
-    path.AddLineToPoint(m_center.x - 13 * scale, m_center.y - 10 * scale);
+    // 输入（多输入时沿后缘延长）
+    AddInputStubs(path, -40, true);
 
     // 反相气泡 + 输出线
     path.AddCircle(m_center.x + 45 * scale, m_center.y, 5 * scale);
@@ -586,19 +601,19 @@ bool XNORGate::Isinside(const wxPoint& p) const {
 }
 
 void XNORGate::UpdateGeometry() {
-    m_BoundaryPoints[0] = wxPoint(m_center.x - 46 * scale, m_center.y - 22 * scale);
-    m_BoundaryPoints[1] = wxPoint(m_center.x - 46 * scale, m_center.y + 22 * scale);
-    m_BoundaryPoints[2] = wxPoint(m_center.x + 66 * scale, m_center.y - 22 * scale);
-    m_BoundaryPoints[3] = wxPoint(m_center.x + 66 * scale, m_center.y + 22 * scale);
+    m_BoundaryPoints[0] = wxPoint(m_center.x - 46 * scale, m_center.y - HalfH(22) * scale);
+    m_BoundaryPoints[1] = wxPoint(m_center.x - 46 * scale, m_center.y + HalfH(22) * scale);
+    m_BoundaryPoints[2] = wxPoint(m_center.x + 66 * scale, m_center.y - HalfH(22) * scale);
+    m_BoundaryPoints[3] = wxPoint(m_center.x + 66 * scale, m_center.y + HalfH(22) * scale);
     pout = wxPoint(m_center.x + 66 * scale, m_center.y);
 }
 
 std::vector<wxPoint> XNORGate::GetPins() const {
-    return {
-        wxPoint(m_center.x - 40 * scale, m_center.y - 10 * scale),
-        wxPoint(m_center.x - 40 * scale, m_center.y + 10 * scale),
-        wxPoint(m_center.x + 66 * scale, m_center.y) // 输出在气泡之后
-    };
+    std::vector<wxPoint> pins;
+    pins.reserve(Inputs() + 1);
+    AppendInputPins(pins, -40);
+    pins.push_back(wxPoint(m_center.x + 66 * scale, m_center.y));   // 输出在气泡之后
+    return pins;
 }
 
 // ------ 2-4 译码器 ------
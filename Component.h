@@ -1,28 +1,16 @@
 ﻿#pragma once
 #include <wx/wx.h>
 #include <vector> 
+#include "ComponentType.h"
 
-// 新增更完整的门/器件类型
-enum ComponentType {
-    ANDGATE,
-    ORGATE,
-    NOTGATE,
-    NANDGATE,
-    NORGATE,      // NOR
-    XORGATE,
-    XNORGATE,     // ★ 新增：XNOR
-    POWER,
-    NODE_BASIC,   // 普通结点（小圆点，多线汇聚）
-    NODE_START,   // 起始节点
-    NODE_END,     // 终止节点
-    DECODER24,    // ★ 新增：2-4 译码器
-    DECODER38     // ★ 新增：3-8 译码器
-};
+class wxGraphicsPath;
 
 class Component {
 public:
     ComponentType m_type;
     double scale;
+    int width = 1;           // 位宽参数：寄存器/分线器/合线器为位数，门为总线宽度（整字运算）；改后需 UpdateGeometry
+    int inputs = 2;          // 输入数：与/或/异或类门的输入个数，数据选择器的数据路数；改后需 UpdateGeometry
     bool scaling = false;
     wxPoint m_BoundaryPoints[4];
 
@@ -50,12 +38,23 @@ protected:
 
 class Gate : public Component {
 public:
+    static constexpr int MAX_INPUTS = 32;
     wxPoint pout; // 输出引脚位置（可选使用）
     Gate(wxPoint center, ComponentType type) : Component(center, type) {}
     virtual ~Gate() {}
     virtual void drawSelf(wxMemoryDC& memDC) = 0;
     virtual void UpdateGeometry() = 0;
     virtual bool Isinside(const wxPoint& point) const = 0;
+
+    int Inputs() const { return inputs < 2 ? 2 : (inputs > MAX_INPUTS ? MAX_INPUTS : inputs); }
+
+protected:
+    // 多输入门：输入引脚间距 20、以中心对称（2 输入时即 ±10），超出门体的部分沿后缘补竖线
+    double InputDy(int k) const { return (k - (Inputs() - 1) / 2.0) * 20.0; }   // 未缩放
+    void AppendInputPins(std::vector<wxPoint>& pins, double pinDx) const;
+    // 输入短线：pinDx → 门体后缘（curvedBack 为或门类的弧形后缘）
+    void AddInputStubs(wxGraphicsPath& path, double pinDx, bool curvedBack) const;
+    double HalfH(double minHalf) const;   // 包围盒半高（未缩放），随输入跨度增长
 };
 
 // ---------- AND ----------
@@ -0,0 +1,30 @@
+﻿// ComponentType.h
+#pragma once
+
+// 元件类型（不依赖 wx，仿真核心与界面共用）
+enum ComponentType {
+    ANDGATE,
+    ORGATE,
+    NOTGATE,
+    NANDGATE,
+    NORGATE,      // NOR
+    XORGATE,
+    XNORGATE,     // ★ 新增：XNOR
+    POWER,
+    NODE_BASIC,   // 普通结点（小圆点，多线汇聚）
+    NODE_START,   // 起始节点
+    NODE_END,     // 终止节点
+    DECODER24,    // ★ 新增：2-4 译码器
+    DECODER38,    // ★ 新增：3-8 译码器
+    SUBCIRCUIT,   // 用户定义的子电路（定义共享，见 Subcircuit.h）
+    CLOCK,        // 时钟源（仿真时每个节拍翻转）
+    DFF,          // D 触发器（上升沿）：D, CLK → Q, QN
+    JKFF,         // JK 触发器（上升沿）：J, CLK, K → Q, QN
+    DLATCH,       // D 锁存器（EN 高电平透明）：D, EN → Q, QN
+    REGISTER,     // N 位寄存器（上升沿）：D0..Dn-1, CLK → Q0..Qn-1，位宽见 Component::width
+    SPLITTER,     // 分线器：一根 N 位总线 → N 根单线（位 0 在上）
+    MERGER,       // 合线器：N 根单线 → 一根 N 位总线
+    MUX,          // 数据选择器：D0..Dn-1（各 width 位）, S（选择总线）→ Y；路数见 Component::inputs
+    ADDER,        // 加法器：A, B（width 位）, CIN → S（width 位）, COUT；1 位即全加器
+    COMPARATOR    // 无符号比较器：A, B（width 位）→ LT, EQ, GT
+};
@@ -0,0 +1,217 @@
+﻿// Connectivity.cpp
+#include "Connectivity.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
+namespace {
+
+    // ========= 并查集（按大小合并 + 路径减半）=========
+    struct UF {
+        std::vector<int> parent, size;
+        explicit UF(int n) : parent(n), size(n, 1) { std::iota(parent.begin(), parent.end(), 0); }
+        int find(int i) {
+            while (parent[i] != i) {
+                parent[i] = parent[parent[i]];
+                i = parent[i];
+            }
+            return i;
+        }
+        void unite(int i, int j) {
+            int ri = find(i), rj = find(j);
+            if (ri == rj) return;
+            if (size[ri] < size[rj]) std::swap(ri, rj);
+            parent[rj] = ri;
+            size[ri] += size[rj];
+        }
+    };
+
+    inline int DivFloorInt(int v, int d) {
+        if (v >= 0) return v / d;
+        return -(((-v) + d - 1) / d);
+    }
+
+    template <class P>
+    inline bool NearlyEqualPt(const P& a, const P& b, int tol) {
+        return (std::abs(a.x - b.x) <= tol) && (std::abs(a.y - b.y) <= tol);
+    }
+
+    template <class P>
+    bool PointOnSegmentTol(const P& p, const P& a, const P& b, int tol) {
+        // 轴对齐线段（Manhattan） + 少量容差
+        if (a.x == b.x) {
+            const int y0 = std::min(a.y, b.y);
+            const int y1 = std::max(a.y, b.y);
+            return (std::abs(p.x - a.x) <= tol) && (p.y >= y0 - tol) && (p.y <= y1 + tol);
+        }
+        if (a.y == b.y) {
+            const int x0 = std::min(a.x, b.x);
+            const int x1 = std::max(a.x, b.x);
+            return (std::abs(p.y - a.y) <= tol) && (p.x >= x0 - tol) && (p.x <= x1 + tol);
+        }
+
+        // 斜线兜底：点到线段距离
+        const double vx = double(b.x) - a.x, vy = double(b.y) - a.y;
+        const double wx = double(p.x) - a.x, wy = double(p.y) - a.y;
+        const double vv = vx * vx + vy * vy;
+        if (vv <= 1e-9) return NearlyEqualPt(p, a, tol);
+        double t = (wx * vx + wy * vy) / vv;
+        t = std::clamp(t, 0.0, 1.0);
+        const double dx = wx - t * vx, dy = wy - t * vy;
+        return (dx * dx + dy * dy) <= double(tol) * tol;
+    }
+
+    // ========= 均匀网格（CSR）：计数排序把点按格子归桶 =========
+    // 格子不小于 minCell；点很稀疏时再放大，保证格子总数与点数同阶
+    class PointGrid {
+    public:
+        PointGrid(const std::vector<int>& xs, const std::vector<int>& ys, int minCell) {
+            const int n = (int)xs.size();
+            if (n == 0) { m_cell = minCell; m_nx = m_ny = 1; m_start.assign(2, 0); return; }
+
+            m_x0 = *std::min_element(xs.begin(), xs.end());
+            m_y0 = *std::min_element(ys.begin(), ys.end());
+            const int64_t w = int64_t(*std::max_element(xs.begin(), xs.end())) - m_x0 + 1;
+            const int64_t h = int64_t(*std::max_element(ys.begin(), ys.end())) - m_y0 + 1;
+
+            int64_t cell = minCell;
+            while ((w / cell + 1) * (h / cell + 1) > 2 * int64_t(n) + 64) cell *= 2;
+            m_cell = (int)cell;
+            m_nx = int(w / cell + 1);
+            m_ny = int(h / cell + 1);
+
+            m_start.assign(size_t(m_nx) * m_ny + 1, 0);
+            for (int i = 0; i < n; ++i) ++m_start[Index(CellX(xs[i]), CellY(ys[i])) + 1];
+            for (size_t k = 1; k < m_start.size(); ++k) m_start[k] += m_start[k - 1];
+            m_order.resize(n);
+            m_xs.resize(n);
+            m_ys.resize(n);
+            std::vector<int> fill(m_start.begin(), m_start.end() - 1);
+            for (int i = 0; i < n; ++i) {
+                const int k = fill[Index(CellX(xs[i]), CellY(ys[i]))]++;
+                m_order[k] = i;
+                m_xs[k] = xs[i];   // 坐标按格子顺序再存一份，扫格子时连续访问
+                m_ys[k] = ys[i];
+            }
+        }
+
+        int CellX(int x) const { return DivFloorInt(x - m_x0, m_cell); }
+        int CellY(int y) const { return DivFloorInt(y - m_y0, m_cell); }
+
+        // 遍历格子区间 [cx0,cx1]x[cy0,cy1] 中的点 f(下标, x, y)（自动裁到网格范围）
+        template <class F>
+        void ForEachInCells(int cx0, int cx1, int cy0, int cy1, F&& f) const {
+            cx0 = std::max(cx0, 0); cy0 = std::max(cy0, 0);
+            cx1 = std::min(cx1, m_nx - 1); cy1 = std::min(cy1, m_ny - 1);
+            for (int cy = cy0; cy <= cy1; ++cy) {
+                for (int cx = cx0; cx <= cx1; ++cx) {
+                    const size_t c = Index(cx, cy);
+                    for (int k = m_start[c]; k < m_start[c + 1]; ++k) f(m_order[k], m_xs[k], m_ys[k]);
+                }
+            }
+        }
+
+    private:
+        size_t Index(int cx, int cy) const { return size_t(cy) * m_nx + cx; }
+
+        int m_cell = 1, m_nx = 1, m_ny = 1;
+        int m_x0 = 0, m_y0 = 0;
+        std::vector<int> m_start;   // 格子 c 的点为 m_order[m_start[c], m_start[c + 1])
+        std::vector<int> m_order;
+        std::vector<int> m_xs, m_ys;
+    };
+
+} // namespace
+
+void Connectivity::Clear() {
+    m_pinPts.clear();
+    m_pinRefs.clear();
+    m_wirePts.clear();
+    m_wireStart.assign(1, 0);
+    m_pinNet.clear();
+    m_wireNet.clear();
+    m_netStart.assign(1, 0);
+    m_netPins.clear();
+}
+
+void Connectivity::Reserve(size_t pins, size_t wireVerts) {
+    m_pinPts.reserve(pins);
+    m_pinRefs.reserve(pins);
+    m_wirePts.reserve(wireVerts);
+}
+
+int Connectivity::AddPin(const PinRef& ref, int x, int y) {
+    m_pinPts.push_back(Pt{ x, y });
+    m_pinRefs.push_back(ref);
+    return (int)m_pinPts.size() - 1;
+}
+
+void Connectivity::Extract(int tol) {
+    const int numPins = (int)m_pinPts.size();
+    const int numWires = (int)m_wireStart.size() - 1;
+    const int n = numPins + (int)m_wirePts.size();   // 图节点：引脚在前，wire 顶点在后
+
+    std::vector<int> xs(n), ys(n);
+    for (int i = 0; i < numPins; ++i) { xs[i] = m_pinPts[i].x; ys[i] = m_pinPts[i].y; }
+    for (int i = 0; i < (int)m_wirePts.size(); ++i) { xs[numPins + i] = m_wirePts[i].x; ys[numPins + i] = m_wirePts[i].y; }
+    auto ptOf = [&](int i) { return Pt{ xs[i], ys[i] }; };
+
+    UF uf(n);
+
+    // 格子比容差大：近重合通常只查本格，线段只扫它覆盖的一条窄带
+    const PointGrid grid(xs, ys, std::max(32, 2 * (tol + 1)));
+
+    // 1) 合并“几乎重合”的点
+    for (int i = 0; i < n; ++i) {
+        const Pt p = ptOf(i);
+        grid.ForEachInCells(grid.CellX(p.x - tol), grid.CellX(p.x + tol),
+            grid.CellY(p.y - tol), grid.CellY(p.y + tol), [&](int j, int x, int y) {
+            if (j > i && NearlyEqualPt(p, Pt{ x, y }, tol)) uf.unite(i, j);
+            });
+    }
+
+    // 2) 每一段导线把落在段上的点合并（T 形连接、引脚在线中间）
+    for (int w = 0; w < numWires; ++w) {
+        const int b0 = m_wireStart[w], b1 = m_wireStart[w + 1];
+        if (b1 - b0 < 2) continue;
+        for (int k = b0 + 1; k < b1; ++k) {
+            const Pt a = m_wirePts[k - 1], b = m_wirePts[k];
+            const int self = numPins + k;
+            uf.unite(self - 1, self);   // 同一条线上相邻顶点必然连通
+            if (a.x == b.x && a.y == b.y) continue;
+
+            const int minx = std::min(a.x, b.x) - tol, maxx = std::max(a.x, b.x) + tol;
+            const int miny = std::min(a.y, b.y) - tol, maxy = std::max(a.y, b.y) + tol;
+            grid.ForEachInCells(grid.CellX(minx), grid.CellX(maxx), grid.CellY(miny), grid.CellY(maxy), [&](int j, int x, int y) {
+                const Pt p{ x, y };
+                if (p.x < minx || p.x > maxx || p.y < miny || p.y > maxy) return;
+                if (PointOnSegmentTol(p, a, b, tol)) uf.unite(self, j);
+                });
+        }
+    }
+
+    // 3) 只含引脚的分量才成网；按最小引脚下标编号，网内引脚升序
+    std::vector<int> rootNet(n, -1);
+    m_pinNet.assign(numPins, -1);
+    int numNets = 0;
+    for (int i = 0; i < numPins; ++i) {
+        int& id = rootNet[uf.find(i)];
+        if (id < 0) id = numNets++;
+        m_pinNet[i] = id;
+    }
+
+    m_netStart.assign(numNets + 1, 0);
+    for (int i = 0; i < numPins; ++i) ++m_netStart[m_pinNet[i] + 1];
+    for (int k = 0; k < numNets; ++k) m_netStart[k + 1] += m_netStart[k];
+    m_netPins.resize(numPins);
+    std::vector<int> fill(m_netStart.begin(), m_netStart.end() - 1);
+    for (int i = 0; i < numPins; ++i) m_netPins[fill[m_pinNet[i]]++] = i;
+
+    m_wireNet.assign(numWires, -1);
+    for (int w = 0; w < numWires; ++w) {
+        if (m_wireStart[w + 1] - m_wireStart[w] < 2) continue;
+        m_wireNet[w] = rootNet[uf.find(numPins + m_wireStart[w])];
+    }
+}
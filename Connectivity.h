@@ -0,0 +1,76 @@
+﻿// Connectivity.h
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <utility>
+
+// ==========================================================
+//  几何连通性提取（导出与仿真共用，不依赖 wx）
+//  输入：元件引脚点 + 导线折线
+//  规则：
+//    - 距离在容差内的点视为同一点（抗缩放取整误差）
+//    - 落在导线任一段上的点（引脚 / 另一条线的端点或拐点）与该线连通
+//      即 T 形连接、NODE_BASIC 扇出、引脚落在线中间都无需拆线
+//  实现：并查集 + 均匀网格空间索引，近似线性
+// ==========================================================
+
+// ========== 引脚引用结构 ==========
+struct PinRef {
+    int compIdx = -1;  // 组件下标
+    int pinIdx = -1;   // 引脚下标（0..n-1）
+    bool operator==(const PinRef& o) const { return compIdx == o.compIdx && pinIdx == o.pinIdx; }
+};
+
+class Connectivity {
+public:
+    // 连接容差：不要太大（避免误连），但要能覆盖缩放/取整造成的 1~2 像素误差
+    static constexpr int CONNECT_TOL = 4;
+
+    void Clear();
+    void Reserve(size_t pins, size_t wireVerts);
+
+    // 添加引脚，返回引脚下标（按添加顺序）
+    int AddPin(const PinRef& ref, int x, int y);
+
+    // 添加一条折线（任意带 x/y 成员的点类型），返回 wire 下标
+    // 少于 2 个点的线保留下标但不参与连通
+    template <class PointT>
+    int AddWire(const std::vector<PointT>& poly) {
+        const int w = (int)m_wireStart.size() - 1;
+        for (const auto& p : poly) m_wirePts.push_back(Pt{ (int)p.x, (int)p.y });
+        m_wireStart.push_back((int)m_wirePts.size());
+        return w;
+    }
+
+    // 计算连通分量；调用后下面的查询才有效
+    void Extract(int tol = CONNECT_TOL);
+
+    // 网 = 至少含一个引脚的连通分量，按其最小引脚下标排序编号
+    int NumNets() const { return (int)m_netStart.size() - 1; }
+    int NumPins() const { return (int)m_pinPts.size(); }
+    int NumWires() const { return (int)m_wireStart.size() - 1; }
+
+    const PinRef& Pin(int pin) const { return m_pinRefs[pin]; }
+    int PinX(int pin) const { return m_pinPts[pin].x; }
+    int PinY(int pin) const { return m_pinPts[pin].y; }
+    int PinNet(int pin) const { return m_pinNet[pin]; }
+    int WireNet(int wire) const { return m_wireNet[wire]; }  // -1：不连任何引脚或点数不足
+
+    // 网内引脚下标，升序
+    std::pair<const int*, const int*> NetPins(int net) const {
+        return { m_netPins.data() + m_netStart[net], m_netPins.data() + m_netStart[net + 1] };
+    }
+
+private:
+    struct Pt { int x, y; };
+
+    std::vector<Pt> m_pinPts;
+    std::vector<PinRef> m_pinRefs;
+    std::vector<Pt> m_wirePts;         // 所有 wire 顶点平铺
+    std::vector<int> m_wireStart{ 0 }; // wire w 的顶点为 m_wirePts[m_wireStart[w], m_wireStart[w + 1])
+
+    std::vector<int> m_pinNet;
+    std::vector<int> m_wireNet;
+    std::vector<int> m_netStart{ 0 };
+    std::vector<int> m_netPins;
+};
@@ -0,0 +1,222 @@
+﻿// DesignGen.cpp
+#include "DesignGen.h"
+#include "SynthBoard.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace synth {
+
+    namespace {
+
+        // 先记下全部单元，最后一次性设好网数再加入网表（AddCell 会丢弃越界的网号）
+        class Builder {
+        public:
+            int NewNet() { return m_nets++; }
+
+            int Add(ComponentType t, std::initializer_list<int> pins) { return Add(t, pins.begin(), (int)pins.size()); }
+            int Add(ComponentType t, const int* pins, int n) {
+                m_types.push_back(t);
+                m_pins.insert(m_pins.end(), pins, pins + n);
+                m_start.push_back((int)m_pins.size());
+                return (int)m_types.size() - 1;
+            }
+
+            int Input(const std::string& name) {
+                const int n = NewNet();
+                m_ports.push_back({ Add(NODE_START, { n }), name });
+                return n;
+            }
+            void Output(int net, const std::string& name) { m_ports.push_back({ Add(NODE_END, { net }), name }); }
+
+            void Emit(SimNetlist& nl) const {
+                nl.Clear();
+                nl.SetNumNets(m_nets);
+                std::vector<std::string> names(m_types.size());
+                for (const auto& p : m_ports) names[p.first] = p.second;
+                for (size_t i = 0; i < m_types.size(); ++i) {
+                    nl.AddCell(m_types[i], m_pins.data() + m_start[i], m_start[i + 1] - m_start[i], 1, nullptr, names[i]);
+                }
+                for (const auto& p : m_ports) {
+                    if (m_types[p.first] == NODE_START) nl.AddInputPort(p.first);
+                    else                                nl.AddOutputPort(p.first);
+                }
+            }
+
+        private:
+            int m_nets = 0;
+            std::vector<ComponentType> m_types;
+            std::vector<int> m_pins;
+            std::vector<int> m_start{ 0 };
+            std::vector<std::pair<int, std::string>> m_ports;   // 单元下标 + 端口名，按登记顺序
+        };
+
+        int RandomDag(const GenOptions& o, Builder& b) {
+            std::mt19937 rng(o.seed);
+            const int gates = std::max(1, o.gates);
+            const int numIn = std::max(2, std::min(1024, gates / 16));
+            for (int k = 0; k < numIn; ++k) b.Input("I" + std::to_string(k));
+            int cur = numIn;   // 已有的网：网号即生成顺序
+
+            static const ComponentType kTypes[] = { ANDGATE, ORGATE, NANDGATE, NORGATE, XORGATE, XNORGATE };
+            const int window = std::max(2, o.window);
+            const int maxFanIn = std::max(2, std::min(o.maxFanIn, logic::MaxInputs(ANDGATE)));
+            std::vector<int> pins;
+            for (int g = 0; g < gates; ++g) {
+                const bool isNot = rng() % 10 == 0;
+                const ComponentType t = isNot ? NOTGATE : kTypes[rng() % 6];
+                const int fanIn = isNot ? 1 : 2 + int(rng() % unsigned(maxFanIn - 1));
+                pins.clear();
+                for (int k = 0; k < fanIn; ++k) {
+                    const int lo = (rng() % 10 == 0) ? 0 : std::max(0, cur - window);
+                    pins.push_back(lo + int(rng() % unsigned(cur - lo)));
+                }
+                pins.push_back(b.NewNet());
+                b.Add(t, pins.data(), (int)pins.size());
+                ++cur;
+            }
+            const int outs = std::min(gates, std::max(1, o.maxOutputs));
+            for (int k = 0; k < outs; ++k) b.Output(cur - outs + k, "O" + std::to_string(k));
+            return gates;
+        }
+
+        int AdderChain(const GenOptions& o, Builder& b) {
+            const int bits = std::max(1, o.gates / 5);
+            std::vector<int> a(bits), bb(bits);
+            for (int i = 0; i < bits; ++i) a[i] = b.Input("A" + std::to_string(i));
+            for (int i = 0; i < bits; ++i) bb[i] = b.Input("B" + std::to_string(i));
+            int carry = b.Input("CI");
+            const int outs = std::max(1, o.maxOutputs);
+            for (int i = 0; i < bits; ++i) {
+                // s = a ^ b ^ c；co = (a ^ b) & c | a & b
+                const int x = b.NewNet(), s = b.NewNet(), t1 = b.NewNet(), t2 = b.NewNet(), co = b.NewNet();
+                b.Add(XORGATE, { a[i], bb[i], x });
+                b.Add(XORGATE, { x, carry, s });
+                b.Add(ANDGATE, { x, carry, t1 });
+                b.Add(ANDGATE, { a[i], bb[i], t2 });
+                b.Add(ORGATE, { t1, t2, co });
+                if (i < outs - 1) b.Output(s, "S" + std::to_string(i));
+                carry = co;
+            }
+            b.Output(carry, "CO");
+            return bits * 5;
+        }
+
+        int GridMesh(const GenOptions& o, Builder& b) {
+            const int side = std::max(1, (int)std::ceil(std::sqrt((double)std::max(1, o.gates))));
+            const int rows = std::max(1, (std::max(1, o.gates) + side - 1) / side), cols = side;
+            std::vector<int> top(cols), left(rows);
+            for (int c = 0; c < cols; ++c) top[c] = b.Input("T" + std::to_string(c));
+            for (int r = 0; r < rows; ++r) left[r] = b.Input("L" + std::to_string(r));
+            std::vector<int> prev(top), row(cols);
+            for (int r = 0; r < rows; ++r) {
+                for (int c = 0; c < cols; ++c) {
+                    const int in1 = prev[c], in2 = c == 0 ? left[r] : row[c - 1];
+                    row[c] = b.NewNet();
+                    b.Add((r + c) % 2 ? NANDGATE : XORGATE, { in1, in2, row[c] });
+                }
+                prev.swap(row);
+            }
+            const int outs = std::min(cols, std::max(1, o.maxOutputs));
+            for (int k = 0; k < outs; ++k) b.Output(prev[cols - outs + k], "O" + std::to_string(k));
+            return rows * cols;
+        }
+
+        int DecoderTree(const GenOptions& o, Builder& b) {
+            const int gates = std::max(1, o.gates);
+            int levels = 1;
+            for (long long total = 1, width = 1; total < gates; ++levels) { width *= 4; total += width; }
+            const int en = b.Input("EN");
+            std::vector<int> addr(2 * levels);
+            for (int k = 0; k < 2 * levels; ++k) addr[k] = b.Input("A" + std::to_string(k));
+
+            std::vector<int> enables{ en }, next;
+            int made = 0;
+            for (int l = 0; l < levels && made < gates; ++l) {
+                next.clear();
+                for (int e : enables) {
+                    if (made >= gates) break;
+                    int pins[7] = { e, addr[2 * l], addr[2 * l + 1] };
+                    for (int k = 0; k < 4; ++k) { pins[3 + k] = b.NewNet(); next.push_back(pins[3 + k]); }
+                    b.Add(DECODER24, pins, 7);
+                    ++made;
+                }
+                enables.swap(next);
+            }
+            const int outs = std::min((int)enables.size(), std::max(1, o.maxOutputs));
+            for (int k = 0; k < outs; ++k) b.Output(enables[k], "Y" + std::to_string(k));
+            return made;
+        }
+    }
+
+    const char* TopologyName(Topology t)
+    {
+        switch (t) {
+        case Topology::RandomDag:   return "RandomDag";
+        case Topology::AdderChain:  return "AdderChain";
+        case Topology::GridMesh:    return "GridMesh";
+        case Topology::DecoderTree: return "DecoderTree";
+        case Topology::Layered:     return "Layered";
+        default:                    return "?";
+        }
+    }
+
+    bool TopologyFromName(const std::string& s, Topology& t)
+    {
+        std::string u;
+        for (char ch : s) u.push_back((char)std::tolower((unsigned char)ch));
+        if (u == "randomdag" || u == "dag")       { t = Topology::RandomDag; return true; }
+        if (u == "adderchain" || u == "adder")    { t = Topology::AdderChain; return true; }
+        if (u == "gridmesh" || u == "grid")       { t = Topology::GridMesh; return true; }
+        if (u == "decodertree" || u == "decoder") { t = Topology::DecoderTree; return true; }
+        if (u == "layered" || u == "layer")       { t = Topology::Layered; return true; }
+        return false;
+    }
+
+    const char* WireStyleName(WireStyle s)
+    {
+        switch (s) {
+        case WireStyle::Star:  return "star";
+        case WireStyle::Trunk: return "trunk";
+        case WireStyle::Node:  return "node";
+        case WireStyle::Mixed: return "mixed";
+        default:               return "?";
+        }
+    }
+
+    bool WireStyleFromName(const std::string& s, WireStyle& w)
+    {
+        std::string u;
+        for (char ch : s) u.push_back((char)std::tolower((unsigned char)ch));
+        if (u == "star")  { w = WireStyle::Star; return true; }
+        if (u == "trunk") { w = WireStyle::Trunk; return true; }
+        if (u == "node")  { w = WireStyle::Node; return true; }
+        if (u == "mixed") { w = WireStyle::Mixed; return true; }
+        return false;
+    }
+
+    int Generate(const GenOptions& opt, SimNetlist& nl)
+    {
+        if (opt.topology == Topology::Layered) {
+            Board board;
+            const int made = GenerateBoard(opt, board);
+            nl = std::move(board.netlist);
+            return made;
+        }
+        Builder b;
+        int made = 0;
+        switch (opt.topology) {
+        case Topology::RandomDag:   made = RandomDag(opt, b); break;
+        case Topology::AdderChain:  made = AdderChain(opt, b); break;
+        case Topology::GridMesh:    made = GridMesh(opt, b); break;
+        case Topology::DecoderTree: made = DecoderTree(opt, b); break;
+        default: break;
+        }
+        b.Emit(nl);
+        return made;
+    }
+
+} // namespace synth
@@ -0,0 +1,54 @@
+﻿// DesignGen.h
+#pragma once
+#include <string>
+#include "SimNetlist.h"
+
+// ==========================================================
+//  合成设计生成器（不依赖 wx）：基准测试与压力测试用
+//  直接生成仿真网表，固定种子可复现，百万门在一秒量级内生成
+//  - RandomDag：随机有向无环图，输入大多取自最近生成的网（局部性近似真实电路）
+//  - AdderChain：基本门搭的行波进位加法器（每位 5 门），改一位输入要沿进位链传到底
+//  - GridMesh：R×C 网格，每格取左、上邻居为输入，事件沿对角线波前推进
+//  - DecoderTree：2-4 译码器四叉树，每层共用两根地址线，上层输出做下层使能
+//  - Layered：分层随机逻辑，可配扇入、扇出、级数、反馈环与连线形态；带几何，见 SynthBoard.h
+//  输入端口为起始节点、输出端口为终止节点（输出数有上限，其余末端网悬空）
+// ==========================================================
+
+namespace synth {
+
+    enum class Topology { RandomDag, AdderChain, GridMesh, DecoderTree, Layered };
+    const char* TopologyName(Topology t);
+    // 不分大小写（"dag" / "adder" / "grid" / "decoder" / "layer" 也认）
+    bool TopologyFromName(const std::string& s, Topology& t);
+
+    // 合成画布的连线形态
+    enum class WireStyle {
+        Star,    // 每个负载一条从驱动引脚出发的折线
+        Trunk,   // 一条竖直干线，驱动与各负载以 T 形分支接上
+        Node,    // 驱动先连到一个 NODE_BASIC，再从结点放射到各负载
+        Mixed    // 逐网随机选以上三种
+    };
+    const char* WireStyleName(WireStyle s);
+    bool WireStyleFromName(const std::string& s, WireStyle& w);
+
+    struct GenOptions {
+        Topology topology = Topology::RandomDag;
+        int gates = 1000;       // 目标逻辑元件数（不含端口），实际值按拓扑取整
+        unsigned seed = 1;
+        int maxFanIn = 4;       // RandomDag / Layered：每门最多几个输入
+        int window = 64;        // RandomDag：输入从最近 window 个网里挑（另有 1/10 全局随机）
+        int maxOutputs = 64;    // 输出端口上限
+
+        // ---- Layered ----
+        int depth = 16;                      // 门的级数（列数）
+        int minFanIn = 2;                    // 1 时会出现非门
+        int maxFanOut = 8;                   // 每个网的负载数上限（挑输入时尽量满足）
+        int rowWindow = 3;                   // 负载取驱动所在行 ±rowWindow 行
+        double loopRatio = 0.0;              // 带一条反馈边（来自下一列同一行）的门的比例
+        WireStyle wireStyle = WireStyle::Mixed;
+    };
+
+    // 生成到 nl（先 Clear）；返回实际逻辑元件数
+    int Generate(const GenOptions& opt, SimNetlist& nl);
+
+} // namespace synth
@@ -3,15 +3,29 @@
 #include "SelectionEvents.h"
 #include "EditCommands.h"
 #include <cmath>   // 为 std::lround
+#include <climits>
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <wx/display.h>
 // === 追加：导出 BookShelf 网表 ===
 #include "BookShelfExporter.h"
 #include <unordered_map>
 #include <map>
 #include <set>
 #include "BookShelfImporter.h"
+#include "Placer.h"
 #include "Simulator.h"
+#include "Sequential.h"
+#include "Bus.h"
+#include "Arith.h"
+#include "LogicKernel.h"
+#include "NetlistIO.h"
 #include "Component.h"
+#include "Profiler.h"
 using bookshelf::BSDesign;
+using bookshelf::BSPin;
+using bookshelf::kNoNode;
 using bookshelf::ParseBookShelf;
 using bookshelf::Node;
 using bookshelf::Net;
@@ -51,6 +65,173 @@ namespace {
     inline bool IsTerminal(ComponentType t) {
         return (t == NODE_START || t == NODE_END);
     }
+
+    // 结点类（普通结点/起始/终止）只是连线汇聚点，不占面积、不挡线
+    inline bool IsNodeType(ComponentType t) {
+        return (t == NODE_BASIC || t == NODE_START || t == NODE_END);
+    }
+
+    // 元件轴对齐包围盒（由 m_BoundaryPoints[4] 推得）
+    inline MetricsBox BoundaryBox(const Component* c) {
+        const wxPoint* pts = c->m_BoundaryPoints;
+        MetricsBox b{ pts[0].x, pts[0].y, pts[0].x, pts[0].y };
+        for (int i = 1; i < 4; ++i) {
+            b.x0 = std::min(b.x0, pts[i].x); b.x1 = std::max(b.x1, pts[i].x);
+            b.y0 = std::min(b.y0, pts[i].y); b.y1 = std::max(b.y1, pts[i].y);
+        }
+        return b;
+    }
+
+    // 指标用包围盒：结点类按零面积处理（不计密度/重叠）
+    inline MetricsBox MetricsBoxOf(const Component* c) {
+        if (!IsNodeType(c->m_type)) return BoundaryBox(c);
+        const wxPoint cen = const_cast<Component*>(c)->GetCenter();
+        return MetricsBox{ cen.x, cen.y, cen.x, cen.y };
+    }
+
+    // 去掉重复点与共线中间点
+    void SimplifyPolyline(std::vector<wxPoint>& pts) {
+        std::vector<wxPoint> out;
+        out.reserve(pts.size());
+        for (const auto& p : pts) {
+            if (!out.empty() && out.back() == p) continue;
+            if (out.size() >= 2) {
+                const wxPoint& a = out[out.size() - 2];
+                const wxPoint& b = out.back();
+                if ((a.x == b.x && b.x == p.x) || (a.y == b.y && b.y == p.y)) { out.back() = p; continue; }
+            }
+            out.push_back(p);
+        }
+        pts.swap(out);
+    }
+
+    // 折线 / 包围盒 → 屏幕矩形（局部重绘用）
+    inline wxRect PolyRect(const std::vector<wxPoint>& poly) {
+        if (poly.empty()) return wxRect();
+        int x0 = poly[0].x, y0 = poly[0].y, x1 = x0, y1 = y0;
+        for (const auto& p : poly) {
+            x0 = std::min(x0, p.x); x1 = std::max(x1, p.x);
+            y0 = std::min(y0, p.y); y1 = std::max(y1, p.y);
+        }
+        return wxRect(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+    }
+
+    inline wxRect BoxRect(const MetricsBox& b) { return wxRect(b.x0, b.y0, b.x1 - b.x0 + 1, b.y1 - b.y0 + 1); }
+
+    inline wxRect UnionRect(const wxRect& a, const wxRect& b) {
+        if (a.IsEmpty()) return b;
+        if (b.IsEmpty()) return a;
+        return a.Union(b);
+    }
+
+    inline long long NowMs() {
+        using namespace std::chrono;
+        return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    inline RoutePoint ToRoutePoint(const wxPoint& p) { return RoutePoint{ p.x, p.y }; }
+
+    // 总线记号：在 a→b 段中点画一道斜杠，旁边标注 label（位宽或当前值）
+    void DrawBusTick(wxGraphicsContext* gc, const wxPoint& a, const wxPoint& b, const wxString& label) {
+        const double mx = (a.x + b.x) / 2.0, my = (a.y + b.y) / 2.0;
+        gc->StrokeLine(mx - 4, my + 6, mx + 4, my - 6);
+        double tw = 0, th = 0, descent = 0, extlead = 0;
+        gc->GetTextExtent(label, &tw, &th, &descent, &extlead);
+        if (a.y == b.y) gc->DrawText(label, mx - tw / 2, my - 8 - th);   // 水平段：标在上方
+        else            gc->DrawText(label, mx + 7, my - th / 2);        // 竖直段：标在右侧
+    }
+
+    inline std::vector<wxPoint> ToWxPoly(const std::vector<RoutePoint>& v) {
+        std::vector<wxPoint> out;
+        out.reserve(v.size());
+        for (const auto& p : v) out.emplace_back(p.x, p.y);
+        return out;
+    }
+
+    // 删掉 ids 指定的下标：先打标记再一次压缩，避免逐个 erase 的 O(n^2)
+    template <class T>
+    bool EraseIndices(std::vector<T>& vec, const std::vector<int>& ids) {
+        std::vector<char> del(vec.size(), 0);
+        bool any = false;
+        for (int i : ids) {
+            if (i >= 0 && i < (int)vec.size()) { del[i] = 1; any = true; }
+        }
+        if (!any) return false;
+        size_t k = 0;
+        for (size_t i = 0; i < vec.size(); ++i) {
+            if (del[i]) continue;
+            if (k != i) vec[k] = std::move(vec[i]);
+            ++k;
+        }
+        vec.erase(vec.begin() + k, vec.end());
+        return true;
+    }
+
+    inline bool IsPresent(const std::unique_ptr<Component>& c) { return c != nullptr; }
+    inline bool IsPresent(const std::vector<wxPoint>&) { return true; }
+
+    // EraseIndices 的逆操作：items 按原下标升序，一次线性合并插回
+    template <class T, class Item, class Make>
+    void InsertAtIndices(std::vector<T>& vec, const std::vector<std::pair<long, Item>>& items, Make make) {
+        if (items.empty()) return;
+        std::vector<T> out;
+        out.reserve(vec.size() + items.size());
+        size_t src = 0, k = 0;
+        while (src < vec.size() || k < items.size()) {
+            if (k < items.size() && (src == vec.size() || (long)out.size() >= items[k].first)) {
+                T v = make(items[k++].second);
+                if (IsPresent(v)) out.push_back(std::move(v));
+            }
+            else {
+                out.push_back(std::move(vec[src++]));
+            }
+        }
+        vec.swap(out);
+    }
+
+    inline wxRect NormalizedRect(const wxPoint& a, const wxPoint& b) {
+        return wxRect(std::min(a.x, b.x), std::min(a.y, b.y), std::abs(a.x - b.x) + 1, std::abs(a.y - b.y) + 1);
+    }
+
+    // 元件表 + 已 Extract 的连通性 → 仿真网表（画布与子电路定义共用）
+    void FillSimNetlist(const std::vector<std::unique_ptr<Component>>& comps, const Connectivity& conn, SimNetlist& nl) {
+        nl.Clear();
+        nl.SetNumNets(conn.NumNets());
+        // 引脚按元件、引脚下标顺序加入提取器
+        std::vector<int> pinStart(comps.size() + 1, 0);
+        for (int k = 0; k < conn.NumPins(); ++k) ++pinStart[conn.Pin(k).compIdx + 1];
+        for (size_t i = 0; i < comps.size(); ++i) pinStart[i + 1] += pinStart[i];
+
+        std::vector<int> pinNets;
+        std::vector<std::pair<wxPoint, int>> ins, outs;
+        for (int i = 0; i < (int)comps.size(); ++i) {
+            Component* c = comps[i].get();
+            if (!c) { nl.AddCell(NODE_BASIC, nullptr, 0); continue; }   // 保持单元下标 = 元件下标
+            const int numPins = pinStart[i + 1] - pinStart[i];
+            pinNets.resize(numPins);
+            for (int p = 0; p < numPins; ++p) pinNets[p] = conn.PinNet(pinStart[i] + p);
+            std::shared_ptr<const SubcircuitDef> def;
+            if (c->m_type == SUBCIRCUIT) def = static_cast<const SubcircuitComp*>(c)->Def();
+            nl.AddCell(c->m_type, pinNets.data(), numPins, c->width, def, def ? def->Name() : std::string());
+            if (c->m_type == NODE_START) ins.push_back({ c->GetCenter(), i });
+            else if (c->m_type == NODE_END) outs.push_back({ c->GetCenter(), i });
+        }
+
+        // 端口自上而下、同高度自左向右
+        auto byPos = [](const std::pair<wxPoint, int>& a, const std::pair<wxPoint, int>& b) {
+            return a.first.y != b.first.y ? a.first.y < b.first.y : a.first.x < b.first.x;
+        };
+        std::sort(ins.begin(), ins.end(), byPos);
+        std::sort(outs.begin(), outs.end(), byPos);
+        for (size_t k = 0; k < ins.size(); ++k) {
+            nl.CellAt(ins[k].second).name = "I" + std::to_string(k);
+            nl.AddInputPort(ins[k].second);
+        }
+        for (size_t k = 0; k < outs.size(); ++k) {
+            nl.CellAt(outs[k].second).name = "O" + std::to_string(k);
+            nl.AddOutputPort(outs[k].second);
+        }
+    }
 }
 
 
@@ -62,20 +243,27 @@ const wxColour DrawBoard::HANDLE_STROKE_RGB(0, 0, 0);
 // ★ 在一个 .cpp 里实现一次全局事件
 wxDEFINE_EVENT(EVT_SELECTION_CHANGED, wxCommandEvent);
 
-DrawBoard::DrawBoard(wxWindow* parent) : wxPanel(parent)
+// wxWANTS_CHARS：方向键直接交给画布，不被面板的 Tab 导航吃掉
+DrawBoard::DrawBoard(wxWindow* parent)
+    : wxPanel(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxWANTS_CHARS)
 {
     SetBackgroundStyle(wxBG_STYLE_PAINT);
     Bind(wxEVT_PAINT, &DrawBoard::OnPaint, this);
     Bind(wxEVT_MOTION, &DrawBoard::OnButtonMove, this);
     Bind(wxEVT_LEFT_DOWN, &DrawBoard::OnLeftDown, this);
     Bind(wxEVT_LEFT_UP, &DrawBoard::OnLeftUp, this);
+    Bind(wxEVT_KEY_DOWN, &DrawBoard::OnKeyDown, this);
+    Bind(wxEVT_KEY_UP, &DrawBoard::OnKeyUp, this);
 
     st1 = new wxStaticText(this, -1, wxT(""), wxPoint(10, 10));
     st2 = new wxStaticText(this, -1, wxT(""), wxPoint(10, 30));
+    st3 = new wxStaticText(this, -1, wxT(""), wxPoint(10, 50));
 
     // 创建仿真器与定时器
     m_sim = new Simulator(this);
     m_simTimer = new wxTimer(this);
+    m_dragTimer = new wxTimer(this);
+    m_profTimer = new wxTimer(this);
     Bind(wxEVT_TIMER, &DrawBoard::OnTimer, this);
 }
 
@@ -87,6 +275,12 @@ DrawBoard::~DrawBoard()
     Unbind(wxEVT_TIMER, &DrawBoard::OnTimer, this);
     delete m_simTimer;
     m_simTimer = nullptr;
+    if (m_dragTimer) m_dragTimer->Stop();
+    delete m_dragTimer;
+    m_dragTimer = nullptr;
+    if (m_profTimer) m_profTimer->Stop();
+    delete m_profTimer;
+    m_profTimer = nullptr;
 
     delete m_sim;
     m_sim = nullptr;
@@ -118,6 +312,10 @@ static bool __FindNearestGatePinExcluding(const DrawBoard* self, const wxPoint&
 
 void DrawBoard::OnPaint(wxPaintEvent& event)
 {
+    // 一帧 = 相邻两次绘制之间：先结算上一帧（含上次绘制与其后的仿真节拍、命中测试）
+    prof::Profiler::Get().EndFrame();
+    PROF_SCOPE(ZonePaint);
+
     wxAutoBufferedPaintDC dc(this);
     dc.SetBackground(*wxWHITE_BRUSH);
     dc.Clear();
@@ -128,28 +326,72 @@ void DrawBoard::OnPaint(wxPaintEvent& event)
     memDC.SetBackground(*wxWHITE_BRUSH);
     memDC.Clear();
 
+    // 只重画失效区域（拖动时只失效被拖元件与其连线附近）
+    // 失效区常含十字线的横竖两条，包围盒几乎就是整个客户区，所以按区域本身逐项判断
+    const wxRegion updRgn = GetUpdateRegion();
+    wxRect upd = updRgn.GetBox();
+    const bool whole = upd.IsEmpty();
+    if (whole) upd = wxRect(GetClientSize());
+    auto visible = [&](const wxRect& r) {
+        return whole ? r.Intersects(upd) : updRgn.Contains(r) != wxOutRegion;
+        };
+
     wxGraphicsContext* gc = wxGraphicsContext::Create(memDC);
     if (gc) {
+        if (whole) gc->Clip(upd.x, upd.y, upd.width, upd.height);
+        else gc->Clip(updRgn);
+
         // 背景网格
         drawGrid(gc);
 
         // ====== A) 已保存的线（折线绘制）======
         for (int wi = 0; wi < (int)wires.size(); ++wi) {
             const auto& poly = wires[wi];
+            if (!visible(PolyRect(poly).Inflate(2))) continue;
 
-            // 仿真着色：高电平红色，低电平蓝灰；未仿真则默认黑
-            if (m_simulating && m_sim) {
+            // 总线画粗线；位宽冲突的网用橙色提示
+            const int busWidth = WireBusWidth(wi);
+            const int penW = busWidth > 1 ? 4 : 2;
+
+            // 仿真着色：高电平红色，低电平蓝灰（总线非零为高）；振荡的环驱动的线（X）加粗洋红；未仿真则默认黑
+            const bool unknown = m_simulating && m_sim && m_sim->IsWireUnknown(wi);
+            if (unknown) {
+                gc->SetPen(wxPen(wxColour(200, 0, 200), penW + 2));
+            }
+            else if (m_simulating && m_sim) {
                 bool high = m_sim->IsWireHigh(wi);
                 wxColour cc = high ? wxColour(255, 0, 0) : wxColour(100, 120, 200);
-                gc->SetPen(wxPen(cc, 2));
+                gc->SetPen(wxPen(cc, penW));
+            }
+            else if (IsWireSelected(wi)) {
+                gc->SetPen(wxPen(wxColour(0, 120, 215), penW));   // 多选中的线
+            }
+            else if (WireWidthConflict(wi)) {
+                gc->SetPen(wxPen(wxColour(255, 140, 0), penW));
             }
             else {
-                gc->SetPen(wxPen(wxColour(0, 0, 0), 2));
+                gc->SetPen(wxPen(wxColour(0, 0, 0), penW));
             }
 
             for (size_t i = 1; i < poly.size(); ++i) {
                 gc->StrokeLine(poly[i - 1].x, poly[i - 1].y, poly[i].x, poly[i].y);
             }
+
+            // 总线记号标在最长的一段上：平时标位宽，仿真时标当前值（十六进制）
+            if (busWidth > 1 && poly.size() >= 2) {
+                size_t seg = 1;
+                int best = -1;
+                for (size_t i = 1; i < poly.size(); ++i) {
+                    const int len = std::abs(poly[i].x - poly[i - 1].x) + std::abs(poly[i].y - poly[i - 1].y);
+                    if (len > best) { best = len; seg = i; }
+                }
+                const wxString label = unknown ? wxString("X")
+                    : (m_simulating && m_sim) ? wxString::Format("0x%llX", (unsigned long long)m_sim->WireValue(wi))
+                    : wxString::Format("%d", busWidth);
+                gc->SetPen(wxPen(wxColour(0, 0, 0), 1));
+                gc->SetFont(wxFontInfo(8).Family(wxFONTFAMILY_DEFAULT), *wxBLACK);
+                DrawBusTick(gc, poly[seg - 1], poly[seg], label);
+            }
         }
 
         // ====== A1) 被选中的连线：两端定位点 ======
@@ -205,21 +447,59 @@ void DrawBoard::OnPaint(wxPaintEvent& event)
 
         // ⭐ 矢量门绘制
         for (int i = 0; i < (int)components.size(); ++i) {
-            components[i]->SetSelected(i == selectedGateIndex);
+            components[i]->SetSelected(i == selectedGateIndex || IsGateSelected(i));
+            // 引脚短线与选中锚点会画出包围盒一点
+            if (!visible(BoxRect(BoundaryBox(components[i].get())).Inflate(12))) continue;
             components[i]->drawSelf(memDC);
+
+            // 整字门：输出引脚旁标位宽（门的外形与单线门相同）
+            const Component* c = components[i].get();
+            if (c->width > 1 && logic::IsBasicGate(c->m_type)) {
+                const auto pins = c->GetPins();
+                if (!pins.empty()) {
+                    const wxPoint& out = pins.back();
+                    gc->SetPen(wxPen(wxColour(0, 0, 0), 1));
+                    gc->SetFont(wxFontInfo(8).Family(wxFONTFAMILY_DEFAULT), *wxBLACK);
+                    DrawBusTick(gc, out - wxPoint(10, 0), out, wxString::Format("%d", c->width));
+                }
+            }
+        }
+
+        // 振荡的环：涉及的元件外加洋红虚线框
+        if (m_simulating && m_sim) {
+            gc->SetPen(wxPen(wxColour(200, 0, 200), 2, wxPENSTYLE_SHORT_DASH));
+            gc->SetBrush(*wxTRANSPARENT_BRUSH);
+            for (const auto& loop : m_sim->OscillatingLoops()) {
+                for (int ci : loop) {
+                    if (ci < 0 || ci >= (int)components.size()) continue;
+                    const wxRect box = BoxRect(BoundaryBox(components[ci].get())).Inflate(6);
+                    if (visible(box)) gc->DrawRectangle(box.x, box.y, box.width, box.height);
+                }
+            }
         }
 
         // 绘制节点状态（输入/输出0-1）
         DrawNodeStates(gc);
 
+        // 框选矩形
+        if (m_isBanding) {
+            const wxRect band = NormalizedRect(m_bandStart, mousePos);
+            gc->SetPen(wxPen(wxColour(0, 120, 215), 1, wxPENSTYLE_SHORT_DASH));
+            gc->SetBrush(wxBrush(wxColour(0, 120, 215, 32)));
+            gc->DrawRectangle(band.x, band.y, band.width, band.height);
+        }
+
         // 十字线
         gc->SetPen(wxPen(wxColour(0, 0, 0), 1));
         gc->StrokeLine(mousePos.x, 0, mousePos.x, GetSize().y);
         gc->StrokeLine(0, mousePos.y, GetSize().x, mousePos.y);
+        m_paintedCrosshair = mousePos;
+
+        if (m_showProfiler) DrawProfilerOverlay(gc);
 
         delete gc;
     }
-    dc.Blit(0, 0, GetClientSize().GetWidth(), GetClientSize().GetHeight(), &memDC, 0, 0);
+    dc.Blit(upd.x, upd.y, upd.width, upd.height, &memDC, upd.x, upd.y);
 }
 
 void DrawBoard::drawGrid(wxGraphicsContext* gc)
@@ -231,6 +511,64 @@ void DrawBoard::drawGrid(wxGraphicsContext* gc)
     for (int y = 0; y < size.GetHeight(); y += gridSize) gc->StrokeLine(0, y, size.GetWidth(), y);
 }
 
+void DrawBoard::ApplyDragStep()
+{
+    if (!m_dragPending) return;
+    m_dragPending = false;
+    m_lastDragApplyMs = NowMs();
+
+    // 整组拖动：各元件保持相对位置平移，连线在 MoveGatesTo 里一次重布
+    if (m_isGroupDragging) {
+        const wxPoint delta = SnapToStep(mousePos - m_dragStartMouse);
+        std::vector<wxPoint> centers(m_selGates.size());
+        for (size_t k = 0; k < m_selGates.size(); ++k) centers[k] = m_groupStartCenters[k] + delta;
+        MoveGatesTo(m_selGates, centers);
+        return;
+    }
+
+    if (!m_isDragging || m_draggingIndex < 0 || m_draggingIndex >= (int)components.size()) return;
+
+    const wxPoint delta = mousePos - m_dragStartMouse;
+    wxPoint target = m_dragStartCenter + delta;
+    wxPoint snapped = SnapToStep(target);
+
+    // 起始/终止节点：优先吸附到“其他”元件的引脚，避免吸到自身
+    auto* moved = components[m_draggingIndex].get();
+    if (IsAttachableNode(moved->m_type)) {
+        wxPoint pinSnap;
+        if (__FindNearestGatePinExcluding(this, target, pinSnap, 15, m_draggingIndex)) {
+            snapped = pinSnap;
+        }
+    }
+
+    // 十字线跟着鼠标走：旧位置与新位置各失效一条横竖细带
+    const wxSize cs = GetClientSize();
+    for (const wxPoint& c : { m_paintedCrosshair, mousePos }) {
+        RefreshRect(wxRect(c.x - 1, 0, 3, cs.GetHeight()), false);
+        RefreshRect(wxRect(0, c.y - 1, cs.GetWidth(), 3), false);
+    }
+
+    if (snapped == moved->GetCenter()) return;
+
+    wxRect dirty = BoxRect(BoundaryBox(moved));
+    moved->SetCenter(snapped);
+    RerouteWiresForMovedComponent(m_draggingIndex, preMovePins, &dirty);
+    preMovePins = moved->GetPins();
+    MetricsGateMoved(m_draggingIndex);
+    dirty = UnionRect(dirty, BoxRect(BoundaryBox(moved)));
+    RefreshRect(dirty.Inflate(16), false);   // 余量盖住引脚短线、选中锚点与线宽
+}
+
+int DrawBoard::FrameIntervalMs() const
+{
+    const int idx = wxDisplay::GetFromWindow(this);
+    if (idx != wxNOT_FOUND) {
+        const int hz = wxDisplay(unsigned(idx)).GetCurrentMode().GetRefresh();
+        if (hz > 0) return std::max(1, 1000 / hz);
+    }
+    return 16;   // 查不到刷新率时按 60Hz
+}
+
 void DrawBoard::OnButtonMove(wxMouseEvent& event)
 {
     mousePos = event.GetPosition();
@@ -240,27 +578,14 @@ void DrawBoard::OnButtonMove(wxMouseEvent& event)
     if (isDrawing) currentEnd = mousePos;
 
     // 拖动组件（实时预览；真正的命令在 MouseUp 记录 from->to）
-    if (m_isDragging && m_draggingIndex >= 0 && m_draggingIndex < (int)components.size()) {
-        const wxPoint delta = mousePos - m_dragStartMouse;
-        wxPoint target = m_dragStartCenter + delta;
-        wxPoint snapped = SnapToStep(target);
-
-        // 起始/终止节点：优先吸附到“其他”元件的引脚，避免吸到自身
-        if (m_draggingIndex >= 0 && m_draggingIndex < (int)components.size()) {
-            auto* moved = components[m_draggingIndex].get();
-            if (moved->m_type == ComponentType::NODE_START || moved->m_type == ComponentType::NODE_END) {
-                wxPoint pinSnap;
-                if (__FindNearestGatePinExcluding(this, target, pinSnap, 15, m_draggingIndex)) {
-                    snapped = pinSnap;
-                }
-            }
+    // 一帧内的多次鼠标移动只按最后的位置处理一次：距上次处理不足一帧就交给定时器补上
+    if (m_isGroupDragging || (m_isDragging && m_draggingIndex >= 0 && m_draggingIndex < (int)components.size())) {
+        m_dragPending = true;
+        if (NowMs() - m_lastDragApplyMs >= m_dragFrameMs) {
+            ApplyDragStep();
         }
-
-        if (snapped != components[m_draggingIndex]->GetCenter()) {
-            components[m_draggingIndex]->SetCenter(snapped);
-            RerouteWiresForMovedComponent(m_draggingIndex, preMovePins);
-            preMovePins = components[m_draggingIndex]->GetPins();
-            Refresh(false);
+        else if (m_dragTimer && !m_dragTimer->IsRunning()) {
+            m_dragTimer->StartOnce(int(std::max<long long>(1, m_dragFrameMs - (NowMs() - m_lastDragApplyMs))));
         }
         return;
     }
@@ -280,6 +605,8 @@ void DrawBoard::OnButtonMove(wxMouseEvent& event)
 void DrawBoard::OnLeftDown(wxMouseEvent& event)
 {
     wxPoint pos = event.GetPosition();
+    SetFocus();   // 方向键微调需要画布持有键盘焦点
+    if (m_cmd) m_cmd->BreakCoalescing();   // 之前的微调已结束，拖动不并进去
 
     // 点击起始节点切换电平（优先处理）
     if (m_sim) {
@@ -296,14 +623,51 @@ void DrawBoard::OnLeftDown(wxMouseEvent& event)
 
     // Arrow 工具：选择 + 准备拖动
     if (currentTool == ID_TOOL_ARROW) {
+        const bool shift = event.ShiftDown();
         int hit = HitTestGate(pos);
+
+        // Shift 点选：切换该元件在多选集合中的状态
+        if (hit >= 0 && shift) {
+            auto it = std::lower_bound(m_selGates.begin(), m_selGates.end(), hit);
+            if (it != m_selGates.end() && *it == hit) m_selGates.erase(it);
+            else m_selGates.insert(it, hit);
+            selectedGateIndex = IsGateSelected(hit) ? hit : (m_selGates.empty() ? -1 : m_selGates.front());
+            selectedWireIndex = -1;
+            m_selKind = selectedGateIndex >= 0 ? SelKind::Gate : SelKind::None;
+            m_selId = selectedGateIndex;
+            Refresh(false);
+            NotifySelectionChanged();
+            return;
+        }
+
+        // 点在多选集合里的元件上：整组拖动
+        if (hit >= 0 && IsGateSelected(hit) && MultiSelectionSize() > 1) {
+            selectedGateIndex = hit;
+            m_isGroupDragging = true;
+            m_dragStartMouse = pos;
+            m_groupStartCenters.resize(m_selGates.size());
+            for (size_t k = 0; k < m_selGates.size(); ++k) m_groupStartCenters[k] = components[m_selGates[k]]->GetCenter();
+            m_dragFrameMs = FrameIntervalMs();
+            m_dragPending = false;
+            if (!HasCapture()) CaptureMouse();
+
+            m_selKind = SelKind::Gate;
+            m_selId = selectedGateIndex;
+            NotifySelectionChanged();
+            return;
+        }
+
         if (hit >= 0) {
             selectedGateIndex = hit;
+            m_selGates.assign(1, hit);
+            m_selWires.clear();
             m_draggingIndex = hit;
             m_isDragging = true;
             m_dragStartMouse = pos;
             m_dragStartCenter = components[hit]->GetCenter();
             preMovePins = components[hit]->GetPins();
+            m_dragFrameMs = FrameIntervalMs();
+            m_dragPending = false;
             if (!HasCapture()) CaptureMouse();
             Refresh(false);
 
@@ -312,15 +676,25 @@ void DrawBoard::OnLeftDown(wxMouseEvent& event)
             NotifySelectionChanged();
         }
         else {
-            selectedGateIndex = -1;
+            if (!shift) selectedGateIndex = -1;
             m_draggingIndex = -1;
             m_isDragging = false;
 
             // 先看连线
             int w = HitTestWire(pos);
             if (w >= 0) {
-                selectedWireIndex = w;
-                m_selKind = SelKind::Wire;
+                if (shift) {
+                    auto it = std::lower_bound(m_selWires.begin(), m_selWires.end(), w);
+                    if (it != m_selWires.end() && *it == w) m_selWires.erase(it);
+                    else m_selWires.insert(it, w);
+                    selectedWireIndex = IsWireSelected(w) ? w : -1;
+                }
+                else {
+                    selectedWireIndex = w;
+                    m_selGates.clear();
+                    m_selWires.assign(1, w);
+                }
+                m_selKind = selectedWireIndex >= 0 ? SelKind::Wire : SelKind::None;
                 m_selId = selectedWireIndex;
 
                 // 取消文本选择/拖动
@@ -329,12 +703,13 @@ void DrawBoard::OnLeftDown(wxMouseEvent& event)
                 m_dragTextIndex = -1;
             }
             else {
-                selectedWireIndex = -1;
+                if (!shift) selectedWireIndex = -1;
 
                 // ===== 新增：命中文本？ =====
                 int t = HitTestText(pos);
                 if (t >= 0) {
                     selectedTextIndex = t;
+                    ClearMultiSelection();
 
                     // 准备拖动文本
                     m_isDraggingText = true;
@@ -347,13 +722,20 @@ void DrawBoard::OnLeftDown(wxMouseEvent& event)
                     m_selId = -1;
                 }
                 else {
-                    // 均未命中
+                    // 均未命中：开始框选（Shift 时在原集合上追加）
                     selectedTextIndex = -1;
                     m_isDraggingText = false;
                     m_dragTextIndex = -1;
 
-                    m_selKind = SelKind::None;
-                    m_selId = -1;
+                    if (!shift) {
+                        ClearMultiSelection();
+                        m_selKind = SelKind::None;
+                        m_selId = -1;
+                    }
+                    m_isBanding = true;
+                    m_bandAdditive = shift;
+                    m_bandStart = pos;
+                    if (!HasCapture()) CaptureMouse();
                 }
             }
             Refresh(false);
@@ -386,8 +768,36 @@ void DrawBoard::OnLeftDown(wxMouseEvent& event)
 
 void DrawBoard::OnLeftUp(wxMouseEvent& event)
 {
+    // 结束整组拖动 → 一条批量移动命令
+    if (m_isGroupDragging) {
+        if (m_dragTimer) m_dragTimer->Stop();
+        ApplyDragStep();
+        m_isGroupDragging = false;
+        if (HasCapture()) ReleaseMouse();
+
+        std::vector<wxPoint> to(m_selGates.size());
+        for (size_t k = 0; k < m_selGates.size(); ++k) to[k] = components[m_selGates[k]]->GetCenter();
+        if (to != m_groupStartCenters && m_cmd) {
+            m_cmd->Execute(std::make_unique<MoveGatesCmd>(this, m_selGates, m_groupStartCenters, to));
+            m_cmd->BreakCoalescing();   // 一次拖动是一步，随后的微调另起一步
+        }
+        m_groupStartCenters.clear();
+        return;
+    }
+
+    // 结束框选
+    if (m_isBanding) {
+        m_isBanding = false;
+        if (HasCapture()) ReleaseMouse();
+        SelectInRect(NormalizedRect(m_bandStart, event.GetPosition()), m_bandAdditive);
+        return;
+    }
+
     // 结束拖动 → 生成移动命令
     if (m_isDragging) {
+        // 先把还在等定时器的最后一次移动应用掉
+        if (m_dragTimer) m_dragTimer->Stop();
+        ApplyDragStep();
         m_isDragging = false;
         int idx = m_draggingIndex;
         m_draggingIndex = -1;
@@ -409,6 +819,7 @@ void DrawBoard::OnLeftUp(wxMouseEvent& event)
 
             if (from != to && m_cmd) {
                 m_cmd->Execute(std::make_unique<MoveGateCmd>(this, idx, from, to));
+                m_cmd->BreakCoalescing();
             }
         }
 
@@ -459,8 +870,58 @@ void DrawBoard::OnLeftUp(wxMouseEvent& event)
     }
 }
 
+void DrawBoard::OnKeyDown(wxKeyEvent& event)
+{
+    int dx = 0, dy = 0;
+    switch (event.GetKeyCode()) {
+    case WXK_LEFT:  dx = -1; break;
+    case WXK_RIGHT: dx = 1;  break;
+    case WXK_UP:    dy = -1; break;
+    case WXK_DOWN:  dy = 1;  break;
+    default: event.Skip(); return;
+    }
+    if (currentTool != ID_TOOL_ARROW || m_isDragging || m_isGroupDragging) { event.Skip(); return; }
+
+    std::vector<int> ids = m_selGates;
+    if (ids.empty() && selectedGateIndex >= 0 && selectedGateIndex < (int)components.size()) ids.push_back(selectedGateIndex);
+    if (ids.empty()) { event.Skip(); return; }
+
+    // 连续按键在命令管理器里合并成一步撤销
+    const int step = event.ShiftDown() ? GRID : STEP;
+    const wxPoint d(dx * step, dy * step);
+    if (ids.size() == 1) {
+        const wxPoint from = components[ids[0]]->GetCenter();
+        if (m_cmd) m_cmd->Execute(std::make_unique<MoveGateCmd>(this, ids[0], from, from + d));
+        else       MoveGateTo(ids[0], from + d);
+    }
+    else {
+        std::vector<wxPoint> from(ids.size()), to(ids.size());
+        for (size_t k = 0; k < ids.size(); ++k) {
+            from[k] = components[ids[k]]->GetCenter();
+            to[k] = from[k] + d;
+        }
+        if (m_cmd) m_cmd->Execute(std::make_unique<MoveGatesCmd>(this, ids, from, to));
+        else       MoveGatesTo(ids, to);
+    }
+    NotifySelectionChanged();   // 属性面板里的坐标随之刷新
+}
+
+void DrawBoard::OnKeyUp(wxKeyEvent& event)
+{
+    switch (event.GetKeyCode()) {
+    case WXK_LEFT: case WXK_RIGHT: case WXK_UP: case WXK_DOWN:
+        // 按住时的自动重复只有 KEY_DOWN；松开才算一串微调结束
+        if (m_cmd) m_cmd->BreakCoalescing();
+        break;
+    default:
+        break;
+    }
+    event.Skip();
+}
+
 int DrawBoard::HitTestText(const wxPoint& pt) const
 {
+    PROF_SCOPE(ZoneHitTest);
     // 从上往下（后绘制优先）
     // 注意：需要一个 gc/度量，这里临时创建 DC+GC
     wxBitmap tmpBmp(1, 1);
@@ -500,6 +961,8 @@ void DrawBoard::ClearPics() {
     wires.clear();
     lines.clear();
     selectedWireIndex = -1;
+    m_selWires.clear();
+    InvalidateLayoutCaches();
     Refresh(false);
     NotifySelectionChanged();
 }
@@ -534,10 +997,14 @@ void DrawBoard::ClearAll() {
     m_selKind = SelKind::None;
     m_selId = -1;
     preMovePins.clear();
+    ClearMultiSelection();
+    m_isGroupDragging = false;
+    m_isBanding = false;
 
     // 清空“准备插入的元件类型”（避免一键清空后误触继续插入）
     if (pSelectedGateName) pSelectedGateName->Clear();
 
+    InvalidateLayoutCaches();
     Refresh(false);
     NotifySelectionChanged();
 }
@@ -555,6 +1022,16 @@ void DrawBoard::AddGate(const wxPoint& center, const wxString& typeName)
     }
 
     GateSnapshot snap{ t, finalCenter, 1.0 };
+    // 参数后缀："<类型>[位宽][_IN<输入数>]"，如 "REGISTER8"、"AND8"（8 位总线与门）、"AND_IN4"（4 输入与门）、"MUX8_IN4"
+    logic::TypeSpec spec;
+    logic::ParseTypeSpec(std::string(typeName.ToUTF8()), spec);
+    snap.width = spec.width;
+    snap.inputs = spec.inputs;
+    if (typeName.StartsWith("SUBCKT:")) {
+        snap.type = SUBCIRCUIT;
+        snap.def = FindSubcircuit(std::string(typeName.Mid(7).ToUTF8()));
+        if (!snap.def) return;
+    }
     if (m_cmd) m_cmd->Execute(std::make_unique<AddGateCmd>(this, snap));
     else       AddGateFromSnapshot(snap);
 
@@ -595,6 +1072,15 @@ void DrawBoard::DeleteSelectedWire() {
 }
 
 void DrawBoard::DeleteSelection() {
+    // 多选：一条批量命令，一次压缩、一次重绘
+    if (MultiSelectionSize() > 1) {
+        if (m_cmd) m_cmd->Execute(std::make_unique<DeleteItemsCmd>(this, m_selGates, m_selWires));
+        else       DeleteItems(std::vector<int>(m_selGates), std::vector<int>(m_selWires));
+        m_selKind = SelKind::None;
+        m_selId = -1;
+        NotifySelectionChanged();
+        return;
+    }
     if (selectedGateIndex >= 0) { DeleteSelectedGate(); return; }
     if (selectedWireIndex >= 0) { DeleteSelectedWire(); return; }
     if (selectedTextIndex >= 0) { DeleteSelectedText(); return; }
@@ -603,12 +1089,73 @@ void DrawBoard::DeleteSelection() {
 
 int DrawBoard::HitTestGate(const wxPoint& pt) const
 {
-    for (int i = (int)components.size() - 1; i >= 0; --i) {
-        if (components[i]->Isinside(pt)) return i;
+    PROF_SCOPE(ZoneHitTest);
+    // 只检查包围盒覆盖该点的元件，仍按从上到下（下标大的优先）
+    EnsureSpatialIndex();
+    std::vector<int> cand;
+    m_gateIndex.Query(pt.x, pt.y, pt.x, pt.y, cand);
+    for (auto it = cand.rbegin(); it != cand.rend(); ++it) {
+        if (components[*it]->Isinside(pt)) return *it;
     }
     return -1;
 }
 
+void DrawBoard::EnsureSpatialIndex() const
+{
+    if (!m_spatialDirty) return;
+    m_gateIndex.Clear();
+    for (int i = 0; i < (int)components.size(); ++i) {
+        if (!components[i]) continue;
+        const MetricsBox b = BoundaryBox(components[i].get());
+        m_gateIndex.Insert(i, b.x0, b.y0, b.x1, b.y1);
+    }
+    // 连线按段登记（与 LayoutMetrics::SetWireImpl 一样），L 形长线不会占满整个包围盒
+    m_wireIndex.Clear();
+    for (int w = 0; w < (int)wires.size(); ++w) {
+        const auto& poly = wires[w];
+        if (poly.size() == 1) m_wireIndex.Insert(w, poly[0].x, poly[0].y, poly[0].x, poly[0].y);
+        for (size_t k = 1; k < poly.size(); ++k) m_wireIndex.Insert(w, poly[k - 1].x, poly[k - 1].y, poly[k].x, poly[k].y);
+    }
+    m_spatialDirty = false;
+}
+
+void DrawBoard::SelectInRect(const wxRect& r, bool additive)
+{
+    EnsureSpatialIndex();
+    std::vector<int> gates, wiresIn, cand;
+
+    m_gateIndex.Query(r.x, r.y, r.GetRight(), r.GetBottom(), cand);
+    for (int i : cand) {
+        if (r.Contains(BoxRect(BoundaryBox(components[i].get())))) gates.push_back(i);
+    }
+    m_wireIndex.Query(r.x, r.y, r.GetRight(), r.GetBottom(), cand);
+    for (int w : cand) {
+        if (r.Contains(PolyRect(wires[w]))) wiresIn.push_back(w);
+    }
+
+    if (additive) {
+        std::vector<int> merged;
+        std::set_union(m_selGates.begin(), m_selGates.end(), gates.begin(), gates.end(), std::back_inserter(merged));
+        m_selGates.swap(merged);
+        merged.clear();
+        std::set_union(m_selWires.begin(), m_selWires.end(), wiresIn.begin(), wiresIn.end(), std::back_inserter(merged));
+        m_selWires.swap(merged);
+    }
+    else {
+        m_selGates.swap(gates);
+        m_selWires.swap(wiresIn);
+    }
+
+    // 主选：第一个元件，没有元件时第一条线
+    selectedGateIndex = m_selGates.empty() ? -1 : m_selGates.front();
+    selectedWireIndex = (selectedGateIndex < 0 && !m_selWires.empty()) ? m_selWires.front() : -1;
+    if (selectedGateIndex >= 0)      { m_selKind = SelKind::Gate; m_selId = selectedGateIndex; }
+    else if (selectedWireIndex >= 0) { m_selKind = SelKind::Wire; m_selId = selectedWireIndex; }
+    else                             { m_selKind = SelKind::None; m_selId = -1; }
+    Refresh(false);
+    NotifySelectionChanged();
+}
+
 // ============ JSON ============
 void DrawBoard::SaveToJson(const std::string& filename)
 {
@@ -650,14 +1197,47 @@ void DrawBoard::SaveToJson(const std::string& filename)
     }
 
     // 4) 门
-    for (auto& c : components) {
-        Json::Value obj;
-        obj["name"] = TypeToName(c->m_type);
-        wxPoint cen = c->GetCenter();
-        obj["x"] = cen.x;
-        obj["y"] = cen.y;
-        obj["scale"] = c->scale;
-        root["gates"].append(obj);
+    for (auto& c : components) root["gates"].append(GateToJson(c.get()));
+
+    // 5) 子电路定义（按创建顺序，加载时被嵌套的定义先就位）
+    for (const auto& def : m_subcircuits) {
+        Json::Value d;
+        d["name"] = def->Name();
+        d["gates"] = Json::Value(Json::arrayValue);
+        for (const auto& part : def->Parts()) d["gates"].append(GateToJson(part.get()));
+        d["wires"] = Json::Value(Json::arrayValue);
+        for (const auto& poly : def->Wires()) {
+            Json::Value arr(Json::arrayValue);
+            for (const auto& p : poly) {
+                Json::Value node;
+                node["x"] = p.x;
+                node["y"] = p.y;
+                arr.append(node);
+            }
+            d["wires"].append(arr);
+        }
+        // 无界面仿真用的编译网表（与画布仿真同一套连通性规则）
+        Connectivity sub;
+        for (int i = 0; i < (int)def->Parts().size(); ++i) {
+            const auto pins = def->Parts()[i]->GetPins();
+            for (int p = 0; p < (int)pins.size(); ++p) sub.AddPin(PinRef{ i, p }, pins[p].x, pins[p].y);
+        }
+        for (const auto& poly : def->Wires()) sub.AddWire(poly);
+        sub.Extract();
+        SimNetlist subNl;
+        FillSimNetlist(def->Parts(), sub, subNl);
+        d["netlist"] = netio::ToJson(subNl);
+        root["subcircuits"].append(d);
+    }
+
+    // 6) 顶层网表：命令行仿真只读这一节，不需要元件几何
+    {
+        Connectivity conn;
+        BuildConnectivity(conn);
+        conn.Extract();
+        SimNetlist nl;
+        BuildSimNetlist(conn, nl);
+        root["netlist"] = netio::ToJson(nl);
     }
 
     std::ofstream ofs(filename);
@@ -678,6 +1258,29 @@ void DrawBoard::LoadFromJson(const std::string& filename)
 
     // 清空
     wires.clear(); lines.clear(); texts.clear(); components.clear();
+    selectedGateIndex = selectedWireIndex = -1;
+    ClearMultiSelection();
+    m_subcircuits.clear();
+
+    // 0) 子电路定义：门引用定义名，先于门读入
+    if (root.isMember("subcircuits") && root["subcircuits"].isArray()) {
+        for (const auto& d : root["subcircuits"]) {
+            const std::string name = d.get("name", "").asString();
+            if (name.empty() || FindSubcircuit(name)) continue;
+            std::vector<std::unique_ptr<Component>> parts;
+            for (const auto& obj : d["gates"]) {
+                if (auto comp = GateFromJson(obj)) parts.push_back(std::move(comp));
+            }
+            std::vector<std::vector<wxPoint>> polys;
+            for (const auto& arr : d["wires"]) {
+                if (!arr.isArray() || arr.size() < 2) continue;
+                std::vector<wxPoint> poly;
+                for (const auto& node : arr) poly.emplace_back(node.get("x", 0).asInt(), node.get("y", 0).asInt());
+                polys.push_back(std::move(poly));
+            }
+            m_subcircuits.push_back(SubcircuitDef::Create(name, std::move(parts), std::move(polys)));
+        }
+    }
 
     // 1) wires（折线）
     if (root.isMember("wires") && root["wires"].isArray()) {
@@ -730,20 +1333,49 @@ void DrawBoard::LoadFromJson(const std::string& filename)
     // 4) 门
     if (root.isMember("gates") && root["gates"].isArray()) {
         for (auto& obj : root["gates"]) {
-            wxPoint center(obj.get("x", 0).asInt(), obj.get("y", 0).asInt());
-            wxString name = wxString::FromUTF8(obj.get("name", "").asCString());
-            auto comp = MakeComponent(NameToType(name), center);
-            if (comp) {
-                if (obj.isMember("scale")) comp->scale = obj["scale"].asDouble();
-                comp->UpdateGeometry();
-                components.push_back(std::move(comp));
-            }
+            if (auto comp = GateFromJson(obj)) components.push_back(std::move(comp));
         }
     }
 
+    InvalidateLayoutCaches();
     Refresh(false);
 }
 
+Json::Value DrawBoard::GateToJson(Component* c)
+{
+    Json::Value obj;
+    obj["name"] = TypeToName(c->m_type);
+    wxPoint cen = c->GetCenter();
+    obj["x"] = cen.x;
+    obj["y"] = cen.y;
+    obj["scale"] = c->scale;
+    if (c->m_type == SUBCIRCUIT) {
+        const auto& def = static_cast<const SubcircuitComp*>(c)->Def();
+        if (def) obj["def"] = def->Name();
+    }
+    // 可变位宽的类型总是写出：寄存器/分线器等新建时的默认位宽不是 1，省略会读回成默认值
+    if (logic::MaxWidth(c->m_type) > 1 || c->width != 1) obj["width"] = c->width;
+    if (c->inputs != 2) obj["inputs"] = c->inputs;
+    return obj;
+}
+
+std::unique_ptr<Component> DrawBoard::GateFromJson(const Json::Value& obj) const
+{
+    wxPoint center(obj.get("x", 0).asInt(), obj.get("y", 0).asInt());
+    wxString name = wxString::FromUTF8(obj.get("name", "").asCString());
+    const ComponentType t = NameToType(name);
+    std::shared_ptr<const SubcircuitDef> def;
+    if (t == SUBCIRCUIT) def = FindSubcircuit(obj.get("def", "").asString());   // 找不到定义的实例丢弃
+    auto comp = MakeComponent(t, center, def);
+    if (comp) {
+        if (obj.isMember("scale")) comp->scale = obj["scale"].asDouble();
+        if (obj.isMember("width")) comp->width = obj["width"].asInt();
+        if (obj.isMember("inputs")) comp->inputs = obj["inputs"].asInt();
+        comp->UpdateGeometry();
+    }
+    return comp;
+}
+
 // ============ 小工具 ============
 std::array<wxPoint, 4> DrawBoard::GetGateAnchorPoints(const Component* comp) const
 {
@@ -754,54 +1386,16 @@ std::array<wxPoint, 4> DrawBoard::GetGateAnchorPoints(const Component* comp) con
 
 ComponentType DrawBoard::NameToType(const wxString& s)
 {
-    wxString u = s.Upper().Trim(true).Trim(false);
-
-    // 先匹配更具体的
-    if (u.Contains("XNOR")) return XNORGATE;        // ★ 新增
-    if (u.Contains("NAND")) return NANDGATE;
-    if (u.Contains("NOR"))  return NORGATE;
-    if (u.Contains("XOR"))  return XORGATE;
-
-    // 基本门
-    if (u.Contains("NOT"))  return NOTGATE;
-    if (u.Contains("OR"))   return ORGATE;
-    if (u.Contains("AND"))  return ANDGATE;
-
-    // 译码器
-    if (u.Contains("DECODER38") || u.Contains("DEC3TO8") || u.Contains("3-8"))
-        return DECODER38;                              // ★ 新增
-    if (u.Contains("DECODER24") || u.Contains("DEC2TO4") || u.Contains("2-4"))
-        return DECODER24;                              // ★ 新增
-
-    // 结点
-    if (u.Contains("START_NODE") || u.Contains("STARTNODE") || u.Contains("起始")) return NODE_START;
-    if (u.Contains("END_NODE") || u.Contains("ENDNODE") || u.Contains("终止")) return NODE_END;
-    if (u.Contains("NODE"))  return NODE_BASIC;
-
-    return ANDGATE; // 兜底
+    return logic::TypeFromName(std::string(s.ToUTF8()));   // 与无界面加载共用同一套识别规则
 }
 
-
 const char* DrawBoard::TypeToName(ComponentType t)
 {
-    switch (t) {
-    case ANDGATE:     return "AND";
-    case ORGATE:      return "OR";
-    case NOTGATE:     return "NOT";
-    case NANDGATE:    return "NAND";
-    case NORGATE:     return "NOR";
-    case XORGATE:     return "XOR";
-    case XNORGATE:    return "XNOR";       // ★ 新增
-    case DECODER24:   return "DECODER24";  // ★ 新增
-    case DECODER38:   return "DECODER38";  // ★ 新增
-    case NODE_BASIC:  return "NODE";
-    case NODE_START:  return "START_NODE";
-    case NODE_END:    return "END_NODE";
-    default:          return "AND";
-    }
+    return logic::TypeName(t);
 }
 
-std::unique_ptr<Component> DrawBoard::MakeComponent(ComponentType t, const wxPoint& center)
+std::unique_ptr<Component> DrawBoard::MakeComponent(ComponentType t, const wxPoint& center,
+    std::shared_ptr<const SubcircuitDef> def)
 {
     switch (t) {
     case ANDGATE:     return std::make_unique<ANDGate>(center);
@@ -816,10 +1410,33 @@ std::unique_ptr<Component> DrawBoard::MakeComponent(ComponentType t, const wxPoi
     case NODE_BASIC:  return std::make_unique<NodeDot>(center);
     case NODE_START:  return std::make_unique<StartNode>(center);
     case NODE_END:    return std::make_unique<EndNode>(center);
+    case SUBCIRCUIT:  return def ? std::make_unique<SubcircuitComp>(center, std::move(def)) : nullptr;
+    case CLOCK:       return std::make_unique<ClockSource>(center);
+    case DFF:         return std::make_unique<DFlipFlop>(center);
+    case JKFF:        return std::make_unique<JKFlipFlop>(center);
+    case DLATCH:      return std::make_unique<DLatchComp>(center);
+    case REGISTER:    return std::make_unique<RegisterComp>(center, 4);
+    case SPLITTER:    return std::make_unique<SplitterComp>(center, 8);
+    case MERGER:      return std::make_unique<MergerComp>(center, 8);
+    case MUX:         return std::make_unique<MuxComp>(center, 2, 1);
+    case ADDER:       return std::make_unique<AdderComp>(center, 1);
+    case COMPARATOR:  return std::make_unique<ComparatorComp>(center, 1);
     default:          return nullptr;
     }
 }
 
+std::unique_ptr<Component> DrawBoard::MakeFromSnapshot(const GateSnapshot& s, const wxPoint& center)
+{
+    auto comp = MakeComponent(s.type, center, s.def);
+    if (comp) {
+        comp->scale = s.scale;
+        comp->width = s.width;
+        comp->inputs = s.inputs;
+        comp->UpdateGeometry();
+    }
+    return comp;
+}
+
 bool DrawBoard::FindNearestPin(const wxPoint& p, wxPoint& out, int* compIdx) const
 {
     int bestIdx = -1;
@@ -866,45 +1483,196 @@ wxPoint DrawBoard::SnapToStep(const wxPoint& p) const
     return wxPoint(roundTo(p.x, STEP), roundTo(p.y, STEP));
 }
 
-void DrawBoard::RerouteWiresForMovedComponent(int compIdx, const std::vector<wxPoint>& prevPins)
+void DrawBoard::RerouteWiresForMovedComponent(int compIdx, const std::vector<wxPoint>& prevPins, wxRect* dirty)
 {
     if (compIdx < 0 || compIdx >= (int)components.size()) return;
 
     // 新/旧引脚表
-    const std::vector<wxPoint> newPins = components[compIdx]->GetPins();
+    Component* comp = components[compIdx].get();
+    const std::vector<wxPoint> newPins = comp->GetPins();
     if (prevPins.empty() || newPins.empty()) return;
 
-    auto nearlyEqual = [](const wxPoint& a, const wxPoint& b) {
-        // 容忍 1 个像素以内的差异，避免栅格/吸附导致的非严格相等
-        return (std::abs(a.x - b.x) <= 1) && (std::abs(a.y - b.y) <= 1);
-        };
+    EnsurePinWireIndex();
 
-    auto findPinByPoint = [&](const wxPoint& p)->int {
-        for (int i = 0; i < (int)prevPins.size(); ++i) {
-            if (nearlyEqual(prevPins[i], p)) return i;
-        }
-        return -1;
-        };
+    // 1) 占用表：增量挪动该元件；需要重建时按新位置整体重建
+    const MetricsBox newBox = BoundaryBox(comp);
+    RouterComponentMoved(compIdx, prevPins);
+    EnsureRouter();
+    m_spatialDirty = true;
 
-    for (auto& poly : wires) {
+    // 2) 只处理挂在该元件引脚上的线：先全部移出占用，再逐条重布并登记
+    const auto& ends = m_compWires[compIdx];
+    std::vector<int> touched;
+    for (const WireEnd& e : ends) {
+        if (e.wire < (int)wires.size() && std::find(touched.begin(), touched.end(), e.wire) == touched.end())
+            touched.push_back(e.wire);
+    }
+    for (int w : touched) m_router.RemoveWire(wires[w]);
+
+    for (int w : touched) {
+        auto& poly = wires[w];
         if (poly.size() < 2) continue;
+        if (dirty) *dirty = UnionRect(*dirty, PolyRect(poly));
+
+        int pinS = -1, pinE = -1;
+        for (const WireEnd& e : ends) {
+            if (e.wire != w || e.pin >= (int)newPins.size()) continue;
+            (e.atEnd ? pinE : pinS) = e.pin;
+        }
+
+        if (pinS >= 0 && pinE >= 0) {
+            poly = RouteOrManhattan(m_router, newPins[pinS], newPins[pinE]);   // 两端都在本元件上
+        }
+        else if (pinE >= 0) {
+            poly = RerouteTail(m_router, poly, newPins[pinE], newBox);
+        }
+        else if (pinS >= 0) {
+            std::vector<wxPoint> rev(poly.rbegin(), poly.rend());
+            rev = RerouteTail(m_router, rev, newPins[pinS], newBox);
+            poly.assign(rev.rbegin(), rev.rend());
+        }
+        m_router.AddWire(poly);
+        if (!m_metricsDirty) m_metrics.SetWire(w, poly);
+        if (dirty) *dirty = UnionRect(*dirty, PolyRect(poly));
+    }
+
+    // 起始/终止节点会吸附到别的引脚上，挂接关系可能变了
+    if (IsAttachableNode(comp->m_type)) m_pinWireDirty = true;
+}
+
+std::vector<wxPoint> DrawBoard::RerouteTail(GridRouter& router, const std::vector<wxPoint>& poly,
+    const wxPoint& newEnd, const MetricsBox& keepOut) const
+{
+    const wxPoint start = poly.front();
+    if (start == newEnd) return { start, newEnd };
+
+    // 保留前缀 poly[0..j]：去掉最后一个 L（两段），并截到第一段穿过移动后元件的线段之前
+    int j = std::max(0, (int)poly.size() - 3);
+    for (int k = 0; k < j; ++k) {
+        const wxPoint& a = poly[k];
+        const wxPoint& b = poly[k + 1];
+        const bool cuts = std::min(a.x, b.x) < keepOut.x1 && std::max(a.x, b.x) > keepOut.x0 &&
+            std::min(a.y, b.y) < keepOut.y1 && std::max(a.y, b.y) > keepOut.y0;
+        if (cuts) { j = k; break; }
+    }
+
+    std::vector<wxPoint> prefix(poly.begin(), poly.begin() + j + 1);
+    std::vector<RoutePoint> tail;
+    // 前缀暂记入占用，免得尾部沿着自己折回
+    if (prefix.size() >= 2) router.AddWire(prefix);
+    const bool ok = prefix.back() != newEnd &&
+        router.Route(ToRoutePoint(prefix.back()), ToRoutePoint(newEnd), tail);
+    if (prefix.size() >= 2) router.RemoveWire(prefix);
+
+    if (!ok) return RouteOrManhattan(router, start, newEnd);
+    std::vector<wxPoint> out = std::move(prefix);
+    for (size_t k = 1; k < tail.size(); ++k) out.emplace_back(tail[k].x, tail[k].y);
+    SimplifyPolyline(out);
+    return out;
+}
+
+void DrawBoard::RouterComponentMoved(int compIdx, const std::vector<wxPoint>& prevPins)
+{
+    if (m_routerDirty) return;   // 稍后整体重建时自然是新位置
+    Component* comp = components[compIdx].get();
+    const MetricsBox newBox = BoundaryBox(comp);
+    if (!m_router.Contains(newBox.x0, newBox.y0) || !m_router.Contains(newBox.x1, newBox.y1)) {
+        m_routerDirty = true;   // 移出了网格范围
+        return;
+    }
+    const bool obstacle = !IsNodeType(comp->m_type);
+    const MetricsBox& oldBox = m_routerBoxes[compIdx];
+    if (obstacle) m_router.RemoveObstacle(oldBox.x0, oldBox.y0, oldBox.x1, oldBox.y1);
+    for (const auto& p : prevPins) m_router.RemovePinKeepout(p.x, p.y);
+    if (obstacle) m_router.AddObstacle(newBox.x0, newBox.y0, newBox.x1, newBox.y1);
+    for (const auto& p : comp->GetPins()) m_router.AddPinKeepout(p.x, p.y);
+    m_routerBoxes[compIdx] = newBox;
+}
 
-        wxPoint start = poly.front();
-        wxPoint end = poly.back();
-        bool changed = false;
+void DrawBoard::EnsureRouter()
+{
+    if (!m_routerDirty) return;
+    PrepareRouter(m_router);
+    m_routerBoxes.resize(components.size());
+    for (size_t i = 0; i < components.size(); ++i) {
+        if (components[i]) m_routerBoxes[i] = BoundaryBox(components[i].get());
+    }
+    m_routerDirty = false;
+}
+
+void DrawBoard::EnsurePinWireIndex()
+{
+    if (!m_pinWireDirty) return;
+
+    // 引脚坐标 → (元件, 引脚)；端点与引脚相差 1 像素以内视为挂接（与旧的逐点比较一致）
+    std::unordered_map<uint64_t, std::vector<std::pair<int, int>>> byPoint;
+    auto key = [](int x, int y) { return (uint64_t(uint32_t(x)) << 32) | uint32_t(y); };
+    for (int i = 0; i < (int)components.size(); ++i) {
+        if (!components[i]) continue;
+        const auto pins = components[i]->GetPins();
+        for (int p = 0; p < (int)pins.size(); ++p) byPoint[key(pins[p].x, pins[p].y)].push_back({ i, p });
+    }
+
+    m_compWires.assign(components.size(), {});
+    auto attach = [&](int w, bool atEnd, const wxPoint& pt) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                auto it = byPoint.find(key(pt.x + dx, pt.y + dy));
+                if (it == byPoint.end()) continue;
+                for (const auto& cp : it->second) m_compWires[cp.first].push_back(WireEnd{ w, atEnd, cp.second });
+            }
+        }
+        };
+    for (int w = 0; w < (int)wires.size(); ++w) {
+        if (wires[w].size() < 2) continue;
+        attach(w, false, wires[w].front());
+        attach(w, true, wires[w].back());
+    }
+    m_pinWireDirty = false;
+}
 
-        int idxS = findPinByPoint(start);
-        int idxE = findPinByPoint(end);
+void DrawBoard::PrepareRouter(GridRouter& router, const std::vector<char>* skipWire) const
+{
+    // 覆盖全部元件与导线
+    int minx = INT_MAX, miny = INT_MAX, maxx = INT_MIN, maxy = INT_MIN;
+    auto grow = [&](int x, int y) {
+        minx = std::min(minx, x); miny = std::min(miny, y);
+        maxx = std::max(maxx, x); maxy = std::max(maxy, y);
+        };
+    for (const auto& up : components) {
+        if (!up) continue;
+        const MetricsBox b = BoundaryBox(up.get());
+        grow(b.x0, b.y0);
+        grow(b.x1, b.y1);
+    }
+    for (const auto& poly : wires) for (const auto& p : poly) grow(p.x, p.y);
+    if (minx > maxx) { minx = miny = 0; maxx = maxy = GRID; }
 
-        if (idxS >= 0 && idxS < (int)newPins.size()) { start = newPins[idxS]; changed = true; }
-        if (idxE >= 0 && idxE < (int)newPins.size()) { end = newPins[idxE]; changed = true; }
+    RouterOptions opt;
+    opt.pitch = STEP;
+    router.Reset(minx, miny, maxx, maxy, opt);
 
-        if (changed) {
-            poly = MakeManhattan(start, end);
+    for (const auto& up : components) {
+        if (!up) continue;
+        if (!IsNodeType(up->m_type)) {
+            const MetricsBox b = BoundaryBox(up.get());
+            router.AddObstacle(b.x0, b.y0, b.x1, b.y1);
         }
+        for (const auto& p : up->GetPins()) router.AddPinKeepout(p.x, p.y);
+    }
+    for (size_t w = 0; w < wires.size(); ++w) {
+        if (skipWire && w < skipWire->size() && (*skipWire)[w]) continue;
+        router.AddWire(wires[w]);
     }
 }
 
+std::vector<wxPoint> DrawBoard::RouteOrManhattan(GridRouter& router, const wxPoint& a, const wxPoint& b) const
+{
+    std::vector<RoutePoint> path;
+    if (a != b && router.Route(ToRoutePoint(a), ToRoutePoint(b), path)) return ToWxPoly(path);
+    return MakeManhattan(a, b);
+}
+
 int DrawBoard::Dist2_PointToSeg(const wxPoint& p, const wxPoint& a, const wxPoint& b)
 {
     const int vx = b.x - a.x, vy = b.y - a.y;
@@ -921,8 +1689,13 @@ int DrawBoard::Dist2_PointToSeg(const wxPoint& p, const wxPoint& a, const wxPoin
 
 int DrawBoard::HitTestWire(const wxPoint& pt) const
 {
+    PROF_SCOPE(ZoneHitTest);
     const int th2 = LINE_HIT_PX * LINE_HIT_PX;
-    for (int i = (int)wires.size() - 1; i >= 0; --i) {
+    EnsureSpatialIndex();
+    std::vector<int> cand;
+    m_wireIndex.Query(pt.x - LINE_HIT_PX, pt.y - LINE_HIT_PX, pt.x + LINE_HIT_PX, pt.y + LINE_HIT_PX, cand);
+    for (auto it = cand.rbegin(); it != cand.rend(); ++it) {
+        const int i = *it;
         const auto& poly = wires[i];
         for (size_t k = 1; k < poly.size(); ++k) {
             if (Dist2_PointToSeg(pt, poly[k - 1], poly[k]) <= th2) return i;
@@ -942,6 +1715,7 @@ void DrawBoard::NotifySelectionChanged() {
 void DrawBoard::SelectNone() {
     selectedGateIndex = -1;
     selectedWireIndex = -1;
+    ClearMultiSelection();
     m_selKind = SelKind::None;
     m_selId = -1;
     Refresh(false);
@@ -952,6 +1726,8 @@ void DrawBoard::SelectGateByIndex(int idx) {
     if (idx >= 0 && idx < (int)components.size()) {
         selectedGateIndex = idx;
         selectedWireIndex = -1;
+        m_selGates.assign(1, idx);
+        m_selWires.clear();
         m_selKind = SelKind::Gate;
         m_selId = idx;
         Refresh(false);
@@ -963,6 +1739,8 @@ void DrawBoard::SelectWireByIndex(int idx) {
     if (idx >= 0 && idx < (int)wires.size()) {
         selectedWireIndex = idx;
         selectedGateIndex = -1;
+        m_selGates.clear();
+        m_selWires.assign(1, idx);
         m_selKind = SelKind::Wire;
         m_selId = idx;
         Refresh(false);
@@ -971,12 +1749,29 @@ void DrawBoard::SelectWireByIndex(int idx) {
 }
 
 // ===== 命令层 API =====
+void DrawBoard::SetCommandManager(CommandManager* m)
+{
+    m_cmd = m;
+    if (m_cmd) m_cmd->SetOnBatch([this](bool begin) { begin ? BeginBatchUpdate() : EndBatchUpdate(); });
+}
+
+void DrawBoard::BeginBatchUpdate()
+{
+    if (m_batchDepth++ == 0) Freeze();
+}
+
+void DrawBoard::EndBatchUpdate()
+{
+    if (m_batchDepth == 0 || --m_batchDepth > 0) return;
+    Thaw();
+    Refresh(false);
+}
+
 long DrawBoard::AddGateFromSnapshot(const GateSnapshot& s) {
-    auto comp = MakeComponent(s.type, SnapToStep(s.center));
+    auto comp = MakeFromSnapshot(s, SnapToStep(s.center));
     if (!comp) return -1;
-    comp->scale = s.scale;
-    comp->UpdateGeometry();
     components.push_back(std::move(comp));
+    InvalidateLayoutCaches();
     Refresh(false);
     return (long)components.size() - 1;
 }
@@ -988,6 +1783,9 @@ std::optional<GateSnapshot> DrawBoard::ExportGateByIndex(long id) const {
     s.type = c->m_type;
     s.center = c->GetCenter();
     s.scale = c->scale;
+    s.width = c->width;
+    s.inputs = c->inputs;
+    if (c->m_type == SUBCIRCUIT) s.def = static_cast<const SubcircuitComp*>(c.get())->Def();
     return s;
 }
 
@@ -995,6 +1793,8 @@ void DrawBoard::DeleteGateByIndex(long id) {
     if (id < 0 || id >= (long)components.size()) return;
     components.erase(components.begin() + id);
     if (selectedGateIndex == id) selectedGateIndex = -1;
+    ClearMultiSelection();   // 后面的下标整体前移，集合作废
+    InvalidateLayoutCaches();
     Refresh(false);
 }
 
@@ -1005,12 +1805,31 @@ void DrawBoard::MoveGateTo(long id, const wxPoint& pos) {
     components[id]->SetCenter(SnapToStep(pos));
     // After move, reroute wires using prevPins -> new pins mapping
     RerouteWiresForMovedComponent((int)id, prevPins);
+    MetricsGateMoved((int)id);
+    Refresh(false);
+}
+
+void DrawBoard::SetGateParams(long id, int width, int inputs) {
+    if (id < 0 || id >= (long)components.size()) return;
+    Component* c = components[id].get();
+    width = std::max(1, std::min(width, logic::MaxWidth(c->m_type)));
+    if (logic::MaxInputs(c->m_type) > 0) inputs = std::max(2, std::min(inputs, logic::MaxInputs(c->m_type)));
+    else inputs = c->inputs;
+    if (c->width == width && c->inputs == inputs) return;
+    // 引脚数随位宽/输入数变化：按下标对应的引脚让连线跟随，多出的连线留在原处
+    std::vector<wxPoint> prevPins = c->GetPins();
+    c->width = width;
+    c->inputs = inputs;
+    c->UpdateGeometry();
+    RerouteWiresForMovedComponent((int)id, prevPins);
+    InvalidateLayoutCaches();
     Refresh(false);
 }
 
 long DrawBoard::AddWire(const WireSnapshot& w) {
     if (w.poly.size() < 2) return -1;
     wires.push_back(w.poly);
+    InvalidateLayoutCaches();
     Refresh(false);
     return (long)wires.size() - 1;
 }
@@ -1024,6 +1843,410 @@ void DrawBoard::DeleteWireByIndex(long id) {
     if (id < 0 || id >= (long)wires.size()) return;
     wires.erase(wires.begin() + id);
     if (selectedWireIndex == id) selectedWireIndex = -1;
+    ClearMultiSelection();
+    InvalidateLayoutCaches();
+    Refresh(false);
+}
+
+ItemsSnapshot DrawBoard::ExportItems(const std::vector<int>& gateIds, const std::vector<int>& wireIds) const
+{
+    std::vector<int> g(gateIds), w(wireIds);
+    std::sort(g.begin(), g.end()); g.erase(std::unique(g.begin(), g.end()), g.end());
+    std::sort(w.begin(), w.end()); w.erase(std::unique(w.begin(), w.end()), w.end());
+
+    ItemsSnapshot s;
+    for (int id : g) {
+        if (auto snap = ExportGateByIndex(id)) s.gates.emplace_back(id, *snap);
+    }
+    for (int id : w) {
+        if (auto snap = ExportWireByIndex(id)) s.wires.emplace_back(id, *snap);
+    }
+    return s;
+}
+
+void DrawBoard::DeleteItems(const std::vector<int>& gateIds, const std::vector<int>& wireIds)
+{
+    bool changed = EraseIndices(components, gateIds);
+    changed = EraseIndices(wires, wireIds) || changed;
+    if (!changed) return;
+    selectedGateIndex = -1;
+    selectedWireIndex = -1;
+    ClearMultiSelection();
+    InvalidateLayoutCaches();
+    Refresh(false);
+}
+
+void DrawBoard::InsertItems(const ItemsSnapshot& s)
+{
+    if (s.gates.empty() && s.wires.empty()) return;
+    InsertAtIndices(components, s.gates, [](const GateSnapshot& g) { return MakeFromSnapshot(g, g.center); });
+    InsertAtIndices(wires, s.wires, [](const WireSnapshot& w) { return w.poly; });
+
+    // 插回的对象即为新的多选集合
+    ClearMultiSelection();
+    for (const auto& g : s.gates) m_selGates.push_back((int)g.first);
+    for (const auto& w : s.wires) m_selWires.push_back((int)w.first);
+    selectedGateIndex = m_selGates.empty() ? -1 : m_selGates.front();
+    selectedWireIndex = -1;
+    InvalidateLayoutCaches();
+    Refresh(false);
+}
+
+void DrawBoard::AppendClipboard(const ClipboardData& d, const wxPoint& offset)
+{
+    const int g0 = (int)components.size(), w0 = (int)wires.size();
+    components.reserve(components.size() + d.gates.size());
+    for (const GateSnapshot& g : d.gates) {
+        auto comp = MakeFromSnapshot(g, g.center + offset);
+        if (!comp) continue;
+        components.push_back(std::move(comp));
+    }
+    wires.reserve(wires.size() + d.WireCount());
+    for (size_t w = 0; w < d.WireCount(); ++w) {
+        std::vector<wxPoint> poly(d.points.begin() + d.wireStart[w], d.points.begin() + d.wireStart[w + 1]);
+        for (auto& p : poly) p += offset;
+        wires.push_back(std::move(poly));
+    }
+
+    // 粘贴出来的对象成为新的多选集合
+    m_selGates.resize(components.size() - g0);
+    std::iota(m_selGates.begin(), m_selGates.end(), g0);
+    m_selWires.resize(wires.size() - w0);
+    std::iota(m_selWires.begin(), m_selWires.end(), w0);
+    selectedGateIndex = m_selGates.empty() ? -1 : m_selGates.front();
+    selectedWireIndex = (selectedGateIndex < 0 && !m_selWires.empty()) ? m_selWires.front() : -1;
+    if (selectedGateIndex >= 0)      { m_selKind = SelKind::Gate; m_selId = selectedGateIndex; }
+    else if (selectedWireIndex >= 0) { m_selKind = SelKind::Wire; m_selId = selectedWireIndex; }
+
+    InvalidateLayoutCaches();
+    Refresh(false);
+    NotifySelectionChanged();
+}
+
+void DrawBoard::TruncateItems(size_t gateCount, size_t wireCount)
+{
+    if (components.size() <= gateCount && wires.size() <= wireCount) return;
+    if (components.size() > gateCount) components.erase(components.begin() + gateCount, components.end());
+    if (wires.size() > wireCount) wires.erase(wires.begin() + wireCount, wires.end());
+    if (selectedGateIndex >= (int)gateCount) selectedGateIndex = -1;
+    if (selectedWireIndex >= (int)wireCount) selectedWireIndex = -1;
+    ClearMultiSelection();
+    m_selKind = selectedGateIndex >= 0 ? SelKind::Gate : (selectedWireIndex >= 0 ? SelKind::Wire : SelKind::None);
+    m_selId = selectedGateIndex >= 0 ? selectedGateIndex : selectedWireIndex;
+    InvalidateLayoutCaches();
+    Refresh(false);
+    NotifySelectionChanged();
+}
+
+bool DrawBoard::CollectSelection(std::vector<int>& gateIds, std::vector<int>& wireIds)
+{
+    gateIds = m_selGates;
+    wireIds = m_selWires;
+    if (gateIds.empty() && wireIds.empty()) {
+        if (selectedGateIndex >= 0 && selectedGateIndex < (int)components.size()) gateIds.push_back(selectedGateIndex);
+        else if (selectedWireIndex >= 0 && selectedWireIndex < (int)wires.size()) wireIds.push_back(selectedWireIndex);
+    }
+    if (gateIds.empty() && wireIds.empty()) return false;
+
+    // 内部连线：两端都挂在被复制的元件上
+    EnsurePinWireIndex();
+    std::vector<unsigned char> endMask(wires.size(), 0);
+    for (int g : gateIds) {
+        for (const WireEnd& e : m_compWires[g]) {
+            if (e.wire < (int)wires.size()) endMask[e.wire] |= e.atEnd ? 2 : 1;
+        }
+    }
+    for (int w = 0; w < (int)wires.size(); ++w) {
+        if (endMask[w] == 3) wireIds.push_back(w);
+    }
+    std::sort(wireIds.begin(), wireIds.end());
+    wireIds.erase(std::unique(wireIds.begin(), wireIds.end()), wireIds.end());
+    return true;
+}
+
+bool DrawBoard::CopySelection()
+{
+    std::vector<int> gateIds, wireIds;
+    if (!CollectSelection(gateIds, wireIds)) return false;
+    CopyItems(gateIds, wireIds);
+    return true;
+}
+
+void DrawBoard::CopyItems(const std::vector<int>& gateIds, const std::vector<int>& wireIds)
+{
+    // 左上角对齐到网格，粘贴后仍落在格点上
+    int minx = INT_MAX, miny = INT_MAX;
+    for (int g : gateIds) {
+        const MetricsBox b = BoundaryBox(components[g].get());
+        minx = std::min(minx, b.x0); miny = std::min(miny, b.y0);
+    }
+    for (int w : wireIds) {
+        for (const auto& p : wires[w]) { minx = std::min(minx, p.x); miny = std::min(miny, p.y); }
+    }
+    auto floorTo = [](int v, int step) { return (v >= 0 ? v / step : -((-v + step - 1) / step)) * step; };
+    const wxPoint origin(floorTo(minx, GRID), floorTo(miny, GRID));
+
+    auto data = std::make_shared<ClipboardData>();
+    data->origin = origin;
+    data->gates.reserve(gateIds.size());
+    for (int g : gateIds) {
+        GateSnapshot s = *ExportGateByIndex(g);
+        s.center -= origin;
+        data->gates.push_back(s);
+    }
+    data->wireStart.reserve(wireIds.size() + 1);
+    data->wireStart.push_back(0);
+    for (int w : wireIds) {
+        for (const auto& p : wires[w]) data->points.push_back(p - origin);
+        data->wireStart.push_back((int)data->points.size());
+    }
+    m_clipboard = std::move(data);
+    m_pasteCount = 0;
+}
+
+std::shared_ptr<const SubcircuitDef> DrawBoard::FindSubcircuit(const std::string& name) const
+{
+    for (const auto& def : m_subcircuits) {
+        if (def->Name() == name) return def;
+    }
+    return nullptr;
+}
+
+bool DrawBoard::CreateSubcircuitFromSelection(const wxString& name, wxString* why)
+{
+    auto fail = [why](const wxString& msg) { if (why) *why = msg; return false; };
+    const std::string key(name.ToUTF8());
+    if (key.empty()) return fail("子电路名称不能为空");
+    if (FindSubcircuit(key)) return fail("已存在同名子电路：" + name);
+
+    std::vector<int> gateIds, wireIds;
+    if (!CollectSelection(gateIds, wireIds) || gateIds.empty()) return fail("请先选中要封装的元件");
+
+    // 包围盒中心对齐到网格作为定义原点，实例就放在这里
+    int minx = INT_MAX, miny = INT_MAX, maxx = INT_MIN, maxy = INT_MIN;
+    for (int g : gateIds) {
+        const MetricsBox b = BoundaryBox(components[g].get());
+        minx = std::min(minx, b.x0); miny = std::min(miny, b.y0);
+        maxx = std::max(maxx, b.x1); maxy = std::max(maxy, b.y1);
+    }
+    const wxPoint origin = SnapToGrid(wxPoint((minx + maxx) / 2, (miny + maxy) / 2));
+
+    std::vector<std::unique_ptr<Component>> parts;
+    parts.reserve(gateIds.size());
+    for (int g : gateIds) {
+        const GateSnapshot s = *ExportGateByIndex(g);
+        if (logic::IsSequential(s.type))
+            return fail("子电路只能封装组合逻辑，选区里有时钟源/触发器/寄存器/锁存器");
+        if (logic::IsWordOp(s.type, s.width))
+            return fail("子电路的端口与内部求值都是单线，选区里有分线器/合线器、运算块或总线门");
+        auto comp = MakeFromSnapshot(s, s.center - origin);
+        if (!comp) continue;
+        parts.push_back(std::move(comp));
+    }
+    std::vector<std::vector<wxPoint>> polys;
+    polys.reserve(wireIds.size());
+    for (int w : wireIds) {
+        std::vector<wxPoint> poly = wires[w];
+        for (auto& p : poly) p -= origin;
+        polys.push_back(std::move(poly));
+    }
+
+    auto def = SubcircuitDef::Create(key, std::move(parts), std::move(polys));
+    if (def->NumInputs() + def->NumOutputs() == 0)
+        return fail("选区里没有起始/终止节点，子电路没有端口");
+    m_subcircuits.push_back(def);
+
+    // 边界连线：选区外、一端挂在选中的起始/终止节点上的线
+    // 端口编号与 SubcircuitDef 相同（各按 (y, x) 排序），对应实例的第 k 个输入 / 第 nIn + k 个引脚
+    std::vector<std::pair<wxPoint, int>> inPorts, outPorts;
+    for (int g : gateIds) {
+        Component* c = components[g].get();
+        if (c->m_type == NODE_START) inPorts.push_back({ c->GetCenter(), g });
+        else if (c->m_type == NODE_END) outPorts.push_back({ c->GetCenter(), g });
+    }
+    auto byPos = [](const std::pair<wxPoint, int>& a, const std::pair<wxPoint, int>& b) {
+        return a.first.y != b.first.y ? a.first.y < b.first.y : a.first.x < b.first.x;
+        };
+    std::sort(inPorts.begin(), inPorts.end(), byPos);
+    std::sort(outPorts.begin(), outPorts.end(), byPos);
+    std::vector<int> instPin(components.size(), -1);
+    for (size_t k = 0; k < inPorts.size(); ++k) instPin[inPorts[k].second] = (int)k;
+    for (size_t k = 0; k < outPorts.size(); ++k) instPin[outPorts[k].second] = def->NumInputs() + (int)k;
+
+    struct Boundary { std::vector<wxPoint> poly; int pinS = -1, pinE = -1; };   // 两端挂到的实例引脚
+    std::vector<Boundary> boundary;
+    std::vector<int> slot(wires.size(), -1), deadWires = wireIds;
+    EnsurePinWireIndex();
+    for (int w : wireIds) slot[w] = -2;
+    for (int g : gateIds) {
+        if (instPin[g] < 0) continue;
+        for (const WireEnd& e : m_compWires[g]) {
+            if (e.wire >= (int)wires.size() || slot[e.wire] == -2) continue;
+            if (slot[e.wire] < 0) {
+                slot[e.wire] = (int)boundary.size();
+                boundary.push_back(Boundary{ wires[e.wire] });
+                deadWires.push_back(e.wire);
+            }
+            (e.atEnd ? boundary[slot[e.wire]].pinE : boundary[slot[e.wire]].pinS) = instPin[g];
+        }
+    }
+    std::sort(deadWires.begin(), deadWires.end());
+
+    // 删除选区 + 放置实例 + 边界连线改接到实例引脚，一步撤销（定义留在库里）
+    GateSnapshot snap{ SUBCIRCUIT, origin, 1.0, def };
+    CommandTransaction tx(m_cmd);
+    if (m_cmd) {
+        m_cmd->Execute(std::make_unique<DeleteItemsCmd>(this, gateIds, deadWires));
+        m_cmd->Execute(std::make_unique<AddGateCmd>(this, snap));
+    }
+    else {
+        DeleteItems(gateIds, deadWires);
+        AddGateFromSnapshot(snap);
+    }
+
+    // 外侧那端保持不动，只重布靠近实例的尾部
+    const Component* inst = components.back().get();
+    const std::vector<wxPoint> pins = inst->GetPins();
+    const MetricsBox instBox = BoundaryBox(inst);
+    EnsureRouter();
+    for (Boundary& b : boundary) {
+        auto& poly = b.poly;
+        if (b.pinS >= (int)pins.size() || b.pinE >= (int)pins.size()) continue;
+        if (b.pinS >= 0 && b.pinE >= 0) {
+            poly = RouteOrManhattan(m_router, pins[b.pinS], pins[b.pinE]);
+        }
+        else if (b.pinE >= 0) {
+            poly = RerouteTail(m_router, poly, pins[b.pinE], instBox);
+        }
+        else {
+            std::vector<wxPoint> rev(poly.rbegin(), poly.rend());
+            rev = RerouteTail(m_router, rev, pins[b.pinS], instBox);
+            poly.assign(rev.rbegin(), rev.rend());
+        }
+        m_router.AddWire(poly);
+        if (m_cmd) m_cmd->Execute(std::make_unique<AddWireCmd>(this, WireSnapshot{ poly }));
+        else       AddWire(WireSnapshot{ poly });
+    }
+
+    ClearMultiSelection();
+    selectedWireIndex = -1;
+    selectedGateIndex = (int)components.size() - 1;
+    m_selKind = SelKind::Gate;
+    m_selId = selectedGateIndex;
+    Refresh(false);
+    NotifySelectionChanged();
+    return true;
+}
+
+void DrawBoard::CutSelection()
+{
+    // 复制与删除用同一份清单：内部连线也一起剪走，粘贴时不会多出一份
+    std::vector<int> gateIds, wireIds;
+    if (!CollectSelection(gateIds, wireIds)) return;
+    CopyItems(gateIds, wireIds);
+    {
+        CommandTransaction tx(m_cmd);
+        if (m_cmd) m_cmd->Execute(std::make_unique<DeleteItemsCmd>(this, gateIds, wireIds));
+        else       DeleteItems(gateIds, wireIds);
+    }
+    ClearMultiSelection();
+    selectedGateIndex = -1;
+    selectedWireIndex = -1;
+    m_selKind = SelKind::None;
+    m_selId = -1;
+    NotifySelectionChanged();
+}
+
+void DrawBoard::Paste()
+{
+    if (!m_clipboard) return;
+    ++m_pasteCount;
+    // 每次粘贴相对原位置再错开两格，连续粘贴不会叠在一起
+    const wxPoint offset = m_clipboard->origin + wxPoint(2 * GRID * m_pasteCount, 2 * GRID * m_pasteCount);
+    if (m_cmd) m_cmd->Execute(std::make_unique<PasteCmd>(this, m_clipboard, offset));
+    else       AppendClipboard(*m_clipboard, offset);
+}
+
+void DrawBoard::MoveGatesTo(const std::vector<int>& ids, const std::vector<wxPoint>& centers)
+{
+    EnsurePinWireIndex();
+
+    // 1) 元件就位；占用表逐个增量挪动（越界时稍后整体重建一次）
+    const int n = (int)components.size();
+    std::vector<char> moved(n, 0);
+    std::vector<wxPoint> shift(n);
+    std::vector<int> movedIds;
+    bool attachable = false;
+    for (size_t k = 0; k < ids.size() && k < centers.size(); ++k) {
+        const int id = ids[k];
+        if (id < 0 || id >= n || moved[id]) continue;
+        Component* c = components[id].get();
+        const wxPoint old = c->GetCenter();
+        if (centers[k] == old) continue;
+        const std::vector<wxPoint> prevPins = c->GetPins();
+        c->SetCenter(centers[k]);
+        RouterComponentMoved(id, prevPins);
+        moved[id] = 1;
+        shift[id] = centers[k] - old;
+        movedIds.push_back(id);
+        attachable = attachable || IsAttachableNode(c->m_type);
+    }
+    if (movedIds.empty()) return;
+    EnsureRouter();
+
+    // 2) 挂在被移动元件上的线：记下两端各挂在哪个元件的哪个引脚
+    struct Ends { int compS = -1, pinS = -1, compE = -1, pinE = -1; };
+    std::vector<int> slot(wires.size(), -1), touched;
+    std::vector<Ends> ends;
+    for (int id : movedIds) {
+        for (const WireEnd& e : m_compWires[id]) {
+            if (e.wire >= (int)wires.size()) continue;
+            if (slot[e.wire] < 0) { slot[e.wire] = (int)touched.size(); touched.push_back(e.wire); ends.emplace_back(); }
+            Ends& x = ends[slot[e.wire]];
+            if (e.atEnd) { x.compE = id; x.pinE = e.pin; }
+            else         { x.compS = id; x.pinS = e.pin; }
+        }
+    }
+    for (int w : touched) m_router.RemoveWire(wires[w]);
+
+    auto pinOf = [&](int comp, int pin, const wxPoint& fallback) {
+        const std::vector<wxPoint> pins = components[comp]->GetPins();
+        return pin < (int)pins.size() ? pins[pin] : fallback;
+        };
+    auto rigid = [&](const Ends& x) { return x.compS >= 0 && x.compE >= 0 && shift[x.compS] == shift[x.compE]; };
+
+    // 3) 两端随同一位移的线整条平移，先登记，其余线绕开它们只重布一次
+    for (size_t t = 0; t < touched.size(); ++t) {
+        if (!rigid(ends[t])) continue;
+        auto& poly = wires[touched[t]];
+        for (auto& p : poly) p += shift[ends[t].compS];
+        m_router.AddWire(poly);
+    }
+    for (size_t t = 0; t < touched.size(); ++t) {
+        const Ends& x = ends[t];
+        if (rigid(x)) continue;
+        auto& poly = wires[touched[t]];
+        if (x.compS >= 0 && x.compE >= 0) {
+            poly = RouteOrManhattan(m_router, pinOf(x.compS, x.pinS, poly.front()), pinOf(x.compE, x.pinE, poly.back()));
+        }
+        else if (x.compE >= 0) {
+            poly = RerouteTail(m_router, poly, pinOf(x.compE, x.pinE, poly.back()), BoundaryBox(components[x.compE].get()));
+        }
+        else {
+            std::vector<wxPoint> rev(poly.rbegin(), poly.rend());
+            rev = RerouteTail(m_router, rev, pinOf(x.compS, x.pinS, poly.front()), BoundaryBox(components[x.compS].get()));
+            poly.assign(rev.rbegin(), rev.rend());
+        }
+        m_router.AddWire(poly);
+    }
+
+    // 4) 指标增量更新；起始/终止节点的挂接关系可能变了
+    for (int id : movedIds) MetricsGateMoved(id);
+    if (!m_metricsDirty) {
+        for (int w : touched) m_metrics.SetWire(w, wires[w]);
+    }
+    if (attachable) m_pinWireDirty = true;
+    m_spatialDirty = true;
     Refresh(false);
 }
 
@@ -1072,6 +2295,7 @@ void DrawBoard::ZoomBy(double factor, const wxPoint& anchorDevicePt)
         seg.second.y = Z(seg.second.y, anchorDevicePt.y);
     }
 
+    InvalidateLayoutCaches();
     Refresh(false);
     Update();
 }
@@ -1090,6 +2314,140 @@ void DrawBoard::ZoomOutCenter()
     ZoomBy(1.0 / 1.1, anchor);   // 每次缩小 10%
 }
 
+// 把全部元件引脚与导线交给连通性提取器（引脚按元件、引脚下标顺序加入）
+void DrawBoard::BuildConnectivity(Connectivity& conn) const
+{
+    conn.Clear();
+    size_t verts = 0;
+    for (const auto& poly : wires) verts += poly.size();
+    conn.Reserve(components.size() * 4, verts);
+
+    for (int i = 0; i < (int)components.size(); ++i) {
+        if (!components[i]) continue;
+        const auto pins = components[i]->GetPins();
+        for (int p = 0; p < (int)pins.size(); ++p) conn.AddPin(PinRef{ i, p }, pins[p].x, pins[p].y);
+    }
+    for (const auto& poly : wires) conn.AddWire(poly);
+}
+
+void DrawBoard::BuildSimNetlist(const Connectivity& conn, SimNetlist& nl) const
+{
+    FillSimNetlist(components, conn, nl);
+}
+
+void DrawBoard::ComputeNetWidths(const Connectivity& conn, std::vector<int>& width, std::vector<char>& conflict) const
+{
+    SimNetlist nl;
+    BuildSimNetlist(conn, nl);
+    nl.ComputeWidths(width, conflict);
+}
+
+void DrawBoard::EnsureWireWidths() const
+{
+    if (!m_wireWidthDirty && m_wireWidth.size() == wires.size()) return;
+    m_wireWidthDirty = false;
+    m_wireWidth.assign(wires.size(), 1);
+    m_wireWidthConflict.assign(wires.size(), 0);
+
+    // 没有任何总线引脚时全是单线，不必提取连通性
+    const bool anyBus = std::any_of(components.begin(), components.end(), [](const std::unique_ptr<Component>& c) {
+        return c && logic::IsWordOp(c->m_type, c->width);
+    });
+    if (!anyBus) return;
+
+    Connectivity conn;
+    BuildConnectivity(conn);
+    conn.Extract();
+    std::vector<int> netWidth;
+    std::vector<char> netConflict;
+    ComputeNetWidths(conn, netWidth, netConflict);
+    for (int w = 0; w < conn.NumWires() && w < (int)wires.size(); ++w) {
+        const int n = conn.WireNet(w);
+        if (n < 0) continue;
+        m_wireWidth[w] = netWidth[n];
+        m_wireWidthConflict[w] = netConflict[n];
+    }
+}
+
+int DrawBoard::WireBusWidth(int wireIndex) const
+{
+    EnsureWireWidths();
+    return (wireIndex >= 0 && wireIndex < (int)m_wireWidth.size()) ? m_wireWidth[wireIndex] : 1;
+}
+
+bool DrawBoard::WireWidthConflict(int wireIndex) const
+{
+    EnsureWireWidths();
+    return wireIndex >= 0 && wireIndex < (int)m_wireWidthConflict.size() && m_wireWidthConflict[wireIndex] != 0;
+}
+
+// ======= 版图指标 =======
+void DrawBoard::InvalidateLayoutCaches()
+{
+    m_metricsDirty = true;
+    m_routerDirty = true;
+    m_pinWireDirty = true;
+    m_spatialDirty = true;
+    m_wireWidthDirty = true;
+    ScheduleMetricsLabel();
+}
+
+void DrawBoard::RebuildMetricsIfDirty()
+{
+    if (!m_metricsDirty) return;
+    Connectivity conn;
+    BuildConnectivity(conn);
+    conn.Extract();
+
+    std::vector<MetricsBox> cells(components.size());
+    for (size_t i = 0; i < components.size(); ++i) {
+        if (components[i]) cells[i] = MetricsBoxOf(components[i].get());
+    }
+    m_metrics.Build(conn, cells);
+    m_metrics.ResizeWires(wires.size());
+    for (int w = 0; w < (int)wires.size(); ++w) m_metrics.SetWire(w, wires[w]);
+    m_metricsDirty = false;
+}
+
+void DrawBoard::MetricsGateMoved(int compIdx)
+{
+    if (m_metricsDirty || compIdx < 0 || compIdx >= (int)components.size()) return;
+    Component* c = components[compIdx].get();
+    // 起始/终止节点会吸附到别的引脚上，连通关系可能变化，只能全量重建
+    if (IsAttachableNode(c->m_type)) { InvalidateLayoutCaches(); return; }
+    m_metrics.MoveCell(compIdx, MetricsBoxOf(c), c->GetPins());
+    ScheduleMetricsLabel();
+}
+
+void DrawBoard::NotifyGateGeometryChanged(long id)
+{
+    // 连线没有跟着动，引脚-导线关系与障碍都按全量重建
+    m_routerDirty = true;
+    m_pinWireDirty = true;
+    m_spatialDirty = true;
+    m_wireWidthDirty = true;
+    MetricsGateMoved((int)id);
+}
+
+LayoutMetrics::Summary DrawBoard::GetMetricsSummary()
+{
+    RebuildMetricsIfDirty();
+    return m_metrics.GetSummary();
+}
+
+void DrawBoard::ScheduleMetricsLabel()
+{
+    if (!st3 || m_metricsLabelPending) return;
+    m_metricsLabelPending = true;
+    CallAfter([this]() {
+        m_metricsLabelPending = false;
+        if (!st3) return;
+        const LayoutMetrics::Summary s = GetMetricsSummary();
+        st3->SetLabel(wxString::Format("HPWL: %.0f  线长: %.0f  网: %d  重叠: %lld  密度峰值: %.2f (溢出 %d)  拥塞峰值: %.2f",
+            s.hpwl, s.wireLength, s.nets, s.overlaps, s.peakDensity, s.overflowBins, s.peakCongestion));
+    });
+}
+
 // 把当前画布导出为 BookShelf .nodes + .nets
 bool DrawBoard::ExportAsBookShelf(const std::string& projectName,
     const std::filesystem::path& outDir)
@@ -1105,9 +2463,10 @@ bool DrawBoard::ExportAsBookShelf(const std::string& projectName,
 
     for (size_t i = 0; i < components.size(); ++i) {
         const auto& c = components[i];
-        const char* base = TypeToName(c->m_type);               // e.g. "AND"/"NODE"/"START_NODE"... :contentReference[oaicite:4]{index=4}
+        // 名字带上位宽/输入数（"AND8_IN4_3"），命令行仿真据此还原引脚数
+        const std::string base = logic::TypeSpecName({ c->m_type, c->width, c->inputs });
         int id = ++typeCount[c->m_type];
-        std::string name = MakeNodeName(base, id);
+        std::string name = MakeNodeName(base.c_str(), id);
 
         auto [w, h] = AABBwh(c->m_BoundaryPoints);               // 用边界盒宽高做尺寸 :contentReference[oaicite:5]{index=5}
         Node n;
@@ -1115,133 +2474,48 @@ bool DrawBoard::ExportAsBookShelf(const std::string& projectName,
         n.width = IsTerminal(c->m_type) ? 0.0 : std::max(1.0, w);
         n.height = IsTerminal(c->m_type) ? 0.0 : std::max(1.0, h);
         n.terminal = IsTerminal(c->m_type);
+        // .pl 记录左下角；导入时按 x + w/2, y + h/2 还原中心
+        const wxPoint cen = c->GetCenter();
+        n.x = cen.x - n.width / 2.0;
+        n.y = cen.y - n.height / 2.0;
+        n.fixed = n.terminal;
 
         nodes.push_back(n);
         comp2name[i] = name;
     }
 
-    // 2) 把所有元件的 pin 摊平做“坐标 -> (compIdx,pinIdx)”索引
-    struct PinKey { int x, y; };
-    struct PinInfo { int compIdx; int pinIdx; wxPoint pt; };
-    struct KeyHash { size_t operator()(const PinKey& k) const { return (size_t(k.x) << 32) ^ size_t(unsigned(k.y)); } };
-    struct KeyEq { bool operator()(const PinKey& a, const PinKey& b) const { return a.x == b.x && a.y == b.y; } };
-
-    std::unordered_map<PinKey, std::vector<PinInfo>, KeyHash, KeyEq> pinAt;
-
-    std::vector<std::vector<wxPoint>> allCompPins(components.size());
-    for (size_t ci = 0; ci < components.size(); ++ci) {
-        allCompPins[ci] = components[ci]->GetPins();            // 每个元件的所有引脚坐标（画布坐标）:contentReference[oaicite:6]{index=6}
-        for (int pi = 0; pi < (int)allCompPins[ci].size(); ++pi) {
-            wxPoint p = allCompPins[ci][pi];
-            PinKey k{ p.x, p.y };
-            pinAt[k].push_back(PinInfo{ (int)ci, pi, p });
-        }
-    }
-
-    // 3) 解析 wires 端点 -> 找到对应的 pin；把“连到一起的 pin”合并成一个网
-    //    我们把“pin”作为图节点；每条 wire 把两个端点 pin 连起来；用并查集合并连通分量。
-    struct PID { int compIdx; int pinIdx; };
-    auto pidLess = [](const PID& a, const PID& b) {
-        if (a.compIdx != b.compIdx) return a.compIdx < b.compIdx;
-        return a.pinIdx < b.pinIdx;
-        };
-
-    // 为所有命中的 pin 分配一个递增 id
-    std::map<PID, int, decltype(pidLess)> pid2id(pidLess);
-    std::vector<PID> id2pid;
-
-    auto getOrAddPid = [&](int ci, int pi)->int {
-        PID k{ ci, pi };
-        auto it = pid2id.find(k);
-        if (it != pid2id.end()) return it->second;
-        int id = (int)id2pid.size();
-        id2pid.push_back(k);
-        pid2id.emplace(k, id);
-        return id;
-        };
+    // 2) 几何连通性：与仿真共用同一个提取器（T 形连接、NODE_BASIC 扇出、引脚落在线中间都能识别）
+    Connectivity conn;
+    BuildConnectivity(conn);
+    conn.Extract();
 
-    // 并查集
-    std::vector<int> uf; // 按需增长
-    auto ufFind = [&](auto self, int x)->int {
-        if (uf[x] == x) return x;
-        uf[x] = self(self, uf[x]);
-        return uf[x];
-        };
-    auto ufUnion = [&](int a, int b) {
-        int ra = ufFind(ufFind, a), rb = ufFind(ufFind, b);
-        if (ra != rb) uf[rb] = ra;
-        };
-
-    auto ensureUf = [&](int needSize) {
-        int old = (int)uf.size();
-        if (needSize > old) {
-            uf.resize(needSize);
-            for (int i = old; i < needSize; ++i) uf[i] = i;
-        }
-        };
-
-    auto findPinByPoint = [&](const wxPoint& p)->std::vector<PinInfo> {
-        // 先尝试完全相等，再尝试 1px 容忍
-        PinKey k{ p.x, p.y };
-        auto it = pinAt.find(k);
-        if (it != pinAt.end()) return it->second;
-        // 容忍 1px（匹配你移动重布线时的容忍逻辑）:contentReference[oaicite:7]{index=7}
-        for (int dx = -1; dx <= 1; ++dx)
-            for (int dy = -1; dy <= 1; ++dy) {
-                if (dx == 0 && dy == 0) continue;
-                PinKey k2{ p.x + dx, p.y + dy };
-                auto it2 = pinAt.find(k2);
-                if (it2 != pinAt.end()) return it2->second;
-            }
-        return {};
-        };
-
-    for (const auto& poly : wires) {
-        if (poly.size() < 2) continue;
-        wxPoint a = poly.front();
-        wxPoint b = poly.back();
-
-        auto pinsA = findPinByPoint(a);
-        auto pinsB = findPinByPoint(b);
-        if (pinsA.empty() || pinsB.empty()) continue; // 端点没吸到 pin 就忽略该线段
-
-        // 允许端点上多 pin（少见），做笛卡尔连接
-        for (const auto& pa : pinsA) {
-            for (const auto& pb : pinsB) {
-                int idA = getOrAddPid(pa.compIdx, pa.pinIdx);
-                int idB = getOrAddPid(pb.compIdx, pb.pinIdx);
-                ensureUf(std::max(idA, idB) + 1);
-                ufUnion(idA, idB);
-            }
-        }
-    }
-
-    // 4) 把每个连通分量变成一个 Net，填入 pins（计算相对偏移）
-    std::unordered_map<int, std::vector<int>> compSets; // rootId -> [pidId...]
-    for (int id = 0; id < (int)id2pid.size(); ++id) {
-        int root = ufFind(ufFind, id);
-        compSets[root].push_back(id);
-    }
+    // 总线整根是一个网，名字带上位宽（net_<k>_w<N>）
+    std::vector<int> netWidth;
+    std::vector<char> netConflict;
+    ComputeNetWidths(conn, netWidth, netConflict);
 
+    // 3) 每个至少两个引脚的网导出为一个 Net（计算相对中心的偏移）
     std::vector<Net> nets;
-    int autoNetIdx = 0;
+    nets.reserve(conn.NumNets());
+    std::vector<std::vector<wxPoint>> allCompPins(components.size());
+    for (size_t ci = 0; ci < components.size(); ++ci) allCompPins[ci] = components[ci]->GetPins();
 
-    for (auto& kv : compSets) {
-        const auto& pidList = kv.second;
-        if (pidList.size() < 2) continue; // 单引脚不构成网
+    for (int n = 0; n < conn.NumNets(); ++n) {
+        auto [first, last] = conn.NetPins(n);
+        if (last - first < 2) continue; // 单引脚不构成网
 
         Net net;
-        net.name = "net_" + std::to_string(autoNetIdx++);
-
-        for (int pid : pidList) {
-            const auto [ci, pi] = id2pid[pid];
-            const auto& comp = components[ci];
-            const wxPoint ccen = comp->GetCenter();
-            const wxPoint ppt = allCompPins[ci][pi];
+        net.name = "net_" + std::to_string(nets.size());
+        if (netWidth[n] > 1) net.name += "_w" + std::to_string(netWidth[n]);
+        net.pins.reserve(size_t(last - first));
+        for (const int* it = first; it != last; ++it) {
+            const PinRef& ref = conn.Pin(*it);
+            const wxPoint ccen = components[ref.compIdx]->GetCenter();
+            const wxPoint ppt = allCompPins[ref.compIdx][ref.pinIdx];
 
             Pin p;
-            p.cellName = comp2name[ci];
-            p.pinName = PinNameByIndex(pi);
+            p.cellName = comp2name[ref.compIdx];
+            p.pinName = PinNameByIndex(ref.pinIdx);
             p.dx = double(ppt.x - ccen.x);
             p.dy = double(ppt.y - ccen.y);
             net.pins.push_back(std::move(p));
@@ -1249,7 +2523,7 @@ bool DrawBoard::ExportAsBookShelf(const std::string& projectName,
         nets.push_back(std::move(net));
     }
 
-    // 5) 调用通用导出器
+    // 4) 调用通用导出器
     ExportOptions opt;
     opt.outDir = outDir;
     opt.floatPrecision = 6;
@@ -1299,13 +2573,56 @@ bool DrawBoard::ImportBookShelf(const std::filesystem::path& nodesPath,
 {
     BSDesign d = ParseBookShelf(nodesPath, netsPath);
 
+    // 同目录同名的 .pl 存在就一并读入坐标
+    std::filesystem::path plPath = nodesPath;
+    plPath.replace_extension(".pl");
+    if (std::filesystem::exists(plPath)) bookshelf::ParsePlacement(plPath, d);
+
+    return ApplyBookShelfDesign(d);
+}
+
+bool DrawBoard::ImportBookShelfAux(const std::filesystem::path& auxPath)
+{
+    BSDesign d = bookshelf::ParseBookShelfAux(auxPath);
+    return ApplyBookShelfDesign(d);
+}
+
+bool DrawBoard::ApplyBookShelfDesign(const BSDesign& d)
+{
     // 1) 清空当前画布
     wires.clear(); lines.clear(); texts.clear(); components.clear();
+    selectedGateIndex = selectedWireIndex = -1;
+    ClearMultiSelection();
 
     // 2) 生成组件：类型来自名称前缀（AND/NOR/DECODER24/NODE/START_NODE/...）
     const int N = (int)d.nodes.size();
-    auto centers = AutoGridPlace(N, GetClientSize()); // 简单自动排布
-    std::unordered_map<std::string, int> name2idx;
+    // 有 .pl 时用真实坐标（左下角 → 中心）；只有缺坐标的节点才走栅格兜底，排在已布局区域下方
+    std::vector<wxPoint> centers(N);
+    std::vector<int> unplaced;
+    int placedBottom = 0;
+    for (int i = 0; i < N; ++i) {
+        const auto& n = d.nodes[i];
+        if (!n.placed) { unplaced.push_back(i); continue; }
+        centers[i] = wxPoint((int)std::lround(n.x + n.width / 2.0), (int)std::lround(n.y + n.height / 2.0));
+        placedBottom = std::max(placedBottom, (int)std::lround(n.y + n.height));
+    }
+    if (!unplaced.empty()) {
+        auto grid = AutoGridPlace((int)unplaced.size(), GetClientSize()); // 简单自动排布
+        const int yOff = d.placedNodes > 0 ? placedBottom + GRID * 3 : 0;
+        for (size_t k = 0; k < unplaced.size(); ++k) centers[unplaced[k]] = grid[k] + wxPoint(0, yOff);
+    }
+
+    // 完全没有 .pl：以栅格排布为初值跑二次布局，按连接关系把相连的单元放到一起
+    m_lastPlaceStats.reset();
+    if (d.placedNodes == 0 && N >= 2 && !d.nets.empty()) {
+        std::vector<double> cx(N), cy(N);
+        for (int i = 0; i < N; ++i) { cx[i] = centers[i].x; cy[i] = centers[i].y; }
+        bookshelf::PlaceOptions opt;
+        opt.grid = GRID;
+        m_lastPlaceStats = bookshelf::PlaceDesign(d, cx, cy, opt);
+        for (int i = 0; i < N; ++i) centers[i] = wxPoint((int)std::lround(cx[i]), (int)std::lround(cy[i]));
+    }
+    std::vector<int> node2comp(N, -1);                // nodes 下标 → components 下标
 
     for (int i = 0; i < N; ++i) {
         const auto& n = d.nodes[i];
@@ -1316,43 +2633,77 @@ bool DrawBoard::ImportBookShelf(const std::filesystem::path& nodesPath,
         auto up = MakeComponent(t, centers[i]); // 直接创建你的组件实例。:contentReference[oaicite:5]{index=5}
         if (!up) continue;
         up->UpdateGeometry();
-        name2idx[n.name] = (int)components.size();
+        node2comp[i] = (int)components.size();
         components.push_back(std::move(up));
     }
 
-    // 3) 按 .nets 画线
-    // 规则：找 O（输出）做源；若没有 O，取第一个 pin 作源；其余视作汇，分别连一条曼哈顿折线
-    for (const auto& net : d.nets) {
-        if (net.pins.size() < 2) continue;
+    // 引脚名已驻留成小表：每个名字只判断一次是否为输出
+    // 以 pinName 中的 'O' 作为驱动判断（常见写法）；否则留到后面兜底。:contentReference[oaicite:6]{index=6}
+    std::vector<char> isOutput(d.pinNames.size(), 0);
+    for (size_t k = 0; k < d.pinNames.size(); ++k) {
+        const auto& nm = d.pinNames[k];
+        isOutput[k] = !nm.empty() && (nm[0] == 'O' || nm[0] == 'o');
+    }
+
+    auto getAbs = [&](const BSPin& p)->wxPoint {
+        if (p.nodeId == kNoNode || node2comp[p.nodeId] < 0) return wxPoint(0, 0);
+        wxPoint c = components[node2comp[p.nodeId]]->GetCenter();
+        return wxPoint((int)std::lround(c.x + p.dx), (int)std::lround(c.y + p.dy));
+        };
 
-        auto getAbs = [&](const std::string& cell, double dx, double dy)->wxPoint {
-            auto it = name2idx.find(cell);
-            if (it == name2idx.end()) return wxPoint(0, 0);
-            int idx = it->second;
-            wxPoint c = components[idx]->GetCenter();
-            return wxPoint((int)std::lround(c.x + dx), (int)std::lround(c.y + dy));
-            };
+    // 3) 按 .nets 布线
+    // 规则：找 O（输出）做源；若没有 O，取第一个 pin 作源；整网用避障布线器连成一棵树，
+    //       布不通的汇退回到源的曼哈顿折线
+    GridRouter router;
+    PrepareRouter(router);
+    std::vector<RoutePoint> treePins;
+    std::vector<wxPoint> absPins;
+    std::vector<std::vector<RoutePoint>> branches;
+    for (const auto& net : d.nets) {
+        if (net.numPins < 2) continue;
+        const BSPin* pins = d.PinsBegin(net);
+        const int np = (int)net.numPins;
 
         // 找驱动端
-        int src = -1;
-        for (int i = 0; i < (int)net.pins.size(); ++i) {
-            const auto& p = net.pins[i];
-            // 以 pinName 中的 'O' 作为驱动判断（常见写法）；否则留到后面兜底。:contentReference[oaicite:6]{index=6}
-            if (!p.pinName.empty() && (p.pinName[0] == 'O' || p.pinName[0] == 'o')) { src = i; break; }
+        int src = 0;
+        for (int i = 0; i < np; ++i) {
+            if (isOutput[pins[i].pinNameId]) { src = i; break; }
         }
-        if (src < 0) src = 0;
 
-        wxPoint s = getAbs(net.pins[src].cellName, net.pins[src].dx, net.pins[src].dy);
-        for (int i = 0; i < (int)net.pins.size(); ++i) {
+        // 源放在首位；重合的引脚只保留一个
+        absPins.clear();
+        absPins.push_back(getAbs(pins[src]));
+        for (int i = 0; i < np; ++i) {
             if (i == src) continue;
-            wxPoint t = getAbs(net.pins[i].cellName, net.pins[i].dx, net.pins[i].dy);
-            auto poly = MakeManhattan(s, t);          // 你的 L 型走线工具。:contentReference[oaicite:7]{index=7}
-            if (poly.size() >= 2 && !(poly.front() == poly.back())) {
-                AddWire({ poly });                    // 用画布的“添加线”API。:contentReference[oaicite:8]{index=8}
+            const wxPoint t = getAbs(pins[i]);
+            if (std::find(absPins.begin(), absPins.end(), t) == absPins.end()) absPins.push_back(t);
+        }
+        if (absPins.size() < 2) continue;
+
+        treePins.clear();
+        for (const auto& p : absPins) treePins.push_back(ToRoutePoint(p));
+        const int reached = router.RouteTree(treePins, branches);
+        for (const auto& br : branches) {
+            router.AddWire(br);
+            AddWire({ ToWxPoly(br) });
+        }
+        if (reached < (int)treePins.size()) {
+            // 找出没连上的引脚（不是任何分支的端点）
+            for (size_t k = 1; k < absPins.size(); ++k) {
+                const RoutePoint& p = treePins[k];
+                bool hit = false;
+                for (const auto& br : branches) {
+                    if ((br.front().x == p.x && br.front().y == p.y) || (br.back().x == p.x && br.back().y == p.y)) { hit = true; break; }
+                }
+                if (hit) continue;
+                auto poly = MakeManhattan(absPins[0], absPins[k]);
+                router.AddWire(poly);
+                AddWire({ poly });
             }
         }
     }
 
+    InvalidateLayoutCaches();
     Refresh(false);
     return true;
 }
@@ -1366,13 +2717,17 @@ void DrawBoard::SimStart() {
     // ★ 第一次运行时，先 Settle 一次，计算初始状态
     m_sim->Step();
 
-    // 20ms 一步（50Hz），可按需调整
-    m_simTimer->Start(20);
+    // 推进交给仿真线程；界面只按显示刷新节拍取快照重画
+    m_reportedOsc = 0;
+    ReportOscillation();
+    m_sim->StartWorker(m_simRate);
+    m_simTimer->Start(FrameIntervalMs());
     Refresh(false);
 }
 
 void DrawBoard::SimStop() {
     if (!m_sim) return;
+    m_sim->StopWorker();
     m_sim->Stop();
     m_simulating = false;
     m_simTimer->Stop();
@@ -1386,16 +2741,61 @@ void DrawBoard::SimStep() {
     // (如果 m_simulating 为 true, 假设网表仍然有效)
     if (!m_simulating) {
         m_sim->BuildNetlist();
+        m_reportedOsc = 0;
     }
-    m_sim->Step(); // 执行一次 Settle
+    m_sim->Tick(); // 半个时钟周期（没有时钟源时只 Settle）
+    ReportOscillation();
     Refresh(false); // 单步也刷新
 }
 
+long long DrawBoard::SimRunCycles(long long n) {
+    if (!m_sim) return 0;
+    if (!m_simulating) SimStart();
+    const long long done = m_sim->RunCycles(n);
+    ReportOscillation();
+    Refresh(false);
+    return done;
+}
+
 void DrawBoard::OnTimer(wxTimerEvent& e) {
+    if (m_dragTimer && &e.GetTimer() == m_dragTimer) {
+        ApplyDragStep();
+        return;
+    }
+    if (m_profTimer && &e.GetTimer() == m_profTimer) {
+        RefreshRect(ProfilerOverlayRect(), false);
+        return;
+    }
     if (m_sim && m_simulating) {
-        m_sim->Step(); // ★ 定时器现在调用 Settle
-        Refresh(false); // 关键：推进后立刻刷新，连线与节点变色
+        // 只在仿真线程发布了新快照时重画；仿真慢于显示时不空画
+        if (m_sim->PullSnapshot()) {
+            ReportOscillation();
+            Refresh(false);
+        }
+    }
+}
+
+void DrawBoard::ReportOscillation() {
+    if (!m_sim || m_sim->OscillationEvents() == m_reportedOsc) return;
+    m_reportedOsc = m_sim->OscillationEvents();
+    const auto& loops = m_sim->OscillatingLoops();
+    if (loops.empty()) return;   // 报告前已恢复收敛
+
+    // 列出第一个环的元件（类型#下标），其余只报个数
+    wxString parts;
+    const auto& first = loops.front();
+    for (size_t k = 0; k < first.size() && k < 8; ++k) {
+        const int ci = first[k];
+        if (ci < 0 || ci >= (int)components.size()) continue;
+        parts += wxString::Format(" %s#%d", logic::TypeName(components[ci]->m_type), ci);
     }
+    if (first.size() > 8) parts += wxString::Format(" 等 %zu 个元件", first.size());
+    wxLogStatus("组合逻辑不收敛：%zu 个环振荡，已标为 X 并在后续节拍跳过（环 1:%s）", loops.size(), parts);
+}
+
+void DrawBoard::SetSimRate(double ticksPerSec) {
+    m_simRate = std::max(0.0, ticksPerSec);
+    if (m_sim) m_sim->SetTargetRate(m_simRate);
 }
 
 bool DrawBoard::IsWireHighForPaint(int wireIndex) const {
@@ -1403,6 +2803,78 @@ bool DrawBoard::IsWireHighForPaint(int wireIndex) const {
     return (m_sim && m_simulating) ? m_sim->IsWireHigh(wireIndex) : false;
 }
 
+// ========================
+//  性能浮层
+// ========================
+void DrawBoard::SetProfilerOverlay(bool on)
+{
+    if (on == m_showProfiler) return;
+    m_showProfiler = on;
+    auto& p = prof::Profiler::Get();
+    if (on) p.Clear();
+    p.SetEnabled(on);
+    if (on) m_profTimer->Start(500);
+    else    m_profTimer->Stop();
+    RefreshRect(ProfilerOverlayRect(), false);
+}
+
+wxRect DrawBoard::ProfilerOverlayRect() const
+{
+    const int w = 300, h = 222;
+    return wxRect(std::max(0, GetClientSize().GetWidth() - w - 10), 10, w, h);
+}
+
+void DrawBoard::DrawProfilerOverlay(wxGraphicsContext* gc)
+{
+    const prof::Summary s = prof::Profiler::Get().Summarize();
+    const wxRect r = ProfilerOverlayRect();
+
+    gc->SetPen(*wxTRANSPARENT_PEN);
+    gc->SetBrush(wxBrush(wxColour(20, 20, 20, 200)));
+    gc->DrawRoundedRectangle(r.x, r.y, r.width, r.height, 4);
+
+    gc->SetFont(wxFontInfo(9).Family(wxFONTFAMILY_TELETYPE), wxColour(230, 230, 230));
+    const auto& last = s.last;
+    const wxString lines[] = {
+        wxString::Format("FPS %.0f    帧 %d", s.fps, s.frames),
+        wxString::Format("绘制  %.2f ms  均 %.2f  p95 %.2f  峰 %.2f",
+            last.ms[prof::ZonePaint], s.avgMs[prof::ZonePaint], s.p95Ms[prof::ZonePaint], s.maxMs[prof::ZonePaint]),
+        wxString::Format("仿真  %.3f ms/节拍  本帧 %lld 节拍", s.simMsPerTick, last.counters[prof::CounterSimTicks]),
+        wxString::Format("稳定迭代 %.1f/节拍  网值改变 %.0f/节拍", s.settlePerTick, s.changedPerTick),
+        wxString::Format("构网  %.2f ms  峰 %.2f", last.ms[prof::ZoneBuildNetlist], s.maxMs[prof::ZoneBuildNetlist]),
+        wxString::Format("命中测试 %.3f ms/帧 (%d 次)  p95 %.3f",
+            s.avgMs[prof::ZoneHitTest], last.calls[prof::ZoneHitTest], s.p95Ms[prof::ZoneHitTest]),
+        wxString::Format("分配  %lld 本帧  均 %.0f/帧", last.allocs, s.allocsPerFrame),
+    };
+    double y = r.y + 6;
+    for (const auto& ln : lines) {
+        gc->DrawText(ln, r.x + 8, y);
+        y += 15;
+    }
+
+    // 绘制耗时直方图（最近 kHistory 帧），红线为 16.7 ms（60 Hz）所在桶的上界
+    const auto& h = s.hist[prof::ZonePaint];
+    const double bx = r.x + 8, by = r.GetBottom() - 18, bh = 54;
+    const double bw = (r.width - 16) / double(prof::Histogram::kBins);
+    int peak = 1;
+    for (int c : h.bins) peak = std::max(peak, c);
+    gc->SetBrush(wxBrush(wxColour(90, 170, 250)));
+    for (int k = 0; k < prof::Histogram::kBins; ++k) {
+        const double bar = bh * h.bins[k] / peak;
+        if (bar > 0) gc->DrawRectangle(bx + k * bw + 1, by - bar, bw - 2, bar);
+    }
+    const int k60 = prof::Histogram::BinOf(1000.0 / 60);
+    gc->SetPen(wxPen(wxColour(240, 80, 80), 1));
+    gc->StrokeLine(bx + (k60 + 1) * bw, by - bh, bx + (k60 + 1) * bw, by);
+
+    gc->SetFont(wxFontInfo(7).Family(wxFONTFAMILY_TELETYPE), wxColour(180, 180, 180));
+    for (int k = 0; k < prof::Histogram::kBins; k += 2) {
+        const double up = prof::Histogram::BinUpper(k);
+        gc->DrawText(up < 1 ? wxString::Format("%.2g", up) : wxString::Format("%.0f", up), bx + k * bw, by + 2);
+    }
+    gc->DrawText("ms", r.GetRight() - 18, by + 2);
+}
+
 // ========== 点击起始节点切换电平 ==========
 void DrawBoard::ToggleStartNodeAt(const wxPoint& pos)
 {
@@ -1419,8 +2891,8 @@ void DrawBoard::ToggleStartNodeAt(const wxPoint& pos)
     bool oldVal = m_sim->GetStartNodeValue(hit);
     m_sim->SetStartNodeValue(hit, !oldVal);
 
-    // ★ 切换后立即 Settle 一次，而不是等待定时器
-    m_sim->Step();
+    // ★ 仿真线程在下一拍之前应用新电平，快照随显示节拍取回；线程没在跑时立即 Settle 一次
+    if (!m_sim->WorkerRunning()) m_sim->Step();
     Refresh(false);
 }
 
@@ -1443,7 +2915,7 @@ void DrawBoard::DrawNodeStates(wxGraphicsContext* gc)
         const bool isEnd = (c->m_type == ComponentType::NODE_END);
         if (!isStart && !isEnd) continue; // 只给起始/终止节点着色
 
-        bool level = false;
+        bool level = false, unknown = false;
         if (isStart) {
             level = m_sim->GetStartNodeValue(i);
         }
@@ -1454,7 +2926,8 @@ void DrawBoard::DrawNodeStates(wxGraphicsContext* gc)
             for (const auto& net : m_sim->m_nets) {
                 for (const auto& ld : net.loads) {
                     if (ld.compIdx == i) {
-                        v = v || net.value; // 多个输入到终止节点, 取 OR
+                        v = v || net.value != 0; // 多个输入到终止节点, 取 OR（总线：非零即高）
+                        unknown = unknown || net.unknown;
                     }
                 }
             }
@@ -1471,7 +2944,8 @@ void DrawBoard::DrawNodeStates(wxGraphicsContext* gc)
         }
 
 
-        wxColour col = level ? wxColour(255, 0, 0) : wxColour(80, 120, 220); // 红=1，蓝=0
+        wxColour col = unknown ? wxColour(200, 0, 200)                        // 洋红=X
+            : level ? wxColour(255, 0, 0) : wxColour(80, 120, 220);           // 红=1，蓝=0
         gc->SetPen(*wxTRANSPARENT_PEN);
         gc->SetBrush(wxBrush(col));
         // ★ 在引脚处绘制小圆点
@@ -6,13 +6,22 @@
 #include <memory>
 #include <array>
 #include <optional>
+#include <algorithm>
 #include <json/json.h>
 #include "AppConfig.h"
 #include "Component.h"
 #include "SelectionEvents.h"
 #include "UndoRedo.h"
+#include "Connectivity.h"
 #include <filesystem>
 #include "BookShelfExporter.h"
+#include "BookShelfImporter.h"
+#include "Placer.h"
+#include "Metrics.h"
+#include "Router.h"
+#include "SpatialIndex.h"
+#include "Subcircuit.h"
+#include "SimNetlist.h"
 
 // 统一选择类型（供属性面板查询）
 enum class SelKind { None = 0, Gate = 1, Wire = 2 };
@@ -22,12 +31,30 @@ struct GateSnapshot {
     ComponentType type;
     wxPoint center;
     double scale{ 1.0 };
+    std::shared_ptr<const SubcircuitDef> def;   // 仅 SUBCIRCUIT：共享的定义
+    int width{ 1 };                             // 位宽（寄存器 / 分线器 / 合线器 / 运算块 / 总线门）
+    int inputs{ 2 };                            // 输入数（多输入门 / 数据选择器路数）
 };
 
 struct WireSnapshot {
     std::vector<wxPoint> poly;
 };
 
+// 批量删除的快照：带原下标，撤销时按原位置插回
+struct ItemsSnapshot {
+    std::vector<std::pair<long, GateSnapshot>> gates;   // 下标升序
+    std::vector<std::pair<long, WireSnapshot>> wires;   // 下标升序
+};
+
+// 剪贴板：选中元件 + 内部连线，坐标相对 origin；多次粘贴的命令共享同一份数据
+struct ClipboardData {
+    wxPoint origin;                      // 复制时的左上角（按 GRID 对齐）
+    std::vector<GateSnapshot> gates;     // center 为相对坐标
+    std::vector<int> wireStart;          // 第 w 条线的点为 points[wireStart[w], wireStart[w+1])
+    std::vector<wxPoint> points;         // 所有连线的点，首尾相接存放
+    size_t WireCount() const { return wireStart.empty() ? 0 : wireStart.size() - 1; }
+};
+
 class Simulator; // 前向声明
 
 class DrawBoard : public wxPanel
@@ -76,6 +103,7 @@ public:
 
     wxStaticText* st1 = nullptr;
     wxStaticText* st2 = nullptr;
+    wxStaticText* st3 = nullptr;     // 版图指标（HPWL / 线长 / 重叠 / 密度 / 拥塞）
 
     // 指向 cMain 的“当前选中元件类型名称”（例如 "AND", "OR", "NOT"...）
     wxString* pSelectedGateName = nullptr;
@@ -89,8 +117,25 @@ public:
     void SelectGateByIndex(int idx);
     void SelectWireByIndex(int idx);
 
+    // === 多选（框选 / Shift 点选）===
+    const std::vector<int>& GetSelectedGates() const { return m_selGates; }
+    const std::vector<int>& GetSelectedWires() const { return m_selWires; }
+    void SelectInRect(const wxRect& r, bool additive);   // 完全落在框内的元件与连线
+
+    // === 复制 / 剪切 / 粘贴 ===
+    bool CopySelection();        // 选中元件 + 两端都挂在其上的连线 + 选中的连线
+    void CutSelection();         // 复制后删除，一步撤销
+    void Paste();                // 相对原位置依次错开，一条批量命令
+    bool CanPaste() const { return m_clipboard != nullptr; }
+
+    // === 子电路库：定义只存一份，实例共享 ===
+    const std::vector<std::shared_ptr<const SubcircuitDef>>& GetSubcircuits() const { return m_subcircuits; }
+    std::shared_ptr<const SubcircuitDef> FindSubcircuit(const std::string& name) const;
+    // 选中元件 + 内部连线收成一个定义，原地换成一个实例（一步撤销）；失败时 why 给出原因
+    bool CreateSubcircuitFromSelection(const wxString& name, wxString* why = nullptr);
+
     // ===== 对外功能（保持你的接口）=====
-    void AddGate(const wxPoint& center, const wxString& typeName);
+    void AddGate(const wxPoint& center, const wxString& typeName);   // 子电路为 "SUBCKT:<定义名>"
     void SelectGate(const wxPoint& pos);
     void DeleteSelectedGate();
     void DeleteSelectedWire();
@@ -103,7 +148,10 @@ public:
     bool ExportAsBookShelf(const std::string& projectName,
         const std::filesystem::path& outDir);
     bool ImportBookShelf(const std::filesystem::path& nodesPath,
-        const std::filesystem::path& netsPath);
+        const std::filesystem::path& netsPath);            // 同名 .pl 存在时使用其坐标
+    bool ImportBookShelfAux(const std::filesystem::path& auxPath); // 按 .aux 读入 nodes/nets/pl/scl
+    // 最近一次导入若跑了自动布局（没有 .pl 时），这里给出 HPWL 前后对比
+    const std::optional<bookshelf::PlaceStats>& GetLastPlaceStats() const { return m_lastPlaceStats; }
 
     // JSON
     void SaveToJson(const std::string& filename);
@@ -120,18 +168,32 @@ public:
     static const char* TypeToName(ComponentType t);
 
     // ===== 与命令管理器对接 =====
-    void SetCommandManager(CommandManager* m) { m_cmd = m; }
+    void SetCommandManager(CommandManager* m);
+    CommandManager* GetCommandManager() const { return m_cmd; }
+
+    // 批量改动期间暂停重绘，最外层结束时整体重绘一次（命令事务 / 撤销组合命令时使用）
+    void BeginBatchUpdate();
+    void EndBatchUpdate();
 
     // —— 命令层需要的最小 API（被 ICommand 调用）——
     long AddGateFromSnapshot(const GateSnapshot& s);                    // 返回 gate 索引
     std::optional<GateSnapshot> ExportGateByIndex(long id) const;       // 导出 gate 快照
     void DeleteGateByIndex(long id);                                     // 删除 gate
     void MoveGateTo(long id, const wxPoint& pos);                        // 移动 gate
+    void SetGateParams(long id, int width, int inputs);                  // 改位宽/输入数（引脚数可能变化，连线跟随）
 
     long AddWire(const WireSnapshot& w);                                 // 返回 wire 索引
     std::optional<WireSnapshot> ExportWireByIndex(long id) const;        // 导出 wire 快照
     void DeleteWireByIndex(long id);                                      // 删除 wire
 
+    // —— 批量 API：一次压缩 / 一次重布 / 一次重绘 ——
+    ItemsSnapshot ExportItems(const std::vector<int>& gateIds, const std::vector<int>& wireIds) const;
+    void DeleteItems(const std::vector<int>& gateIds, const std::vector<int>& wireIds);
+    void InsertItems(const ItemsSnapshot& s);                                             // 按原下标插回
+    void MoveGatesTo(const std::vector<int>& ids, const std::vector<wxPoint>& centers);  // 中心取绝对坐标
+    void AppendClipboard(const ClipboardData& d, const wxPoint& offset);  // 批量追加到末尾并选中
+    void TruncateItems(size_t gateCount, size_t wireCount);              // 截掉末尾追加的对象（撤销粘贴）
+
     void ZoomInCenter();                                        // 以视窗中心放大
     void ZoomOutCenter();                                       // 以视窗中心缩小
     void ZoomBy(double factor, const wxPoint& anchorDevicePt);  // 以给定屏幕点为锚
@@ -140,16 +202,40 @@ public:
     void SimStart();
     void SimStop();
     void SimStep();
+    long long SimRunCycles(long long n);         // 不逐帧刷新地连跑 n 个时钟周期，结束后刷新一次
     bool IsSimulating() const { return m_simulating; }
+    // 连续仿真的目标节拍率（节拍/秒，0 为尽快跑）；仿真中修改立即生效
+    void SetSimRate(double ticksPerSec);
+    double GetSimRate() const { return m_simRate; }
     void ToggleStartNodeAt(const wxPoint& pos);  // 点击切换起始节点电平
     void DrawNodeStates(wxGraphicsContext* gc);  // 绘制节点状态
 
     //节点吸附
     bool FindNearestGatePin(const wxPoint& pos, wxPoint& snappedPos, int tolerance = 10) const;
 
+    // 把引脚与导线交给连通性提取器（导出与仿真共用）
+    void BuildConnectivity(Connectivity& conn) const;
+    // 画布 → 不依赖 wx 的仿真网表（单元下标即元件下标；conn 须已 Extract）
+    // 端口名：起始节点 I0..、终止节点 O0..，各按 (y, x) 排序，与子电路端口顺序一致
+    void BuildSimNetlist(const Connectivity& conn, SimNetlist& nl) const;
+    // 各网位宽 = 所接引脚的最大位宽；引脚位宽不一致的网 conflict 置 1（conn 须已 Extract）
+    void ComputeNetWidths(const Connectivity& conn, std::vector<int>& width, std::vector<char>& conflict) const;
+    // 连线位宽（> 1 为总线，按所连引脚推出）与位宽冲突标记；绘制与属性面板使用
+    int  WireBusWidth(int wireIndex) const;
+    bool WireWidthConflict(int wireIndex) const;
+
+    // 版图指标：必要时全量重建后返回汇总
+    LayoutMetrics::Summary GetMetricsSummary();
+    // 外部直接改了元件几何（如属性面板改坐标）后通知，增量更新指标
+    void NotifyGateGeometryChanged(long id);
+
     // 供渲染时查询某条 wire 是否高电平
     bool IsWireHighForPaint(int wireIndex) const;
 
+    // 性能浮层：帧率、绘制/构网/仿真/命中测试耗时、稳定迭代、网值改变与分配次数；打开期间记录剖析数据
+    void SetProfilerOverlay(bool on);
+    bool IsProfilerOverlayShown() const { return m_showProfiler; }
+
     Simulator* m_sim = nullptr;
 
 private:
@@ -157,6 +243,8 @@ private:
     void OnButtonMove(wxMouseEvent& event);
     void OnLeftDown(wxMouseEvent& event);
     void OnLeftUp(wxMouseEvent& event);
+    void OnKeyDown(wxKeyEvent& event);   // 方向键微调选中元件（Shift 一次一整格）
+    void OnKeyUp(wxKeyEvent& event);     // 松开方向键：这一串微调到此为止，不与之后的操作合并
     void drawGrid(wxGraphicsContext* gc);
 
     // 计算锚点（由门对象的 m_BoundaryPoints 给出）
@@ -164,7 +252,23 @@ private:
     // 该元件移动前的引脚坐标
     std::vector<wxPoint> preMovePins;
 
-    static std::unique_ptr<Component> MakeComponent(ComponentType t, const wxPoint& center);
+    // ===== 拖动节流：鼠标事件按显示刷新节拍合并，只重绘受影响区域 =====
+    wxTimer* m_dragTimer = nullptr;
+    bool m_dragPending = false;                       // 有尚未应用的鼠标位置
+    int  m_dragFrameMs = 16;                          // 一帧的毫秒数（按显示器刷新率）
+    long long m_lastDragApplyMs = 0;
+    wxPoint m_paintedCrosshair;                       // 上次绘制十字线的位置（局部重绘时要擦掉）
+    void ApplyDragStep();                             // 按当前 mousePos 移动被拖元件（或整组）
+    int  FrameIntervalMs() const;
+
+    static std::unique_ptr<Component> MakeComponent(ComponentType t, const wxPoint& center,
+        std::shared_ptr<const SubcircuitDef> def = nullptr);   // SUBCIRCUIT 必须给出定义
+    // 按快照（类型/定义/缩放/位宽）在 center 处重建元件
+    static std::unique_ptr<Component> MakeFromSnapshot(const GateSnapshot& s, const wxPoint& center);
+
+    // 用解析好的 BookShelf 设计替换画布内容
+    bool ApplyBookShelfDesign(const bookshelf::BSDesign& d);
+    std::optional<bookshelf::PlaceStats> m_lastPlaceStats;
 
     // 选中锚点样式
     static const wxColour HANDLE_FILL_RGB;
@@ -178,13 +282,78 @@ private:
     // 生成 L 形曼哈顿路径（start→end）
     std::vector<wxPoint> MakeManhattan(const wxPoint& a, const wxPoint& b) const;
 
+    // 避障布线：元件包围盒为障碍、引脚为禁行格、已有导线计入占用（skipWire[i] 非 0 的线不计）
+    void PrepareRouter(GridRouter& router, const std::vector<char>* skipWire = nullptr) const;
+    // 布不通时退回 MakeManhattan
+    std::vector<wxPoint> RouteOrManhattan(GridRouter& router, const wxPoint& a, const wxPoint& b) const;
+    // 只重布 poly 靠近 newEnd 的尾部：保留从固定端起、不穿过 keepOut 的前缀
+    std::vector<wxPoint> RerouteTail(GridRouter& router, const std::vector<wxPoint>& poly,
+        const wxPoint& newEnd, const MetricsBox& keepOut) const;
+
+    // 常驻布线占用：拖动时只增量更新被移动元件与其相连的线
+    GridRouter m_router;
+    bool m_routerDirty = true;
+    std::vector<MetricsBox> m_routerBoxes;   // 建占用表时各元件的包围盒（移动时据此撤销旧障碍）
+    void EnsureRouter();
+    // 占用表里把元件从旧位置挪到新位置（移出网格范围时标记重建）
+    void RouterComponentMoved(int compIdx, const std::vector<wxPoint>& prevPins);
+
+    // 引脚 → 端点挂在其上的导线
+    struct WireEnd {
+        int wire;       // wires 下标
+        bool atEnd;     // false：poly.front()；true：poly.back()
+        int pin;        // 元件引脚下标
+    };
+    std::vector<std::vector<WireEnd>> m_compWires;  // 按元件下标
+    bool m_pinWireDirty = true;
+    void EnsurePinWireIndex();
+
     // 吸附到网格/步进
     wxPoint SnapToGrid(const wxPoint& p) const;
     wxPoint SnapToStep(const wxPoint& p) const;      // 半格吸附
-    void RerouteWiresForMovedComponent(int compIdx, const std::vector<wxPoint>& prevPins); // 线跟随重算（传入移动前引脚坐标）
+    // 线跟随重算（传入移动前引脚坐标）；dirty 非空时并入改动前后的导线范围
+    void RerouteWiresForMovedComponent(int compIdx, const std::vector<wxPoint>& prevPins, wxRect* dirty = nullptr);
 
     int selectedWireIndex = -1;          // 选中的连线（wires 数组下标）
 
+    // 多选集合（升序下标）；selectedGateIndex / selectedWireIndex 仍是主选，属性面板只看主选
+    std::vector<int> m_selGates, m_selWires;
+    bool IsGateSelected(int i) const { return std::binary_search(m_selGates.begin(), m_selGates.end(), i); }
+    bool IsWireSelected(int i) const { return std::binary_search(m_selWires.begin(), m_selWires.end(), i); }
+    void ClearMultiSelection() { m_selGates.clear(); m_selWires.clear(); }
+    size_t MultiSelectionSize() const { return m_selGates.size() + m_selWires.size(); }
+
+    std::shared_ptr<const ClipboardData> m_clipboard;
+    std::vector<std::shared_ptr<const SubcircuitDef>> m_subcircuits;   // 按创建顺序（被嵌套的在前）
+    // 当前选区：选中元件 + 两端都挂在其上的连线 + 选中的连线（升序）；为空返回 false
+    bool CollectSelection(std::vector<int>& gateIds, std::vector<int>& wireIds);
+    // 把给定的元件与连线放进剪贴板（下标升序）
+    void CopyItems(const std::vector<int>& gateIds, const std::vector<int>& wireIds);
+    // JSON 中的单个元件（子电路实例按定义名引用）
+    static Json::Value GateToJson(Component* c);
+    std::unique_ptr<Component> GateFromJson(const Json::Value& obj) const;
+    int m_pasteCount = 0;                // 同一份剪贴板已粘贴次数（决定错开量）
+
+    // 框选：空白处按下拖出矩形，松开时选中框内对象（按住 Shift 为追加）
+    bool    m_isBanding = false;
+    bool    m_bandAdditive = false;
+    wxPoint m_bandStart;
+
+    // 整组拖动：按下时各选中元件的中心
+    bool m_isGroupDragging = false;
+    std::vector<wxPoint> m_groupStartCenters;
+
+    // 空间索引：元件包围盒 / 连线包围盒，命中测试与框选只看附近的对象
+    mutable SpatialIndex m_gateIndex, m_wireIndex;
+    mutable bool m_spatialDirty = true;
+    void EnsureSpatialIndex() const;
+
+    // 连线位宽缓存：连通关系变化（增删、导入、改位宽）时作废，绘制时按需重算
+    mutable std::vector<int> m_wireWidth;
+    mutable std::vector<char> m_wireWidthConflict;
+    mutable bool m_wireWidthDirty = true;
+    void EnsureWireWidths() const;
+
     // 命中测试：点是否命中某条折线（返回下标；未命中返回 -1）
     int HitTestWire(const wxPoint& pt) const;
 
@@ -208,10 +377,31 @@ private:
 
     // ★ 命令管理器
     CommandManager* m_cmd = nullptr;
+    int m_batchDepth = 0;
 
     
     bool m_simulating = false;
-    wxTimer* m_simTimer = nullptr;
+    wxTimer* m_simTimer = nullptr;      // 仿真时按显示刷新节拍取快照重画（推进由仿真线程负责）
+    double m_simRate = 50.0;            // 默认 50 节拍/秒，与原来 20 ms 一拍的观感一致
+    long long m_reportedOsc = 0;        // 已在状态栏报告过的振荡次数
+    void ReportOscillation();           // 有新的环被判为振荡时在状态栏列出涉及的元件
 
     void OnTimer(wxTimerEvent& e);
+
+    // ===== 性能浮层 =====
+    bool m_showProfiler = false;
+    wxTimer* m_profTimer = nullptr;        // 定时刷新浮层区域（画布空闲时数字也会更新）
+    wxRect ProfilerOverlayRect() const;    // 右上角
+    void DrawProfilerOverlay(wxGraphicsContext* gc);
+
+    // 增删元件/连线、缩放、导入后：指标、布线占用、引脚-导线索引都需要全量重建
+    void InvalidateLayoutCaches();
+
+    // ===== 版图指标（增量） =====
+    LayoutMetrics m_metrics;
+    bool m_metricsDirty = true;
+    bool m_metricsLabelPending = false;  // 同一轮事件里的多次改动只刷新一次标签
+    void RebuildMetricsIfDirty();
+    void MetricsGateMoved(int compIdx);
+    void ScheduleMetricsLabel();
 };
\ No newline at end of file
@@ -30,16 +30,35 @@ public:
     MoveGateCmd(DrawBoard* b, long id, wxPoint from, wxPoint to) : b(b), id(id), oldPos(from), newPos(to) {}
     void Do() override { b->MoveGateTo(id, newPos); }
     void Undo() override { b->MoveGateTo(id, oldPos); }
+    // 同一元件的连续移动（方向键微调、属性面板改坐标）并成一步：保留最初的 from，取最新的 to
+    bool MergeWith(const ICommand& next) override {
+        auto* m = dynamic_cast<const MoveGateCmd*>(&next);
+        if (!m || m->b != b || m->id != id) return false;
+        newPos = m->newPos;
+        return true;
+    }
 private:
     DrawBoard* b; long id; wxPoint oldPos, newPos;
 };
 
+// 改位宽/输入数（属性面板）：引脚数可能变化，连线由 SetGateParams 跟随
+class SetGateParamsCmd : public ICommand {
+public:
+    SetGateParamsCmd(DrawBoard* b, long id, int fromWidth, int fromInputs, int toWidth, int toInputs)
+        : b(b), id(id), oldW(fromWidth), oldIn(fromInputs), newW(toWidth), newIn(toInputs) {}
+    void Do() override { b->SetGateParams(id, newW, newIn); }
+    void Undo() override { b->SetGateParams(id, oldW, oldIn); }
+private:
+    DrawBoard* b; long id; int oldW, oldIn, newW, newIn;
+};
+
 // 添加/删除连线
 class AddWireCmd : public ICommand {
 public:
     AddWireCmd(DrawBoard* b, const WireSnapshot& w) : b(b), w(w), newId(-1) {}
     void Do() override { newId = b->AddWire(w); }
     void Undo() override { if (newId >= 0) b->DeleteWireByIndex(newId); }
+    size_t MemoryBytes() const override { return sizeof(*this) + w.poly.size() * sizeof(wxPoint); }
 private:
     DrawBoard* b; WireSnapshot w; long newId;
 };
@@ -49,6 +68,58 @@ public:
     DeleteWireCmd(DrawBoard* b, long id) : b(b), id(id) {}
     void Do() override { backup = b->ExportWireByIndex(id); b->DeleteWireByIndex(id); }
     void Undo() override { if (backup.has_value()) b->AddWire(*backup); }
+    size_t MemoryBytes() const override { return sizeof(*this) + (backup ? backup->poly.size() * sizeof(wxPoint) : 0); }
 private:
     DrawBoard* b; long id; std::optional<WireSnapshot> backup;
 };
+
+// 批量移动（整组拖动）：一条命令，连线只重布一次
+class MoveGatesCmd : public ICommand {
+public:
+    MoveGatesCmd(DrawBoard* b, std::vector<int> ids, std::vector<wxPoint> from, std::vector<wxPoint> to)
+        : b(b), ids(std::move(ids)), oldPos(std::move(from)), newPos(std::move(to)) {}
+    void Do() override { b->MoveGatesTo(ids, newPos); }
+    void Undo() override { b->MoveGatesTo(ids, oldPos); }
+    bool MergeWith(const ICommand& next) override {
+        auto* m = dynamic_cast<const MoveGatesCmd*>(&next);
+        if (!m || m->b != b || m->ids != ids) return false;
+        newPos = m->newPos;
+        return true;
+    }
+    size_t MemoryBytes() const override { return sizeof(*this) + ids.size() * (sizeof(int) + 2 * sizeof(wxPoint)); }
+private:
+    DrawBoard* b; std::vector<int> ids; std::vector<wxPoint> oldPos, newPos;
+};
+
+// 粘贴：与剪贴板共享同一份数据，不做拷贝；撤销时截掉追加在末尾的对象
+class PasteCmd : public ICommand {
+public:
+    PasteCmd(DrawBoard* b, std::shared_ptr<const ClipboardData> data, wxPoint offset)
+        : b(b), data(std::move(data)), offset(offset) {}
+    void Do() override {
+        gates0 = b->components.size();
+        wires0 = b->wires.size();
+        b->AppendClipboard(*data, offset);
+    }
+    void Undo() override { b->TruncateItems(gates0, wires0); }
+private:
+    DrawBoard* b; std::shared_ptr<const ClipboardData> data; wxPoint offset;
+    size_t gates0 = 0, wires0 = 0;
+};
+
+// 批量删除（多选）：一次压缩；撤销时按原下标插回
+class DeleteItemsCmd : public ICommand {
+public:
+    DeleteItemsCmd(DrawBoard* b, std::vector<int> gates, std::vector<int> wires)
+        : b(b), gates(std::move(gates)), wires(std::move(wires)) {}
+    void Do() override { backup = b->ExportItems(gates, wires); b->DeleteItems(gates, wires); }
+    void Undo() override { b->InsertItems(backup); }
+    size_t MemoryBytes() const override {
+        size_t n = sizeof(*this) + (gates.size() + wires.size()) * sizeof(int)
+            + backup.gates.size() * sizeof(backup.gates[0]) + backup.wires.size() * sizeof(backup.wires[0]);
+        for (const auto& w : backup.wires) n += w.second.poly.size() * sizeof(wxPoint);
+        return n;
+    }
+private:
+    DrawBoard* b; std::vector<int> gates, wires; ItemsSnapshot backup;
+};
@@ -0,0 +1,440 @@
+﻿// LogicKernel.cpp
+#include "LogicKernel.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace logic {
+
+    int InputCount(ComponentType t, int numPins)
+    {
+        switch (t) {
+        case NODE_START: return 0;
+        case NODE_END:   return 1;
+        case NODE_BASIC: return numPins;
+        case DECODER24:  return 3;   // EN, A0, A1
+        case DECODER38:  return 4;   // EN, A0, A1, A2
+        case SUBCIRCUIT: return -1;
+        case CLOCK:      return 0;
+        case DFF:        return 2;   // D, CLK
+        case JKFF:       return 3;   // J, CLK, K
+        case DLATCH:     return 2;   // D, EN
+        case REGISTER:   return (numPins + 1) / 2;   // D0..Dn-1, CLK | Q0..Qn-1
+        case SPLITTER:   return 1;                   // 总线 | 位 0..n-1
+        case MERGER:     return numPins > 0 ? numPins - 1 : 0;   // 位 0..n-1 | 总线
+        case MUX:        return numPins > 0 ? numPins - 1 : 0;   // D0..Dn-1, S | Y
+        case ADDER:      return 3;                   // A, B, CIN | S, COUT
+        case COMPARATOR: return 2;                   // A, B | LT, EQ, GT
+        case NOTGATE:
+        case ANDGATE:
+        case ORGATE:
+        case NANDGATE:
+        case NORGATE:
+        case XORGATE:
+        case XNORGATE:
+            return numPins > 0 ? numPins - 1 : 0;
+        default:
+            return numPins;          // 未知类型：全部当输入，不驱动任何网
+        }
+    }
+
+    bool IsMultiOutput(ComponentType t)
+    {
+        return t == DECODER24 || t == DECODER38 || t == SUBCIRCUIT
+            || t == DFF || t == JKFF || t == DLATCH || t == REGISTER || t == SPLITTER
+            || t == ADDER || t == COMPARATOR;
+    }
+
+    void Evaluate(ComponentType t, const bool* in, int nIn, bool* out, int nOut)
+    {
+        if (nOut <= 0) return;
+        switch (t) {
+        case ANDGATE:
+        case NANDGATE: {
+            bool v = nIn > 0;
+            for (int k = 0; k < nIn && v; ++k) v = in[k];
+            out[0] = (t == ANDGATE) ? v : !v;
+            break;
+        }
+        case ORGATE:
+        case NORGATE: {
+            bool v = false;
+            for (int k = 0; k < nIn && !v; ++k) v = in[k];
+            out[0] = (t == ORGATE) ? v : !v;
+            break;
+        }
+        case NOTGATE:
+            out[0] = !(nIn >= 1 && in[0]);
+            break;
+        case XORGATE:
+        case XNORGATE: {
+            bool v = false;
+            for (int k = 0; k < nIn; ++k) v ^= in[k];
+            out[0] = (t == XORGATE) ? v : (nIn > 0 ? !v : true);
+            break;
+        }
+        case DECODER24:
+        case DECODER38: {
+            // 输入 EN, A0..；输出 Y0..：EN 有效时仅地址对应的一路为 1
+            const bool en = nIn >= 1 && in[0];
+            int idx = 0;
+            for (int k = 1; k < nIn; ++k) idx |= (in[k] ? 1 : 0) << (k - 1);
+            for (int k = 0; k < nOut; ++k) out[k] = en && k == idx;
+            break;
+        }
+        default:
+            for (int k = 0; k < nOut; ++k) out[k] = false;
+            break;
+        }
+    }
+
+    int StateBits(ComponentType t, int /*nIn*/, int nOut)
+    {
+        switch (t) {
+        case NODE_START:
+        case CLOCK:
+        case DFF:
+        case JKFF:
+        case DLATCH:
+            return 1;
+        case REGISTER:
+            return nOut;
+        default:
+            return 0;
+        }
+    }
+
+    bool IsSequential(ComponentType t)
+    {
+        return t == CLOCK || t == DFF || t == JKFF || t == DLATCH || t == REGISTER;
+    }
+
+    bool IsEdgeTriggered(ComponentType t)
+    {
+        return t == DFF || t == JKFF || t == REGISTER;
+    }
+
+    int ClockPin(ComponentType t, int nIn)
+    {
+        switch (t) {
+        case DFF:
+        case JKFF:     return 1;
+        case REGISTER: return nIn - 1;
+        default:       return -1;
+        }
+    }
+
+    void NextState(ComponentType t, const bool* in, int nIn, const bool* q, bool* next, int nState)
+    {
+        switch (t) {
+        case DFF:
+            next[0] = nIn >= 1 && in[0];
+            break;
+        case JKFF: {
+            const bool j = nIn >= 1 && in[0], k = nIn >= 3 && in[2];
+            next[0] = (j && !q[0]) || (!k && q[0]);   // 00 保持，10 置位，01 复位，11 翻转
+            break;
+        }
+        case REGISTER:
+            for (int b = 0; b < nState; ++b) next[b] = b < nIn - 1 && in[b];
+            break;
+        default:
+            for (int b = 0; b < nState; ++b) next[b] = q[b];
+            break;
+        }
+    }
+
+    void StateOutputs(ComponentType t, const bool* q, int nState, bool* out, int nOut)
+    {
+        switch (t) {
+        case DFF:
+        case JKFF:
+        case DLATCH:
+            if (nOut >= 1) out[0] = q[0];
+            if (nOut >= 2) out[1] = !q[0];
+            break;
+        default:
+            for (int k = 0; k < nOut; ++k) out[k] = k < nState && q[k];
+            break;
+        }
+    }
+
+    bool IsBasicGate(ComponentType t)
+    {
+        return t == ANDGATE || t == ORGATE || t == NOTGATE || t == NANDGATE
+            || t == NORGATE || t == XORGATE || t == XNORGATE;
+    }
+
+    int MaxWidth(ComponentType t)
+    {
+        if (t == REGISTER) return 32;
+        if (t == SPLITTER || t == MERGER || t == MUX || t == ADDER || t == COMPARATOR || IsBasicGate(t))
+            return kMaxBusWidth;
+        return 1;
+    }
+
+    int MaxInputs(ComponentType t)
+    {
+        if (t == MUX) return 16;
+        if (IsBasicGate(t) && t != NOTGATE) return 32;
+        return 0;
+    }
+
+    int SelectBits(int n)
+    {
+        int b = 1;
+        while ((1 << b) < n) ++b;
+        return b;
+    }
+
+    int PinWidth(ComponentType t, int pin, int numPins, int width)
+    {
+        if (t == NODE_BASIC || t == NODE_END) return 0;
+        if (width < 1) width = 1;
+        if (IsBasicGate(t)) return width;
+        if (t == SPLITTER) return pin == 0 ? width : 1;
+        if (t == MERGER) return pin == numPins - 1 ? width : 1;
+        if (t == MUX) return pin == numPins - 2 ? SelectBits(numPins - 2) : width;   // D..., S, Y
+        if (t == ADDER) return (pin == 2 || pin == 4) ? 1 : width;                   // A, B, CIN, S, COUT
+        if (t == COMPARATOR) return pin < 2 ? width : 1;                             // A, B, LT, EQ, GT
+        return 1;
+    }
+
+    bool IsWordOp(ComponentType t, int width)
+    {
+        return t == SPLITTER || t == MERGER || t == MUX || t == ADDER || t == COMPARATOR
+            || (width > 1 && IsBasicGate(t));
+    }
+
+    void EvaluateWord(ComponentType t, const uint64_t* in, int nIn, uint64_t* out, int nOut, int width)
+    {
+        if (nOut <= 0) return;
+        const uint64_t mask = WidthMask(width);
+        switch (t) {
+        case ANDGATE:
+        case NANDGATE: {
+            uint64_t v = nIn > 0 ? mask : 0;
+            for (int k = 0; k < nIn; ++k) v &= in[k];
+            out[0] = (t == ANDGATE ? v : ~v) & mask;
+            break;
+        }
+        case ORGATE:
+        case NORGATE: {
+            uint64_t v = 0;
+            for (int k = 0; k < nIn; ++k) v |= in[k];
+            out[0] = (t == ORGATE ? v : ~v) & mask;
+            break;
+        }
+        case XORGATE:
+        case XNORGATE: {
+            uint64_t v = 0;
+            for (int k = 0; k < nIn; ++k) v ^= in[k];
+            out[0] = (t == XORGATE ? v : ~v) & mask;
+            break;
+        }
+        case NOTGATE:
+            out[0] = ~(nIn >= 1 ? in[0] : 0) & mask;
+            break;
+        case SPLITTER: {
+            const uint64_t bus = nIn >= 1 ? in[0] : 0;
+            for (int k = 0; k < nOut; ++k) out[k] = k < 64 ? (bus >> k) & 1 : 0;
+            break;
+        }
+        case MERGER: {
+            uint64_t v = 0;
+            for (int k = 0; k < nIn && k < 64; ++k) v |= (in[k] & 1) << k;
+            out[0] = v & mask;
+            break;
+        }
+        case MUX: {
+            // 最后一个输入是选择总线；超出路数时输出 0
+            const int n = nIn - 1;
+            const uint64_t sel = nIn >= 1 ? in[nIn - 1] & WidthMask(SelectBits(n)) : 0;
+            out[0] = (n > 0 && sel < uint64_t(n)) ? in[sel] & mask : 0;
+            break;
+        }
+        case ADDER: {
+            const uint64_t a = nIn >= 1 ? in[0] & mask : 0;
+            const uint64_t b = nIn >= 2 ? in[1] & mask : 0;
+            const uint64_t cin = nIn >= 3 ? in[2] & 1 : 0;
+            const uint64_t ab = a + b, sum = ab + cin;
+            out[0] = sum & mask;
+            if (nOut >= 2) {
+                // 64 位时进位由回绕判断，否则就是第 width 位
+                out[1] = width >= 64 ? uint64_t(ab < a || sum < ab) : (sum >> width) & 1;
+            }
+            break;
+        }
+        case COMPARATOR: {
+            const uint64_t a = nIn >= 1 ? in[0] & mask : 0;
+            const uint64_t b = nIn >= 2 ? in[1] & mask : 0;
+            const uint64_t r[3] = { a < b, a == b, a > b };
+            for (int k = 0; k < nOut; ++k) out[k] = k < 3 ? r[k] : 0;
+            break;
+        }
+        default:
+            for (int k = 0; k < nOut; ++k) out[k] = 0;
+            break;
+        }
+    }
+
+    // ============ 类型名 ============
+    const char* TypeName(ComponentType t)
+    {
+        switch (t) {
+        case ANDGATE:     return "AND";
+        case ORGATE:      return "OR";
+        case NOTGATE:     return "NOT";
+        case NANDGATE:    return "NAND";
+        case NORGATE:     return "NOR";
+        case XORGATE:     return "XOR";
+        case XNORGATE:    return "XNOR";
+        case DECODER24:   return "DECODER24";
+        case DECODER38:   return "DECODER38";
+        case NODE_BASIC:  return "NODE";
+        case NODE_START:  return "START_NODE";
+        case NODE_END:    return "END_NODE";
+        case SUBCIRCUIT:  return "SUBCKT";
+        case CLOCK:       return "CLOCK";
+        case DFF:         return "DFF";
+        case JKFF:        return "JKFF";
+        case DLATCH:      return "DLATCH";
+        case REGISTER:    return "REGISTER";
+        case SPLITTER:    return "SPLITTER";
+        case MERGER:      return "MERGER";
+        case MUX:         return "MUX";
+        case ADDER:       return "ADDER";
+        case COMPARATOR:  return "COMPARATOR";
+        default:          return "AND";
+        }
+    }
+
+    bool MatchTypeName(const std::string& s, ComponentType& t)
+    {
+        // 只把 ASCII 字母转大写，中文按 UTF-8 原样匹配
+        std::string u;
+        u.reserve(s.size());
+        for (char ch : s) u.push_back((char)std::toupper((unsigned char)ch));
+        const size_t b = u.find_first_not_of(" \t\r\n");
+        if (b == std::string::npos) return false;
+        u = u.substr(b, u.find_last_not_of(" \t\r\n") - b + 1);
+        auto starts = [&](const char* p) { return u.rfind(p, 0) == 0; };
+        auto has = [&](const char* p) { return u.find(p) != std::string::npos; };
+
+        // 子电路（"SUBCKT" 或 "SUBCKT:<定义名>"，定义名里可能含门的名字）
+        if (starts("SUBCKT")) { t = SUBCIRCUIT; return true; }
+
+        // 运算块（"COMPARATOR" 含 "OR"，须在门之前判断）
+        if (starts("COMPARATOR") || starts("CMP")) { t = COMPARATOR; return true; }
+        if (starts("ADDER"))    { t = ADDER; return true; }
+        if (starts("MUX"))      { t = MUX; return true; }
+
+        // 结点（"START_NODE" 不能被当成门）
+        if (has("START_NODE") || has("STARTNODE") || has("起始")) { t = NODE_START; return true; }
+        if (has("END_NODE") || has("ENDNODE") || has("终止"))     { t = NODE_END; return true; }
+
+        // 先匹配更具体的门
+        if (has("XNOR")) { t = XNORGATE; return true; }
+        if (has("NAND")) { t = NANDGATE; return true; }
+        if (has("NOR"))  { t = NORGATE; return true; }
+        if (has("XOR"))  { t = XORGATE; return true; }
+        if (has("NOT"))  { t = NOTGATE; return true; }
+        if (has("OR"))   { t = ORGATE; return true; }
+        if (has("AND"))  { t = ANDGATE; return true; }
+
+        // 译码器
+        if (has("DECODER38") || has("DEC3TO8") || has("3-8")) { t = DECODER38; return true; }
+        if (has("DECODER24") || has("DEC2TO4") || has("2-4")) { t = DECODER24; return true; }
+
+        // 时序元件与总线（带位宽后缀）
+        if (starts("CLOCK"))    { t = CLOCK; return true; }
+        if (starts("DFF"))      { t = DFF; return true; }
+        if (starts("JKFF"))     { t = JKFF; return true; }
+        if (starts("DLATCH"))   { t = DLATCH; return true; }
+        if (starts("REGISTER")) { t = REGISTER; return true; }
+        if (starts("SPLIT"))    { t = SPLITTER; return true; }
+        if (starts("MERGE"))    { t = MERGER; return true; }
+
+        if (has("NODE")) { t = NODE_BASIC; return true; }
+        return false;
+    }
+
+    ComponentType TypeFromName(const std::string& s)
+    {
+        ComponentType t = ANDGATE;
+        return MatchTypeName(s, t) ? t : ANDGATE;
+    }
+
+    int DefaultWidth(ComponentType t)
+    {
+        if (t == REGISTER) return 4;
+        if (t == SPLITTER || t == MERGER) return 8;
+        return 1;
+    }
+
+    namespace {
+        // 末尾的十进制数（"REGISTER8" → 8）；没有时返回 def
+        int TrailingNumber(const std::string& s, int def)
+        {
+            size_t k = s.size();
+            while (k > 0 && std::isdigit((unsigned char)s[k - 1])) --k;
+            if (k == s.size() || s.size() - k > 4) return def;
+            const int v = std::stoi(s.substr(k));
+            return v > 0 ? v : def;
+        }
+    }
+
+    bool ParseTypeSpec(const std::string& s, TypeSpec& spec)
+    {
+        spec = TypeSpec{};
+        if (!MatchTypeName(s, spec.type)) return false;
+
+        std::string base = s, inSuffix;
+        std::string u;
+        for (char ch : s) u.push_back((char)std::toupper((unsigned char)ch));
+        const size_t at = u.find("_IN");
+        if (at != std::string::npos) {
+            base = s.substr(0, at);
+            inSuffix = s.substr(at + 3);
+        }
+        spec.width = DefaultWidth(spec.type);
+        if (MaxWidth(spec.type) > 1) spec.width = std::min(TrailingNumber(base, spec.width), MaxWidth(spec.type));
+        if (MaxInputs(spec.type) > 0) spec.inputs = std::max(2, std::min(TrailingNumber(inSuffix, 2), MaxInputs(spec.type)));
+        return true;
+    }
+
+    std::string TypeSpecName(const TypeSpec& spec)
+    {
+        std::string s = TypeName(spec.type);
+        if (MaxWidth(spec.type) > 1 && (spec.width != 1 || DefaultWidth(spec.type) != 1)) s += std::to_string(spec.width);
+        if (MaxInputs(spec.type) > 0 && spec.inputs != 2) s += "_IN" + std::to_string(spec.inputs);
+        return s;
+    }
+
+    int PinCount(ComponentType t, int width, int inputs)
+    {
+        const int in = std::max(2, inputs);
+        switch (t) {
+        case NODE_BASIC:
+        case NODE_START:
+        case NODE_END:
+        case CLOCK:      return 1;
+        case NOTGATE:    return 2;
+        case DECODER24:  return 3 + 4;
+        case DECODER38:  return 4 + 8;
+        case DFF:        return 2 + 2;
+        case JKFF:       return 3 + 2;
+        case DLATCH:     return 2 + 2;
+        case REGISTER:   return 2 * std::max(1, std::min(width, MaxWidth(REGISTER))) + 1;
+        case SPLITTER:
+        case MERGER:     return std::max(1, std::min(width, kMaxBusWidth)) + 1;
+        case MUX:        return std::min(in, MaxInputs(MUX)) + 2;
+        case ADDER:      return 3 + 2;
+        case COMPARATOR: return 2 + 3;
+        case SUBCIRCUIT: return -1;
+        default:
+            return IsBasicGate(t) ? std::min(in, MaxInputs(t)) + 1 : 0;
+        }
+    }
+
+} // namespace logic
@@ -0,0 +1,89 @@
+﻿// LogicKernel.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include "ComponentType.h"
+
+// ==========================================================
+//  组合元件求值内核（不依赖 wx）
+//  引脚约定：输入在前、输出在后（门：输入..., 输出；译码器：EN, A0.., Y0..）
+//  仿真器与子电路模板共用同一套求值，保证两边语义一致
+//  时序元件（触发器/寄存器/锁存器/时钟源）的输出由内部状态决定，状态的更新时机由调度器负责
+//  总线：网值为 uint64_t，门按位宽整字运算；分线器/合线器在总线与单线之间拆合
+// ==========================================================
+
+namespace logic {
+
+    // 不透明的组合块（如子电路模板）：调度器只通过这个接口求值
+    class Macro {
+    public:
+        virtual ~Macro() = default;
+        virtual int NumInputs() const = 0;
+        virtual int NumOutputs() const = 0;
+        virtual void Evaluate(const bool* in, bool* out) const = 0;
+    };
+
+    // 输入引脚数；SUBCIRCUIT 由定义决定，这里返回 -1，由调用方查询
+    int InputCount(ComponentType t, int numPins);
+
+    // 该类型的输出是否不止一个（需要按引脚分别取值）
+    bool IsMultiOutput(ComponentType t);
+
+    // in[nIn] → out[nOut]（nOut = 引脚数 - nIn）；不处理起始节点、子电路与时序元件
+    void Evaluate(ComponentType t, const bool* in, int nIn, bool* out, int nOut);
+
+    // ---- 时序元件 ----
+    // 时钟源、触发器、寄存器、锁存器（有内部状态，不能放进组合子电路）
+    bool IsSequential(ComponentType t);
+    // 状态位数（0 表示纯组合）；起始节点、时钟源各 1 位，寄存器为位宽
+    int StateBits(ComponentType t, int nIn, int nOut);
+    // 是否在时钟上升沿更新状态；ClockPin 为时钟输入的引脚下标
+    bool IsEdgeTriggered(ComponentType t);
+    int ClockPin(ComponentType t, int nIn);
+    // 上升沿：按边沿前的输入 in 由当前状态 q 得到次态 next（均为 StateBits 位）
+    void NextState(ComponentType t, const bool* in, int nIn, const bool* q, bool* next, int nState);
+    // 状态 → 输出（Q / QN / Q0..）
+    void StateOutputs(ComponentType t, const bool* q, int nState, bool* out, int nOut);
+
+    // ---- 总线 ----
+    constexpr int kMaxBusWidth = 64;
+    inline uint64_t WidthMask(int w) { return w >= 64 ? ~uint64_t(0) : ((uint64_t(1) << (w > 0 ? w : 0)) - 1); }
+    // 与/或/非/与非/或非/异或/同或
+    bool IsBasicGate(ComponentType t);
+    // 位宽可调的类型允许的最大位宽（1 表示没有位宽参数）
+    int MaxWidth(ComponentType t);
+    // 输入数可调的类型允许的最大输入数（多输入门、数据选择器；0 表示不可调）
+    int MaxInputs(ComponentType t);
+    // 数据选择器 n 路数据所需的选择位数
+    int SelectBits(int n);
+    // 引脚位宽；0 表示随所在网（普通结点、终止节点）
+    // 门的所有引脚同为 width；分线器输入 / 合线器输出为 width，其余引脚 1 位
+    int PinWidth(ComponentType t, int pin, int numPins, int width);
+    // 是否走整字求值：分线器、合线器、运算块（选择器/加法器/比较器）、位宽 > 1 的门
+    bool IsWordOp(ComponentType t, int width);
+    // 整字求值：in[nIn] → out[nOut]，输出只保留各引脚位宽内的位
+    void EvaluateWord(ComponentType t, const uint64_t* in, int nIn, uint64_t* out, int nOut, int width);
+
+    // ---- 类型名（画布、JSON、BookShelf、命令行共用） ----
+    // 规范名："AND"、"START_NODE"、"REGISTER"...
+    const char* TypeName(ComponentType t);
+    // 名字 → 类型（不分大小写，兼容 "DEC2TO4"、"起始" 等写法）；认不出时返回 false
+    bool MatchTypeName(const std::string& s, ComponentType& t);
+    // 同上，认不出时按与门处理
+    ComponentType TypeFromName(const std::string& s);
+
+    // 带参数的元件名 "<类型>[位宽][_IN<输入数>]"，如 "AND8"、"AND_IN4"、"MUX8_IN4"、"REGISTER8"
+    struct TypeSpec {
+        ComponentType type = ANDGATE;
+        int width = 1;
+        int inputs = 2;
+    };
+    // 没有位宽后缀时取 DefaultWidth；参数夹到 MaxWidth / MaxInputs；类型认不出时返回 false（spec 为 2 输入与门）
+    bool ParseTypeSpec(const std::string& s, TypeSpec& spec);
+    std::string TypeSpecName(const TypeSpec& spec);
+    // 新建元件的默认位宽：寄存器 4、分线/合线器 8，其余 1
+    int DefaultWidth(ComponentType t);
+    // 由参数得到引脚数（与画布元件的 GetPins 一致）；SUBCIRCUIT 由定义决定，返回 -1
+    int PinCount(ComponentType t, int width, int inputs);
+
+} // namespace logic
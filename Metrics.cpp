@@ -0,0 +1,277 @@
+﻿// Metrics.cpp
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    inline int DivFloorInt(int v, int d) {
+        if (v >= 0) return v / d;
+        return -(((-v) + d - 1) / d);
+    }
+
+    inline bool HasArea(const MetricsBox& b) { return b.x1 > b.x0 && b.y1 > b.y0; }
+
+    // 内部相交才算重叠（仅共边不算）
+    inline bool Overlap(const MetricsBox& a, const MetricsBox& b) {
+        return a.x0 < b.x1 && b.x0 < a.x1 && a.y0 < b.y1 && b.y0 < a.y1;
+    }
+
+    inline int Overlap1D(int a0, int a1, int b0, int b1) {
+        return std::max(0, std::min(a1, b1) - std::max(a0, b0));
+    }
+
+} // namespace
+
+void LayoutMetrics::Build(const Connectivity& conn, const std::vector<MetricsBox>& cells)
+{
+    const int numPins = conn.NumPins();
+    const int numCells = (int)cells.size();
+
+    // 1) 引脚坐标 + 单元 -> 引脚（按 pinIdx 排列）
+    m_pinX.resize(numPins);
+    m_pinY.resize(numPins);
+    m_pinNet.resize(numPins);
+    m_cellPinStart.assign(numCells + 1, 0);
+    for (int i = 0; i < numPins; ++i) {
+        m_pinX[i] = conn.PinX(i);
+        m_pinY[i] = conn.PinY(i);
+        m_pinNet[i] = conn.PinNet(i);
+        const PinRef& r = conn.Pin(i);
+        if (r.compIdx >= 0 && r.compIdx < numCells)
+            m_cellPinStart[r.compIdx + 1] = std::max(m_cellPinStart[r.compIdx + 1], r.pinIdx + 1);
+    }
+    for (int c = 0; c < numCells; ++c) m_cellPinStart[c + 1] += m_cellPinStart[c];
+    m_cellPins.assign(m_cellPinStart.back(), -1);
+    for (int i = 0; i < numPins; ++i) {
+        const PinRef& r = conn.Pin(i);
+        if (r.compIdx >= 0 && r.compIdx < numCells) m_cellPins[m_cellPinStart[r.compIdx] + r.pinIdx] = i;
+    }
+
+    // 2) 网
+    const int numNets = conn.NumNets();
+    m_netStart.assign(numNets + 1, 0);
+    m_netPins.clear();
+    m_netPins.reserve(numPins);
+    for (int n = 0; n < numNets; ++n) {
+        auto [first, last] = conn.NetPins(n);
+        m_netPins.insert(m_netPins.end(), first, last);
+        m_netStart[n + 1] = (int)m_netPins.size();
+    }
+    m_netHpwl.assign(numNets, 0.0);
+    m_hpwl = 0;
+    m_multiPinNets = 0;
+    for (int n = 0; n < numNets; ++n) {
+        if (m_netStart[n + 1] - m_netStart[n] >= 2) ++m_multiPinNets;
+        RecomputeNet(n);
+    }
+
+    // 3) 单元：装箱后逐个统计重叠（每对算两次）
+    m_cells = cells;
+    m_bins.clear();
+    m_stamp.assign(numCells, 0);
+    m_stampId = 0;
+    for (int c = 0; c < numCells; ++c) AddCell(c, +1);
+    long long twice = 0;
+    for (int c = 0; c < numCells; ++c) twice += CountOverlaps(c);
+    m_overlaps = twice / 2;
+
+    // 4) 导线由调用方 ResizeWires + SetWire 填入
+    m_wirePieces.clear();
+    m_wireLen.clear();
+    m_wireLength = 0;
+}
+
+void LayoutMetrics::ResizeWires(size_t n)
+{
+    // 缩小时先把多出来的线从箱里扣掉
+    for (size_t w = n; w < m_wirePieces.size(); ++w) SetWireImpl((int)w, {});
+    m_wirePieces.resize(n);
+    m_wireLen.resize(n, 0.0);
+}
+
+void LayoutMetrics::SetWireImpl(int w, const std::vector<Pt>& poly)
+{
+    if (w < 0) return;
+    if ((size_t)w >= m_wirePieces.size()) ResizeWires(size_t(w) + 1);
+
+    // 扣除旧贡献
+    for (const WirePiece& p : m_wirePieces[w]) {
+        auto it = m_bins.find(p.bin);
+        if (it == m_bins.end()) continue;
+        it->second.wireLen -= p.len;
+        if (it->second.wireLen < 1e-6) it->second.wireLen = 0;
+        if (it->second.cells.empty() && it->second.cellArea == 0 && it->second.wireLen == 0) m_bins.erase(it);
+    }
+    m_wirePieces[w].clear();
+    m_wireLength -= m_wireLen[w];
+    m_wireLen[w] = 0;
+
+    // 按段切到各箱：水平/竖直段按箱边界切开，斜段整段记到中点所在箱
+    auto& pieces = m_wirePieces[w];
+    double total = 0;
+    for (size_t k = 1; k < poly.size(); ++k) {
+        const Pt a = poly[k - 1], b = poly[k];
+        if (a.y == b.y) {
+            const int x0 = std::min(a.x, b.x), x1 = std::max(a.x, b.x);
+            const int by = DivFloorInt(a.y, BIN);
+            for (int bx = DivFloorInt(x0, BIN); bx <= DivFloorInt(x1, BIN); ++bx) {
+                const int len = Overlap1D(x0, x1, bx * BIN, (bx + 1) * BIN);
+                if (len > 0) pieces.push_back(WirePiece{ BinKey(bx, by), float(len) });
+            }
+            total += x1 - x0;
+        }
+        else if (a.x == b.x) {
+            const int y0 = std::min(a.y, b.y), y1 = std::max(a.y, b.y);
+            const int bx = DivFloorInt(a.x, BIN);
+            for (int by = DivFloorInt(y0, BIN); by <= DivFloorInt(y1, BIN); ++by) {
+                const int len = Overlap1D(y0, y1, by * BIN, (by + 1) * BIN);
+                if (len > 0) pieces.push_back(WirePiece{ BinKey(bx, by), float(len) });
+            }
+            total += y1 - y0;
+        }
+        else {
+            const double len = std::abs(double(b.x) - a.x) + std::abs(double(b.y) - a.y);
+            pieces.push_back(WirePiece{ BinKey(DivFloorInt((a.x + b.x) / 2, BIN), DivFloorInt((a.y + b.y) / 2, BIN)), float(len) });
+            total += len;
+        }
+    }
+    for (const WirePiece& p : pieces) m_bins[p.bin].wireLen += p.len;
+    m_wireLen[w] = total;
+    m_wireLength += total;
+}
+
+void LayoutMetrics::RecomputeNet(int net)
+{
+    const int b = m_netStart[net], e = m_netStart[net + 1];
+    double h = 0;
+    if (e - b >= 2) {
+        int x0 = m_pinX[m_netPins[b]], x1 = x0, y0 = m_pinY[m_netPins[b]], y1 = y0;
+        for (int k = b + 1; k < e; ++k) {
+            const int p = m_netPins[k];
+            x0 = std::min(x0, m_pinX[p]); x1 = std::max(x1, m_pinX[p]);
+            y0 = std::min(y0, m_pinY[p]); y1 = std::max(y1, m_pinY[p]);
+        }
+        h = double(x1 - x0) + double(y1 - y0);
+    }
+    m_hpwl += h - m_netHpwl[net];
+    m_netHpwl[net] = h;
+}
+
+void LayoutMetrics::AddCell(int c, int sign)
+{
+    const MetricsBox& b = m_cells[c];
+    if (!HasArea(b)) return;
+
+    // 右/下边界开区间：恰好压在箱边上的单元不算进下一个箱
+    const int bx0 = DivFloorInt(b.x0, BIN), bx1 = DivFloorInt(b.x1 - 1, BIN);
+    const int by0 = DivFloorInt(b.y0, BIN), by1 = DivFloorInt(b.y1 - 1, BIN);
+    for (int by = by0; by <= by1; ++by) {
+        for (int bx = bx0; bx <= bx1; ++bx) {
+            const double area = double(Overlap1D(b.x0, b.x1, bx * BIN, (bx + 1) * BIN))
+                * Overlap1D(b.y0, b.y1, by * BIN, (by + 1) * BIN);
+            if (sign > 0) {
+                Bin& bin = m_bins[BinKey(bx, by)];
+                bin.cellArea += area;
+                bin.cells.push_back(c);
+            }
+            else {
+                auto it = m_bins.find(BinKey(bx, by));
+                if (it == m_bins.end()) continue;
+                Bin& bin = it->second;
+                bin.cellArea -= area;
+                auto pos = std::find(bin.cells.begin(), bin.cells.end(), c);
+                if (pos != bin.cells.end()) { *pos = bin.cells.back(); bin.cells.pop_back(); }
+                if (bin.cells.empty() && bin.wireLen == 0) m_bins.erase(it);
+            }
+        }
+    }
+}
+
+long long LayoutMetrics::CountOverlaps(int c)
+{
+    const MetricsBox& b = m_cells[c];
+    if (!HasArea(b)) return 0;
+
+    // 同一对单元可能同时落在多个箱里，用时间戳去重
+    if (++m_stampId == 0) { std::fill(m_stamp.begin(), m_stamp.end(), 0); m_stampId = 1; }
+    m_stamp[c] = m_stampId;
+
+    long long n = 0;
+    const int bx0 = DivFloorInt(b.x0, BIN), bx1 = DivFloorInt(b.x1 - 1, BIN);
+    const int by0 = DivFloorInt(b.y0, BIN), by1 = DivFloorInt(b.y1 - 1, BIN);
+    for (int by = by0; by <= by1; ++by) {
+        for (int bx = bx0; bx <= bx1; ++bx) {
+            auto it = m_bins.find(BinKey(bx, by));
+            if (it == m_bins.end()) continue;
+            for (int j : it->second.cells) {
+                if (m_stamp[j] == m_stampId) continue;
+                m_stamp[j] = m_stampId;
+                if (Overlap(b, m_cells[j])) ++n;
+            }
+        }
+    }
+    return n;
+}
+
+void LayoutMetrics::MoveCellImpl(int c, const MetricsBox& box, const std::vector<Pt>& pins)
+{
+    if (c < 0 || c >= (int)m_cells.size()) return;
+
+    // 1) 引脚坐标 + 受影响网的 HPWL
+    const int b = m_cellPinStart[c], e = m_cellPinStart[c + 1];
+    for (int k = 0; k < e - b && k < (int)pins.size(); ++k) {
+        const int p = m_cellPins[b + k];
+        if (p < 0) continue;
+        m_pinX[p] = pins[k].x;
+        m_pinY[p] = pins[k].y;
+    }
+    for (int k = b; k < e; ++k) {
+        const int p = m_cellPins[k];
+        if (p < 0) continue;
+        const int net = m_pinNet[p];
+        bool seen = false;   // 一个元件的引脚通常很少，线性去重即可
+        for (int q = b; q < k && !seen; ++q) seen = m_cellPins[q] >= 0 && m_pinNet[m_cellPins[q]] == net;
+        if (!seen) RecomputeNet(net);
+    }
+
+    // 2) 密度与重叠：先按旧位置扣除，再按新位置加入
+    m_overlaps -= CountOverlaps(c);
+    AddCell(c, -1);
+    m_cells[c] = box;
+    AddCell(c, +1);
+    m_overlaps += CountOverlaps(c);
+}
+
+LayoutMetrics::Summary LayoutMetrics::GetSummary() const
+{
+    Summary s;
+    s.hpwl = m_hpwl;
+    s.wireLength = m_wireLength;
+    s.nets = m_multiPinNets;
+    s.overlaps = m_overlaps;
+
+    const double binArea = double(BIN) * BIN;
+    const double capacity = 2.0 * (BIN / TRACK_PITCH) * BIN;   // 横竖两个方向的走线总长
+    for (const auto& kv : m_bins) {
+        const double d = kv.second.cellArea / binArea;
+        s.peakDensity = std::max(s.peakDensity, d);
+        if (d > 1.0 + 1e-9) ++s.overflowBins;
+        s.peakCongestion = std::max(s.peakCongestion, kv.second.wireLen / capacity);
+    }
+    return s;
+}
+
+std::vector<LayoutMetrics::BinInfo> LayoutMetrics::BinMap() const
+{
+    const double binArea = double(BIN) * BIN;
+    const double capacity = 2.0 * (BIN / TRACK_PITCH) * BIN;
+    std::vector<BinInfo> out;
+    out.reserve(m_bins.size());
+    for (const auto& kv : m_bins) {
+        out.push_back(BinInfo{ int(int32_t(kv.first >> 32)), int(int32_t(kv.first & 0xffffffffu)),
+            kv.second.cellArea / binArea, kv.second.wireLen / capacity });
+    }
+    return out;
+}
@@ -0,0 +1,98 @@
+﻿// Metrics.h
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include "Connectivity.h"
+
+// ==========================================================
+//  版图指标（不依赖 wx）：
+//    - HPWL：每个网的引脚包围盒半周长及总和
+//    - 实际布线长度：wires 折线的曼哈顿长度总和
+//    - 分箱密度（单元面积 / 箱面积）与拥塞（箱内导线长度 / 走线容量）
+//    - 单元重叠对数
+//  全量 Build 之后，单元移动与单条导线改动都只更新受影响的网/箱
+// ==========================================================
+
+struct MetricsBox { int x0 = 0, y0 = 0, x1 = 0, y1 = 0; };  // 面积为 0 的单元不参与密度/重叠
+
+class LayoutMetrics {
+public:
+    static constexpr int BIN = 200;          // 箱边长（像素）
+    static constexpr int TRACK_PITCH = 10;   // 走线间距，用于估算箱内走线容量
+
+    struct Summary {
+        double hpwl = 0;            // 总半周长线长
+        double wireLength = 0;      // 实际布线总长
+        int nets = 0;               // 至少两个引脚的网
+        long long overlaps = 0;     // 相互重叠的单元对数
+        double peakDensity = 0;     // 最大箱密度
+        int overflowBins = 0;       // 密度 > 1 的箱数
+        double peakCongestion = 0;  // 最大箱拥塞
+    };
+
+    struct BinInfo { int bx, by; double density, congestion; };
+
+    // 全量重建：网来自 conn（已 Extract），cells 与元件下标一一对应
+    void Build(const Connectivity& conn, const std::vector<MetricsBox>& cells);
+
+    // 导线：Build 后按 wire 下标逐条设置（改动某条线时也调用它）
+    void ResizeWires(size_t n);
+    template <class PointT>
+    void SetWire(int w, const std::vector<PointT>& poly) {
+        m_tmpPoly.clear();
+        for (const auto& p : poly) m_tmpPoly.push_back(Pt{ (int)p.x, (int)p.y });
+        SetWireImpl(w, m_tmpPoly);
+    }
+
+    // 单元移动：新包围盒 + 新引脚坐标（按 pinIdx，数量与 Build 时相同）
+    template <class PointT>
+    void MoveCell(int c, const MetricsBox& box, const std::vector<PointT>& pins) {
+        m_tmpPoly.clear();
+        for (const auto& p : pins) m_tmpPoly.push_back(Pt{ (int)p.x, (int)p.y });
+        MoveCellImpl(c, box, m_tmpPoly);
+    }
+
+    Summary GetSummary() const;
+    double NetHPWL(int net) const { return m_netHpwl[net]; }
+    std::vector<BinInfo> BinMap() const;   // 仅非空箱
+
+private:
+    struct Pt { int x, y; };
+    struct Bin {
+        double cellArea = 0;
+        double wireLen = 0;
+        std::vector<int> cells;     // 与该箱相交的单元（重叠检测用）
+    };
+    struct WirePiece { uint64_t bin; float len; };
+
+    static uint64_t BinKey(int bx, int by) { return (uint64_t(uint32_t(bx)) << 32) | uint32_t(by); }
+
+    void SetWireImpl(int w, const std::vector<Pt>& poly);
+    void MoveCellImpl(int c, const MetricsBox& box, const std::vector<Pt>& pins);
+    void RecomputeNet(int net);
+    void AddCell(int c, int sign);           // sign = +1 加入箱 / -1 移出箱
+    long long CountOverlaps(int c);          // 与 c 重叠的其他单元数
+
+    // 引脚（下标同 Connectivity）
+    std::vector<int> m_pinX, m_pinY, m_pinNet;
+    std::vector<int> m_cellPinStart{ 0 }, m_cellPins;   // 单元 c 的第 k 个引脚 = m_cellPins[m_cellPinStart[c] + k]
+    std::vector<int> m_netStart, m_netPins;
+    std::vector<double> m_netHpwl;
+    double m_hpwl = 0;
+    int m_multiPinNets = 0;
+
+    // 单元
+    std::vector<MetricsBox> m_cells;
+    std::unordered_map<uint64_t, Bin> m_bins;
+    long long m_overlaps = 0;
+    std::vector<int> m_stamp;
+    int m_stampId = 0;
+
+    // 导线
+    std::vector<std::vector<WirePiece>> m_wirePieces;
+    std::vector<double> m_wireLen;
+    double m_wireLength = 0;
+
+    std::vector<Pt> m_tmpPoly;
+};
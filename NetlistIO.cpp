@@ -0,0 +1,190 @@
+﻿// NetlistIO.cpp
+#include "NetlistIO.h"
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <fstream>
+
+namespace netio {
+
+    namespace {
+        // "AND8_IN4_3" → "AND8_IN4"：去掉导出时追加的 "_<序号>"
+        std::string StripIndex(const std::string& s)
+        {
+            size_t k = s.size();
+            while (k > 0 && std::isdigit((unsigned char)s[k - 1])) --k;
+            if (k < s.size() && k > 0 && s[k - 1] == '_') return s.substr(0, k - 1);
+            return s;
+        }
+
+        // "P12" → 12；不是 P<k> 形式返回 -1
+        int PinIndexOf(const std::string& s)
+        {
+            if (s.size() < 2 || (s[0] != 'P' && s[0] != 'p')) return -1;
+            int v = 0;
+            for (size_t i = 1; i < s.size(); ++i) {
+                if (!std::isdigit((unsigned char)s[i]) || v > 100000) return -1;
+                v = v * 10 + (s[i] - '0');
+            }
+            return v;
+        }
+
+        std::string Lower(std::string s)
+        {
+            for (char& ch : s) ch = (char)std::tolower((unsigned char)ch);
+            return s;
+        }
+    }
+
+    // ============ JSON ============
+    Json::Value ToJson(const SimNetlist& nl)
+    {
+        Json::Value v;
+        v["nets"] = nl.NumNets();
+        v["cells"] = Json::Value(Json::arrayValue);
+        for (int i = 0; i < nl.NumCells(); ++i) {
+            const SimNetlist::Cell& c = nl.CellAt(i);
+            Json::Value cell;
+            cell["type"] = logic::TypeName(c.type);
+            Json::Value pins(Json::arrayValue);
+            for (int p = 0; p < c.numPins; ++p) pins.append(nl.PinNet(i, p));
+            cell["pins"] = pins;
+            if (c.width != 1) cell["width"] = c.width;
+            if (!c.name.empty()) cell["name"] = c.name;
+            v["cells"].append(cell);
+        }
+        v["inputs"] = Json::Value(Json::arrayValue);
+        for (int c : nl.Inputs()) v["inputs"].append(c);
+        v["outputs"] = Json::Value(Json::arrayValue);
+        for (int c : nl.Outputs()) v["outputs"].append(c);
+        return v;
+    }
+
+    bool FromJson(const Json::Value& v, const MacroTable& macros, SimNetlist& nl, std::string& err)
+    {
+        nl.Clear();
+        if (!v.isObject() || !v["cells"].isArray()) { err = "缺少 netlist.cells"; return false; }
+        nl.SetNumNets(v.get("nets", 0).asInt());
+
+        std::vector<int> pinNets;
+        for (const auto& cell : v["cells"]) {
+            ComponentType t = ANDGATE;
+            const std::string typeName = cell.get("type", "").asString();
+            if (!logic::MatchTypeName(typeName, t)) { err = "未知元件类型: " + typeName; return false; }
+            pinNets.clear();
+            for (const auto& n : cell["pins"]) pinNets.push_back(n.asInt());
+            const std::string name = cell.get("name", "").asString();
+            std::shared_ptr<const logic::Macro> macro;
+            if (t == SUBCIRCUIT) {
+                auto it = macros.find(name);
+                if (it != macros.end()) macro = it->second;
+            }
+            nl.AddCell(t, pinNets.data(), (int)pinNets.size(), cell.get("width", 1).asInt(), macro, name);
+        }
+
+        auto readPorts = [&](const Json::Value& arr, bool input) {
+            for (const auto& c : arr) {
+                const int i = c.asInt();
+                if (i < 0 || i >= nl.NumCells()) continue;
+                if (input) nl.AddInputPort(i);
+                else       nl.AddOutputPort(i);
+            }
+        };
+        readPorts(v["inputs"], true);
+        readPorts(v["outputs"], false);
+        return true;
+    }
+
+    bool LoadJson(const std::filesystem::path& path, SimNetlist& nl, std::string& err)
+    {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs.is_open()) { err = "无法打开文件: " + path.string(); return false; }
+        Json::Value root;
+        Json::CharReaderBuilder rb;
+        std::string perr;
+        if (!Json::parseFromStream(rb, ifs, &root, &perr)) { err = "JSON 解析失败: " + perr; return false; }
+        if (!root.isMember("netlist")) { err = "文件没有 netlist 节（请用新版画布重新保存）"; return false; }
+
+        // 子电路定义按创建顺序保存，被嵌套的在前
+        MacroTable macros;
+        for (const auto& d : root["subcircuits"]) {
+            const std::string name = d.get("name", "").asString();
+            if (name.empty() || !d.isMember("netlist")) continue;
+            SimNetlist sub;
+            if (!FromJson(d["netlist"], macros, sub, err)) { err = "子电路 " + name + ": " + err; return false; }
+            if (sub.HasSequential()) { err = "子电路 " + name + " 含时序元件"; return false; }
+            macros[name] = std::make_shared<NetlistMacro>(sub);
+        }
+        return FromJson(root["netlist"], macros, nl, err);
+    }
+
+    // ============ BookShelf ============
+    bool FromBookShelf(const bookshelf::BSDesign& d, SimNetlist& nl, std::string& err, std::string* warnings)
+    {
+        nl.Clear();
+        nl.SetNumNets((int)d.nets.size());
+
+        const int N = (int)d.nodes.size();
+        std::vector<logic::TypeSpec> spec(N);
+        std::vector<int> pinStart(N + 1, 0);
+        size_t unknownCells = 0, droppedPins = 0;
+        for (int i = 0; i < N; ++i) {
+            if (!logic::ParseTypeSpec(StripIndex(d.nodes[i].name), spec[i])) ++unknownCells;
+            if (spec[i].type == SUBCIRCUIT) { err = "BookShelf 不含子电路定义: " + d.nodes[i].name; return false; }
+            pinStart[i + 1] = pinStart[i] + logic::PinCount(spec[i].type, spec[i].width, spec[i].inputs);
+        }
+
+        // 引脚名驻留表：每个名字只解析一次
+        std::vector<int> pinIndex(d.pinNames.size());
+        for (size_t k = 0; k < d.pinNames.size(); ++k) pinIndex[k] = PinIndexOf(d.pinNames[k]);
+
+        std::vector<int> pinNets(pinStart[N], -1);
+        for (int n = 0; n < (int)d.nets.size(); ++n) {
+            for (const bookshelf::BSPin* p = d.PinsBegin(d.nets[n]); p != d.PinsEnd(d.nets[n]); ++p) {
+                const int k = pinIndex[p->pinNameId];
+                if (p->nodeId == bookshelf::kNoNode || k < 0 || pinStart[p->nodeId] + k >= pinStart[p->nodeId + 1]) {
+                    ++droppedPins;
+                    continue;
+                }
+                pinNets[pinStart[p->nodeId] + k] = n;
+            }
+        }
+
+        for (int i = 0; i < N; ++i) {
+            const int c = nl.AddCell(spec[i].type, pinNets.data() + pinStart[i], pinStart[i + 1] - pinStart[i],
+                spec[i].width, nullptr, d.nodes[i].name);
+            if (spec[i].type == NODE_START) nl.AddInputPort(c);
+            else if (spec[i].type == NODE_END) nl.AddOutputPort(c);
+        }
+
+        if (warnings) {
+            warnings->clear();
+            if (unknownCells) *warnings += std::to_string(unknownCells) + " 个单元名无法识别，按 2 输入与门处理; ";
+            if (droppedPins) *warnings += std::to_string(droppedPins) + " 个引脚无法对应到单元引脚，已忽略; ";
+        }
+        return true;
+    }
+
+    bool LoadDesign(const std::filesystem::path& path, SimNetlist& nl, std::string& err, std::string* warnings)
+    {
+        if (warnings) warnings->clear();
+        const std::string ext = Lower(path.extension().string());
+        try {
+            if (ext == ".json") return LoadJson(path, nl, err);
+            if (ext == ".aux") return FromBookShelf(bookshelf::ParseBookShelfAux(path), nl, err, warnings);
+            if (ext == ".nodes") {
+                std::filesystem::path nets = path;
+                nets.replace_extension(".nets");
+                return FromBookShelf(bookshelf::ParseBookShelf(path, nets), nl, err, warnings);
+            }
+        }
+        catch (const std::exception& e) {
+            err = e.what();
+            return false;
+        }
+        err = "不支持的设计文件: " + path.string() + "（需要 .json / .aux / .nodes）";
+        return false;
+    }
+
+} // namespace netio
@@ -0,0 +1,39 @@
+﻿// NetlistIO.h
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <json/json.h>
+#include "BookShelfImporter.h"
+#include "SimNetlist.h"
+
+// ==========================================================
+//  仿真网表的读写（不依赖 wx，命令行仿真与画布共用）
+//  - JSON：画布保存时在 "netlist" 节（顶层与每个子电路定义各一份）附带网表，
+//    无界面加载只读这一节，不需要元件几何；子电路单元按定义名引用
+//      { "nets": N, "cells": [ { "type": "AND", "pins": [0, 1, 2], "width": 8, "name": "I0" } ...],
+//        "inputs": [单元下标...], "outputs": [单元下标...] }
+//  - BookShelf：单元名为 "<带参数的类型名>_<序号>"（如 AND8_IN4_3），引脚名 P<k> 即引脚下标，
+//    起始/终止节点为端口，端口名取单元名
+// ==========================================================
+
+namespace netio {
+
+    using MacroTable = std::unordered_map<std::string, std::shared_ptr<const logic::Macro>>;
+
+    Json::Value ToJson(const SimNetlist& nl);
+
+    // macros：已读入的子电路模板（按定义名）；找不到定义的子电路单元不驱动任何网
+    bool FromJson(const Json::Value& v, const MacroTable& macros, SimNetlist& nl, std::string& err);
+
+    // 读整个 JSON 设计（先读子电路定义再读顶层）；没有 "netlist" 节的旧文件返回 false
+    bool LoadJson(const std::filesystem::path& path, SimNetlist& nl, std::string& err);
+
+    // BookShelf 设计 → 网表；认不出的单元名按 2 输入与门处理，越界引脚丢弃，计数写进 warnings
+    bool FromBookShelf(const bookshelf::BSDesign& d, SimNetlist& nl, std::string& err, std::string* warnings = nullptr);
+
+    // 按扩展名分派：.json / .aux / .nodes（同名 .nets）
+    bool LoadDesign(const std::filesystem::path& path, SimNetlist& nl, std::string& err, std::string* warnings = nullptr);
+
+} // namespace netio
@@ -0,0 +1,314 @@
+﻿#include "Placer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+using namespace std;
+
+namespace bookshelf {
+
+    namespace {
+
+        // 对称稀疏矩阵：对角单独存，非对角用 CSR
+        struct SparseSym {
+            vector<double> diag;
+            vector<int> rowStart;
+            vector<int> col;
+            vector<double> val;
+
+            void Multiply(const vector<double>& x, vector<double>& y) const {
+                const int n = (int)diag.size();
+                for (int i = 0; i < n; ++i) {
+                    double s = diag[i] * x[i];
+                    for (int k = rowStart[i]; k < rowStart[i + 1]; ++k) s += val[k] * x[col[k]];
+                    y[i] = s;
+                }
+            }
+        };
+
+        // Jacobi 预条件共轭梯度；x 为初值（热启动），返回迭代次数
+        int SolveCG(const SparseSym& A, const vector<double>& b, vector<double>& x, int maxIter, double tol) {
+            const int n = (int)b.size();
+            vector<double> r(n), z(n), p(n), Ap(n);
+            A.Multiply(x, Ap);
+            double bNorm = 0;
+            for (int i = 0; i < n; ++i) { r[i] = b[i] - Ap[i]; bNorm += b[i] * b[i]; }
+            bNorm = std::sqrt(bNorm);
+            if (bNorm == 0) bNorm = 1;
+
+            double rz = 0;
+            for (int i = 0; i < n; ++i) { z[i] = r[i] / A.diag[i]; p[i] = z[i]; rz += r[i] * z[i]; }
+
+            int it = 0;
+            for (; it < maxIter; ++it) {
+                double rNorm = 0;
+                for (int i = 0; i < n; ++i) rNorm += r[i] * r[i];
+                if (std::sqrt(rNorm) <= tol * bNorm) break;
+
+                A.Multiply(p, Ap);
+                double pAp = 0;
+                for (int i = 0; i < n; ++i) pAp += p[i] * Ap[i];
+                if (pAp <= 0) break;
+                const double alpha = rz / pAp;
+                for (int i = 0; i < n; ++i) { x[i] += alpha * p[i]; r[i] -= alpha * Ap[i]; }
+
+                double rzNew = 0;
+                for (int i = 0; i < n; ++i) { z[i] = r[i] / A.diag[i]; rzNew += r[i] * z[i]; }
+                const double beta = rzNew / rz;
+                rz = rzNew;
+                for (int i = 0; i < n; ++i) p[i] = z[i] + beta * p[i];
+            }
+            return it;
+        }
+
+        // 弹簧端点：变量（可动单元或 star 中心）或固定坐标
+        struct End {
+            int var;          // -1 表示固定
+            double fx, fy;    // 固定端的绝对坐标（var < 0 时有效）
+            double ox, oy;    // 引脚偏移
+        };
+
+        struct Spring { End a, b; double w; };
+
+        // 递归二分：把 cells 按坐标顺序分给槽位矩形 [c0,c1)x[r0,r1)，每槽至多一个单元
+        struct SlotAssigner {
+            const vector<double>& x;
+            const vector<double>& y;
+            double pitchX, pitchY;
+            vector<int>& slotCol;
+            vector<int>& slotRow;
+
+            void Assign(int* first, int* last, int c0, int c1, int r0, int r1) {
+                const long long n = last - first;
+                if (n == 0) return;
+                const long long cap = (long long)(c1 - c0) * (r1 - r0);
+                if (cap == 1) {
+                    slotCol[*first] = c0;
+                    slotRow[*first] = r0;
+                    return;
+                }
+
+                // 沿物理尺寸较长的方向切
+                const bool splitX = (c1 - c0) * pitchX >= (r1 - r0) * pitchY && (c1 - c0) > 1;
+                long long capL;
+                int mid;
+                if (splitX || (r1 - r0) == 1) {
+                    mid = (c0 + c1) / 2;
+                    capL = (long long)(mid - c0) * (r1 - r0);
+                }
+                else {
+                    mid = (r0 + r1) / 2;
+                    capL = (long long)(c1 - c0) * (mid - r0);
+                }
+                long long nL = (long long)std::llround(double(n) * double(capL) / double(cap));
+                nL = std::clamp(nL, std::max(0LL, n - (cap - capL)), std::min(n, capL));
+
+                int* cut = first + nL;
+                if (splitX || (r1 - r0) == 1) {
+                    std::nth_element(first, cut, last, [&](int a, int b) { return x[a] < x[b] || (x[a] == x[b] && a < b); });
+                    Assign(first, cut, c0, mid, r0, r1);
+                    Assign(cut, last, mid, c1, r0, r1);
+                }
+                else {
+                    std::nth_element(first, cut, last, [&](int a, int b) { return y[a] < y[b] || (y[a] == y[b] && a < b); });
+                    Assign(first, cut, c0, c1, r0, mid);
+                    Assign(cut, last, c0, c1, mid, r1);
+                }
+            }
+        };
+
+        double SnapToGrid(double v, int grid) {
+            return grid > 0 ? std::round(v / grid) * grid : v;
+        }
+
+    } // namespace
+
+    double ComputeHPWL(const BSDesign& d, const vector<double>& cx, const vector<double>& cy) {
+        double total = 0;
+        for (const auto& net : d.nets) {
+            double x0 = numeric_limits<double>::max(), x1 = -x0, y0 = x0, y1 = -x0;
+            int cnt = 0;
+            for (const BSPin* p = d.PinsBegin(net); p != d.PinsEnd(net); ++p) {
+                if (p->nodeId == kNoNode) continue;
+                const double px = cx[p->nodeId] + p->dx, py = cy[p->nodeId] + p->dy;
+                x0 = std::min(x0, px); x1 = std::max(x1, px);
+                y0 = std::min(y0, py); y1 = std::max(y1, py);
+                ++cnt;
+            }
+            if (cnt >= 2) total += (x1 - x0) + (y1 - y0);
+        }
+        return total;
+    }
+
+    PlaceStats PlaceDesign(const BSDesign& d, vector<double>& cx, vector<double>& cy, const PlaceOptions& opt) {
+        const auto t0 = chrono::steady_clock::now();
+        const int N = (int)d.nodes.size();
+        if ((int)cx.size() != N || (int)cy.size() != N) throw invalid_argument("PlaceDesign: coordinate size mismatch");
+
+        PlaceStats st;
+        st.hpwlBefore = ComputeHPWL(d, cx, cy);
+
+        // 1) 变量编号：可动单元在前，star 中心在后
+        vector<int> varOf(N, -1);
+        vector<int> cellOfVar;
+        for (int i = 0; i < N; ++i) {
+            if (d.nodes[i].fixed) continue;
+            varOf[i] = (int)cellOfVar.size();
+            cellOfVar.push_back(i);
+        }
+        const int numCells = (int)cellOfVar.size();
+        st.movable = numCells;
+        if (numCells == 0) return st;
+
+        auto endOf = [&](const BSPin& p) -> End {
+            const int v = varOf[p.nodeId];
+            return End{ v, v < 0 ? cx[p.nodeId] : 0.0, v < 0 ? cy[p.nodeId] : 0.0, p.dx, p.dy };
+            };
+
+        // 2) 网 → 弹簧
+        vector<Spring> springs;
+        int numVars = numCells;
+        vector<const BSPin*> pins;
+        for (const auto& net : d.nets) {
+            pins.clear();
+            for (const BSPin* p = d.PinsBegin(net); p != d.PinsEnd(net); ++p) {
+                if (p->nodeId != kNoNode) pins.push_back(p);
+            }
+            const int k = (int)pins.size();
+            if (k < 2) continue;
+            if (k <= opt.cliqueMaxDegree) {
+                const double w = 1.0 / (k - 1);
+                for (int a = 0; a < k; ++a)
+                    for (int b = a + 1; b < k; ++b)
+                        springs.push_back(Spring{ endOf(*pins[a]), endOf(*pins[b]), w });
+            }
+            else {
+                const int star = numVars++;
+                const double w = double(k) / (k - 1);
+                for (const BSPin* p : pins) springs.push_back(Spring{ endOf(*p), End{ star, 0, 0, 0, 0 }, w });
+            }
+        }
+
+        // 3) 组装 A（x/y 共用）与两个右端项
+        SparseSym A;
+        A.diag.assign(numVars, 0.0);
+        vector<double> bx(numVars, 0.0), by(numVars, 0.0);
+        struct Trip { int r, c; double v; };
+        vector<Trip> trips;
+        trips.reserve(springs.size() * 2);
+        for (const auto& s : springs) {
+            const End& a = s.a;
+            const End& b = s.b;
+            if (a.var >= 0 && b.var >= 0) {
+                if (a.var == b.var) continue;
+                A.diag[a.var] += s.w; A.diag[b.var] += s.w;
+                trips.push_back({ a.var, b.var, -s.w });
+                trips.push_back({ b.var, a.var, -s.w });
+                bx[a.var] += s.w * (b.ox - a.ox); bx[b.var] += s.w * (a.ox - b.ox);
+                by[a.var] += s.w * (b.oy - a.oy); by[b.var] += s.w * (a.oy - b.oy);
+            }
+            else if (a.var >= 0 || b.var >= 0) {
+                const End& v = a.var >= 0 ? a : b;
+                const End& f = a.var >= 0 ? b : a;
+                A.diag[v.var] += s.w;
+                bx[v.var] += s.w * (f.fx + f.ox - v.ox);
+                by[v.var] += s.w * (f.fy + f.oy - v.oy);
+            }
+        }
+        std::sort(trips.begin(), trips.end(), [](const Trip& a, const Trip& b) { return a.r != b.r ? a.r < b.r : a.c < b.c; });
+        A.rowStart.assign(numVars + 1, 0);
+        for (size_t k = 0; k < trips.size();) {
+            size_t j = k;
+            double v = 0;
+            while (j < trips.size() && trips[j].r == trips[k].r && trips[j].c == trips[k].c) v += trips[j++].v;
+            A.col.push_back(trips[k].c);
+            A.val.push_back(v);
+            ++A.rowStart[trips[k].r + 1];
+            k = j;
+        }
+        for (int i = 0; i < numVars; ++i) A.rowStart[i + 1] += A.rowStart[i];
+        trips.clear();
+        trips.shrink_to_fit();
+
+        const vector<double> baseDiag = A.diag;
+        double meanDiag = 0;
+        for (int i = 0; i < numCells; ++i) meanDiag += baseDiag[i];
+        meanDiag = std::max(1e-3, meanDiag / numCells);
+
+        // 初值：可动单元取输入坐标，star 中心取其所连单元均值的近似（先放在整体质心）
+        vector<double> x(numVars), y(numVars);
+        double mx = 0, my = 0;
+        for (int v = 0; v < numCells; ++v) { x[v] = cx[cellOfVar[v]]; y[v] = cy[cellOfVar[v]]; mx += x[v]; my += y[v]; }
+        mx /= numCells; my /= numCells;
+        for (int v = numCells; v < numVars; ++v) { x[v] = mx; y[v] = my; }
+
+        // 4) 槽位网格：可动单元 / 利用率 个槽，区域近似正方形
+        const double pitchX = std::max<double>(opt.grid, SnapToGrid(opt.pitchX, opt.grid));
+        const double pitchY = std::max<double>(opt.grid, SnapToGrid(opt.pitchY, opt.grid));
+        const double slots = std::ceil(numCells / std::clamp(opt.utilization, 0.1, 1.0));
+        const int cols = std::max(1, (int)std::ceil(std::sqrt(slots * pitchY / pitchX)));
+        const int rows = std::max(1, (int)std::ceil(slots / cols));
+        vector<int> slotCol(N, 0), slotRow(N, 0);
+        vector<int> order(numCells);
+
+        auto legalize = [&](vector<double>& ox, vector<double>& oy) {
+            // ox/oy 按 node 下标的坐标；只用来排序
+            for (int v = 0; v < numCells; ++v) order[v] = cellOfVar[v];
+            SlotAssigner sa{ ox, oy, pitchX, pitchY, slotCol, slotRow };
+            sa.Assign(order.data(), order.data() + numCells, 0, cols, 0, rows);
+            };
+        auto slotX = [&](int node) { return SnapToGrid(opt.originX + (slotCol[node] + 0.5) * pitchX, opt.grid); };
+        auto slotY = [&](int node) { return SnapToGrid(opt.originY + (slotRow[node] + 0.5) * pitchY, opt.grid); };
+
+        vector<double> nodeX(cx), nodeY(cy);
+        auto scatter = [&]() {
+            for (int v = 0; v < numCells; ++v) { nodeX[cellOfVar[v]] = x[v]; nodeY[cellOfVar[v]] = y[v]; }
+            };
+
+        // 5) 首次求解：极弱锚点只为消除平移不定（没有固定单元时矩阵奇异）
+        {
+            const double eps = 1e-4 * meanDiag;
+            vector<double> rx(bx), ry(by);
+            for (int v = 0; v < numVars; ++v) A.diag[v] = baseDiag[v] + (v < numCells ? eps : 0.0);
+            for (int v = numCells; v < numVars; ++v) if (A.diag[v] <= 0) A.diag[v] = eps;
+            for (int v = 0; v < numCells; ++v) { rx[v] += eps * x[v]; ry[v] += eps * y[v]; }
+            st.cgIterations += SolveCG(A, rx, x, opt.cgMaxIterations, opt.cgTolerance);
+            st.cgIterations += SolveCG(A, ry, y, opt.cgMaxIterations, opt.cgTolerance);
+        }
+
+        // 6) 展开：二分到槽位 → 以槽位为锚点重解，锚点权重逐轮加大
+        for (int round = 1; round <= opt.spreadRounds; ++round) {
+            scatter();
+            legalize(nodeX, nodeY);
+            const double wa = meanDiag * 0.05 * round * round;
+            vector<double> rx(bx), ry(by);
+            for (int v = 0; v < numVars; ++v) A.diag[v] = baseDiag[v];
+            for (int v = numCells; v < numVars; ++v) if (A.diag[v] <= 0) A.diag[v] = wa;
+            for (int v = 0; v < numCells; ++v) {
+                const int node = cellOfVar[v];
+                A.diag[v] += wa;
+                rx[v] += wa * slotX(node);
+                ry[v] += wa * slotY(node);
+            }
+            st.cgIterations += SolveCG(A, rx, x, opt.cgMaxIterations, opt.cgTolerance);
+            st.cgIterations += SolveCG(A, ry, y, opt.cgMaxIterations, opt.cgTolerance);
+        }
+
+        // 7) 合法化：最后一次二分即最终槽位
+        scatter();
+        legalize(nodeX, nodeY);
+        for (int v = 0; v < numCells; ++v) {
+            const int node = cellOfVar[v];
+            cx[node] = slotX(node);
+            cy[node] = slotY(node);
+        }
+
+        st.hpwlAfter = ComputeHPWL(d, cx, cy);
+        st.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        return st;
+    }
+
+} // namespace bookshelf
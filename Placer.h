@@ -0,0 +1,39 @@
+﻿#pragma once
+#include <cstddef>
+#include <vector>
+#include "BookShelfImporter.h"
+
+namespace bookshelf {
+
+    // ===== 解析式（二次）布局 =====
+    // 1) 网用弹簧近似（小网 clique、大网 star），x/y 各解一次 Ax = b（Jacobi 预条件共轭梯度）
+    // 2) 递归二分把单元按相对顺序摊到格点槽位上，既展开又合法化（无重叠）
+    // 3) 以槽位为锚点再解若干轮，逐步加大锚点权重，最后一次二分的结果即最终坐标
+    struct PlaceOptions {
+        int grid = 20;                 // 槽位中心对齐到该网格
+        double pitchX = 140, pitchY = 100; // 槽位间距（与 AutoGridPlace 相同）
+        double originX = 60, originY = 60; // 槽位区域左上角
+        double utilization = 0.8;      // 单元数 / 槽位数
+        int cliqueMaxDegree = 5;       // 超过该度数的网用 star 模型
+        int cgMaxIterations = 150;
+        double cgTolerance = 1e-5;     // 相对残差
+        int spreadRounds = 6;          // 锚定重解轮数
+    };
+
+    struct PlaceStats {
+        double hpwlBefore = 0;         // 输入坐标的 HPWL
+        double hpwlAfter = 0;          // 合法化后的 HPWL
+        double seconds = 0;
+        int cgIterations = 0;          // 所有求解累计
+        size_t movable = 0;
+    };
+
+    /// 半周长线长：按 pin 绝对坐标（中心 + 偏移）逐网求包围盒，找不到单元的引脚忽略
+    double ComputeHPWL(const BSDesign& d, const std::vector<double>& cx, const std::vector<double>& cy);
+
+    /// cx/cy：输入为初始中心坐标，输出为布局后的中心坐标（与 d.nodes 一一对应）
+    /// fixed 节点保持原坐标且不占槽位
+    PlaceStats PlaceDesign(const BSDesign& d, std::vector<double>& cx, std::vector<double>& cy,
+        const PlaceOptions& opt = {});
+
+} // namespace bookshelf
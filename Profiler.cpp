@@ -0,0 +1,217 @@
+﻿// Profiler.cpp
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+
+// ==========================================================
+//  分配计数：替换全局 operator new / delete，只多一次原子加
+//  数组版与 nothrow 版默认实现都转到这里；对齐版不经过（本项目没有超对齐类型）
+// ==========================================================
+namespace {
+    std::atomic<long long> g_allocs{ 0 };
+}
+
+void* operator new(std::size_t n)
+{
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    for (;;) {
+        if (void* p = std::malloc(n ? n : 1)) return p;
+        std::new_handler h = std::get_new_handler();
+        if (!h) throw std::bad_alloc();
+        h();
+    }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace prof {
+
+    namespace {
+        const char* const kZoneNames[ZoneCount] = { "Paint", "BuildNetlist", "SimStep", "HitTest" };
+        const char* const kCounterNames[CounterCount] = { "simTicks", "settlePasses", "evals", "changedNets" };
+
+        // 线程编号：按首次计时的先后从 1 开始（GUI 线程通常是 1）
+        int ThreadId()
+        {
+            static std::atomic<int> next{ 1 };
+            thread_local const int id = next.fetch_add(1);
+            return id;
+        }
+
+        double Ms(Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); }
+    }
+
+    const char* ZoneName(int zone) { return zone >= 0 && zone < ZoneCount ? kZoneNames[zone] : "?"; }
+    const char* CounterName(int counter) { return counter >= 0 && counter < CounterCount ? kCounterNames[counter] : "?"; }
+
+    long long AllocCount() { return g_allocs.load(std::memory_order_relaxed); }
+
+    int Histogram::BinOf(double ms)
+    {
+        if (!(ms > 0)) return 0;
+        const int k = (int)std::floor(std::log2(ms)) + 5;
+        return std::max(0, std::min(kBins - 1, k));
+    }
+
+    double Histogram::BinUpper(int k) { return std::ldexp(1.0, k - 4); }
+
+    Profiler& Profiler::Get()
+    {
+        static Profiler p;
+        return p;
+    }
+
+    Profiler::Profiler() : m_origin(Clock::now()) {}
+
+    void Profiler::SetEnabled(bool on)
+    {
+        std::lock_guard<std::mutex> lk(m_mu);
+        if (on && !m_enabled.load()) {
+            // 重新打开时从干净的一帧开始，关闭期间的调用不算进来
+            m_cur = FrameRecord();
+            m_allocMark = AllocCount();
+        }
+        m_enabled.store(on);
+    }
+
+    void Profiler::Record(int zone, Clock::time_point t0, Clock::time_point t1)
+    {
+        if (zone < 0 || zone >= ZoneCount) return;
+        const int tid = ThreadId();
+        std::lock_guard<std::mutex> lk(m_mu);
+        m_cur.ms[zone] += Ms(t1 - t0);
+        ++m_cur.calls[zone];
+
+        if (m_trace.size() < kTraceCap) m_trace.resize(std::min(kTraceCap, std::max<size_t>(4096, m_trace.size() * 2)));
+        m_trace[m_traceHead] = TraceEvent{
+            std::chrono::duration_cast<std::chrono::nanoseconds>(t0 - m_origin).count(),
+            std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count(), zone, tid };
+        m_traceHead = (m_traceHead + 1) % m_trace.size();
+        m_traceCount = std::min(m_traceCount + 1, m_trace.size());
+    }
+
+    void Profiler::Count(int counter, long long v)
+    {
+        if (counter < 0 || counter >= CounterCount || !Enabled()) return;
+        std::lock_guard<std::mutex> lk(m_mu);
+        m_cur.counters[counter] += v;
+    }
+
+    void Profiler::EndFrame()
+    {
+        if (!Enabled()) return;
+        const long long allocs = AllocCount();
+        std::lock_guard<std::mutex> lk(m_mu);
+        m_cur.end = Clock::now();
+        m_cur.allocs = allocs - m_allocMark;
+        m_allocMark = allocs;
+
+        if (m_frames.size() < (size_t)kHistory) m_frames.resize(kHistory);
+        m_frames[m_frameHead] = m_cur;
+        m_frameHead = (m_frameHead + 1) % m_frames.size();
+        m_frameCount = std::min(m_frameCount + 1, m_frames.size());
+        m_cur = FrameRecord();
+    }
+
+    void Profiler::Clear()
+    {
+        std::lock_guard<std::mutex> lk(m_mu);
+        m_cur = FrameRecord();
+        m_allocMark = AllocCount();
+        m_frameHead = m_frameCount = 0;
+        m_traceHead = m_traceCount = 0;
+    }
+
+    Summary Profiler::Summarize() const
+    {
+        std::vector<FrameRecord> frames;
+        {
+            std::lock_guard<std::mutex> lk(m_mu);
+            frames.reserve(m_frameCount);
+            for (size_t k = 0; k < m_frameCount; ++k) {
+                frames.push_back(m_frames[(m_frameHead + m_frames.size() - m_frameCount + k) % m_frames.size()]);
+            }
+        }
+
+        Summary s;
+        s.frames = (int)frames.size();
+        if (frames.empty()) return s;
+        s.last = frames.back();
+
+        const Clock::time_point oneSecAgo = s.last.end - std::chrono::seconds(1);
+        double ticks = 0, settle = 0, changed = 0, allocs = 0;
+        std::vector<double> v(frames.size());
+        for (int z = 0; z < ZoneCount; ++z) {
+            double sum = 0;
+            for (size_t k = 0; k < frames.size(); ++k) {
+                v[k] = frames[k].ms[z];
+                sum += v[k];
+                s.hist[z].Add(v[k]);
+            }
+            s.avgMs[z] = sum / frames.size();
+            std::sort(v.begin(), v.end());
+            s.p95Ms[z] = v[std::min(v.size() - 1, (size_t)std::ceil(0.95 * v.size()) - 1)];
+            s.maxMs[z] = v.back();
+        }
+        double simMs = 0;
+        for (const auto& f : frames) {
+            if (f.end > oneSecAgo) s.fps += 1;
+            ticks += (double)f.counters[CounterSimTicks];
+            settle += (double)f.counters[CounterSettlePasses];
+            changed += (double)f.counters[CounterChangedNets];
+            allocs += (double)f.allocs;
+            simMs += f.ms[ZoneSimStep];
+        }
+        if (ticks > 0) {
+            s.simMsPerTick = simMs / ticks;
+            s.settlePerTick = settle / ticks;
+            s.changedPerTick = changed / ticks;
+        }
+        s.allocsPerFrame = allocs / frames.size();
+        return s;
+    }
+
+    bool Profiler::WriteChromeTrace(const std::filesystem::path& path, std::string& err) const
+    {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) { err = "无法写入文件: " + path.string(); return false; }
+
+        std::lock_guard<std::mutex> lk(m_mu);
+        char buf[256];
+        bool first = true;
+        auto emit = [&](int n) {
+            if (!first) out << ",\n";
+            first = false;
+            out.write(buf, std::max(0, std::min(n, (int)sizeof(buf) - 1)));
+        };
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        for (size_t k = 0; k < m_traceCount; ++k) {
+            const TraceEvent& e = m_trace[(m_traceHead + m_trace.size() - m_traceCount + k) % m_trace.size()];
+            emit(std::snprintf(buf, sizeof(buf),
+                "{\"name\":\"%s\",\"cat\":\"zongshe\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                ZoneName(e.zone), e.tid, e.tsNs / 1000.0, e.durNs / 1000.0));
+        }
+        // 每帧一个计数事件：仿真节拍、稳定迭代、网值改变与分配次数随时间的曲线
+        for (size_t k = 0; k < m_frameCount; ++k) {
+            const FrameRecord& f = m_frames[(m_frameHead + m_frames.size() - m_frameCount + k) % m_frames.size()];
+            const double ts = std::chrono::duration<double, std::micro>(f.end - m_origin).count();
+            emit(std::snprintf(buf, sizeof(buf),
+                "{\"name\":\"frame\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"%s\":%lld,\"%s\":%lld,\"%s\":%lld,\"allocs\":%lld}}",
+                ts, CounterName(CounterSimTicks), f.counters[CounterSimTicks],
+                CounterName(CounterSettlePasses), f.counters[CounterSettlePasses],
+                CounterName(CounterChangedNets), f.counters[CounterChangedNets], f.allocs));
+        }
+        out << "\n]}\n";
+        out.flush();
+        if (!out) { err = "写入失败: " + path.string(); return false; }
+        return true;
+    }
+
+} // namespace prof
@@ -0,0 +1,123 @@
+﻿// Profiler.h
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ==========================================================
+//  帧耗时与热点路径剖析（不依赖 wx）
+//  - PROF_SCOPE(区段) 在作用域内计时；关闭时只读一次原子标志，不取时钟
+//  - 画布每画完一帧调用 EndFrame：本帧各区段累计耗时、调用数、计数器与分配次数
+//    落成一条帧记录，最近 kHistory 帧用来算均值 / p95 / 直方图
+//  - 同时把每次计时记入有界环形缓冲，可导出为 Chrome 跟踪 JSON（chrome://tracing、Perfetto）
+//  - 分配次数来自 Profiler.cpp 替换的全局 operator new（只计数，不改分配行为）
+// ==========================================================
+
+namespace prof {
+
+    enum Zone : int { ZonePaint, ZoneBuildNetlist, ZoneSimStep, ZoneHitTest, ZoneCount };
+    enum Counter : int { CounterSimTicks, CounterSettlePasses, CounterEvals, CounterChangedNets, CounterCount };
+
+    const char* ZoneName(int zone);
+    const char* CounterName(int counter);
+
+    using Clock = std::chrono::steady_clock;
+
+    // 进程启动以来的 operator new 次数
+    long long AllocCount();
+
+    // 帧耗时直方图：桶边界按 2 的幂（毫秒），第 k 桶为 [2^(k-5), 2^(k-4))，首尾两桶不设下/上界
+    struct Histogram {
+        static constexpr int kBins = 12;
+        std::array<int, kBins> bins{};
+        int total = 0;
+        static int BinOf(double ms);
+        static double BinUpper(int k);   // 第 k 桶上界（ms）
+        void Add(double ms) { ++bins[BinOf(ms)]; ++total; }
+    };
+
+    struct FrameRecord {
+        Clock::time_point end;
+        std::array<double, ZoneCount> ms{};          // 本帧各区段累计耗时
+        std::array<int, ZoneCount> calls{};
+        std::array<long long, CounterCount> counters{};
+        long long allocs = 0;
+    };
+
+    struct Summary {
+        int frames = 0;                               // 参与统计的帧数（≤ kHistory）
+        double fps = 0;                               // 最近一秒的帧数
+        FrameRecord last;
+        std::array<double, ZoneCount> avgMs{}, p95Ms{}, maxMs{};
+        std::array<Histogram, ZoneCount> hist;
+        double simMsPerTick = 0;                      // 以下按最近窗口内的仿真节拍平均
+        double settlePerTick = 0;
+        double changedPerTick = 0;
+        double allocsPerFrame = 0;
+    };
+
+    class Profiler {
+    public:
+        static constexpr int kHistory = 240;          // 约 4 秒（60 Hz）
+        static constexpr size_t kTraceCap = 1 << 18;  // 跟踪环形缓冲的事件数
+
+        static Profiler& Get();
+
+        void SetEnabled(bool on);
+        bool Enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+        void Record(int zone, Clock::time_point t0, Clock::time_point t1);
+        void Count(int counter, long long v);
+        void EndFrame();
+        void Clear();
+
+        Summary Summarize() const;
+        // 缓冲中的计时事件（X）与每帧计数（C）；失败返回 false 并填 err
+        bool WriteChromeTrace(const std::filesystem::path& path, std::string& err) const;
+
+    private:
+        struct TraceEvent {
+            int64_t tsNs, durNs;   // 相对 m_origin
+            int zone;
+            int tid;
+        };
+
+        Profiler();
+
+        std::atomic<bool> m_enabled{ false };
+        mutable std::mutex m_mu;
+        Clock::time_point m_origin;
+
+        FrameRecord m_cur;                           // 正在累计的帧
+        long long m_allocMark = 0;                   // 上一帧结束时的分配计数
+        std::vector<FrameRecord> m_frames;           // 环形，m_frameHead 为下一个写入位置
+        size_t m_frameHead = 0, m_frameCount = 0;
+        std::vector<TraceEvent> m_trace;             // 环形
+        size_t m_traceHead = 0, m_traceCount = 0;
+    };
+
+    class Scope {
+    public:
+        explicit Scope(int zone) : m_zone(zone), m_on(Profiler::Get().Enabled()) {
+            if (m_on) m_t0 = Clock::now();
+        }
+        ~Scope() { if (m_on) Profiler::Get().Record(m_zone, m_t0, Clock::now()); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        int m_zone;
+        bool m_on;
+        Clock::time_point m_t0;
+    };
+
+} // namespace prof
+
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT_(a, b)
+#define PROF_SCOPE(zone) ::prof::Scope PROF_CONCAT(prof_scope_, __LINE__)(::prof::zone)
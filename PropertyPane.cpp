@@ -1,8 +1,10 @@
 ﻿// PropertyPane.cpp
 #include "PropertyPane.h"
 #include "DrawBoard.h"
+#include "EditCommands.h"
 #include <algorithm>
 #include "Simulator.h"
+#include "LogicKernel.h"
 
 PropertyPane::PropertyPane(wxWindow* parent, DrawBoard* board)
     : wxPanel(parent, wxID_ANY), m_board(board)
@@ -77,6 +79,19 @@ void PropertyPane::BuildGatePage(long id) {
     m_pg->Append(new wxIntProperty("Position X", "pos_x", center.x));
     m_pg->Append(new wxIntProperty("Position Y", "pos_y", center.y));
 
+    // 位宽：寄存器 / 分线器 / 合线器为位数，门为总线宽度（整字运算）
+    if (logic::MaxWidth(c->m_type) > 1) {
+        auto* pw = m_pg->Append(new wxIntProperty("Bit Width", "bit_width", c->width));
+        pw->SetAttribute(wxPG_ATTR_MIN, 1);
+        pw->SetAttribute(wxPG_ATTR_MAX, logic::MaxWidth(c->m_type));
+    }
+    // 输入数：多输入门的输入个数 / 数据选择器的路数
+    if (logic::MaxInputs(c->m_type) > 0) {
+        auto* pn = m_pg->Append(new wxIntProperty("Inputs", "inputs", c->inputs));
+        pn->SetAttribute(wxPG_ATTR_MIN, 2);
+        pn->SetAttribute(wxPG_ATTR_MAX, logic::MaxInputs(c->m_type));
+    }
+
     // ========== ★ 优化：节点电平状态 ==========
     if (m_board->IsSimulating() && (c->m_type == ComponentType::NODE_START || c->m_type == ComponentType::NODE_END))
     {
@@ -97,7 +112,7 @@ void PropertyPane::BuildGatePage(long id) {
             for (const auto& net : m_board->m_sim->m_nets) {
                 for (const auto& ld : net.loads) {
                     if (ld.compIdx == id) {
-                        val = net.value;
+                        val = net.value != 0;
                         break; // 找到一个即可
                     }
                 }
@@ -126,6 +141,13 @@ void PropertyPane::BuildWirePage(long id) {
     auto* pvc = m_pg->Append(new wxIntProperty("Vertex Count", "vcount", (int)poly.size()));
     pvc->ChangeFlag(wxPGFlags(wxPG_PROP_READONLY), true);
 
+    // 位宽由所连引脚推出（> 1 为总线）
+    const int busWidth = m_board->WireBusWidth((int)id);
+    auto* pbw = m_pg->Append(new wxStringProperty("Bus Width", "bus_width",
+        m_board->WireWidthConflict((int)id) ? wxString::Format("%d (引脚位宽不一致)", busWidth)
+                                            : wxString::Format("%d", busWidth)));
+    pbw->ChangeFlag(wxPGFlags(wxPG_PROP_READONLY), true);
+
     if (!poly.empty()) {
         m_pg->Append(new wxPropertyCategory("Endpoints (Read-only)"));
         const wxPoint& p0 = poly.front();
@@ -148,8 +170,16 @@ void PropertyPane::BuildWirePage(long id) {
 
     if (m_board->IsSimulating() && m_board->m_sim) {
         // 使用 IsWireHigh (已在上一轮修复)
-        bool level = m_board->m_sim->IsWireHigh(id);
-        levelStr = level ? "1 (High)" : "0 (Low)";
+        if (m_board->m_sim->IsWireUnknown(id)) {
+            levelStr = "X (Oscillating)";   // 振荡的组合环驱动
+        }
+        else if (busWidth > 1) {
+            levelStr = wxString::Format("0x%llX", (unsigned long long)m_board->m_sim->WireValue(id));
+        }
+        else {
+            bool level = m_board->m_sim->IsWireHigh(id);
+            levelStr = level ? "1 (High)" : "0 (Low)";
+        }
     }
 
     auto* plevel = m_pg->Append(new wxStringProperty("Logic Level", "logic_level", levelStr));
@@ -171,17 +201,33 @@ void PropertyPane::OnPropChanged(wxPropertyGridEvent& e) {
             if (key == "pos_x") center.x = v.GetInteger();
             else                center.y = v.GetInteger();
 
-            // ★ TODO: 为支持 Undo/Redo，此处应使用 Command 模式
-            // 示例 (需要修改 cMain 和 DrawBoard 以传递 m_cmdMgr):
-            // wxPoint oldPos = c->GetCenter();
-            // if (m_cmd && oldPos != center) {
-            //    m_cmd->Execute(std::make_unique<MoveGateCmd>(m_board, idx, oldPos, center));
-            // } 
-
-            // 当前的直接修改 (无 Undo):
-            c->SetCenter(center);
-            c->UpdateGeometry();
-            m_board->Refresh(false);
+            // 走命令：可撤销，连线跟随；连续修改同一元件会在命令管理器里合并成一步
+            const wxPoint oldPos = c->GetCenter();
+            if (oldPos != center) {
+                if (CommandManager* cmd = m_board->GetCommandManager())
+                    cmd->Execute(std::make_unique<MoveGateCmd>(m_board, idx, oldPos, center));
+                else
+                    m_board->MoveGateTo(idx, center);
+            }
+            // 落点会吸附到步进网格，事件处理完后按实际坐标重建属性页
+            CallAfter([this]() { RebuildBySelection(); });
+        }
+        else if (key == "bit_width" || key == "inputs") {
+            int newW = c->width, newIn = c->inputs;
+            if (key == "bit_width") newW = std::max(1, std::min((int)v.GetInteger(), logic::MaxWidth(c->m_type)));
+            else                    newIn = std::max(2, std::min((int)v.GetInteger(), logic::MaxInputs(c->m_type)));
+            if (newW != c->width || newIn != c->inputs) {
+                if (CommandManager* cmd = m_board->GetCommandManager())
+                    cmd->Execute(std::make_unique<SetGateParamsCmd>(m_board, idx, c->width, c->inputs, newW, newIn));
+                else
+                    m_board->SetGateParams(idx, newW, newIn);
+                // 仿真中改参数：网表要重建
+                if (m_board->IsSimulating() && m_board->m_sim) {
+                    m_board->m_sim->BuildNetlist();
+                    m_board->Refresh(false);
+                }
+            }
+            CallAfter([this]() { RebuildBySelection(); });
         }
         // ========== ★ 优化：处理 START_NODE 值变化 ==========
         else if (key == "start_val") {
@@ -193,7 +239,8 @@ void PropertyPane::OnPropChanged(wxPropertyGridEvent& e) {
 
                 // 当前的直接修改 (无 Undo):
                 m_board->m_sim->SetStartNodeValue(idx, newVal);
-                m_board->SimStep(); // 立即触发一次 Settle
+                // 后台线程在跑时由它稳定，这里只在没有线程时立即触发一次 Settle
+                if (!m_board->m_sim->WorkerRunning()) m_board->SimStep();
                 m_board->Refresh(false);
             }
         }
@@ -0,0 +1,352 @@
+﻿// Router.cpp
+#include "Router.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace {
+
+    inline int DivFloorInt(int v, int d) {
+        if (v >= 0) return v / d;
+        return -(((-v) + d - 1) / d);
+    }
+
+    // 方向：0 +x，1 -x，2 +y，3 -y；d ^ 1 为反方向
+    constexpr int DX[4] = { 1, -1, 0, 0 };
+    constexpr int DY[4] = { 0, 0, 1, -1 };
+
+    inline void Bump(uint16_t& v, int delta) {
+        if (delta > 0) { if (v < UINT16_MAX) ++v; }
+        else if (v > 0) --v;
+    }
+
+    inline bool SamePt(const RoutePoint& a, const RoutePoint& b) { return a.x == b.x && a.y == b.y; }
+
+    // 去掉重复点与共线中间点
+    void Simplify(std::vector<RoutePoint>& pts) {
+        std::vector<RoutePoint> out;
+        out.reserve(pts.size());
+        for (const auto& p : pts) {
+            if (!out.empty() && SamePt(out.back(), p)) continue;
+            if (out.size() >= 2) {
+                const RoutePoint& a = out[out.size() - 2];
+                const RoutePoint& b = out.back();
+                if ((a.x == b.x && b.x == p.x) || (a.y == b.y && b.y == p.y)) { out.back() = p; continue; }
+            }
+            out.push_back(p);
+        }
+        pts.swap(out);
+    }
+
+} // namespace
+
+void GridRouter::Reset(int minX, int minY, int maxX, int maxY, const RouterOptions& opt)
+{
+    m_opt = opt;
+    m_pitch = std::max(1, opt.pitch);
+    if (maxX < minX) std::swap(minX, maxX);
+    if (maxY < minY) std::swap(minY, maxY);
+
+    // 四周留几格余量，让线能绕到最外侧元件的外面
+    const int pad = 4;
+    for (;;) {
+        m_ox = DivFloorInt(minX, m_pitch) * m_pitch - pad * m_pitch;
+        m_oy = DivFloorInt(minY, m_pitch) * m_pitch - pad * m_pitch;
+        m_w = (maxX - m_ox) / m_pitch + pad + 1;
+        m_h = (maxY - m_oy) / m_pitch + pad + 1;
+        if (size_t(m_w) * size_t(m_h) <= m_opt.maxCells || m_pitch > (1 << 20)) break;
+        m_pitch *= 2;
+    }
+
+    const size_t n = size_t(m_w) * m_h;
+    m_block.assign(n, 0);
+    m_pin.assign(n, 0);
+    m_hUse.assign(n, 0);
+    m_vUse.assign(n, 0);
+    m_vtxUse.assign(n, 0);
+    m_stats = RouterStats{};
+}
+
+GridRouter::Cell GridRouter::Snap(int x, int y) const
+{
+    return Cell{ DivFloorInt(x - m_ox + m_pitch / 2, m_pitch), DivFloorInt(y - m_oy + m_pitch / 2, m_pitch) };
+}
+
+void GridRouter::MarkObstacle(int x0, int y0, int x1, int y1, int delta)
+{
+    if (x1 < x0) std::swap(x0, x1);
+    if (y1 < y0) std::swap(y0, y1);
+    // 严格内部：格点像素坐标 > x0 且 < x1
+    const int gx0 = std::max(0, DivFloorInt(x0 - m_ox, m_pitch) + 1);
+    const int gy0 = std::max(0, DivFloorInt(y0 - m_oy, m_pitch) + 1);
+    const int gx1 = std::min(m_w - 1, -DivFloorInt(-(x1 - m_ox), m_pitch) - 1);
+    const int gy1 = std::min(m_h - 1, -DivFloorInt(-(y1 - m_oy), m_pitch) - 1);
+    for (int gy = gy0; gy <= gy1; ++gy)
+        for (int gx = gx0; gx <= gx1; ++gx) Bump(m_block[Idx(gx, gy)], delta);
+}
+
+void GridRouter::MarkPin(int x, int y, int delta)
+{
+    const Cell c = Snap(x, y);
+    if (InGrid(c.x, c.y)) Bump(m_pin[Idx(c.x, c.y)], delta);
+}
+
+void GridRouter::MarkWire(const std::vector<RoutePoint>& poly, int delta)
+{
+    auto bump = [delta](uint16_t& v) { Bump(v, delta); };
+
+    Cell prev{};
+    for (size_t k = 0; k < poly.size(); ++k) {
+        const Cell c = Snap(poly[k].x, poly[k].y);
+        if (InGrid(c.x, c.y)) bump(m_vtxUse[Idx(c.x, c.y)]);
+        if (k > 0) {
+            // 斜段（吸附后仍不共线）只记端点
+            if (c.y == prev.y) {
+                const int y = c.y;
+                if (y >= 0 && y < m_h) {
+                    for (int gx = std::max(0, std::min(c.x, prev.x)); gx <= std::min(m_w - 1, std::max(c.x, prev.x)); ++gx)
+                        bump(m_hUse[Idx(gx, y)]);
+                }
+            }
+            else if (c.x == prev.x) {
+                const int x = c.x;
+                if (x >= 0 && x < m_w) {
+                    for (int gy = std::max(0, std::min(c.y, prev.y)); gy <= std::min(m_h - 1, std::max(c.y, prev.y)); ++gy)
+                        bump(m_vUse[Idx(x, gy)]);
+                }
+            }
+        }
+        prev = c;
+    }
+}
+
+bool GridRouter::SearchInWindow(const std::vector<Cell>& sources, const Cell& target,
+    int wx0, int wy0, int wx1, int wy1, std::vector<Cell>& cells)
+{
+    const int ww = wx1 - wx0 + 1, wh = wy1 - wy0 + 1;
+    const size_t nCells = size_t(ww) * wh;
+    if (m_g.size() < nCells * 4) {
+        m_g.resize(nCells * 4);
+        m_parent.resize(nCells * 4);
+        m_seen.resize(nCells * 4, 0);
+    }
+    if (m_srcMark.size() < nCells) m_srcMark.resize(nCells, 0);
+    if (++m_searchId == 0) {
+        std::fill(m_seen.begin(), m_seen.end(), 0);
+        std::fill(m_srcMark.begin(), m_srcMark.end(), 0);
+        m_searchId = 1;
+    }
+    const uint32_t id = m_searchId;
+
+    auto local = [&](int gx, int gy) { return (gy - wy0) * ww + (gx - wx0); };
+    const double hw = std::max(1.0, m_opt.heuristicWeight);
+    auto heur = [&](int gx, int gy) {
+        const int dx = std::abs(gx - target.x), dy = std::abs(gy - target.y);
+        return int(hw * ((dx + dy) * m_opt.edgeCost + ((dx != 0 && dy != 0) ? m_opt.bendCost : 0)));
+        };
+
+    // 键 = (f << 32) | h：f 相同优先扩展离终点近的
+    using Item = std::pair<long long, int>;
+    auto key = [](int f, int h) { return (static_cast<long long>(f) << 32) | static_cast<uint32_t>(h); };
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+
+    for (size_t k = 0; k < sources.size(); ++k) {
+        const Cell& s = sources[k];
+        if (s.x < wx0 || s.x > wx1 || s.y < wy0 || s.y > wy1) continue;
+        // 除首个起点（本网引脚）外，被别的导线占着的树上格不能作分叉点
+        const size_t gi = Idx(s.x, s.y);
+        if (k > 0 && (m_hUse[gi] | m_vUse[gi] | m_vtxUse[gi]) != 0) continue;
+        const int l = local(s.x, s.y);
+        if (m_srcMark[l] == id) continue;
+        m_srcMark[l] = id;
+        const int h = heur(s.x, s.y);
+        for (int d = 0; d < 4; ++d) {
+            const int st = l * 4 + d;
+            m_seen[st] = id;
+            m_g[st] = 0;
+            m_parent[st] = -1;
+            open.push({ key(h, h), st });
+        }
+    }
+
+    while (!open.empty()) {
+        const auto [k, st] = open.top();
+        open.pop();
+        const int l = st >> 2, d = st & 3;
+        const int cx = wx0 + l % ww, cy = wy0 + l / ww;
+        const int g = m_g[st];
+        if (int(k >> 32) > g + heur(cx, cy)) continue;   // 过期条目
+        ++m_stats.expanded;
+        if (--m_budget < 0) return false;
+
+        if (cx == target.x && cy == target.y) {
+            cells.clear();
+            for (int s = st; s >= 0; s = m_parent[s]) {
+                const int ls = s >> 2;
+                const Cell c{ wx0 + ls % ww, wy0 + ls / ww };
+                if (cells.empty() || cells.back().x != c.x || cells.back().y != c.y) cells.push_back(c);
+            }
+            std::reverse(cells.begin(), cells.end());
+            return true;
+        }
+
+        const size_t ci = Idx(cx, cy);
+        const bool busyHere = (m_hUse[ci] | m_vUse[ci]) != 0 && m_srcMark[l] != id;
+        for (int nd = 0; nd < 4; ++nd) {
+            if (nd == (d ^ 1)) continue;
+            const bool turn = nd != d;
+
+            const int nx = cx + DX[nd], ny = cy + DY[nd];
+            if (nx < wx0 || nx > wx1 || ny < wy0 || ny > wy1) continue;
+            const size_t ni = Idx(nx, ny);
+            const bool isTarget = (nx == target.x && ny == target.y);
+
+            int cost = m_opt.edgeCost;
+            if (turn) {
+                cost += m_opt.bendCost;
+                if (busyHere) cost += m_opt.conflictCost;   // 拐点落在别的导线上
+            }
+            if (!isTarget) {
+                if (m_block[ni] | m_pin[ni]) continue;
+                if (m_vtxUse[ni]) cost += m_opt.conflictCost;   // 别的导线的端点/拐点落在本线上
+                const bool horiz = nd < 2;
+                const uint16_t same = horiz ? m_hUse[ni] : m_vUse[ni];
+                const uint16_t cross = horiz ? m_vUse[ni] : m_hUse[ni];
+                if (same) cost += m_opt.conflictCost;
+                if (cross) cost += m_opt.crossCost;
+            }
+
+            const int ns = local(nx, ny) * 4 + nd;
+            const int ng = g + cost;
+            if (m_seen[ns] != id || ng < m_g[ns]) {
+                m_seen[ns] = id;
+                m_g[ns] = ng;
+                m_parent[ns] = st;
+                const int nh = heur(nx, ny);
+                open.push({ key(ng + nh, nh), ns });
+            }
+        }
+    }
+    return false;
+}
+
+bool GridRouter::Search(const std::vector<Cell>& sources, const Cell& target, std::vector<Cell>& cells)
+{
+    if (sources.empty() || !InGrid(target.x, target.y)) return false;
+    // 窗口以首个起点与终点的包围盒为基准
+    const Cell& a = sources.front();
+    int margin = std::max(1, m_opt.windowMargin);
+    m_budget = m_opt.maxExpansions;
+    for (;;) {
+        const int wx0 = std::max(0, std::min(a.x, target.x) - margin);
+        const int wy0 = std::max(0, std::min(a.y, target.y) - margin);
+        const int wx1 = std::min(m_w - 1, std::max(a.x, target.x) + margin);
+        const int wy1 = std::min(m_h - 1, std::max(a.y, target.y) + margin);
+        if (SearchInWindow(sources, target, wx0, wy0, wx1, wy1, cells)) return true;
+        if (m_budget < 0) return false;
+        if (wx0 == 0 && wy0 == 0 && wx1 == m_w - 1 && wy1 == m_h - 1) return false;
+        margin *= 2;
+    }
+}
+
+void GridRouter::ToPolyline(const std::vector<Cell>& cells, const RoutePoint* from, const RoutePoint* to,
+    std::vector<RoutePoint>& out) const
+{
+    out.clear();
+    out.reserve(cells.size() + 4);
+
+    // 引脚不在格点上（缩放后）时补一小段 L 形短线
+    auto stub = [&](const RoutePoint& p, const RoutePoint& q) {
+        out.push_back(p);
+        if (p.x != q.x && p.y != q.y) out.push_back(RoutePoint{ q.x, p.y });
+        };
+
+    const RoutePoint first = CellPt(cells.front());
+    if (from) stub(*from, first);
+    for (const Cell& c : cells) out.push_back(CellPt(c));
+    if (to) {
+        const RoutePoint last = CellPt(cells.back());
+        if (last.x != to->x && last.y != to->y) out.push_back(RoutePoint{ to->x, last.y });
+        out.push_back(*to);
+    }
+    Simplify(out);
+}
+
+bool GridRouter::Route(const RoutePoint& a, const RoutePoint& b, std::vector<RoutePoint>& out)
+{
+    const Cell ca = Snap(a.x, a.y), cb = Snap(b.x, b.y);
+    if (!InGrid(ca.x, ca.y) || !InGrid(cb.x, cb.y)) { ++m_stats.failed; return false; }
+
+    std::vector<Cell> cells;
+    if (!Search({ ca }, cb, cells)) { ++m_stats.failed; return false; }
+    ToPolyline(cells, &a, &b, out);
+    if (out.size() < 2) out = { a, b };
+    ++m_stats.routes;
+    return true;
+}
+
+int GridRouter::RouteTree(const std::vector<RoutePoint>& pins, std::vector<std::vector<RoutePoint>>& branches)
+{
+    branches.clear();
+    const int n = (int)pins.size();
+    if (n < 2) return n;
+
+    std::vector<Cell> pinCell(n);
+    for (int i = 0; i < n; ++i) pinCell[i] = Snap(pins[i].x, pins[i].y);
+
+    // Prim 式顺序：每次连与已连引脚曼哈顿距离最近的那个
+    std::vector<char> done(n, 0);
+    std::vector<int> bestDist(n, INT_MAX), bestFrom(n, 0);
+    auto relax = [&](int j) {
+        for (int i = 0; i < n; ++i) {
+            if (done[i]) continue;
+            const int dd = std::abs(pins[i].x - pins[j].x) + std::abs(pins[i].y - pins[j].y);
+            if (dd < bestDist[i]) { bestDist[i] = dd; bestFrom[i] = j; }
+        }
+        };
+
+    std::vector<Cell> tree;              // 树上所有格点（首元素会被替换为最近的已连引脚）
+    std::vector<int> connected;
+    done[0] = 1;
+    connected.push_back(0);
+    tree.push_back(pinCell[0]);
+    relax(0);
+
+    int numConnected = 1;
+    std::vector<Cell> sources, cells;
+    std::vector<RoutePoint> poly;
+    for (int step = 1; step < n; ++step) {
+        int r = -1;
+        for (int i = 0; i < n; ++i) if (!done[i] && (r < 0 || bestDist[i] < bestDist[r])) r = i;
+        if (r < 0) break;
+        done[r] = 1;
+
+        if (!InGrid(pinCell[r].x, pinCell[r].y)) { ++m_stats.failed; continue; }
+        const int anchor = bestFrom[r];
+        sources.clear();
+        sources.push_back(pinCell[anchor]);
+        sources.insert(sources.end(), tree.begin(), tree.end());
+        if (!Search(sources, pinCell[r], cells)) { ++m_stats.failed; continue; }
+
+        // 从新引脚出发、止于树；树端恰好是已连引脚时用其精确坐标
+        std::reverse(cells.begin(), cells.end());
+        const RoutePoint* end = nullptr;
+        for (int j : connected) {
+            if (pinCell[j].x == cells.back().x && pinCell[j].y == cells.back().y) { end = &pins[j]; break; }
+        }
+        ToPolyline(cells, &pins[r], end, poly);
+        if (poly.size() < 2) poly = { pins[r], end ? *end : pins[anchor] };
+        branches.push_back(poly);
+        ++m_stats.routes;
+
+        tree.insert(tree.end(), cells.begin(), cells.end());
+        connected.push_back(r);
+        ++numConnected;
+        relax(r);
+    }
+    return numConnected;
+}
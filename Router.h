@@ -0,0 +1,115 @@
+﻿// Router.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ==========================================================
+//  网格布线器（不依赖 wx）
+//  - 在 pitch 间距的格点上走曼哈顿路径：A*，代价 = 步长 + 拐弯 + 穿越/重叠已有导线
+//  - 占用表：元件包围盒内部、别的网的引脚格不可走
+//  - 与已有导线同向重叠、经过其顶点、在其上拐弯都会被连通性提取当成连接，
+//    按高代价处理（实在绕不开时才发生，不至于整条布不通）；垂直穿越只加少量代价
+//  - 多引脚网：依次把最近的未连引脚接到已布好的树上（树上任一点都可作起点），即近似 Steiner 树
+//  - 每次搜索先限制在两端包围盒外扩的窗口内，失败再逐步扩大到整张网格
+// ==========================================================
+
+struct RoutePoint { int x = 0, y = 0; };
+
+struct RouterOptions {
+    int pitch = 10;                 // 格点间距（与画布 STEP 一致）
+    int edgeCost = 1;               // 每走一格
+    int bendCost = 3;               // 每个拐弯
+    int crossCost = 4;              // 垂直穿过已有导线
+    int conflictCost = 200;         // 每个会造成误连的格（重叠/压顶点/在线上拐弯）
+    double heuristicWeight = 1.3;   // >1 为加权 A*：略牺牲最优性换更少的扩展
+    int windowMargin = 12;          // 首次搜索窗口外扩格数，失败后翻倍
+    long long maxExpansions = 400000; // 单次搜索（含窗口扩大）的出堆上限，超出按失败处理
+    size_t maxCells = size_t(8) << 20; // 网格上限；超出时 pitch 翻倍
+};
+
+struct RouterStats {
+    long long routes = 0;           // 成功的两点/分支搜索次数
+    long long failed = 0;
+    long long expanded = 0;         // A* 出堆状态数
+};
+
+class GridRouter {
+public:
+    // 覆盖 [minX,maxX]x[minY,maxY]（像素），清空占用
+    void Reset(int minX, int minY, int maxX, int maxY, const RouterOptions& opt = {});
+
+    // 障碍与引脚都按计数记入，可以成对撤销（元件移动时增量更新）
+    void AddObstacle(int x0, int y0, int x1, int y1) { MarkObstacle(x0, y0, x1, y1, +1); }  // 包围盒严格内部不可走，边界可走
+    void RemoveObstacle(int x0, int y0, int x1, int y1) { MarkObstacle(x0, y0, x1, y1, -1); }
+    void AddPinKeepout(int x, int y) { MarkPin(x, y, +1); }      // 引脚格：只能作为本次布线的端点
+    void RemovePinKeepout(int x, int y) { MarkPin(x, y, -1); }
+
+    // 像素点是否落在网格内（超出时调用方需要 Reset 到更大的范围）
+    bool Contains(int x, int y) const { const Cell c = Snap(x, y); return InGrid(c.x, c.y); }
+
+    // 已有导线记入/移出占用（任意带 x/y 成员的点类型）
+    template <class PointT>
+    void AddWire(const std::vector<PointT>& poly) { MarkWire(ToPts(poly), +1); }
+    template <class PointT>
+    void RemoveWire(const std::vector<PointT>& poly) { MarkWire(ToPts(poly), -1); }
+
+    // 两点布线：out 从 a 到 b（首尾与输入坐标完全相同）；失败返回 false
+    bool Route(const RoutePoint& a, const RoutePoint& b, std::vector<RoutePoint>& out);
+
+    // 多引脚网：branches[k] 从某个引脚出发，终止于另一个引脚或已布好的树上（T 形连接）
+    // 返回成功连上的引脚数（pins[0] 计为已连）；连不上的引脚不生成分支
+    int RouteTree(const std::vector<RoutePoint>& pins, std::vector<std::vector<RoutePoint>>& branches);
+
+    int Pitch() const { return m_pitch; }
+    const RouterStats& Stats() const { return m_stats; }
+
+private:
+    struct Cell { int x, y; };
+
+    template <class PointT>
+    std::vector<RoutePoint> ToPts(const std::vector<PointT>& poly) const {
+        std::vector<RoutePoint> v;
+        v.reserve(poly.size());
+        for (const auto& p : poly) v.push_back(RoutePoint{ (int)p.x, (int)p.y });
+        return v;
+    }
+
+    bool InGrid(int gx, int gy) const { return gx >= 0 && gy >= 0 && gx < m_w && gy < m_h; }
+    size_t Idx(int gx, int gy) const { return size_t(gy) * m_w + gx; }
+    Cell Snap(int x, int y) const;                   // 最近格点
+    RoutePoint CellPt(const Cell& c) const { return RoutePoint{ m_ox + c.x * m_pitch, m_oy + c.y * m_pitch }; }
+
+    void MarkWire(const std::vector<RoutePoint>& poly, int delta);
+    void MarkObstacle(int x0, int y0, int x1, int y1, int delta);
+    void MarkPin(int x, int y, int delta);
+
+    // 多源 A*：sources 中任一格到 target 格；cells 输出格点路径（起点在前）
+    bool Search(const std::vector<Cell>& sources, const Cell& target, std::vector<Cell>& cells);
+    bool SearchInWindow(const std::vector<Cell>& sources, const Cell& target,
+        int wx0, int wy0, int wx1, int wy1, std::vector<Cell>& cells);
+
+    // 格点路径 → 折线（合并共线点），首尾补到真实引脚坐标
+    void ToPolyline(const std::vector<Cell>& cells, const RoutePoint* from, const RoutePoint* to,
+        std::vector<RoutePoint>& out) const;
+
+    RouterOptions m_opt;
+    int m_pitch = 10;
+    int m_ox = 0, m_oy = 0;          // 格点 (0,0) 的像素坐标
+    int m_w = 0, m_h = 0;
+
+    std::vector<uint16_t> m_block;   // 覆盖该格的元件数
+    std::vector<uint16_t> m_pin;     // 落在该格的引脚数
+    std::vector<uint16_t> m_hUse;    // 经过该格的水平导线数
+    std::vector<uint16_t> m_vUse;    // 经过该格的竖直导线数
+    std::vector<uint16_t> m_vtxUse;  // 以该格为顶点（端点/拐点）的导线数
+
+    // 搜索窗口内的状态（格 × 4 个方向），用 stamp 免清零
+    std::vector<int> m_g, m_parent;
+    std::vector<uint32_t> m_seen;
+    uint32_t m_searchId = 0;
+    std::vector<uint32_t> m_srcMark; // 窗口内的起点格标记（同样按 m_searchId）
+
+    long long m_budget = 0;          // 当前搜索剩余的出堆次数
+    RouterStats m_stats;
+};
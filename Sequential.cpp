@@ -0,0 +1,150 @@
+﻿// Sequential.cpp
+#include "Sequential.h"
+
+#include <wx/graphics.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr double kPinLen = 15.0;    // 引脚短线长度
+    constexpr double kPinPitch = 20.0;  // 引脚间距
+}
+
+BlockComponent::BlockComponent(wxPoint center, ComponentType type, double halfW)
+    : Component(center, type), m_halfW(halfW)
+{
+}
+
+double BlockComponent::HalfH() const
+{
+    const int rows = std::max<int>({ 1, (int)InputLabels().size(), (int)OutputLabels().size() });
+    return (rows * kPinPitch / 2.0 + 10.0) * scale;
+}
+
+void BlockComponent::drawSelf(wxMemoryDC& memDC) {
+    wxGraphicsContext* gc = wxGraphicsContext::Create(memDC);
+    if (!gc) return;
+
+    gc->SetPen(wxPen(wxColour(0, 0, 0), 2));
+    gc->SetBrush(*wxWHITE_BRUSH);
+
+    const double halfW = m_halfW * scale;
+    const double halfH = HalfH();
+
+#if wxCHECK_VERSION(3,1,0)
+    gc->DrawRoundedRectangle(m_center.x - halfW, m_center.y - halfH, 2 * halfW, 2 * halfH, 4.0 * scale);
+#else
+    wxGraphicsPath rect = gc->CreatePath();
+    rect.AddRectangle(m_center.x - halfW, m_center.y - halfH, 2 * halfW, 2 * halfH);
+    gc->StrokePath(rect);
+#endif
+
+    const auto pins = GetPins();
+    const auto ins = InputLabels();
+    const auto outs = OutputLabels();
+    const int nIn = (int)ins.size();
+
+    // 引脚短线
+    for (int k = 0; k < (int)pins.size(); ++k) {
+        const double tipX = (k < nIn) ? m_center.x - halfW : m_center.x + halfW;
+        gc->StrokeLine(pins[k].x, pins[k].y, tipX, pins[k].y);
+    }
+
+    // 时钟输入：边沿触发三角
+    const int clk = ClockInput();
+    if (clk >= 0 && clk < nIn) {
+        const double x = m_center.x - halfW, y = pins[clk].y, s = 6.0 * scale;
+        gc->StrokeLine(x, y - s, x + s, y);
+        gc->StrokeLine(x + s, y, x, y + s);
+    }
+
+    // 引脚名 + 标题
+    gc->SetFont(wxFontInfo(int(std::max(5.0, 7.0 * scale))).Family(wxFONTFAMILY_DEFAULT), *wxBLACK);
+    double tw = 0, th = 0, descent = 0, extlead = 0;
+    for (int k = 0; k < nIn; ++k) {
+        if (ins[k].empty()) continue;
+        gc->GetTextExtent(ins[k], &tw, &th, &descent, &extlead);
+        gc->DrawText(ins[k], m_center.x - halfW + 4 * scale, pins[k].y - th / 2);
+    }
+    for (int k = 0; k < (int)outs.size(); ++k) {
+        if (outs[k].empty()) continue;
+        gc->GetTextExtent(outs[k], &tw, &th, &descent, &extlead);
+        gc->DrawText(outs[k], m_center.x + halfW - 4 * scale - tw, pins[nIn + k].y - th / 2);
+    }
+    const wxString title = Title();
+    if (!title.empty()) {
+        gc->SetFont(wxFontInfo(int(std::max(6.0, 8.0 * scale))).Family(wxFONTFAMILY_DEFAULT), *wxBLACK);
+        gc->GetTextExtent(title, &tw, &th, &descent, &extlead);
+        gc->DrawText(title, m_center.x - tw / 2, m_center.y - halfH + 2 * scale);
+    }
+    DrawGlyph(gc);
+
+    if (m_isSelected) {
+        gc->SetPen(wxPen(wxColour(128, 128, 128), 2));
+        for (int j = 0; j < 4; ++j)
+            gc->DrawEllipse(m_BoundaryPoints[j].x - 4, m_BoundaryPoints[j].y - 4, 8, 8);
+    }
+
+    delete gc;
+}
+
+bool BlockComponent::Isinside(const wxPoint& p) const {
+    const int left = m_BoundaryPoints[0].x;
+    const int top = m_BoundaryPoints[0].y;
+    const int right = m_BoundaryPoints[2].x;
+    const int bottom = m_BoundaryPoints[1].y;
+    return (p.x >= left && p.x <= right && p.y >= top && p.y <= bottom);
+}
+
+void BlockComponent::UpdateGeometry() {
+    const int halfW = int(m_halfW * scale);
+    const int halfH = int(HalfH());
+    m_BoundaryPoints[0] = wxPoint(m_center.x - halfW, m_center.y - halfH);
+    m_BoundaryPoints[1] = wxPoint(m_center.x - halfW, m_center.y + halfH);
+    m_BoundaryPoints[2] = wxPoint(m_center.x + halfW, m_center.y - halfH);
+    m_BoundaryPoints[3] = wxPoint(m_center.x + halfW, m_center.y + halfH);
+}
+
+std::vector<wxPoint> BlockComponent::GetPins() const {
+    const int nIn = (int)InputLabels().size(), nOut = (int)OutputLabels().size();
+    std::vector<wxPoint> pins;
+    pins.reserve(nIn + nOut);
+    const int inX = int(std::lround(m_center.x - (m_halfW + kPinLen) * scale));
+    const int outX = int(std::lround(m_center.x + (m_halfW + kPinLen) * scale));
+    auto rowY = [&](int k, int n) { return int(std::lround(m_center.y + (k - (n - 1) / 2.0) * kPinPitch * scale)); };
+    for (int k = 0; k < nIn; ++k) pins.emplace_back(inX, rowY(k, nIn));
+    for (int k = 0; k < nOut; ++k) pins.emplace_back(outX, rowY(k, nOut));
+    return pins;
+}
+
+// ============ 时钟源 ============
+void ClockSource::DrawGlyph(wxGraphicsContext* gc) const {
+    const double w = 10.0 * scale, h = 6.0 * scale;
+    const double x = m_center.x - 1.5 * w, y = m_center.y;
+    wxGraphicsPath wave = gc->CreatePath();
+    wave.MoveToPoint(x, y + h);
+    wave.AddLineToPoint(x + w / 2, y + h);
+    wave.AddLineToPoint(x + w / 2, y - h);
+    wave.AddLineToPoint(x + 1.5 * w, y - h);
+    wave.AddLineToPoint(x + 1.5 * w, y + h);
+    wave.AddLineToPoint(x + 2.5 * w, y + h);
+    wave.AddLineToPoint(x + 2.5 * w, y - h);
+    wave.AddLineToPoint(x + 3 * w, y - h);
+    gc->StrokePath(wave);
+}
+
+// ============ 寄存器 ============
+std::vector<wxString> RegisterComp::InputLabels() const {
+    std::vector<wxString> v;
+    v.reserve(Bits() + 1);
+    for (int b = 0; b < Bits(); ++b) v.push_back(wxString::Format("D%d", b));
+    v.push_back("");   // CLK
+    return v;
+}
+
+std::vector<wxString> RegisterComp::OutputLabels() const {
+    std::vector<wxString> v;
+    v.reserve(Bits());
+    for (int b = 0; b < Bits(); ++b) v.push_back(wxString::Format("Q%d", b));
+    return v;
+}
@@ -0,0 +1,90 @@
+﻿// Sequential.h
+#pragma once
+#include <vector>
+#include "Component.h"
+
+class wxGraphicsContext;
+
+// ==========================================================
+//  时序元件：时钟源、D/JK 触发器、D 锁存器、N 位寄存器
+//  统一画成方框（与译码器同风格）：左侧输入、右侧输出，引脚间距 20，
+//  以中心为轴对称排列；时钟输入画一个小三角
+//  引脚顺序输入在前、输出在后，与 LogicKernel 的约定一致
+// ==========================================================
+
+class BlockComponent : public Component {
+public:
+    BlockComponent(wxPoint center, ComponentType type, double halfW = 45.0);
+
+    void drawSelf(wxMemoryDC& memDC) override;
+    bool Isinside(const wxPoint& p) const override;
+    void UpdateGeometry() override;
+    std::vector<wxPoint> GetPins() const override;
+
+protected:
+    virtual wxString Title() const = 0;
+    virtual std::vector<wxString> InputLabels() const = 0;
+    virtual std::vector<wxString> OutputLabels() const = 0;
+    virtual int ClockInput() const { return -1; }            // 画三角的输入下标
+    virtual void DrawGlyph(wxGraphicsContext* /*gc*/) const {}   // 方框内的附加图形
+
+    double HalfH() const;
+
+    double m_halfW;
+};
+
+// ---------- 时钟源 ----------
+class ClockSource : public BlockComponent {
+public:
+    explicit ClockSource(wxPoint center) : BlockComponent(center, CLOCK, 25.0) { UpdateGeometry(); }
+protected:
+    wxString Title() const override { return ""; }
+    std::vector<wxString> InputLabels() const override { return {}; }
+    std::vector<wxString> OutputLabels() const override { return { "" }; }
+    void DrawGlyph(wxGraphicsContext* gc) const override;   // 方波
+};
+
+// ---------- D 触发器 ----------
+class DFlipFlop : public BlockComponent {
+public:
+    explicit DFlipFlop(wxPoint center) : BlockComponent(center, DFF) { UpdateGeometry(); }
+protected:
+    wxString Title() const override { return "DFF"; }
+    std::vector<wxString> InputLabels() const override { return { "D", "" }; }
+    std::vector<wxString> OutputLabels() const override { return { "Q", "Q'" }; }
+    int ClockInput() const override { return 1; }
+};
+
+// ---------- JK 触发器 ----------
+class JKFlipFlop : public BlockComponent {
+public:
+    explicit JKFlipFlop(wxPoint center) : BlockComponent(center, JKFF) { UpdateGeometry(); }
+protected:
+    wxString Title() const override { return "JK"; }
+    std::vector<wxString> InputLabels() const override { return { "J", "", "K" }; }
+    std::vector<wxString> OutputLabels() const override { return { "Q", "Q'" }; }
+    int ClockInput() const override { return 1; }
+};
+
+// ---------- D 锁存器 ----------
+class DLatchComp : public BlockComponent {
+public:
+    explicit DLatchComp(wxPoint center) : BlockComponent(center, DLATCH) { UpdateGeometry(); }
+protected:
+    wxString Title() const override { return "LATCH"; }
+    std::vector<wxString> InputLabels() const override { return { "D", "EN" }; }
+    std::vector<wxString> OutputLabels() const override { return { "Q", "Q'" }; }
+};
+
+// ---------- N 位寄存器 ----------
+class RegisterComp : public BlockComponent {
+public:
+    static constexpr int MAX_WIDTH = 32;
+    RegisterComp(wxPoint center, int bits) : BlockComponent(center, REGISTER) { width = bits; UpdateGeometry(); }
+    int Bits() const { return width < 1 ? 1 : (width > MAX_WIDTH ? MAX_WIDTH : width); }
+protected:
+    wxString Title() const override { return wxString::Format("REG%d", Bits()); }
+    std::vector<wxString> InputLabels() const override;    // D0..Dn-1, CLK
+    std::vector<wxString> OutputLabels() const override;   // Q0..Qn-1
+    int ClockInput() const override { return Bits(); }
+};
@@ -0,0 +1,572 @@
+﻿// SimBench.cpp
+// ==========================================================
+//  性能基准（不依赖 wx）：在合成设计上测量各核心环节的吞吐量与内存
+//  用于跨提交比较；结果 JSON 与 Google Benchmark 的 --benchmark_out 格式一致，
+//  现成的 compare.py 等工具可直接比对两次结果
+//
+//  基准（名字为 <环节>/<拓扑>/<门数>）：
+//    Compile        网表 → 仿真引擎（BuildNetlist 的编译部分）
+//    Extract        几何连通性提取（BuildNetlist 的几何部分；Layered 用合成画布的真实连线，其余由网表合成引脚/折线）
+//    Step           随机翻转一个输入后稳定一次（每秒步数）
+//    JsonSave/Load  网表节的 JSON 序列化与反序列化（SaveToJson / LoadFromJson 的网表部分）
+//    IndexBuild     元件包围盒建空间索引
+//    HitTest        随机点命中测试（每秒查询数）
+//    ParseBookShelf/<单元数>  BookShelf .nodes/.nets 解析（每秒字节数）
+//  拓扑见 DesignGen.h / SynthBoard.h；规模 100、1k、10k、100k、1M，不超过 --max-gates
+//
+//  用法：simbench [--max-gates N] [--min-time 秒] [--filter 正则] [--seed N] [--out 结果.json]
+//  Linux 下直接编译：
+//    g++ -std=c++17 -O2 -I. SimBench.cpp DesignGen.cpp SynthBoard.cpp SimNetlist.cpp NetlistIO.cpp SimEngine.cpp LogicKernel.cpp
+//        BookShelfImporter.cpp BookShelfExporter.cpp Connectivity.cpp SpatialIndex.cpp json/jsoncpp.cpp -pthread -o simbench
+// ==========================================================
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include <json/json.h>
+#include "BookShelfImporter.h"
+#include "Connectivity.h"
+#include "DesignGen.h"
+#include "NetlistIO.h"
+#include "SimEngine.h"
+#include "SimNetlist.h"
+#include "SpatialIndex.h"
+#include "SynthBoard.h"
+
+namespace {
+
+    struct Options {
+        long long maxGates = 100000;
+        double minTime = 0.2;
+        std::string filter;
+        unsigned seed = 1;
+        std::string out;
+    };
+
+    void Usage()
+    {
+        std::fprintf(stderr, "用法: simbench [--max-gates N] [--min-time 秒] [--filter 正则] [--seed N] [--out 结果.json]\n");
+    }
+
+    bool ParseArgs(int argc, char** argv, Options& o)
+    {
+        for (int i = 1; i < argc; ++i) {
+            const std::string a = argv[i];
+            const bool hasVal = i + 1 < argc;
+            if (a == "--max-gates" && hasVal)     o.maxGates = std::atoll(argv[++i]);
+            else if (a == "--min-time" && hasVal) o.minTime = std::atof(argv[++i]);
+            else if (a == "--filter" && hasVal)   o.filter = argv[++i];
+            else if (a == "--seed" && hasVal)     o.seed = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+            else if (a == "--out" && hasVal)      o.out = argv[++i];
+            else return false;
+        }
+        try { std::regex check(o.filter); }
+        catch (const std::regex_error&) { std::fprintf(stderr, "--filter 不是合法的正则: %s\n", o.filter.c_str()); return false; }
+        return o.maxGates > 0 && o.minTime > 0;
+    }
+
+    // ===== 进程内存与 CPU 时间 =====
+    struct MemInfo { size_t rss = 0, peakRss = 0; };
+
+    MemInfo ProcessMemory()
+    {
+        MemInfo m;
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS pmc{};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+            m.rss = pmc.WorkingSetSize;
+            m.peakRss = pmc.PeakWorkingSetSize;
+        }
+#else
+        rusage ru{};
+        if (getrusage(RUSAGE_SELF, &ru) == 0) m.peakRss = size_t(ru.ru_maxrss) * 1024;   // Linux 以 KB 计
+        if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+            unsigned long long size = 0, resident = 0;
+            if (std::fscanf(f, "%llu %llu", &size, &resident) == 2) m.rss = size_t(resident) * size_t(sysconf(_SC_PAGESIZE));
+            std::fclose(f);
+        }
+#endif
+        return m;
+    }
+
+    // Windows 的 std::clock 是墙钟时间，改用 GetProcessTimes
+    double ProcessCpuSeconds()
+    {
+#ifdef _WIN32
+        FILETIME c, e, k, u;
+        if (!GetProcessTimes(GetCurrentProcess(), &c, &e, &k, &u)) return 0.0;
+        auto toSec = [](const FILETIME& f) { return ((uint64_t(f.dwHighDateTime) << 32) | f.dwLowDateTime) * 1e-7; };
+        return toSec(k) + toSec(u);
+#else
+        return double(std::clock()) / CLOCKS_PER_SEC;
+#endif
+    }
+
+    // ===== 计时框架 =====
+    // body 执行一次迭代并返回本次处理的条目数（门、步、查询、字节……）
+    struct BenchResult {
+        std::string name;
+        long long iterations = 0;
+        double realSeconds = 0, cpuSeconds = 0;
+        double items = 0;                        // 全部迭代合计
+        bool itemsAreBytes = false;
+        std::map<std::string, double> counters;  // 附加计数（规模、内存……）
+    };
+
+    class Harness {
+    public:
+        explicit Harness(const Options& o) : m_opt(o)
+        {
+            if (!o.filter.empty()) m_filter = std::regex(o.filter);
+        }
+
+        bool Wanted(const std::string& name) const { return m_opt.filter.empty() || std::regex_search(name, m_filter); }
+
+        // 和 Google Benchmark 一样：迭代数按上一轮耗时放大，直到一轮不短于 minTime
+        BenchResult& Run(const std::string& name, const std::function<double()>& body, bool itemsAreBytes = false)
+        {
+            using clock = std::chrono::steady_clock;
+            BenchResult r;
+            r.name = name;
+            r.itemsAreBytes = itemsAreBytes;
+            for (long long n = 1;;) {
+                double items = 0;
+                const double cpu0 = ProcessCpuSeconds();
+                const auto t0 = clock::now();
+                for (long long i = 0; i < n; ++i) items += body();
+                const double sec = std::chrono::duration<double>(clock::now() - t0).count();
+                const double cpu = ProcessCpuSeconds() - cpu0;
+                if (sec >= m_opt.minTime || n >= 1000000000LL) {
+                    r.iterations = n;
+                    r.realSeconds = sec;
+                    r.cpuSeconds = cpu;
+                    r.items = items;
+                    break;
+                }
+                const double grow = sec > 0 ? m_opt.minTime * 1.4 / sec : 10.0;
+                n = std::max(n + 1, (long long)(n * std::min(10.0, std::max(1.0, grow))));
+            }
+            const MemInfo m = ProcessMemory();
+            r.counters["rss_bytes"] = (double)m.rss;
+            r.counters["peak_rss_bytes"] = (double)m.peakRss;
+            m_results.push_back(r);
+            Print(m_results.back());
+            return m_results.back();
+        }
+
+        // 在最近一条结果上补记计数
+        void Counter(const std::string& key, double v) { m_results.back().counters[key] = v; }
+
+        const std::vector<BenchResult>& Results() const { return m_results; }
+
+    private:
+        static void Print(const BenchResult& r)
+        {
+            const double perIter = r.realSeconds / r.iterations;
+            const double rate = r.realSeconds > 0 ? r.items / r.realSeconds : 0;
+            char time[32], rateStr[32];
+            if (perIter >= 1e-3)      std::snprintf(time, sizeof(time), "%.3f ms", perIter * 1e3);
+            else if (perIter >= 1e-6) std::snprintf(time, sizeof(time), "%.3f us", perIter * 1e6);
+            else                      std::snprintf(time, sizeof(time), "%.1f ns", perIter * 1e9);
+            if (r.itemsAreBytes) std::snprintf(rateStr, sizeof(rateStr), "%.1f MB/s", rate / (1024.0 * 1024.0));
+            else                 std::snprintf(rateStr, sizeof(rateStr), "%.3g/s", rate);
+            std::printf("%-34s %14s %12lld %16s %10.1f MB\n", r.name.c_str(), time, r.iterations, rateStr,
+                r.counters.at("peak_rss_bytes") / (1024.0 * 1024.0));
+            std::fflush(stdout);
+        }
+
+        const Options& m_opt;
+        std::regex m_filter;
+        std::vector<BenchResult> m_results;
+    };
+
+    Json::Value ResultsJson(const std::vector<BenchResult>& results, const char* exe)
+    {
+        Json::Value root;
+        Json::Value& ctx = root["context"];
+        char date[64];
+        const std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+        ctx["date"] = date;
+        ctx["executable"] = exe;
+        ctx["num_cpus"] = (int)std::thread::hardware_concurrency();
+#ifdef NDEBUG
+        ctx["library_build_type"] = "release";
+#else
+        ctx["library_build_type"] = "debug";
+#endif
+
+        Json::Value& arr = root["benchmarks"];
+        arr = Json::Value(Json::arrayValue);
+        for (const auto& r : results) {
+            Json::Value b;
+            b["name"] = r.name;
+            b["run_name"] = r.name;
+            b["run_type"] = "iteration";
+            b["repetitions"] = 1;
+            b["iterations"] = (Json::Int64)r.iterations;
+            b["real_time"] = r.realSeconds / r.iterations * 1e9;
+            b["cpu_time"] = r.cpuSeconds / r.iterations * 1e9;
+            b["time_unit"] = "ns";
+            if (r.realSeconds > 0 && r.items > 0) b[r.itemsAreBytes ? "bytes_per_second" : "items_per_second"] = r.items / r.realSeconds;
+            for (const auto& kv : r.counters) b[kv.first] = kv.second;
+            arr.append(b);
+        }
+        return root;
+    }
+
+    // ===== 由网表合成画布几何 =====
+    // 单元按方阵排布，引脚在单元左右边；网内相邻引脚之间拉 L 形折线
+    // 与 DrawBoard::BuildConnectivity 喂给 Connectivity 的数据形态一致
+    // 端口紧挨着使用它的单元摆放：否则几万个输入端口挤在左上角，连线横穿全图，测的是不现实的长线
+    struct Geometry {
+        struct P { int x, y; };
+        struct Box { int x0, y0, x1, y1; };
+        std::vector<Box> cells;
+        std::vector<P> pins;                  // 按 (单元, 引脚) 顺序
+        std::vector<PinRef> refs;
+        std::vector<std::vector<P>> wires;
+        P extent{ 1, 1 };                     // 包围全部单元的右下角（左上为原点）
+    };
+
+    constexpr int kPitch = 80, kCellSize = 40;
+
+    Geometry MakeGeometry(const SimNetlist& nl)
+    {
+        Geometry g;
+        const int N = nl.NumCells();
+        const int side = std::max(1, (int)std::ceil(std::sqrt((double)N)));
+        g.cells.reserve(N);
+        std::vector<PinRef> driver;
+        nl.Drivers(driver);
+        std::vector<std::vector<int>> endsOf(nl.NumNets());
+        for (int c : nl.Outputs()) {
+            if (nl.CellAt(c).numPins > 0 && nl.PinNet(c, 0) >= 0) endsOf[nl.PinNet(c, 0)].push_back(c);
+        }
+        std::vector<int> slot(N, -1);
+        int next = 0;
+        auto place = [&](int c) { if (slot[c] < 0) slot[c] = next++; };
+        for (int i = 0; i < N; ++i) {
+            const ComponentType t = nl.CellAt(i).type;
+            if (t == NODE_START || t == NODE_END) continue;
+            for (int p = 0; p < nl.CellAt(i).numPins; ++p) {
+                const int net = nl.PinNet(i, p);
+                if (net < 0) continue;
+                if (!nl.IsOutputPin(i, p)) {
+                    const int d = driver[net].compIdx;
+                    if (d >= 0 && nl.CellAt(d).type == NODE_START) place(d);
+                }
+            }
+            place(i);
+            for (int p = nl.CellAt(i).nIn; p < nl.CellAt(i).numPins; ++p) {
+                const int net = nl.PinNet(i, p);
+                if (net >= 0) for (int e : endsOf[net]) place(e);
+            }
+        }
+        for (int i = 0; i < N; ++i) place(i);
+
+        std::vector<std::vector<int>> netPins(nl.NumNets());
+        for (int i = 0; i < N; ++i) {
+            const int x = (slot[i] % side) * kPitch, y = (slot[i] / side) * kPitch;
+            g.cells.push_back({ x, y, x + kCellSize, y + kCellSize });
+            const SimNetlist::Cell& c = nl.CellAt(i);
+            int nIn = 0, nOut = 0;
+            for (int p = 0; p < c.numPins; ++p) (nl.IsOutputPin(i, p) ? nOut : nIn)++;
+            int in = 0, out = 0;
+            for (int p = 0; p < c.numPins; ++p) {
+                const bool isOut = nl.IsOutputPin(i, p);
+                const int k = isOut ? out++ : in++;
+                const int cnt = isOut ? nOut : nIn;
+                const int py = y + (k + 1) * kCellSize / (cnt + 1);
+                const int pin = (int)g.pins.size();
+                g.pins.push_back({ isOut ? x + kCellSize : x, py });
+                g.refs.push_back({ i, p });
+                const int net = nl.PinNet(i, p);
+                if (net >= 0) netPins[net].push_back(pin);
+            }
+        }
+        // 多引脚网按位置串成一条链：高扇出网画成从一点发出的放射线时几千条线段互相重叠，
+        // 连通性提取退化成平方级，画布上也没人这么连
+        for (auto& pins : netPins) {
+            std::sort(pins.begin(), pins.end(), [&](int a, int b) {
+                return g.pins[a].y != g.pins[b].y ? g.pins[a].y < g.pins[b].y : g.pins[a].x < g.pins[b].x;
+            });
+            for (size_t k = 1; k < pins.size(); ++k) {
+                const Geometry::P a = g.pins[pins[k - 1]], b = g.pins[pins[k]];
+                g.wires.push_back({ a, { b.x, a.y }, b });
+            }
+        }
+        g.extent = { side * kPitch, side * kPitch };
+        return g;
+    }
+
+    // 分层合成画布自带真实几何（T 形分支、NODE_BASIC 扇出），直接用
+    Geometry BoardGeometry(const synth::Board& b)
+    {
+        Geometry g;
+        std::vector<synth::BoardPoint> pins;
+        for (int i = 0; i < (int)b.cells.size(); ++i) {
+            synth::BoardPoint lo, hi;
+            synth::CellBox(b.cells[i], lo, hi);
+            g.cells.push_back({ lo.x, lo.y, hi.x, hi.y });
+            g.extent = { std::max(g.extent.x, hi.x), std::max(g.extent.y, hi.y) };
+            synth::CellPins(b.cells[i], pins);
+            for (int p = 0; p < (int)pins.size(); ++p) {
+                g.pins.push_back({ pins[p].x, pins[p].y });
+                g.refs.push_back({ i, p });
+            }
+        }
+        g.wires.reserve(b.wires.size());
+        for (const auto& w : b.wires) {
+            g.wires.emplace_back();
+            for (const auto& pt : w) g.wires.back().push_back({ pt.x, pt.y });
+        }
+        return g;
+    }
+
+    // ===== 各基准 =====
+    struct Design {
+        synth::Topology topology;
+        int gates = 0;
+        std::string suffix;   // "/<拓扑>/<门数>"
+        SimNetlist nl;
+        std::unique_ptr<synth::Board> board;   // 仅分层拓扑：网表取自其中，几何也用它的
+
+        Geometry Geo() const { return board ? BoardGeometry(*board) : MakeGeometry(nl); }
+    };
+
+    void BenchDesign(Harness& h, Design& d, unsigned seed)
+    {
+        const SimNetlist& nl = d.nl;
+        auto name = [&](const char* what) { return std::string(what) + d.suffix; };
+        auto scale = [&]() {
+            h.Counter("gates", d.gates);
+            h.Counter("nets", nl.NumNets());
+        };
+
+        if (h.Wanted(name("Compile"))) {
+            SimEngine eng;
+            std::vector<int> cellOp;
+            h.Run(name("Compile"), [&] {
+                nl.Compile(eng, cellOp);
+                eng.Finalize();
+                return (double)d.gates;
+            });
+            scale();
+        }
+
+        if (h.Wanted(name("Extract"))) {
+            const Geometry g = d.Geo();
+            size_t verts = 0;
+            for (const auto& w : g.wires) verts += w.size();
+            Connectivity conn;
+            h.Run(name("Extract"), [&] {
+                conn.Clear();
+                conn.Reserve(g.pins.size(), verts);
+                for (size_t k = 0; k < g.pins.size(); ++k) conn.AddPin(g.refs[k], g.pins[k].x, g.pins[k].y);
+                for (const auto& w : g.wires) conn.AddWire(w);
+                conn.Extract();
+                return (double)g.pins.size();
+            });
+            scale();
+            h.Counter("pins", (double)g.pins.size());
+            h.Counter("wires", (double)g.wires.size());
+            if (conn.NumNets() == 0) std::fprintf(stderr, "警告: %s 没有提取出网\n", name("Extract").c_str());
+        }
+
+        if (h.Wanted(name("Step"))) {
+            SimEngine eng;
+            std::vector<int> cellOp;
+            nl.Compile(eng, cellOp);
+            eng.Finalize();
+            eng.Step();
+            std::vector<int> srcOps;
+            std::vector<char> level;
+            for (int c : nl.Inputs()) {
+                srcOps.push_back(cellOp[c]);
+                level.push_back(0);
+            }
+            uint32_t rng = seed * 2654435761u + 1;
+            h.Run(name("Step"), [&] {
+                if (!srcOps.empty()) {
+                    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;   // xorshift32
+                    const size_t k = rng % srcOps.size();
+                    level[k] ^= 1;
+                    eng.SetSource(srcOps[k], level[k] != 0);
+                }
+                eng.Step();
+                return 1.0;
+            });
+            scale();
+        }
+
+        if (h.Wanted(name("JsonSave")) || h.Wanted(name("JsonLoad"))) {
+            Json::StreamWriterBuilder wb;
+            wb["indentation"] = "";
+            std::string text;
+            if (h.Wanted(name("JsonSave"))) {
+                h.Run(name("JsonSave"), [&] {
+                    text = Json::writeString(wb, netio::ToJson(nl));
+                    return (double)text.size();
+                }, true);
+                scale();
+            }
+            else {
+                text = Json::writeString(wb, netio::ToJson(nl));
+            }
+            if (h.Wanted(name("JsonLoad"))) {
+                Json::CharReaderBuilder rb;
+                std::unique_ptr<Json::CharReader> reader(rb.newCharReader());
+                const netio::MacroTable macros;
+                SimNetlist back;
+                h.Run(name("JsonLoad"), [&] {
+                    Json::Value v;
+                    std::string perr, err;
+                    if (!reader->parse(text.data(), text.data() + text.size(), &v, &perr) || !netio::FromJson(v, macros, back, err)) {
+                        std::fprintf(stderr, "JSON 往返失败: %s%s\n", perr.c_str(), err.c_str());
+                        std::exit(2);
+                    }
+                    return (double)text.size();
+                }, true);
+                scale();
+            }
+            h.Counter("json_bytes", (double)text.size());
+        }
+
+        if (h.Wanted(name("IndexBuild")) || h.Wanted(name("HitTest"))) {
+            const Geometry g = d.Geo();
+            SpatialIndex idx;
+            auto build = [&] {
+                idx.Clear();
+                for (int i = 0; i < (int)g.cells.size(); ++i) idx.Insert(i, g.cells[i].x0, g.cells[i].y0, g.cells[i].x1, g.cells[i].y1);
+                return (double)g.cells.size();
+            };
+            if (h.Wanted(name("IndexBuild"))) {
+                h.Run(name("IndexBuild"), build);
+                scale();
+            }
+            else {
+                build();
+            }
+            if (h.Wanted(name("HitTest"))) {
+                uint32_t rng = seed * 2246822519u + 7;
+                std::vector<int> hits;
+                size_t found = 0;
+                // 每次迭代 256 个点，与鼠标移动时的命中测试相当（±2 像素容差）
+                h.Run(name("HitTest"), [&] {
+                    for (int q = 0; q < 256; ++q) {
+                        rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+                        const int x = int(rng % unsigned(g.extent.x)), y = int((rng >> 8) % unsigned(g.extent.y));
+                        hits.clear();
+                        idx.Query(x - 2, y - 2, x + 2, y + 2, hits);
+                        found += hits.size();
+                    }
+                    return 256.0;
+                });
+                scale();
+                h.Counter("hits", (double)found);
+            }
+        }
+    }
+
+    void BenchBookShelf(Harness& h, long long cells, unsigned seed)
+    {
+        const std::string name = "ParseBookShelf/" + std::to_string(cells);
+        if (!h.Wanted(name)) return;
+        const std::filesystem::path dir = std::filesystem::temp_directory_path() / "simbench_bookshelf";
+        std::filesystem::create_directories(dir);
+        // 网数与单元数相同，每网 3 个引脚：与门级网表的平均扇出相近
+        const auto files = bookshelf::WriteSyntheticBookShelf(dir, "bench" + std::to_string(cells), (size_t)cells, (size_t)cells, 3, seed);
+        const double bytes = double(std::filesystem::file_size(files.first) + std::filesystem::file_size(files.second));
+        size_t pins = 0;
+        h.Run(name, [&] {
+            const bookshelf::BSDesign d = bookshelf::ParseBookShelf(files.first, files.second);
+            pins = d.pins.size();
+            return bytes;
+        }, true);
+        h.Counter("cells", (double)cells);
+        h.Counter("pins", (double)pins);
+        std::error_code ec;
+        std::filesystem::remove(files.first, ec);
+        std::filesystem::remove(files.second, ec);
+    }
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options o;
+    if (!ParseArgs(argc, argv, o)) { Usage(); return 2; }
+    Harness h(o);
+    try {
+        static const char* kWhat[] = { "Compile", "Extract", "Step", "JsonSave", "JsonLoad", "IndexBuild", "HitTest" };
+        static const synth::Topology kTopologies[] = {
+            synth::Topology::RandomDag, synth::Topology::AdderChain, synth::Topology::GridMesh, synth::Topology::DecoderTree,
+            synth::Topology::Layered };
+
+        std::printf("%-34s %14s %12s %16s %13s\n", "基准", "每次迭代", "迭代数", "吞吐量", "峰值内存");
+        for (long long n = 100; n <= o.maxGates && n <= 1000000; n *= 10) {
+            for (synth::Topology t : kTopologies) {
+                const std::string suffix = std::string("/") + synth::TopologyName(t) + "/" + std::to_string(n);
+                bool any = false;
+                for (const char* w : kWhat) any = any || h.Wanted(w + suffix);
+                if (!any) continue;   // 整个设计都被过滤掉时不生成
+
+                Design d;
+                d.topology = t;
+                d.suffix = suffix;
+                synth::GenOptions g;
+                g.topology = t;
+                g.gates = (int)n;
+                g.seed = o.seed;
+                if (t == synth::Topology::Layered) {
+                    d.board = std::make_unique<synth::Board>();
+                    d.gates = synth::GenerateBoard(g, *d.board);
+                    d.nl = std::move(d.board->netlist);
+                }
+                else {
+                    d.gates = synth::Generate(g, d.nl);
+                }
+                BenchDesign(h, d, o.seed);
+            }
+            BenchBookShelf(h, n, o.seed);
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "基准失败: %s\n", e.what());
+        return 2;
+    }
+
+    if (!o.out.empty()) {
+        std::ofstream ofs(o.out, std::ios::binary);
+        if (!ofs.is_open()) { std::fprintf(stderr, "无法写入: %s\n", o.out.c_str()); return 2; }
+        Json::StreamWriterBuilder wb;
+        wb["indentation"] = "  ";
+        ofs << Json::writeString(wb, ResultsJson(h.Results(), argv[0])) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,300 @@
+﻿// SimCli.cpp
+// ==========================================================
+//  命令行仿真（不依赖 wx）：读入设计，按向量文件驱动输入，打印或比对输出
+//  用于无界面服务器上的批量回归
+//
+//  用法：simcli <设计.json | 设计.aux | 设计.nodes> [-v 向量文件] [-c 周期数] [-q]
+//    -v  向量文件；省略时上电稳定后打印一次全部输出
+//    -c  每条向量施加后再跑的完整时钟周期数（默认 0：只稳定并处理边沿）
+//    -q  只报告不一致，不逐条打印
+//  向量文件（# 之后为注释）：
+//    in:  I0 I1 I2        输入列（默认全部输入端口，按端口顺序）
+//    out: O0 O1           输出列（默认全部输出端口）
+//    0 1 1 | 1 0x3f       一条向量：输入值；'|' 之后为期望输出（x 为不关心），省略时只打印
+//    run 10               连跑 10 个完整时钟周期
+//  输出值：单线 0/1，总线按网位宽打印十六进制；振荡的组合环及其组合扇出驱动的输出打印 x
+//  （与任何期望值都不一致），结束时在 stderr 列出振荡的环
+//  退出码：0 全部一致，1 有不一致或结束时仍有振荡的环，2 读入或格式错误
+//
+//  Linux 下直接编译：
+//    g++ -std=c++17 -O2 -I. SimCli.cpp SimNetlist.cpp NetlistIO.cpp SimEngine.cpp LogicKernel.cpp
+//        BookShelfImporter.cpp json/jsoncpp.cpp -pthread -o simcli
+// ==========================================================
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "LogicKernel.h"
+#include "NetlistIO.h"
+#include "SimEngine.h"
+#include "SimNetlist.h"
+
+namespace {
+
+    struct Options {
+        std::string design;
+        std::string vectors;
+        long long cycles = 0;
+        bool quiet = false;
+    };
+
+    void Usage()
+    {
+        std::fprintf(stderr, "用法: simcli <设计.json | 设计.aux | 设计.nodes> [-v 向量文件] [-c 周期数] [-q]\n");
+    }
+
+    bool ParseArgs(int argc, char** argv, Options& o)
+    {
+        for (int i = 1; i < argc; ++i) {
+            const std::string a = argv[i];
+            if (a == "-v" && i + 1 < argc)      o.vectors = argv[++i];
+            else if (a == "-c" && i + 1 < argc) o.cycles = std::atoll(argv[++i]);
+            else if (a == "-q")                 o.quiet = true;
+            else if (!a.empty() && a[0] != '-' && o.design.empty()) o.design = a;
+            else return false;
+        }
+        return !o.design.empty();
+    }
+
+    // "1" / "0x3f" / "12"；x 为不关心（只允许出现在期望输出里）
+    bool ParseValue(const std::string& s, uint64_t& v, bool& dontCare)
+    {
+        dontCare = (s == "x" || s == "X");
+        if (dontCare) return true;
+        if (s.empty()) return false;
+        char* end = nullptr;
+        v = std::strtoull(s.c_str(), &end, 0);
+        return end && *end == '\0';
+    }
+
+    std::string FormatValue(uint64_t v, int width)
+    {
+        if (width <= 1) return v ? "1" : "0";
+        char buf[24];
+        std::snprintf(buf, sizeof(buf), "0x%llx", (unsigned long long)v);
+        return buf;
+    }
+
+    // 编译好的设计 + 端口列
+    class Runner {
+    public:
+        bool Init(const SimNetlist& nl, std::string& err)
+        {
+            m_nl = &nl;
+            nl.Compile(m_engine, m_cellOp);
+            m_engine.Finalize();
+            m_opCell.assign(m_engine.NumOps(), -1);
+            for (int c = 0; c < (int)m_cellOp.size(); ++c) if (m_cellOp[c] >= 0) m_opCell[m_cellOp[c]] = c;
+            std::vector<char> conflict;
+            nl.ComputeWidths(m_netWidth, conflict);
+            m_inCols = nl.Inputs();
+            m_outCols = nl.Outputs();
+            if (m_outCols.empty()) { err = "设计没有终止节点（输出端口）"; return false; }
+            return true;
+        }
+
+        bool SetColumns(const std::vector<std::string>& names, bool input, std::string& err)
+        {
+            std::vector<int>& cols = input ? m_inCols : m_outCols;
+            cols.clear();
+            for (const auto& n : names) {
+                const int c = input ? m_nl->FindInput(n) : m_nl->FindOutput(n);
+                if (c < 0) { err = std::string(input ? "没有输入端口 " : "没有输出端口 ") + n; return false; }
+                cols.push_back(c);
+            }
+            return true;
+        }
+
+        const std::vector<int>& InCols() const { return m_inCols; }
+        const std::vector<int>& OutCols() const { return m_outCols; }
+        const std::string& NameOf(int cell) const { return m_nl->CellAt(cell).name; }
+
+        void SetInput(int col, bool v) { m_engine.SetSource(m_cellOp[m_inCols[col]], v); }
+        void Step(long long cycles)
+        {
+            m_engine.Step();
+            if (cycles > 0) m_engine.RunCycles(cycles);
+        }
+        void Run(long long cycles)
+        {
+            if (m_engine.HasClock()) m_engine.RunCycles(cycles);
+            else                     m_engine.Step();
+        }
+
+        int OutWidth(int col) const
+        {
+            const int n = OutNet(col);
+            return n >= 0 ? m_netWidth[n] : 1;
+        }
+        uint64_t Output(int col) const
+        {
+            return m_engine.NetWord(OutNet(col)) & logic::WidthMask(OutWidth(col));
+        }
+        bool OutputUnknown(int col) const { return m_engine.NetUnknown(OutNet(col)); }
+
+        // 振荡的环：每个环一行，列出单元名（无名时为 类型#下标）；返回是否有振荡的环
+        bool ReportLoops() const
+        {
+            std::vector<std::vector<int>> loops;
+            m_engine.OscillatingLoops(loops);
+            if (loops.empty()) return false;
+            std::fprintf(stderr, "警告: %zu 个组合环不收敛，已按 X 处理\n", loops.size());
+            for (size_t k = 0; k < loops.size(); ++k) {
+                std::string line;
+                for (int op : loops[k]) {
+                    const int c = m_opCell[op];
+                    if (c < 0) continue;
+                    const auto& cell = m_nl->CellAt(c);
+                    line += ' ';
+                    line += cell.name.empty() ? std::string(logic::TypeName(cell.type)) + "#" + std::to_string(c) : cell.name;
+                }
+                std::fprintf(stderr, "  环 %zu:%s\n", k + 1, line.c_str());
+            }
+            return true;
+        }
+
+    private:
+        int OutNet(int col) const
+        {
+            const int c = m_outCols[col];
+            return m_nl->CellAt(c).numPins > 0 ? m_nl->PinNet(c, 0) : -1;
+        }
+
+        const SimNetlist* m_nl = nullptr;
+        SimEngine m_engine;
+        std::vector<int> m_cellOp, m_opCell;
+        std::vector<int> m_netWidth;
+        std::vector<int> m_inCols, m_outCols;
+    };
+
+    void PrintHeader(const Runner& r)
+    {
+        std::string line = "#";
+        for (int c : r.InCols()) line += " " + r.NameOf(c);
+        line += " |";
+        for (int c : r.OutCols()) line += " " + r.NameOf(c);
+        std::puts(line.c_str());
+    }
+
+    std::string OutputsLine(const Runner& r)
+    {
+        std::string line;
+        for (int k = 0; k < (int)r.OutCols().size(); ++k) {
+            if (k) line += ' ';
+            line += r.OutputUnknown(k) ? std::string("x") : FormatValue(r.Output(k), r.OutWidth(k));
+        }
+        return line;
+    }
+
+    int RunVectors(Runner& r, const Options& o)
+    {
+        std::ifstream in(o.vectors);
+        if (!in.is_open()) { std::fprintf(stderr, "无法打开向量文件: %s\n", o.vectors.c_str()); return 2; }
+
+        bool headerDone = false;
+        long long vectors = 0, mismatches = 0;
+        std::string raw;
+        for (int lineNo = 1; std::getline(in, raw); ++lineNo) {
+            const size_t hash = raw.find('#');
+            std::string line = hash == std::string::npos ? raw : raw.substr(0, hash);
+            std::istringstream ss(line);
+            std::string first;
+            if (!(ss >> first)) continue;
+
+            auto fail = [&](const std::string& msg) {
+                std::fprintf(stderr, "%s:%d: %s\n", o.vectors.c_str(), lineNo, msg.c_str());
+                return 2;
+            };
+
+            if (first == "in:" || first == "out:") {
+                std::vector<std::string> names;
+                for (std::string n; ss >> n;) names.push_back(n);
+                std::string err;
+                if (!r.SetColumns(names, first == "in:", err)) return fail(err);
+                headerDone = false;   // 列变了，下一条向量前重打表头
+                continue;
+            }
+            if (first == "run") {
+                long long n = 0;
+                if (!(ss >> n) || n < 0) return fail("run 需要非负周期数");
+                r.Run(n);
+                continue;
+            }
+
+            // 向量：输入值 [| 期望输出]
+            std::vector<std::string> ins, exps;
+            bool afterBar = false;
+            for (std::string tok = first;;) {
+                if (tok == "|") afterBar = true;
+                else (afterBar ? exps : ins).push_back(tok);
+                if (!(ss >> tok)) break;
+            }
+            if (ins.size() != r.InCols().size())
+                return fail("输入值个数 " + std::to_string(ins.size()) + " 与输入列数 " + std::to_string(r.InCols().size()) + " 不符");
+            if (!exps.empty() && exps.size() != r.OutCols().size())
+                return fail("期望值个数 " + std::to_string(exps.size()) + " 与输出列数 " + std::to_string(r.OutCols().size()) + " 不符");
+
+            for (int k = 0; k < (int)ins.size(); ++k) {
+                uint64_t v = 0;
+                bool dc = false;
+                if (!ParseValue(ins[k], v, dc) || dc || v > 1) return fail("输入端口是单线，值只能为 0/1: " + ins[k]);
+                r.SetInput(k, v != 0);
+            }
+            r.Step(o.cycles);
+            ++vectors;
+
+            bool ok = true;
+            for (int k = 0; k < (int)exps.size(); ++k) {
+                uint64_t v = 0;
+                bool dc = false;
+                if (!ParseValue(exps[k], v, dc)) return fail("无法解析期望值: " + exps[k]);
+                if (dc || (!r.OutputUnknown(k) && (v & logic::WidthMask(r.OutWidth(k))) == r.Output(k))) continue;
+                ok = false;
+                std::fprintf(stderr, "%s:%d: %s 期望 %s，实际 %s\n", o.vectors.c_str(), lineNo, r.NameOf(r.OutCols()[k]).c_str(),
+                    exps[k].c_str(), r.OutputUnknown(k) ? "x" : FormatValue(r.Output(k), r.OutWidth(k)).c_str());
+            }
+            if (!ok) ++mismatches;
+
+            if (!o.quiet) {
+                if (!headerDone) { PrintHeader(r); headerDone = true; }
+                std::string outLine;
+                for (const auto& s : ins) outLine += s + " ";
+                outLine += "| " + OutputsLine(r);
+                std::puts(outLine.c_str());
+            }
+        }
+        const bool oscillating = r.ReportLoops();
+        std::fprintf(stderr, "向量 %lld 条，不一致 %lld 条\n", vectors, mismatches);
+        return mismatches || oscillating ? 1 : 0;
+    }
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options o;
+    if (!ParseArgs(argc, argv, o)) { Usage(); return 2; }
+
+    SimNetlist nl;
+    std::string err, warnings;
+    if (!netio::LoadDesign(o.design, nl, err, &warnings)) {
+        std::fprintf(stderr, "读入失败: %s\n", err.c_str());
+        return 2;
+    }
+    if (!warnings.empty()) std::fprintf(stderr, "警告: %s\n", warnings.c_str());
+
+    Runner r;
+    if (!r.Init(nl, err)) { std::fprintf(stderr, "%s\n", err.c_str()); return 2; }
+
+    if (o.vectors.empty()) {
+        r.Step(o.cycles);
+        PrintHeader(r);
+        std::puts(("| " + OutputsLine(r)).c_str());
+        return r.ReportLoops() ? 1 : 0;
+    }
+    return RunVectors(r, o);
+}
@@ -0,0 +1,689 @@
+﻿// SimEngine.cpp
+#include "SimEngine.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    constexpr int kMaxSettlePasses = 64;   // 组合环的迭代上限（与原仿真器一致）
+    constexpr int kMaxEdgeRounds = 64;     // 一次 Step 内连锁边沿的轮数上限
+    constexpr int kMaxIsolateRounds = 4;   // 一次 Settle 内隔离振荡环的轮数上限（上游变化可能让下游的环再起振）
+    constexpr size_t kMaxSeenPatterns = 8; // 每个环记住的振荡输入组合数
+
+    bool IsSourceType(ComponentType t) { return t == NODE_START || t == CLOCK; }
+}
+
+void SimEngine::Reset(int numNets)
+{
+    m_ops.clear();
+    m_pins.clear();
+    m_net.assign(std::max(0, numNets), 0);
+    m_state.clear();
+    m_comb.clear();
+    m_seq.clear();
+    m_clocks.clear();
+    m_prevClk.clear();
+    m_fired.clear();
+    m_cyclic = false;
+    m_cycles = 0;
+    m_stats = Stats();
+    m_inBuf.reset(); m_outBuf.reset(); m_qBuf.reset(); m_nextBuf.reset();
+    m_winBuf.reset(); m_woutBuf.reset();
+    m_readerStart.assign(m_net.size() + 1, 0);
+    m_readers.clear();
+    m_dirty.clear();
+    m_numDirty = 0;
+    m_dirtyLo = 0;
+    m_sccOf.clear();
+    m_sccStart.assign(1, 0);
+    m_sccPos.clear();
+    m_sccInStart.assign(1, 0);
+    m_sccIn.clear();
+    m_sccOutStart.assign(1, 0);
+    m_sccOut.clear();
+    m_sccOsc.clear();
+    m_sccCheck.clear();
+    m_sccSeen.clear();
+    m_netX.assign(m_net.size(), 0);
+    m_numX = 0;
+    m_numOsc = m_numCheck = 0;
+    m_watchLoops = false;
+}
+
+int SimEngine::AddOp(ComponentType t, const int* pinNets, int nIn, int nOut, const logic::Macro* macro, int width)
+{
+    Op op{ t, macro, (int)m_pins.size(), std::max(0, nIn), std::max(0, nOut), (int)m_state.size(), 0,
+        std::max(1, std::min(width, logic::kMaxBusWidth)), logic::IsWordOp(t, width) };
+    op.nState = logic::StateBits(t, op.nIn, op.nOut);
+    m_pins.insert(m_pins.end(), pinNets, pinNets + op.nIn + op.nOut);
+    m_state.resize(m_state.size() + op.nState, 0);
+    m_ops.push_back(op);
+    return (int)m_ops.size() - 1;
+}
+
+void SimEngine::Finalize()
+{
+    const int n = (int)m_ops.size();
+    int maxIn = 1, maxOut = 1, maxState = 1;
+    m_comb.clear();
+    m_seq.clear();
+    m_clocks.clear();
+    for (int k = 0; k < n; ++k) {
+        Op& op = m_ops[k];
+        maxIn = std::max(maxIn, op.nIn);
+        maxOut = std::max(maxOut, op.nOut);
+        maxState = std::max(maxState, op.nState);
+        if (op.type == CLOCK) m_clocks.push_back(k);
+        else if (logic::IsEdgeTriggered(op.type)) m_seq.push_back(k);
+        else if (!IsSourceType(op.type) && op.nOut > 0) m_comb.push_back(k);
+    }
+    m_inBuf.reset(new bool[maxIn]);
+    m_outBuf.reset(new bool[maxOut]);
+    m_winBuf.reset(new uint64_t[maxIn]);
+    m_woutBuf.reset(new uint64_t[maxOut]);
+    m_qBuf.reset(new bool[maxState]);
+    m_maxState = maxState;
+    m_nextBuf.reset(new bool[size_t(maxState) * std::max<size_t>(1, m_seq.size())]);
+
+    // 组合 op 拓扑序（Kahn）：A 的输出网是 B 的输入网则 A 在前
+    std::vector<int> combIdx(n, -1);
+    for (int i = 0; i < (int)m_comb.size(); ++i) combIdx[m_comb[i]] = i;
+    std::vector<int> readerStart(m_net.size() + 1, 0), readers;
+    for (int k : m_comb) {
+        const Op& op = m_ops[k];
+        for (int p = 0; p < op.nIn; ++p) {
+            const int net = m_pins[op.first + p];
+            if (net >= 0) ++readerStart[net + 1];
+        }
+    }
+    for (size_t i = 0; i + 1 < readerStart.size(); ++i) readerStart[i + 1] += readerStart[i];
+    readers.resize(readerStart.back());
+    {
+        std::vector<int> fill(readerStart.begin(), readerStart.end() - 1);
+        for (int i = 0; i < (int)m_comb.size(); ++i) {
+            const Op& op = m_ops[m_comb[i]];
+            for (int p = 0; p < op.nIn; ++p) {
+                const int net = m_pins[op.first + p];
+                if (net >= 0) readers[fill[net]++] = i;
+            }
+        }
+    }
+    std::vector<int> indeg(m_comb.size(), 0);
+    auto forEachSucc = [&](int i, auto&& fn) {
+        const Op& op = m_ops[m_comb[i]];
+        for (int p = op.nIn; p < op.nIn + op.nOut; ++p) {
+            const int net = m_pins[op.first + p];
+            if (net < 0) continue;
+            for (int r = readerStart[net]; r < readerStart[net + 1]; ++r) fn(readers[r]);
+        }
+    };
+    for (int i = 0; i < (int)m_comb.size(); ++i) forEachSucc(i, [&](int s) { ++indeg[s]; });
+    std::vector<int> order;
+    order.reserve(m_comb.size());
+    for (int i = 0; i < (int)m_comb.size(); ++i) if (indeg[i] == 0) order.push_back(i);
+    for (size_t h = 0; h < order.size(); ++h) forEachSucc(order[h], [&](int s) { if (--indeg[s] == 0) order.push_back(s); });
+    m_cyclic = order.size() < m_comb.size();
+    if (m_cyclic) {
+        for (int i = 0; i < (int)m_comb.size(); ++i) if (indeg[i] > 0) order.push_back(i);
+    }
+    std::vector<int> sorted(order.size());
+    for (size_t i = 0; i < order.size(); ++i) sorted[i] = m_comb[order[i]];
+    m_comb.swap(sorted);
+
+    // 网 → 读它的组合 op（按拓扑序位置），网值变化时只把这些 op 标脏
+    m_readerStart.assign(m_net.size() + 1, 0);
+    for (int k : m_comb) {
+        const Op& op = m_ops[k];
+        for (int p = 0; p < op.nIn; ++p) {
+            const int net = m_pins[op.first + p];
+            if (net >= 0) ++m_readerStart[net + 1];
+        }
+    }
+    for (size_t i = 0; i + 1 < m_readerStart.size(); ++i) m_readerStart[i + 1] += m_readerStart[i];
+    m_readers.resize(m_readerStart.back());
+    {
+        std::vector<int> fill(m_readerStart.begin(), m_readerStart.end() - 1);
+        for (int pos = 0; pos < (int)m_comb.size(); ++pos) {
+            const Op& op = m_ops[m_comb[pos]];
+            for (int p = 0; p < op.nIn; ++p) {
+                const int net = m_pins[op.first + p];
+                if (net >= 0) m_readers[fill[net]++] = pos;
+            }
+        }
+    }
+    m_dirty.assign(m_comb.size(), 0);
+    m_numDirty = 0;
+    m_dirtyLo = 0;
+    FindLoops();
+
+    m_seqClkNet.assign(m_seq.size(), -1);
+    for (size_t i = 0; i < m_seq.size(); ++i) {
+        const Op& op = m_ops[m_seq[i]];
+        const int clk = logic::ClockPin(op.type, op.nIn);
+        if (clk >= 0 && clk < op.nIn) m_seqClkNet[i] = m_pins[op.first + clk];
+    }
+    Restart();
+}
+
+void SimEngine::Restart()
+{
+    // 复位：起始节点保留外部设置的电平，其余状态清零
+    for (const Op& op : m_ops) {
+        if (op.type != NODE_START) std::fill_n(m_state.begin() + op.state, op.nState, 0);
+    }
+    // 解冻全部环（记下的振荡输入组合保留），仍振荡的由下面的 Settle 重新判出
+    for (int s = 0; s < NumLoops(); ++s) SetOscillating(s, false);
+    std::fill(m_sccCheck.begin(), m_sccCheck.end(), 0);
+    m_numCheck = 0;
+    std::fill(m_netX.begin(), m_netX.end(), 0);
+    m_numX = 0;
+
+    // 上电：全部组合 op 求值一次，状态驱动输出并稳定；当前时钟电平记为“上一次”，上电不算边沿
+    std::fill(m_net.begin(), m_net.end(), 0);
+    std::fill(m_dirty.begin(), m_dirty.end(), 1);
+    m_numDirty = (int)m_comb.size();
+    m_dirtyLo = 0;
+    for (const Op& op : m_ops) if (op.nState > 0 && op.type != DLATCH) DriveFromState(op);
+    Settle();
+    m_prevClk.assign(m_seq.size(), 0);
+    for (size_t i = 0; i < m_seq.size(); ++i) m_prevClk[i] = uint8_t(NetWord(m_seqClkNet[i]) & 1);
+    m_cycles = 0;
+}
+
+void SimEngine::SetSource(int op, bool v)
+{
+    if (op < 0 || op >= (int)m_ops.size()) return;
+    const Op& o = m_ops[op];
+    if (o.type != NODE_START || o.nState < 1) return;
+    m_state[o.state] = v;
+    if (m_qBuf) DriveFromState(o);   // Finalize 之前只记电平，上电时统一驱动
+}
+
+bool SimEngine::GetSource(int op) const
+{
+    if (op < 0 || op >= (int)m_ops.size()) return false;
+    const Op& o = m_ops[op];
+    return o.type == NODE_START && o.nState >= 1 && m_state[o.state] != 0;
+}
+
+bool SimEngine::StateBit(int op, int k) const
+{
+    if (op < 0 || op >= (int)m_ops.size()) return false;
+    const Op& o = m_ops[op];
+    return k >= 0 && k < o.nState && m_state[o.state + k] != 0;
+}
+
+void SimEngine::DriveFromState(const Op& op)
+{
+    bool* q = m_qBuf.get();
+    bool* out = m_outBuf.get();
+    for (int b = 0; b < op.nState; ++b) q[b] = m_state[op.state + b] != 0;
+    logic::StateOutputs(op.type, q, op.nState, out, op.nOut);
+    for (int p = 0; p < op.nOut; ++p) WriteNet(m_pins[op.first + op.nIn + p], out[p]);
+}
+
+bool SimEngine::WriteNet(int net, uint64_t v)
+{
+    if (net < 0 || m_net[net] == v) return false;
+    m_net[net] = v;
+    ++m_stats.netChanges;
+    for (int r = m_readerStart[net]; r < m_readerStart[net + 1]; ++r) {
+        const int pos = m_readers[r];
+        if (m_dirty[pos]) continue;
+        if (m_watchLoops) {
+            // 振荡过的环：输入变了记下待重判；已冻结的不再求值
+            const int s = m_sccOf[pos];
+            if (s >= 0 && !m_sccSeen[s].empty()) {
+                if (!m_sccCheck[s]) { m_sccCheck[s] = 1; ++m_numCheck; }
+                if (m_sccOsc[s]) continue;
+            }
+        }
+        MarkDirty(pos);
+    }
+    return true;
+}
+
+void SimEngine::MarkDirty(int pos)
+{
+    if (m_dirty[pos]) return;
+    m_dirty[pos] = 1;
+    ++m_numDirty;
+    if (pos < m_dirtyLo) m_dirtyLo = pos;
+}
+
+void SimEngine::SetNetX(int net, bool x)
+{
+    if (net < 0 || (m_netX[net] != 0) == x) return;
+    m_netX[net] = x;
+    m_numX += x ? 1 : -1;
+    for (int r = m_readerStart[net]; r < m_readerStart[net + 1]; ++r) {
+        const int pos = m_readers[r];
+        const int s = m_sccOf.empty() ? -1 : m_sccOf[pos];
+        if (s < 0) { MarkDirty(pos); continue; }
+        // 环内 op 按环的外部输入判 X，整个环都要重新求值；冻结的环不动
+        if (m_sccOsc[s]) continue;
+        for (int k = m_sccStart[s]; k < m_sccStart[s + 1]; ++k) MarkDirty(m_sccPos[k]);
+    }
+}
+
+bool SimEngine::InputX(int pos, const Op& op) const
+{
+    const int s = m_sccOf.empty() ? -1 : m_sccOf[pos];
+    if (s >= 0) {
+        for (int k = m_sccInStart[s]; k < m_sccInStart[s + 1]; ++k) if (m_netX[m_sccIn[k]]) return true;
+        return false;
+    }
+    for (int k = 0; k < op.nIn; ++k) {
+        const int n = m_pins[op.first + k];
+        if (n >= 0 && m_netX[n]) return true;
+    }
+    return false;
+}
+
+void SimEngine::EvalAt(int pos)
+{
+    ++m_stats.evals;
+    const Op& op = m_ops[m_comb[pos]];
+    EvalComb(op);
+    if (m_numX == 0) return;   // 没有 X 时输出也一定不是 X
+    const bool x = InputX(pos, op);
+    for (int p = 0; p < op.nOut; ++p) SetNetX(m_pins[op.first + op.nIn + p], x);
+}
+
+bool SimEngine::EvalWord(const Op& op)
+{
+    uint64_t* in = m_winBuf.get();
+    uint64_t* out = m_woutBuf.get();
+    for (int k = 0; k < op.nIn; ++k) {
+        const int n = m_pins[op.first + k];
+        in[k] = n >= 0 ? m_net[n] : 0;
+    }
+    logic::EvaluateWord(op.type, in, op.nIn, out, op.nOut, op.width);
+
+    bool changed = false;
+    for (int p = 0; p < op.nOut; ++p) changed = WriteNet(m_pins[op.first + op.nIn + p], out[p]) || changed;
+    return changed;
+}
+
+bool SimEngine::EvalComb(const Op& op)
+{
+    if (op.word) return EvalWord(op);
+    bool* in = m_inBuf.get();
+    bool* out = m_outBuf.get();
+    for (int k = 0; k < op.nIn; ++k) in[k] = In(op, k);
+
+    if (op.type == DLATCH) {
+        // 电平敏感：EN 为高时透明，否则保持
+        if (op.nIn >= 2 && in[1]) m_state[op.state] = in[0];
+        const bool q = m_state[op.state] != 0;
+        logic::StateOutputs(op.type, &q, 1, out, op.nOut);
+    }
+    else if (op.macro) {
+        if (op.macro->NumInputs() == op.nIn && op.macro->NumOutputs() == op.nOut) op.macro->Evaluate(in, out);
+        else std::fill_n(out, op.nOut, false);
+    }
+    else {
+        logic::Evaluate(op.type, in, op.nIn, out, op.nOut);
+    }
+
+    bool changed = false;
+    for (int p = 0; p < op.nOut; ++p) changed = WriteNet(m_pins[op.first + op.nIn + p], out[p]) || changed;
+    return changed;
+}
+
+bool SimEngine::RunPasses()
+{
+    // 只求值输入网变过的 op，按拓扑序前向扫描：无环时后继总在后面，一遍即稳定；
+    // 有环时回边会把前面的 op 重新标脏，再扫，直到没有脏 op 或达到迭代上限
+    const int n = (int)m_comb.size();
+    for (int pass = 0; pass < kMaxSettlePasses && m_numDirty > 0; ++pass) {
+        ++m_stats.passes;
+        int i = m_dirtyLo;
+        m_dirtyLo = n;
+        for (; i < n && m_numDirty > 0; ++i) {
+            if (!m_dirty[i]) continue;
+            m_dirty[i] = 0;
+            --m_numDirty;
+            EvalAt(i);
+        }
+    }
+    return m_numDirty == 0;
+}
+
+bool SimEngine::Settle()
+{
+    ++m_stats.settles;
+    if (m_numCheck > 0) CheckLoops();
+    if (RunPasses()) return true;
+    ++m_stats.unconverged;
+
+    // 不收敛：把振荡的环隔离成 X，其余部分再稳定
+    for (int round = 0; round < kMaxIsolateRounds && IsolateOscillation(); ++round) {
+        if (RunPasses()) return false;
+    }
+
+    // 仍不收敛：放弃本次剩余的传播
+    std::fill(m_dirty.begin(), m_dirty.end(), 0);
+    m_numDirty = 0;
+    m_dirtyLo = (int)m_comb.size();
+    return false;
+}
+
+// ==========================================================
+//  组合环与振荡诊断
+// ==========================================================
+void SimEngine::FindLoops()
+{
+    const int n = (int)m_comb.size();
+    m_sccOf.assign(n, -1);
+    m_sccStart.assign(1, 0);
+    m_sccPos.clear();
+    m_sccInStart.assign(1, 0);
+    m_sccIn.clear();
+    m_sccOutStart.assign(1, 0);
+    m_sccOut.clear();
+    m_netX.assign(m_net.size(), 0);
+    m_numX = 0;
+    m_numOsc = m_numCheck = 0;
+    m_watchLoops = false;
+    if (!m_cyclic) {
+        m_sccOsc.clear();
+        m_sccCheck.clear();
+        m_sccSeen.clear();
+        return;
+    }
+
+    // Tarjan（迭代）：后继 = 输出网的组合读者；分量按逆拓扑序弹出
+    std::vector<int> index(n, -1), low(n, 0), stack;
+    std::vector<uint8_t> onStack(n, 0);
+    struct Frame { int v, pin, r; };   // 当前位置、输出引脚序号、读者游标（-1 为未开始）
+    std::vector<Frame> call;
+    std::vector<int> compStart{ 0 }, compPos;
+    int counter = 0;
+    auto push = [&](int v) {
+        index[v] = low[v] = counter++;
+        stack.push_back(v);
+        onStack[v] = 1;
+        call.push_back(Frame{ v, 0, -1 });
+    };
+    for (int root = 0; root < n; ++root) {
+        if (index[root] >= 0) continue;
+        push(root);
+        while (!call.empty()) {
+            Frame& f = call.back();
+            const Op& op = m_ops[m_comb[f.v]];
+            bool descended = false;
+            while (f.pin < op.nOut) {
+                const int net = m_pins[op.first + op.nIn + f.pin];
+                if (net < 0) { ++f.pin; continue; }
+                if (f.r < 0) f.r = m_readerStart[net];
+                if (f.r >= m_readerStart[net + 1]) { ++f.pin; f.r = -1; continue; }
+                const int w = m_readers[f.r++];
+                if (index[w] < 0) { push(w); descended = true; break; }
+                if (onStack[w]) low[f.v] = std::min(low[f.v], index[w]);
+            }
+            if (descended) continue;
+
+            const int v = call.back().v;
+            call.pop_back();
+            if (!call.empty()) low[call.back().v] = std::min(low[call.back().v], low[v]);
+            if (low[v] != index[v]) continue;
+            for (;;) {
+                const int w = stack.back();
+                stack.pop_back();
+                onStack[w] = 0;
+                compPos.push_back(w);
+                if (w == v) break;
+            }
+            compStart.push_back((int)compPos.size());
+        }
+    }
+
+    // 只留非平凡分量（多于一个 op，或 op 读自己的输出），按拓扑序编号
+    auto readsItself = [&](int v) {
+        const Op& op = m_ops[m_comb[v]];
+        for (int p = op.nIn; p < op.nIn + op.nOut; ++p) {
+            const int net = m_pins[op.first + p];
+            if (net < 0) continue;
+            for (int r = m_readerStart[net]; r < m_readerStart[net + 1]; ++r) if (m_readers[r] == v) return true;
+        }
+        return false;
+    };
+    for (int c = (int)compStart.size() - 2; c >= 0; --c) {
+        const int b = compStart[c], e = compStart[c + 1];
+        if (e - b == 1 && !readsItself(compPos[b])) continue;
+        const int s = NumLoops();
+        std::vector<int> pos(compPos.begin() + b, compPos.begin() + e);
+        std::sort(pos.begin(), pos.end());
+        for (int p : pos) m_sccOf[p] = s;
+        m_sccPos.insert(m_sccPos.end(), pos.begin(), pos.end());
+        m_sccStart.push_back((int)m_sccPos.size());
+    }
+
+    // 每个环：环内驱动的网，以及不由环内驱动的输入网
+    std::vector<int> nets;
+    for (int s = 0; s < NumLoops(); ++s) {
+        nets.clear();
+        for (int k = m_sccStart[s]; k < m_sccStart[s + 1]; ++k) {
+            const Op& op = m_ops[m_comb[m_sccPos[k]]];
+            for (int p = op.nIn; p < op.nIn + op.nOut; ++p) if (m_pins[op.first + p] >= 0) nets.push_back(m_pins[op.first + p]);
+        }
+        std::sort(nets.begin(), nets.end());
+        nets.erase(std::unique(nets.begin(), nets.end()), nets.end());
+        m_sccOut.insert(m_sccOut.end(), nets.begin(), nets.end());
+        m_sccOutStart.push_back((int)m_sccOut.size());
+
+        const auto outBegin = m_sccOut.begin() + m_sccOutStart[s], outEnd = m_sccOut.end();
+        nets.clear();
+        for (int k = m_sccStart[s]; k < m_sccStart[s + 1]; ++k) {
+            const Op& op = m_ops[m_comb[m_sccPos[k]]];
+            for (int p = 0; p < op.nIn; ++p) {
+                const int net = m_pins[op.first + p];
+                if (net >= 0 && !std::binary_search(outBegin, outEnd, net)) nets.push_back(net);
+            }
+        }
+        std::sort(nets.begin(), nets.end());
+        nets.erase(std::unique(nets.begin(), nets.end()), nets.end());
+        m_sccIn.insert(m_sccIn.end(), nets.begin(), nets.end());
+        m_sccInStart.push_back((int)m_sccIn.size());
+    }
+    m_sccOsc.assign(NumLoops(), 0);
+    m_sccCheck.assign(NumLoops(), 0);
+    m_sccSeen.assign(NumLoops(), {});
+}
+
+bool SimEngine::SettleLoop(int s)
+{
+    for (int pass = 0; pass < kMaxSettlePasses; ++pass) {
+        bool any = false;
+        for (int k = m_sccStart[s]; k < m_sccStart[s + 1]; ++k) {
+            const int pos = m_sccPos[k];
+            if (!m_dirty[pos]) continue;
+            m_dirty[pos] = 0;
+            --m_numDirty;
+            EvalAt(pos);
+            any = true;
+        }
+        if (!any) return true;
+    }
+    return false;
+}
+
+bool SimEngine::IsolateOscillation()
+{
+    // 按拓扑序：上游的环先定下来，下游的环检查时外部输入已是最终值（或已冻结）
+    bool found = false;
+    for (int s = 0; s < NumLoops(); ++s) {
+        if (m_sccOsc[s]) continue;
+        bool dirty = false;
+        for (int k = m_sccStart[s]; k < m_sccStart[s + 1] && !dirty; ++k) dirty = m_dirty[m_sccPos[k]] != 0;
+        if (!dirty || SettleLoop(s)) continue;
+        SetOscillating(s, true);
+        ++m_stats.oscillations;
+        found = true;
+    }
+    return found;
+}
+
+void SimEngine::SetOscillating(int s, bool on)
+{
+    if ((m_sccOsc[s] != 0) == on) return;
+    m_sccOsc[s] = on;
+    m_numOsc += on ? 1 : -1;
+    // 环驱动的网置 / 清 X，读它们的 op 随之标脏，X 沿扇出传下去或撤回
+    // 恢复时先清掉，环重新求值后若外部输入有 X 会再标上
+    for (int k = m_sccOutStart[s]; k < m_sccOutStart[s + 1]; ++k) SetNetX(m_sccOut[k], on);
+    for (int k = m_sccStart[s]; k < m_sccStart[s + 1]; ++k) {
+        const int pos = m_sccPos[k];
+        if (on && m_dirty[pos]) { m_dirty[pos] = 0; --m_numDirty; }
+        else if (!on) MarkDirty(pos);   // 恢复：整个环重新求值一遍
+    }
+    if (on) {
+        m_watchLoops = true;
+        auto& seen = m_sccSeen[s];
+        const uint64_t sig = LoopSignature(s);
+        if (std::find(seen.begin(), seen.end(), sig) == seen.end()) {
+            if (seen.size() >= kMaxSeenPatterns) seen.erase(seen.begin());
+            seen.push_back(sig);
+        }
+    }
+}
+
+void SimEngine::CheckLoops()
+{
+    for (int s = 0; s < NumLoops(); ++s) {
+        if (!m_sccCheck[s]) continue;
+        m_sccCheck[s] = 0;
+        const auto& seen = m_sccSeen[s];
+        const bool known = std::find(seen.begin(), seen.end(), LoopSignature(s)) != seen.end();
+        SetOscillating(s, known);   // 没见过的组合先放开重试，不收敛时 Settle 会再判
+    }
+    m_numCheck = 0;
+}
+
+uint64_t SimEngine::LoopSignature(int s) const
+{
+    // 外部输入网值的 FNV-1a
+    uint64_t h = 1469598103934665603ull;
+    for (int k = m_sccInStart[s]; k < m_sccInStart[s + 1]; ++k) {
+        h ^= m_net[m_sccIn[k]];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+void SimEngine::OscillatingLoops(std::vector<std::vector<int>>& loops) const
+{
+    loops.clear();
+    for (int s = 0; s < NumLoops(); ++s) {
+        if (!m_sccOsc[s]) continue;
+        loops.emplace_back();
+        for (int k = m_sccStart[s]; k < m_sccStart[s + 1]; ++k) loops.back().push_back(m_comb[m_sccPos[k]]);
+    }
+}
+
+void SimEngine::Step()
+{
+    Settle();
+    for (int round = 0; round < kMaxEdgeRounds; ++round) {
+        // 相位 1：所有上升沿的触发器按边沿前已稳定的输入采样次态
+        m_fired.clear();
+        for (int i = 0; i < (int)m_seq.size(); ++i) {
+            const int clkNet = m_seqClkNet[i];
+            const uint8_t level = clkNet >= 0 ? uint8_t(m_net[clkNet] & 1) : 0;
+            if (level == m_prevClk[i]) continue;
+            m_prevClk[i] = level;
+            if (level) {
+                const Op& op = m_ops[m_seq[i]];
+                bool* next = m_nextBuf.get() + m_fired.size() * m_maxState;
+                if (op.type == DFF || op.type == REGISTER) {
+                    // 最常见的情况直接取 D，省掉拷贝与分派
+                    for (int b = 0; b < op.nState; ++b) next[b] = In(op, b);
+                }
+                else {
+                    bool* in = m_inBuf.get();
+                    bool* q = m_qBuf.get();
+                    for (int k = 0; k < op.nIn; ++k) in[k] = In(op, k);
+                    for (int b = 0; b < op.nState; ++b) q[b] = m_state[op.state + b] != 0;
+                    logic::NextState(op.type, in, op.nIn, q, next, op.nState);
+                }
+                m_fired.push_back(i);
+            }
+        }
+        if (m_fired.empty()) break;
+
+        // 相位 2：统一提交（状态没变的不重写输出），再让组合逻辑稳定
+        const bool* next = m_nextBuf.get();
+        size_t changed = 0;
+        for (size_t f = 0; f < m_fired.size(); ++f) {
+            const Op& op = m_ops[m_seq[m_fired[f]]];
+            bool diff = false;
+            for (int b = 0; b < op.nState; ++b) {
+                const uint8_t v = next[f * m_maxState + b];
+                diff = diff || m_state[op.state + b] != v;
+                m_state[op.state + b] = v;
+            }
+            if (diff) m_fired[changed++] = m_fired[f];
+        }
+        m_fired.resize(changed);
+        for (int i : m_fired) DriveFromState(m_ops[m_seq[i]]);
+        Settle();
+    }
+}
+
+void SimEngine::HalfTick()
+{
+    bool rising = false;
+    for (int k : m_clocks) {
+        const Op& op = m_ops[k];
+        m_state[op.state] ^= 1;
+        rising = m_state[op.state] != 0;
+        DriveFromState(op);
+    }
+    if (rising) ++m_cycles;
+    Step();
+}
+
+long long SimEngine::RunCycles(long long n)
+{
+    if (m_clocks.empty()) return 0;
+    for (long long c = 0; c < n; ++c) {
+        HalfTick();
+        HalfTick();
+    }
+    return n;
+}
+
+ClockBenchResult MeasureCounterThroughput(int bits, long long cycles)
+{
+    // 网：0 = 时钟，1 = 常 1；位 i：q = 2+4i，d = 3+4i，进位入 c_i（c_0 为常 1），c_{i+1} = 5+4i
+    bits = std::max(1, bits);
+    const int numNets = 2 + 4 * bits;
+    auto qNet = [](int i) { return 2 + 4 * i; };
+    auto dNet = [](int i) { return 3 + 4 * i; };
+    auto cNet = [](int i) { return i == 0 ? 1 : 1 + 4 * i; };
+
+    SimEngine eng;
+    eng.Reset(numNets);
+    const int clkPins[] = { 0 };
+    eng.AddOp(CLOCK, clkPins, 0, 1);
+    const int onePins[] = { 1 };
+    eng.SetSource(eng.AddOp(NODE_START, onePins, 0, 1), true);
+    for (int i = 0; i < bits; ++i) {
+        const int xorPins[] = { qNet(i), cNet(i), dNet(i) };
+        eng.AddOp(XORGATE, xorPins, 2, 1);
+        const int andPins[] = { qNet(i), cNet(i), cNet(i + 1) };
+        eng.AddOp(ANDGATE, andPins, 2, 1);
+        const int dffPins[] = { dNet(i), 0, qNet(i), -1 };
+        eng.AddOp(DFF, dffPins, 2, 2);
+    }
+    eng.Finalize();
+
+    ClockBenchResult r;
+    r.bits = bits;
+    r.ops = eng.NumOps();
+    const auto t0 = std::chrono::steady_clock::now();
+    r.cycles = eng.RunCycles(cycles);
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return r;
+}
@@ -0,0 +1,158 @@
+﻿// SimEngine.h
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ComponentType.h"
+#include "LogicKernel.h"
+
+// ==========================================================
+//  编译后的仿真调度器（不依赖 wx）
+//  - 网表压成扁平数组：元件 = op（类型 + 引脚所在网），网值为 uint64_t
+//    单线只用最低位；总线整根是一个网，整字运算的 op 一次读写整个字
+//  - 组合 op 按拓扑序排好；只有输入网变过的 op 才求值（事件驱动），
+//    无环时一次前向扫描即稳定，有环时迭代到不再变化
+//  - 时序：两相更新。先让组合逻辑稳定，再对所有出现上升沿的触发器/寄存器
+//    统一采样次态（相位 1），然后一起提交（相位 2），再稳定；
+//    提交引起的新边沿（行波计数器）在下一轮处理
+//  - 时钟源的翻转由 HalfTick 驱动；无界面时 RunCycles 连跑整周期
+//  - 振荡诊断：Settle 到迭代上限时，按拓扑序逐个检查还有脏 op 的组合环（非平凡强连通分量），
+//    外部输入不变、只在环内迭代仍不收敛的环判为振荡：环内 op 驱动的网记为 X（保持当前值），
+//    之后的节拍跳过这些 op；环的外部输入变成没见过的组合时重试，收敛则恢复；
+//    输入回到已知会振荡的组合时直接冻结，不再白跑迭代上限
+//  - X 沿组合扇出传播：任一输入网为 X 的组合 op，输出网也记为 X；
+//    环内的 op 按整个环的外部输入判断（否则环自己的反馈会把 X 锁住）。时序 op 的状态不带 X
+// ==========================================================
+
+class SimEngine {
+public:
+    // numNets 个网，全部清零并丢弃已有的 op
+    void Reset(int numNets);
+
+    // pinNets 为 nIn 个输入网 + nOut 个输出网（-1 为悬空/不驱动）；返回 op 下标
+    // width 为位宽参数（见 Component::width），logic::IsWordOp 成立时按整字求值
+    int AddOp(ComponentType t, const int* pinNets, int nIn, int nOut, const logic::Macro* macro = nullptr, int width = 1);
+
+    // 建组合拓扑序、时序表并复位状态（起始节点保持已设的电平）
+    void Finalize();
+    // 回到上电状态：网与内部状态清零（起始节点保持已设的电平）、解冻振荡的环，再稳定
+    void Restart();
+
+    // 起始节点电平（对其它 op 无效）
+    void SetSource(int op, bool v);
+    bool GetSource(int op) const;
+
+    // 组合逻辑稳定；返回是否在迭代上限内收敛（本次有环被判为振荡时也返回 false）
+    bool Settle();
+    // 稳定 + 处理所有时钟边沿直到不再有新边沿
+    void Step();
+    // 所有时钟源翻转一次后 Step（半个周期）
+    void HalfTick();
+    // 连跑 n 个完整周期（上升 + 下降），返回跑完的周期数
+    long long RunCycles(long long n);
+
+    bool NetValue(int net) const { return NetWord(net) != 0; }
+    uint64_t NetWord(int net) const { return net >= 0 && net < (int)m_net.size() ? m_net[net] : 0; }
+    const std::vector<uint64_t>& NetWords() const { return m_net; }
+    // op 的第 k 位内部状态（触发器 Q、寄存器 Qk、时钟源当前电平）
+    bool StateBit(int op, int k) const;
+
+    int NumNets() const { return (int)m_net.size(); }
+    int NumOps() const { return (int)m_ops.size(); }
+    bool HasClock() const { return !m_clocks.empty(); }
+    bool IsCyclic() const { return m_cyclic; }
+
+    // 振荡的环驱动的网及其组合扇出（X）
+    bool NetUnknown(int net) const { return net >= 0 && net < (int)m_netX.size() && m_netX[net] != 0; }
+    int NumUnknownNets() const { return m_numX; }
+    int NumLoops() const { return (int)m_sccStart.size() - 1; }
+    int NumOscillating() const { return m_numOsc; }
+    // 当前判为振荡的环，每个环列出其中的 op
+    void OscillatingLoops(std::vector<std::vector<int>>& loops) const;
+    long long Cycles() const { return m_cycles; }
+
+    // 累计计数（Reset 清零）；性能浮层按节拍取差值
+    struct Stats {
+        long long settles = 0;       // Settle 次数
+        long long passes = 0;        // 前向扫描遍数（稳定迭代）
+        long long evals = 0;         // 组合 op 求值次数
+        long long netChanges = 0;    // 网值改变次数
+        long long unconverged = 0;   // 达到迭代上限的 Settle 次数
+        long long oscillations = 0;  // 环被判为振荡的次数（同一个环在新的输入组合下再次振荡也算）
+    };
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    struct Op {
+        ComponentType type;
+        const logic::Macro* macro;   // 子电路模板（其余为 nullptr）
+        int first;                   // m_pins 中的起点：先输入后输出
+        int nIn, nOut;
+        int state, nState;           // m_state 中的起点与位数
+        int width;                   // 位宽参数
+        bool word;                   // 整字求值（总线）
+    };
+
+    void EvalAt(int pos);                        // 求值 m_comb[pos] 并传播 X
+    bool EvalComb(const Op& op);                 // 返回是否有输出网改变
+    bool EvalWord(const Op& op);                 // 整字 op 的求值
+    void DriveFromState(const Op& op);           // 由状态写输出网
+    bool WriteNet(int net, uint64_t v);          // 写网值；变化时把读它的组合 op 标脏
+    void MarkDirty(int pos);
+    void SetNetX(int net, bool x);               // X 标记变化时把读它的组合 op（在环上则整个环）标脏
+    bool InputX(int pos, const Op& op) const;    // op 的输入里是否有 X（环内 op 看环的外部输入）
+    bool RunPasses();                            // 按拓扑序扫脏 op 至多 kMaxSettlePasses 遍；返回是否收敛
+    // 单线引脚读网的最低位（接到总线上时取位 0）
+    bool In(const Op& op, int k) const { const int n = m_pins[op.first + k]; return n >= 0 && (m_net[n] & 1) != 0; }
+
+    std::vector<Op> m_ops;
+    std::vector<int> m_pins;
+    std::vector<uint64_t> m_net;
+    std::vector<uint8_t> m_state;
+
+    std::vector<int> m_comb;      // 组合 op（含锁存器、子电路），拓扑序
+    std::vector<int> m_seq;       // 边沿触发 op
+    std::vector<int> m_clocks;    // 时钟源 op
+    std::vector<int> m_seqClkNet;     // 按 m_seq 下标：时钟输入所在网
+    std::vector<uint8_t> m_prevClk;   // 按 m_seq 下标：上次看到的时钟电平
+    std::vector<int> m_fired;     // 本轮出现上升沿的 m_seq 下标
+    std::vector<int> m_readerStart, m_readers;   // 网 → 读它的组合 op 在 m_comb 中的位置（CSR）
+    std::vector<uint8_t> m_dirty;                 // 按 m_comb 位置：输入变过、待求值
+    int m_numDirty = 0, m_dirtyLo = 0;
+    bool m_cyclic = false;
+
+    // 组合环（非平凡强连通分量），环号按拓扑序；各表按 m_comb 位置
+    std::vector<int> m_sccOf;                    // 位置 → 环号，不在环上为 -1
+    std::vector<int> m_sccStart, m_sccPos;       // 环 s 的 op 位置（CSR，升序）
+    std::vector<int> m_sccInStart, m_sccIn;      // 环 s 的外部输入网（CSR）
+    std::vector<int> m_sccOutStart, m_sccOut;    // 环 s 内 op 驱动的网（CSR）
+    std::vector<uint8_t> m_sccOsc, m_sccCheck;   // 已判为振荡 / 外部输入变过、待按签名重判
+    std::vector<std::vector<uint64_t>> m_sccSeen;   // 已知会振荡的外部输入组合（签名）
+    std::vector<uint8_t> m_netX;
+    int m_numX = 0;                    // X 网数；为 0 时求值不必检查 X
+    int m_numOsc = 0, m_numCheck = 0;
+    bool m_watchLoops = false;         // 有环振荡过：写网时要留意环的外部输入
+    void FindLoops();                  // Finalize 中建环表（Tarjan）
+    bool SettleLoop(int s);            // 外部输入不变，只在环 s 内迭代；返回是否收敛
+    bool IsolateOscillation();         // 返回是否新判出振荡的环
+    void SetOscillating(int s, bool on);
+    void CheckLoops();                 // 按外部输入签名冻结或恢复待重判的环
+    uint64_t LoopSignature(int s) const;
+    long long m_cycles = 0;
+    Stats m_stats;
+
+    // 求值临时缓冲（按最大引脚/状态位数分配，避免逐 op 分配）
+    std::unique_ptr<bool[]> m_inBuf, m_outBuf, m_qBuf, m_nextBuf;
+    std::unique_ptr<uint64_t[]> m_winBuf, m_woutBuf;
+    int m_maxState = 1;           // m_nextBuf 中每个触发的 op 占 m_maxState 位
+};
+
+// 基准：n 位同步二进制计数器（DFF + 半加器链），连跑若干周期测吞吐量
+struct ClockBenchResult {
+    int bits = 0;
+    int ops = 0;
+    long long cycles = 0;
+    double seconds = 0.0;
+    double CyclesPerSec() const { return seconds > 0 ? cycles / seconds : 0.0; }
+};
+ClockBenchResult MeasureCounterThroughput(int bits, long long cycles);
@@ -0,0 +1,125 @@
+﻿// SimNetlist.cpp
+#include "SimNetlist.h"
+
+#include <algorithm>
+#include <climits>
+
+void SimNetlist::Clear()
+{
+    m_numNets = 0;
+    m_cells.clear();
+    m_pinNets.clear();
+    m_inputs.clear();
+    m_outputs.clear();
+}
+
+int SimNetlist::AddCell(ComponentType t, const int* pinNets, int numPins, int width,
+    std::shared_ptr<const logic::Macro> macro, std::string name)
+{
+    Cell c;
+    c.type = t;
+    c.width = std::max(1, width);
+    c.first = (int)m_pinNets.size();
+    c.numPins = std::max(0, numPins);
+    // 子电路的输入数由模板决定；没有模板时全部当输入，不驱动任何网
+    const int nIn = macro ? macro->NumInputs() : logic::InputCount(t, c.numPins);
+    c.nIn = nIn < 0 ? c.numPins : std::min(nIn, c.numPins);
+    c.name = std::move(name);
+    c.macro = std::move(macro);
+    for (int p = 0; p < c.numPins; ++p) {
+        const int n = pinNets ? pinNets[p] : -1;
+        m_pinNets.push_back(n >= 0 && n < m_numNets ? n : -1);
+    }
+    m_cells.push_back(std::move(c));
+    return (int)m_cells.size() - 1;
+}
+
+int SimNetlist::FindInput(const std::string& name) const
+{
+    for (int c : m_inputs) if (m_cells[c].name == name) return c;
+    return -1;
+}
+
+int SimNetlist::FindOutput(const std::string& name) const
+{
+    for (int c : m_outputs) if (m_cells[c].name == name) return c;
+    return -1;
+}
+
+void SimNetlist::Drivers(std::vector<PinRef>& driver) const
+{
+    driver.assign(m_numNets, PinRef{});
+    for (int i = 0; i < (int)m_cells.size(); ++i) {
+        const Cell& c = m_cells[i];
+        for (int p = c.nIn; p < c.numPins; ++p) {
+            const int n = m_pinNets[c.first + p];
+            if (n >= 0 && driver[n].compIdx < 0) driver[n] = PinRef{ i, p };
+        }
+    }
+}
+
+void SimNetlist::ComputeWidths(std::vector<int>& width, std::vector<char>& conflict) const
+{
+    width.assign(m_numNets, 1);
+    conflict.assign(m_numNets, 0);
+    std::vector<int> lo(m_numNets, INT_MAX), hi(m_numNets, 0);
+    for (const Cell& c : m_cells) {
+        for (int p = 0; p < c.numPins; ++p) {
+            const int n = m_pinNets[c.first + p];
+            if (n < 0) continue;
+            const int w = logic::PinWidth(c.type, p, c.numPins, c.width);
+            if (w <= 0) continue;   // 结点随网
+            lo[n] = std::min(lo[n], w);
+            hi[n] = std::max(hi[n], w);
+        }
+    }
+    for (int n = 0; n < m_numNets; ++n) {
+        if (hi[n] == 0) continue;
+        width[n] = hi[n];
+        conflict[n] = lo[n] != hi[n];
+    }
+}
+
+bool SimNetlist::HasSequential() const
+{
+    return std::any_of(m_cells.begin(), m_cells.end(), [](const Cell& c) { return logic::IsSequential(c.type); });
+}
+
+void SimNetlist::Compile(SimEngine& eng, std::vector<int>& cellOp) const
+{
+    std::vector<PinRef> driver;
+    Drivers(driver);
+
+    eng.Reset(m_numNets);
+    cellOp.assign(m_cells.size(), -1);
+    std::vector<int> pinNets;
+    for (int i = 0; i < (int)m_cells.size(); ++i) {
+        const Cell& c = m_cells[i];
+        if (c.type == NODE_BASIC) continue;
+        pinNets.assign(m_pinNets.begin() + c.first, m_pinNets.begin() + c.first + c.numPins);
+        // 输出引脚只有被选为该网驱动者时才写网
+        for (int p = c.nIn; p < c.numPins; ++p) {
+            const int n = pinNets[p];
+            if (n >= 0 && !(driver[n] == PinRef{ i, p })) pinNets[p] = -1;
+        }
+        cellOp[i] = eng.AddOp(c.type, pinNets.data(), c.nIn, c.numPins - c.nIn, c.macro.get(), c.width);
+    }
+}
+
+// ============ 网表模板 ============
+NetlistMacro::NetlistMacro(const SimNetlist& nl)
+{
+    std::vector<int> cellOp;
+    nl.Compile(m_engine, cellOp);
+    for (int c : nl.Inputs()) m_inOps.push_back(cellOp[c]);
+    for (int c : nl.Outputs()) m_outNets.push_back(nl.CellAt(c).numPins > 0 ? nl.PinNet(c, 0) : -1);
+    m_engine.Finalize();
+}
+
+void NetlistMacro::Evaluate(const bool* in, bool* out) const
+{
+    // 与 SubcircuitDef::Evaluate 相同：内部网每次清零再稳定，不带上一次（或别的实例）的值
+    for (size_t k = 0; k < m_inOps.size(); ++k) m_engine.SetSource(m_inOps[k], in[k]);
+    m_engine.Restart();
+    for (size_t k = 0; k < m_outNets.size(); ++k) out[k] = m_engine.NetValue(m_outNets[k]);
+}
@@ -0,0 +1,93 @@
+﻿// SimNetlist.h
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "ComponentType.h"
+#include "Connectivity.h"   // PinRef
+#include "LogicKernel.h"
+#include "SimEngine.h"
+
+// ==========================================================
+//  仿真网表（不依赖 wx）
+//  画布、JSON、BookShelf 都先落成这张表，再编译进 SimEngine：
+//  - 单元 = 元件：类型 + 位宽 + 各引脚所在网（先输入后输出，-1 为悬空）
+//  - 网只是编号；位宽由所接引脚推出（ComputeWidths）
+//  - 起始节点为输入端口、终止节点为输出端口，按登记顺序编号并带名字，
+//    命令行等无界面场合按名字读写
+//  - 每个网由第一个输出引脚（单元下标、引脚下标最小者）驱动，其余输出引脚不写网
+// ==========================================================
+
+class SimNetlist {
+public:
+    struct Cell {
+        ComponentType type = ANDGATE;
+        int width = 1;
+        int first = 0;          // 引脚在 m_pinNets 中的起点
+        int numPins = 0;
+        int nIn = 0;            // 输入引脚数（子电路由模板决定）
+        std::string name;       // 端口名；子电路单元为定义名；其余可空
+        std::shared_ptr<const logic::Macro> macro;   // 子电路模板
+    };
+
+    void Clear();
+    void SetNumNets(int n) { m_numNets = n > 0 ? n : 0; }
+    int NumNets() const { return m_numNets; }
+
+    // pinNets[numPins]；返回单元下标
+    int AddCell(ComponentType t, const int* pinNets, int numPins, int width = 1,
+        std::shared_ptr<const logic::Macro> macro = nullptr, std::string name = {});
+
+    int NumCells() const { return (int)m_cells.size(); }
+    const Cell& CellAt(int i) const { return m_cells[i]; }
+    Cell& CellAt(int i) { return m_cells[i]; }
+    int PinNet(int cell, int pin) const { return m_pinNets[m_cells[cell].first + pin]; }
+    bool IsOutputPin(int cell, int pin) const { return pin >= m_cells[cell].nIn; }
+
+    // 端口（单元下标，按端口顺序）
+    void AddInputPort(int cell) { m_inputs.push_back(cell); }
+    void AddOutputPort(int cell) { m_outputs.push_back(cell); }
+    const std::vector<int>& Inputs() const { return m_inputs; }
+    const std::vector<int>& Outputs() const { return m_outputs; }
+    // 按名字找端口单元；找不到返回 -1
+    int FindInput(const std::string& name) const;
+    int FindOutput(const std::string& name) const;
+
+    // 每个网的驱动引脚（compIdx = -1 表示无驱动）
+    void Drivers(std::vector<PinRef>& driver) const;
+    // 网位宽 = 所接引脚位宽的最大值；各引脚位宽不一致时 conflict 置 1
+    void ComputeWidths(std::vector<int>& width, std::vector<char>& conflict) const;
+    // 是否含时序元件（时钟源、触发器、锁存器、寄存器）
+    bool HasSequential() const;
+
+    // 编译进调度器（Reset + AddOp，不 Finalize）：cellOp[i] 为单元 i 的 op，结点为 -1
+    // 调用方设好起始节点电平后再调 eng.Finalize()
+    void Compile(SimEngine& eng, std::vector<int>& cellOp) const;
+
+private:
+    int m_numNets = 0;
+    std::vector<Cell> m_cells;
+    std::vector<int> m_pinNets;
+    std::vector<int> m_inputs, m_outputs;
+};
+
+// ==========================================================
+//  由网表编译的组合块：无界面加载时的子电路模板
+//  端口即网表的输入/输出端口；内部跑一份私有调度器，
+//  与 SubcircuitDef 一样每次求值都从全零的内部网开始，结果只取决于本次输入，
+//  不随调用顺序或实例而变；Evaluate 不可重入（同一模板不要在多个线程里同时求值）
+// ==========================================================
+class NetlistMacro : public logic::Macro {
+public:
+    // 网表不能含时序元件（调用方检查 HasSequential）
+    explicit NetlistMacro(const SimNetlist& nl);
+
+    int NumInputs() const override { return (int)m_inOps.size(); }
+    int NumOutputs() const override { return (int)m_outNets.size(); }
+    void Evaluate(const bool* in, bool* out) const override;
+
+private:
+    mutable SimEngine m_engine;
+    std::vector<int> m_inOps;     // 输入端口的起始节点 op
+    std::vector<int> m_outNets;   // 输出端口所在网
+};
@@ -1,452 +1,290 @@
 ﻿// Simulator.cpp
 #include "Simulator.h"
 #include "DrawBoard.h"
-#include "Component.h"
+#include "Profiler.h"
 
 #include <algorithm>
-#include <cmath>
-#include <map>
-#include <numeric>
+#include <chrono>
 #include <unordered_map>
 
 // ==========================================================
 //  仿真关键点：
-//  1) BuildNetlist 必须正确处理：
+//  1) BuildNetlist 必须正确处理（由 Connectivity 统一实现）：
 //     - 线端点连接
 //     - T 形连接（线的端点落在另一条线的中间）
 //     - pin/节点点落在导线中间（无需手工把线拆段）
-//  2) Step 必须迭代直到网络电平稳定（组合逻辑多级传播）
-//  3) 译码器属于多输出元件，需要按 pinIdx 输出不同值
+//  2) 网表编译进 SimEngine：组合逻辑按拓扑序事件驱动求值，
+//     触发器/寄存器在时钟上升沿两相提交（见 SimEngine.h）
+//  3) 每个网只有第一个输出引脚驱动，其余输出引脚不写网
+//  4) 总线整根是一个网：位宽由所接引脚推出，整字 op（位宽 > 1 的门、分线器/合线器）一次算完
+//  5) 门的求值与子电路模板共用 LogicKernel；子电路按实例直接跑共享的编译模板
+//  6) 网表与求值核心（SimNetlist / SimEngine / LogicKernel）不依赖 wx，
+//     这里只负责从画布提取网表和界面相关的映射，命令行仿真（SimCli）跑同一套核心
+//  7) 连续仿真跑在独立线程上（WorkerLoop），与界面刷新解耦：
+//     仿真线程独占调度器，按目标节拍率或尽快推进，约每 8 ms 发布一次网值快照；
+//     界面按显示刷新节拍取最新快照（PullSnapshot），绘制只读 m_nets，不加锁
 // ==========================================================
 
-
-// ========= 工具：误差判断 =========
-static inline bool NearlyEqualPt(const wxPoint& a, const wxPoint& b, int tol = 4) {
-    return (std::abs(a.x - b.x) <= tol) && (std::abs(a.y - b.y) <= tol);
-}
-
-static inline long long PinKey(int compIdx, int pinIdx) {
-    return (static_cast<long long>(compIdx) << 32) ^ static_cast<unsigned int>(pinIdx);
+namespace {
+    constexpr auto kPublishInterval = std::chrono::milliseconds(8);   // 快照发布间隔（比 60/120Hz 显示稍快）
+    constexpr int kFastBatch = 64;                                    // 尽快跑时每批节拍数（批间才看时钟与输入）
 }
 
-static inline int DivFloorInt(int v, int d) {
-    if (d <= 0) return 0;
-    if (v >= 0) return v / d;
-    return -(((-v) + d - 1) / d);
-}
-
-static inline bool PointOnSegmentTol(const wxPoint& p, const wxPoint& a, const wxPoint& b, int tol) {
-    // 轴对齐线段（Manhattan） + 少量容差
-    if (a.x == b.x) {
-        const int x = a.x;
-        const int y0 = std::min(a.y, b.y);
-        const int y1 = std::max(a.y, b.y);
-        return (std::abs(p.x - x) <= tol) && (p.y >= y0 - tol) && (p.y <= y1 + tol);
-    }
-    if (a.y == b.y) {
-        const int y = a.y;
-        const int x0 = std::min(a.x, b.x);
-        const int x1 = std::max(a.x, b.x);
-        return (std::abs(p.y - y) <= tol) && (p.x >= x0 - tol) && (p.x <= x1 + tol);
-    }
-
-    // 兜底：一般不会出现（你的布线工具是 Manhattan）
-    const double ax = a.x, ay = a.y;
-    const double bx = b.x, by = b.y;
-    const double px = p.x, py = p.y;
-    const double vx = bx - ax;
-    const double vy = by - ay;
-    const double wx_ = px - ax;
-    const double wy_ = py - ay;
-    const double vv = vx * vx + vy * vy;
-    if (vv <= 1e-9) return NearlyEqualPt(p, a, tol);
-
-    double t = (wx_ * vx + wy_ * vy) / vv;
-    if (t < 0.0) t = 0.0;
-    if (t > 1.0) t = 1.0;
-    const double cx = ax + t * vx;
-    const double cy = ay + t * vy;
-    const double dx = px - cx;
-    const double dy = py - cy;
-    return (dx * dx + dy * dy) <= double(tol * tol);
-}
-
-// ========= 并查集 =========
-struct UF {
-    std::vector<int> parent;
-    explicit UF(int n) : parent(n) { std::iota(parent.begin(), parent.end(), 0); }
-    int find(int i) {
-        if (parent[i] == i) return i;
-        return parent[i] = find(parent[i]);
-    }
-    void unite(int i, int j) {
-        const int ri = find(i);
-        const int rj = find(j);
-        if (ri != rj) parent[ri] = rj;
-    }
-};
-
-// ========= 扁平引脚 =========
-struct FlatPin {
-    wxPoint pt;
-    PinRef ref;
-    bool isOutput = false;
-};
-
 Simulator::Simulator(DrawBoard* board) : m_board(board) {}
 
+Simulator::~Simulator() { StopWorker(); }
+
 
 // ==========================================================
 // BuildNetlist：从几何连通性构造仿真网络
 // ==========================================================
 void Simulator::BuildNetlist() {
+    PROF_SCOPE(ZoneBuildNetlist);
+    PauseWorker pause(this);
     m_nets.clear();
     m_wire_to_net_map.clear();
+    m_engine.Reset(0);
+    m_netlist.Clear();
+    m_compOp.clear();
+    m_opComp.clear();
+    m_loops.clear();
+    m_oscEvents = 0;
     if (!m_board) return;
 
-    // 连接容差：不要太大（避免误连），但要能覆盖缩放/取整造成的 1~2 像素误差
-    // 若你有“缩放很多次后偶尔断连”，可把 4 调到 5；一般别再往上。
-    constexpr int CONNECT_TOL = 4;
-    constexpr int CELL = CONNECT_TOL + 1;
-
-    // 1) 收集全部组件引脚
-    std::vector<FlatPin> flat;
-    flat.reserve(256);
-
-    std::vector<wxPoint> nodePts;     // pin 点 + wire 顶点点
-    nodePts.reserve(512);
-    std::vector<int> flatNodeIdx;     // flat[i] -> nodePts idx
-    flatNodeIdx.reserve(256);
-
-    for (int i = 0; i < (int)m_board->components.size(); ++i) {
-        auto* c = m_board->components[i].get();
-        if (!c) continue;
-        const auto pins = c->GetPins();
-        for (int p = 0; p < (int)pins.size(); ++p) {
-            FlatPin fp;
-            fp.pt = pins[p];
-            fp.ref = PinRef{ i, p };
-            fp.isOutput = false;
-
-            switch (c->m_type) {
-            case ComponentType::NODE_START:
-                fp.isOutput = true;
-                break;
-            case ComponentType::NODE_END:
-            case ComponentType::NODE_BASIC:
-                fp.isOutput = false;
-                break;
-            case ComponentType::DECODER24:
-                fp.isOutput = (p >= 3); // EN,A0,A1,Y0..Y3
-                break;
-            case ComponentType::DECODER38:
-                fp.isOutput = (p >= 4); // EN,A0,A1,A2,Y0..Y7
-                break;
-            case ComponentType::NOTGATE:
-            case ComponentType::ANDGATE:
-            case ComponentType::ORGATE:
-            case ComponentType::NANDGATE:
-            case ComponentType::NORGATE:
-            case ComponentType::XORGATE:
-            case ComponentType::XNORGATE:
-                fp.isOutput = (p == (int)pins.size() - 1);
-                break;
-            default:
-                fp.isOutput = false;
-                break;
-            }
-
-            flatNodeIdx.push_back((int)nodePts.size());
-            nodePts.push_back(fp.pt);
-            flat.push_back(fp);
+    // 1) 几何连通性交给共用的提取器（与 BookShelf 导出同一套规则），再落成不依赖 wx 的网表
+    Connectivity conn;
+    m_board->BuildConnectivity(conn);
+    conn.Extract();
+    if (conn.NumPins() == 0) return;
+    m_board->BuildSimNetlist(conn, m_netlist);
+
+    // 2) 每个网：第一个输出引脚做 driver，其余输入引脚做 loads
+    m_nets.resize(m_netlist.NumNets());
+    std::vector<PinRef> drivers;
+    m_netlist.Drivers(drivers);
+    for (int i = 0; i < m_netlist.NumCells(); ++i) {
+        for (int p = 0; p < m_netlist.CellAt(i).numPins; ++p) {
+            const int n = m_netlist.PinNet(i, p);
+            if (n >= 0 && !m_netlist.IsOutputPin(i, p)) m_nets[n].loads.push_back(PinRef{ i, p });
         }
     }
-    if (flat.empty()) return;
-
-    // 2) 收集所有 wire 的折线点
-    std::vector<int> wireAnyNode(m_board->wires.size(), -1);
-    for (int w = 0; w < (int)m_board->wires.size(); ++w) {
-        const auto& poly = m_board->wires[w];
-        if (poly.size() < 2) continue;
-        wireAnyNode[w] = (int)nodePts.size();
-        for (const auto& pt : poly) nodePts.push_back(pt);
+    std::vector<int> netWidth;
+    std::vector<char> widthConflict;
+    m_netlist.ComputeWidths(netWidth, widthConflict);
+    for (int n = 0; n < m_netlist.NumNets(); ++n) {
+        if (drivers[n].compIdx >= 0) m_nets[n].driver = drivers[n];
+        m_nets[n].width = netWidth[n];
     }
-    if (nodePts.empty()) return;
-
-    UF uf((int)nodePts.size());
 
-    // 3) 合并“几乎重合”的点（用于抗缩放取整误差）
-    {
-        auto CellKey = [](int cx, int cy) -> long long {
-            return (static_cast<long long>(cx) << 32) ^ static_cast<unsigned int>(cy);
-            };
-        std::unordered_map<long long, std::vector<int>> buckets;
-        buckets.reserve(nodePts.size() * 2);
-
-        for (int idx = 0; idx < (int)nodePts.size(); ++idx) {
-            const auto& p = nodePts[idx];
-            const int cx = DivFloorInt(p.x, CELL);
-            const int cy = DivFloorInt(p.y, CELL);
-
-            // 查邻域桶，避免漏掉边界情况
-            for (int dx = -1; dx <= 1; ++dx) {
-                for (int dy = -1; dy <= 1; ++dy) {
-                    const long long k = CellKey(cx + dx, cy + dy);
-                    auto it = buckets.find(k);
-                    if (it == buckets.end()) continue;
-                    for (int j : it->second) {
-                        if (NearlyEqualPt(p, nodePts[j], CONNECT_TOL)) uf.unite(idx, j);
-                    }
-                }
-            }
-            buckets[CellKey(cx, cy)].push_back(idx);
-        }
+    // 3) wire -> net 关联（用于渲染着色）
+    for (int w = 0; w < conn.NumWires(); ++w) {
+        const int n = conn.WireNet(w);
+        if (n < 0) continue;
+        m_nets[n].wireIndices.push_back(w);
+        m_wire_to_net_map[w] = n;
     }
 
-    // 4) 通过每一段导线把段上的点合并
-    //    支持：线端点落在另一条线的中间、pin 落在线中间、无需拆线
-    for (int w = 0; w < (int)m_board->wires.size(); ++w) {
-        const auto& poly = m_board->wires[w];
-        if (poly.size() < 2) continue;
-
-        for (size_t k = 1; k < poly.size(); ++k) {
-            const wxPoint a = poly[k - 1];
-            const wxPoint b = poly[k];
-            if (a == b) continue;
-
-            const int minx = std::min(a.x, b.x) - CONNECT_TOL;
-            const int maxx = std::max(a.x, b.x) + CONNECT_TOL;
-            const int miny = std::min(a.y, b.y) - CONNECT_TOL;
-            const int maxy = std::max(a.y, b.y) + CONNECT_TOL;
-
-            std::vector<int> onSeg;
-            onSeg.reserve(8);
-            for (int idx = 0; idx < (int)nodePts.size(); ++idx) {
-                const auto& p = nodePts[idx];
-                if (p.x < minx || p.x > maxx || p.y < miny || p.y > maxy) continue;
-                if (PointOnSegmentTol(p, a, b, CONNECT_TOL)) onSeg.push_back(idx);
-            }
-            for (size_t t = 1; t < onSeg.size(); ++t) uf.unite(onSeg[0], onSeg[t]);
-        }
-    }
+    // 4) 编译进调度器；起始节点先设好电平再上电
+    m_netlist.Compile(m_engine, m_compOp);
+    m_opComp.assign(m_engine.NumOps(), -1);
+    for (int c = 0; c < (int)m_compOp.size(); ++c) if (m_compOp[c] >= 0) m_opComp[m_compOp[c]] = c;
+    for (int c : m_netlist.Inputs()) m_engine.SetSource(m_compOp[c], GetStartNodeValue(c));
+    m_engine.Finalize();
+    SyncNetValues();
+}
 
-    // 5) 根据 UF root 建立 SimNet（只从“组件引脚”生成 driver/loads）
-    std::map<int, SimNet> root_to_net;
-    for (int i = 0; i < (int)flat.size(); ++i) {
-        const int root = uf.find(flatNodeIdx[i]);
-        SimNet& net = root_to_net[root];
 
-        const FlatPin& fp = flat[i];
-        if (fp.isOutput) {
-            if (!net.driver.has_value()) {
-                net.driver = fp.ref;
-            }
-        }
-        else {
-            net.loads.push_back(fp.ref);
-        }
-    }
+// ==========================================================
+// Step：组合逻辑稳定并处理时钟边沿（不翻转时钟源）
+// ==========================================================
+void Simulator::Step() {
+    PROF_SCOPE(ZoneSimStep);
+    PauseWorker pause(this);
+    const SimEngine::Stats before = m_engine.GetStats();
+    m_engine.Step();
+    SyncNetValues();
+    CountTicks(before, 1);
+}
 
-    // 6) wire -> net 关联（按 wire 任意顶点的 root 归属）
-    for (int w = 0; w < (int)m_board->wires.size(); ++w) {
-        const int any = (w >= 0 && w < (int)wireAnyNode.size()) ? wireAnyNode[w] : -1;
-        if (any < 0) continue;
+void Simulator::Tick() {
+    PROF_SCOPE(ZoneSimStep);
+    PauseWorker pause(this);
+    const SimEngine::Stats before = m_engine.GetStats();
+    if (m_engine.HasClock()) m_engine.HalfTick();
+    else                     m_engine.Step();
+    SyncNetValues();
+    CountTicks(before, 1);
+}
 
-        const int root = uf.find(any);
-        auto it = root_to_net.find(root);
-        if (it != root_to_net.end()) {
-            it->second.wireIndices.push_back(w);
-        }
-    }
+long long Simulator::RunCycles(long long n) {
+    PROF_SCOPE(ZoneSimStep);
+    PauseWorker pause(this);
+    const SimEngine::Stats before = m_engine.GetStats();
+    const long long done = m_engine.RunCycles(n);
+    SyncNetValues();
+    CountTicks(before, 2 * done);   // 一个周期两个节拍
+    return done;
+}
 
-    // 7) 转移到 m_nets，并建立 wire -> net 映射
-    m_nets.reserve(root_to_net.size());
-    int net_idx = 0;
-    for (auto& pair : root_to_net) {
-        auto& indices = pair.second.wireIndices;
-        std::sort(indices.begin(), indices.end());
-        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
-
-        for (int wire_idx : indices) m_wire_to_net_map[wire_idx] = net_idx;
-        m_nets.push_back(std::move(pair.second));
-        ++net_idx;
+void Simulator::CountTicks(const SimEngine::Stats& before, long long ticks) {
+    auto& p = prof::Profiler::Get();
+    if (!p.Enabled()) return;
+    const SimEngine::Stats& now = m_engine.GetStats();
+    p.Count(prof::CounterSimTicks, ticks);
+    p.Count(prof::CounterSettlePasses, now.passes - before.passes);
+    p.Count(prof::CounterEvals, now.evals - before.evals);
+    p.Count(prof::CounterChangedNets, now.netChanges - before.netChanges);
+}
+
+void Simulator::SyncNetValues() {
+    for (int n = 0; n < (int)m_nets.size(); ++n) {
+        m_nets[n].value = m_engine.NetWord(n);
+        m_nets[n].unknown = m_engine.NetUnknown(n);
     }
+    std::vector<std::vector<int>> loops;
+    m_engine.OscillatingLoops(loops);
+    SetLoops(loops, m_engine.GetStats().oscillations);
 }
 
+void Simulator::SetLoops(const std::vector<std::vector<int>>& opLoops, long long events) {
+    m_oscEvents = events;
+    m_loops.resize(opLoops.size());
+    for (size_t k = 0; k < opLoops.size(); ++k) {
+        m_loops[k].clear();
+        for (int op : opLoops[k]) {
+            if (op >= 0 && op < (int)m_opComp.size() && m_opComp[op] >= 0) m_loops[k].push_back(m_opComp[op]);
+        }
+    }
+}
 
 // ==========================================================
-// ComputeAllGateOutputs：基于当前 net.value 计算每个元件输出
+// 仿真线程
 // ==========================================================
-void Simulator::ComputeAllGateOutputs(std::vector<bool>& gateOut,
-    std::unordered_map<long long, bool>& multiOut) {
+void Simulator::StartWorker(double ticksPerSec) {
+    StopWorker();
+    m_rate.store(std::max(0.0, ticksPerSec));
+    m_workStop = false;
+    m_snap.Reset();
+    m_shownCycles = m_engine.Cycles();
+    m_worker = std::thread(&Simulator::WorkerLoop, this);
+}
 
-    if (!m_board) return;
+void Simulator::StopWorker() {
+    if (!m_worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lk(m_workMu);
+        m_workStop = true;
+    }
+    m_workCv.notify_all();
+    m_worker.join();
+
+    // 线程停了，调度器归界面线程：把还没应用的输入补上，网值直接同步
+    for (const auto& pv : m_pending) m_engine.SetSource(pv.first, pv.second);
+    m_pending.clear();
+    m_hasPending.store(false);
+    SyncNetValues();
+}
 
-    gateOut.assign(m_board->components.size(), false);
-    multiOut.clear();
-
-    for (int i = 0; i < (int)m_board->components.size(); ++i) {
-        auto* c = m_board->components[i].get();
-        if (!c) continue;
-        const auto pins = c->GetPins();
-
-        // 确定输入引脚数量
-        int inCount = 0;
-        switch (c->m_type) {
-        case ComponentType::NODE_START:  inCount = 0; break;
-        case ComponentType::NODE_END:    inCount = 1; break;
-        case ComponentType::NODE_BASIC:  inCount = (int)pins.size(); break;
-        case ComponentType::DECODER24:   inCount = 3; break; // EN,A0,A1
-        case ComponentType::DECODER38:   inCount = 4; break; // EN,A0,A1,A2
-        case ComponentType::NOTGATE:     inCount = 1; break;
-        default:
-            inCount = std::max(0, (int)pins.size() - 1);
-            break;
-        }
+void Simulator::PublishSnapshot(long long ticks) {
+    SimSnapshot& s = m_snap.WriteSlot();
+    s.nets = m_engine.NetWords();   // 容量够时不再分配
+    s.unknown.clear();
+    if (m_engine.NumUnknownNets() > 0) {
+        s.unknown.resize(s.nets.size());
+        for (int n = 0; n < (int)s.nets.size(); ++n) s.unknown[n] = m_engine.NetUnknown(n);
+    }
+    m_engine.OscillatingLoops(s.loops);
+    s.oscillations = m_engine.GetStats().oscillations;
+    s.cycles = m_engine.Cycles();
+    s.ticks = ticks;
+    m_snap.Publish();
+}
 
-        // 收集输入信号
-        std::vector<bool> ins(inCount, false);
-        for (const auto& net : m_nets) {
-            const bool netVal = net.value;
-            for (const auto& ld : net.loads) {
-                if (ld.compIdx == i && ld.pinIdx >= 0 && ld.pinIdx < inCount) {
-                    ins[ld.pinIdx] = netVal;
-                }
+void Simulator::WorkerLoop() {
+    using Clock = std::chrono::steady_clock;
+    const bool clocked = m_engine.HasClock();
+    long long ticks = 0, batchTicks = 0;
+    Clock::duration busy{};
+    SimEngine::Stats mark = m_engine.GetStats();
+    Clock::time_point next = Clock::now(), lastPub = next;
+
+    // 本批的忙碌时间与计数交给性能浮层（按批记一次，不逐节拍加锁）
+    auto flush = [&](Clock::time_point now) {
+        auto& p = prof::Profiler::Get();
+        if (p.Enabled() && batchTicks > 0) {
+            const SimEngine::Stats& st = m_engine.GetStats();
+            p.Record(prof::ZoneSimStep, now - busy, now);
+            p.Count(prof::CounterSimTicks, batchTicks);
+            p.Count(prof::CounterSettlePasses, st.passes - mark.passes);
+            p.Count(prof::CounterEvals, st.evals - mark.evals);
+            p.Count(prof::CounterChangedNets, st.netChanges - mark.netChanges);
+        }
+        mark = m_engine.GetStats();
+        batchTicks = 0;
+        busy = Clock::duration::zero();
+    };
+
+    for (;;) {
+        if (m_hasPending.load(std::memory_order_acquire) || !clocked) {
+            std::unique_lock<std::mutex> lk(m_workMu);
+            // 没有时钟源：稳定之后网值不会再变，发布一次后睡到输入变化
+            if (!clocked && m_pending.empty() && !m_workStop) {
+                PublishSnapshot(ticks);
+                flush(Clock::now());
+                m_workCv.wait(lk, [this] { return m_workStop || !m_pending.empty(); });
             }
+            if (m_workStop) break;
+            for (const auto& pv : m_pending) m_engine.SetSource(pv.first, pv.second);
+            m_pending.clear();
+            m_hasPending.store(false);
         }
 
-        // 计算输出
-        switch (c->m_type) {
-        case ComponentType::NODE_START: {
-            auto it = m_startNodeValue.find(i);
-            gateOut[i] = (it != m_startNodeValue.end()) ? it->second : false;
-            break;
-        }
-        case ComponentType::NODE_END: {
-            gateOut[i] = (inCount >= 1) ? ins[0] : false;
-            break;
-        }
-        case ComponentType::ANDGATE: {
-            bool v = true;
-            for (bool b : ins) v = v && b;
-            gateOut[i] = (inCount > 0) ? v : false;
-            break;
-        }
-        case ComponentType::ORGATE: {
-            bool v = false;
-            for (bool b : ins) v = v || b;
-            gateOut[i] = (inCount > 0) ? v : false;
-            break;
-        }
-        case ComponentType::NOTGATE: {
-            gateOut[i] = (inCount >= 1) ? !ins[0] : true;
-            break;
+        const double rate = m_rate.load(std::memory_order_relaxed);
+        const int batch = (rate > 0 || !clocked) ? 1 : kFastBatch;
+        const Clock::time_point t0 = Clock::now();
+        for (int k = 0; k < batch; ++k) {
+            if (clocked) m_engine.HalfTick();
+            else         m_engine.Step();
         }
-        case ComponentType::NANDGATE: {
-            bool v = true;
-            for (bool b : ins) v = v && b;
-            gateOut[i] = (inCount > 0) ? !v : true;
-            break;
-        }
-        case ComponentType::NORGATE: {
-            bool v = false;
-            for (bool b : ins) v = v || b;
-            gateOut[i] = (inCount > 0) ? !v : true;
-            break;
-        }
-        case ComponentType::XORGATE: {
-            bool v = false;
-            for (bool b : ins) v ^= b;
-            gateOut[i] = (inCount > 0) ? v : false;
-            break;
-        }
-        case ComponentType::XNORGATE: {
-            bool v = false;
-            for (bool b : ins) v ^= b;
-            gateOut[i] = (inCount > 0) ? !v : true;
-            break;
-        }
-        case ComponentType::DECODER24: {
-            // 7 pins: EN(0),A0(1),A1(2),Y0(3)..Y3(6)
-            const bool en = (inCount >= 1) ? ins[0] : false;
-            const int a0 = (inCount >= 2 && ins[1]) ? 1 : 0;
-            const int a1 = (inCount >= 3 && ins[2]) ? 1 : 0;
-            const int idx = (a1 << 1) | a0;
-            for (int outPin = 3; outPin <= 6; ++outPin) {
-                const bool v = en && ((outPin - 3) == idx);
-                multiOut[PinKey(i, outPin)] = v;
-            }
-            gateOut[i] = false;
-            break;
+        const Clock::time_point now = Clock::now();
+        busy += now - t0;
+        ticks += batch;
+        batchTicks += batch;
+
+        if (now - lastPub >= kPublishInterval) {
+            PublishSnapshot(ticks);
+            flush(now);
+            lastPub = now;
         }
-        case ComponentType::DECODER38: {
-            // 12 pins: EN(0),A0(1),A1(2),A2(3),Y0(4)..Y7(11)
-            const bool en = (inCount >= 1) ? ins[0] : false;
-            const int a0 = (inCount >= 2 && ins[1]) ? 1 : 0;
-            const int a1 = (inCount >= 3 && ins[2]) ? 1 : 0;
-            const int a2 = (inCount >= 4 && ins[3]) ? 1 : 0;
-            const int idx = (a2 << 2) | (a1 << 1) | a0;
-            for (int outPin = 4; outPin <= 11; ++outPin) {
-                const bool v = en && ((outPin - 4) == idx);
-                multiOut[PinKey(i, outPin)] = v;
-            }
-            gateOut[i] = false;
-            break;
+
+        if (rate > 0) {
+            // 按目标节拍率排下一拍；落后太多（调试暂停、系统卡顿）时不追赶
+            next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+            if (now - next > std::chrono::milliseconds(100)) next = now;
+            std::unique_lock<std::mutex> lk(m_workMu);
+            m_workCv.wait_until(lk, next, [this] { return m_workStop || !m_pending.empty(); });
+            if (m_workStop) break;
         }
-        case ComponentType::NODE_BASIC:
-        default:
-            gateOut[i] = false;
-            break;
+        else {
+            std::lock_guard<std::mutex> lk(m_workMu);
+            if (m_workStop) break;
         }
     }
+    PublishSnapshot(ticks);
+    flush(Clock::now());
 }
 
-
-// ==========================================================
-// Step：迭代传播直到稳定（Settle）
-// ==========================================================
-void Simulator::Step() {
-    if (!m_board) return;
-
-    const int MAX_ITERATIONS = 64;
-    bool changed = true;
-
-    std::vector<bool> gateOut(m_board->components.size(), false);
-    std::unordered_map<long long, bool> multiOut;
-    multiOut.reserve(m_board->components.size() * 4);
-
-    for (int iter = 0; iter < MAX_ITERATIONS && changed; ++iter) {
-        changed = false;
-
-        // 1) 计算输出
-        ComputeAllGateOutputs(gateOut, multiOut);
-
-        // 2) 写回网络
-        for (auto& net : m_nets) {
-            bool new_val = false;
-
-            if (net.driver.has_value()) {
-                const auto& d = *net.driver;
-                if (d.compIdx >= 0 && d.compIdx < (int)m_board->components.size()) {
-                    auto* dc = m_board->components[d.compIdx].get();
-                    if (dc && (dc->m_type == ComponentType::DECODER24 || dc->m_type == ComponentType::DECODER38)) {
-                        auto it = multiOut.find(PinKey(d.compIdx, d.pinIdx));
-                        new_val = (it != multiOut.end()) ? it->second : false;
-                    }
-                    else {
-                        if (d.compIdx >= 0 && d.compIdx < (int)gateOut.size()) {
-                            new_val = gateOut[d.compIdx];
-                        }
-                    }
-                }
-            }
-
-            if (net.value != new_val) {
-                net.value = new_val;
-                changed = true;
-            }
-        }
+bool Simulator::PullSnapshot() {
+    if (!m_snap.Acquire()) return false;
+    const SimSnapshot& s = m_snap.ReadSlot();
+    const int n = (int)std::min(s.nets.size(), m_nets.size());
+    for (int i = 0; i < n; ++i) {
+        m_nets[i].value = s.nets[i];
+        m_nets[i].unknown = !s.unknown.empty() && s.unknown[i] != 0;
     }
+    SetLoops(s.loops, s.oscillations);
+    m_shownCycles = s.cycles;
+    return true;
 }
 
 void Simulator::Run() { m_running = true; }
@@ -457,17 +295,39 @@ void Simulator::Stop() { m_running = false; }
 // IsWireHigh：wire 着色查询
 // ==========================================================
 bool Simulator::IsWireHigh(int wireIndex) const {
+    return WireValue(wireIndex) != 0;
+}
+
+bool Simulator::IsWireUnknown(int wireIndex) const {
     auto it = m_wire_to_net_map.find(wireIndex);
     if (it == m_wire_to_net_map.end()) return false;
+    return it->second >= 0 && it->second < (int)m_nets.size() && m_nets[it->second].unknown;
+}
+
+uint64_t Simulator::WireValue(int wireIndex) const {
+    auto it = m_wire_to_net_map.find(wireIndex);
+    if (it == m_wire_to_net_map.end()) return 0;
 
     const int net_idx = it->second;
-    if (net_idx < 0 || net_idx >= (int)m_nets.size()) return false;
+    if (net_idx < 0 || net_idx >= (int)m_nets.size()) return 0;
 
     return m_nets[net_idx].value;
 }
 
 void Simulator::SetStartNodeValue(int compIdx, bool v) {
     m_startNodeValue[compIdx] = v;
+    if (compIdx < 0 || compIdx >= (int)m_compOp.size()) return;
+    if (WorkerRunning()) {
+        // 调度器归仿真线程：排进队列，下一拍之前应用
+        {
+            std::lock_guard<std::mutex> lk(m_workMu);
+            m_pending.emplace_back(m_compOp[compIdx], v);
+            m_hasPending.store(true, std::memory_order_release);
+        }
+        m_workCv.notify_all();
+        return;
+    }
+    m_engine.SetSource(m_compOp[compIdx], v);
 }
 
 bool Simulator::GetStartNodeValue(int compIdx) const {
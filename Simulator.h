@@ -1,42 +1,97 @@
 ﻿// Simulator.h
 #pragma once
 #include <wx/wx.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 #include <optional>
+#include "Connectivity.h"   // PinRef
+#include "SimEngine.h"
+#include "SimNetlist.h"
 
 class DrawBoard;   // 前向声明
 class Component;
 
-// ========== 引脚引用结构 ==========
-struct PinRef {
-    int compIdx = -1;  // 组件下标
-    int pinIdx = -1;   // 引脚下标（0..n-1）
-    bool operator==(const PinRef& o) const { return compIdx == o.compIdx && pinIdx == o.pinIdx; }
-};
-
 // ========== 仿真用网络结构 (避免与 bookshelf::Net 冲突) ==========
 struct SimNet {
     std::optional<PinRef> driver;   // 驱动引脚
     std::vector<PinRef>   loads;    // 被驱动引脚
-    bool value = false;             // 当前电平
+    uint64_t value = 0;             // 当前值：单线只用最低位，总线为整个字
+    int width = 1;                  // 位宽（由所接引脚推出，见 DrawBoard::ComputeNetWidths）
+    bool unknown = false;           // X：由不收敛（振荡）的组合环驱动
     std::vector<int> wireIndices;   // 关联的 wire 索引，用于渲染
 };
 
+// ========== 仿真线程发布给界面的网值快照 ==========
+struct SimSnapshot {
+    std::vector<uint64_t> nets;   // 按网下标
+    std::vector<uint8_t> unknown; // 按网下标的 X 标记；没有振荡的环时为空
+    std::vector<std::vector<int>> loops;   // 振荡的环（op 下标）
+    long long oscillations = 0;   // 见 SimEngine::Stats::oscillations
+    long long cycles = 0;
+    long long ticks = 0;          // 仿真线程启动以来的节拍数
+};
+
+// 双缓冲快照：写方（仿真线程）写完整块后与“就绪”槽交换，读方（界面线程）只在有新快照时换走就绪槽；
+// 多一个备用槽，双方各占一块、互不等待，不加锁也不会读到写了一半的快照
+class SnapshotBuffer {
+public:
+    SimSnapshot& WriteSlot() { return m_slots[m_write]; }
+    void Publish() { m_write = m_ready.exchange(m_write | kFresh, std::memory_order_acq_rel) & kIndex; }
+    // 有新快照时换到读方并返回 true；ReadSlot 始终是最近取到的那块
+    bool Acquire() {
+        if (!(m_ready.load(std::memory_order_relaxed) & kFresh)) return false;
+        m_read = m_ready.exchange(m_read, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+    const SimSnapshot& ReadSlot() const { return m_slots[m_read]; }
+    // 双方都停下时调用：丢掉未取的快照
+    void Reset() { m_ready.store(1); m_write = 0; m_read = 2; }
+
+private:
+    static constexpr int kIndex = 3, kFresh = 4;
+    SimSnapshot m_slots[3];
+    int m_write = 0, m_read = 2;
+    std::atomic<int> m_ready{ 1 };
+};
+
 // ========== 仿真控制类 ==========
 class Simulator {
 public:
     explicit Simulator(DrawBoard* board);
+    ~Simulator();
 
-    void BuildNetlist();   // 从 DrawBoard 生成仿真网络
-    void Step();           // 单步仿真（迭代直到稳定）
+    // 以下四个在仿真线程运行时会先停下它，做完再接着跑
+    void BuildNetlist();   // 从 DrawBoard 生成仿真网络并编译进调度器（时序元件复位）
+    void Step();           // 单步仿真：组合逻辑稳定 + 处理时钟边沿
+    void Tick();           // 一个节拍：时钟源翻转半个周期后 Step（没有时钟源时等同 Step）
+    long long RunCycles(long long n);   // 连跑 n 个完整时钟周期（不刷新界面）
+
+    // ===== 仿真线程：连续推进节拍，按显示节奏发布网值快照 =====
+    // ticksPerSec > 0 为目标节拍率，0 为尽快跑；没有时钟源时稳定后只等输入变化
+    void StartWorker(double ticksPerSec);
+    void StopWorker();     // 停下并把最终网值同步到 m_nets
+    bool WorkerRunning() const { return m_worker.joinable(); }
+    void SetTargetRate(double ticksPerSec) { m_rate.store(ticksPerSec); m_workCv.notify_all(); }
+    // 界面线程：取最新快照写入 m_nets[].value；有新快照返回 true
+    bool PullSnapshot();
     void Run();            // 启动连续仿真
     void Stop();           // 停止仿真
     bool IsRunning() const { return m_running; }
 
-    bool IsWireHigh(int wireIndex) const;             // 查询线的高低电平
+    bool IsWireHigh(int wireIndex) const;             // 查询线的高低电平（总线：非零）
+    bool IsWireUnknown(int wireIndex) const;          // 线所在网是否为 X（振荡的环驱动）
+    uint64_t WireValue(int wireIndex) const;          // 线所在网的值（总线整字）
     void SetStartNodeValue(int compIdx, bool v);      // 设置起始节点输出值
     bool GetStartNodeValue(int compIdx) const;        // 获取起始节点输出值
+    bool HasClock() const { return m_engine.HasClock(); }
+    // 当前判为振荡的组合环（元件下标）；OscillationEvents 变了说明又有环被判为振荡
+    const std::vector<std::vector<int>>& OscillatingLoops() const { return m_loops; }
+    long long OscillationEvents() const { return m_oscEvents; }
+    long long Cycles() const { return WorkerRunning() ? m_shownCycles : m_engine.Cycles(); }
 
     std::vector<SimNet> m_nets;                       // 仿真网络
     std::unordered_map<int, bool> m_startNodeValue;   // 起始节点电平表
@@ -48,8 +103,36 @@ private:
     // wire 索引到 net 索引的映射（用于渲染着色）
     std::unordered_map<int, int> m_wire_to_net_map;
 
-    // gateOut: 单输出元件的输出（按 compIdx 存）
-    // multiOut: 多输出元件（目前仅译码器）的输出（按 (compIdx,pinIdx) 存）
-    void ComputeAllGateOutputs(std::vector<bool>& gateOut,
-        std::unordered_map<long long, bool>& multiOut);
+    SimNetlist m_netlist;        // 画布提取出的网表（单元下标即元件下标）
+    SimEngine m_engine;
+    std::vector<int> m_compOp;   // 元件下标 → 调度器 op（-1 为不参与求值）
+    std::vector<int> m_opComp;   // 调度器 op → 元件下标
+    std::vector<std::vector<int>> m_loops;   // 振荡的环（元件下标），随网值一起同步
+    long long m_oscEvents = 0;
+    void SetLoops(const std::vector<std::vector<int>>& opLoops, long long events);
+    void SyncNetValues();        // 调度器网值 → m_nets[].value（渲染/属性面板读取）
+
+    // 仿真线程运行时，m_engine 只归它；界面线程读 m_nets（来自快照），改起始节点电平走 m_pending
+    std::thread m_worker;
+    std::mutex m_workMu;
+    std::condition_variable m_workCv;
+    bool m_workStop = false;                       // 受 m_workMu 保护
+    std::vector<std::pair<int, bool>> m_pending;   // op, 电平；受 m_workMu 保护
+    std::atomic<bool> m_hasPending{ false };
+    std::atomic<double> m_rate{ 0.0 };
+    SnapshotBuffer m_snap;
+    long long m_shownCycles = 0;
+    void WorkerLoop();
+    void PublishSnapshot(long long ticks);
+
+    // 作用域内停下仿真线程，离开时按原节拍率重新启动
+    class PauseWorker {
+    public:
+        explicit PauseWorker(Simulator* s) : m_s(s), m_was(s->WorkerRunning()) { if (m_was) s->StopWorker(); }
+        ~PauseWorker() { if (m_was) m_s->StartWorker(m_s->m_rate.load()); }
+    private:
+        Simulator* m_s;
+        bool m_was;
+    };
+    void CountTicks(const SimEngine::Stats& before, long long ticks);   // 本次推进的计数交给性能浮层
 };
@@ -0,0 +1,75 @@
+﻿// SpatialIndex.cpp
+#include "SpatialIndex.h"
+
+#include <algorithm>
+
+int SpatialIndex::CellOf(int v) const
+{
+    if (v >= 0) return v / m_cell;
+    return -(((-v) + m_cell - 1) / m_cell);
+}
+
+void SpatialIndex::Clear()
+{
+    m_boxes.clear();
+    m_cells.clear();
+    m_stamp.clear();
+    m_stampId = 0;
+    m_idEnd = 0;
+}
+
+void SpatialIndex::Insert(int id, int x0, int y0, int x1, int y1)
+{
+    if (id < 0) return;
+    if (x1 < x0) std::swap(x0, x1);
+    if (y1 < y0) std::swap(y0, y1);
+    m_idEnd = std::max(m_idEnd, id + 1);
+    const int b = (int)m_boxes.size();
+    m_boxes.push_back(Box{ x0, y0, x1, y1, id });
+
+    for (int cy = CellOf(y0); cy <= CellOf(y1); ++cy)
+        for (int cx = CellOf(x0); cx <= CellOf(x1); ++cx) m_cells[Key(cx, cy)].push_back(b);
+}
+
+void SpatialIndex::Query(int x0, int y0, int x1, int y1, std::vector<int>& out) const
+{
+    out.clear();
+    if (x1 < x0) std::swap(x0, x1);
+    if (y1 < y0) std::swap(y0, y1);
+
+    // 同一对象跨多个格子或有多个矩形时，按 id 用时间戳去重
+    if (m_stamp.size() < (size_t)m_idEnd) m_stamp.resize(m_idEnd, 0);
+    if (++m_stampId == 0) { std::fill(m_stamp.begin(), m_stamp.end(), 0); m_stampId = 1; }
+
+    const int cx0 = CellOf(x0), cx1 = CellOf(x1), cy0 = CellOf(y0), cy1 = CellOf(y1);
+    // 查询框远大于已登记对象所占格子时，直接扫全部对象更省
+    const long long cellsInQuery = (long long)(cx1 - cx0 + 1) * (cy1 - cy0 + 1);
+    if (cellsInQuery > (long long)m_cells.size()) {
+        for (const Box& b : m_boxes) {
+            if (m_stamp[b.id] == m_stampId) continue;
+            if (b.x0 <= x1 && b.x1 >= x0 && b.y0 <= y1 && b.y1 >= y0) {
+                m_stamp[b.id] = m_stampId;
+                out.push_back(b.id);
+            }
+        }
+        std::sort(out.begin(), out.end());
+        return;
+    }
+
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            auto it = m_cells.find(Key(cx, cy));
+            if (it == m_cells.end()) continue;
+            for (int k : it->second) {
+                const Box& b = m_boxes[k];
+                if (m_stamp[b.id] == m_stampId) continue;
+                // 只有真正相交才记下：同一 id 的其他矩形可能还在别的格子里命中
+                if (b.x0 <= x1 && b.x1 >= x0 && b.y0 <= y1 && b.y1 >= y0) {
+                    m_stamp[b.id] = m_stampId;
+                    out.push_back(b.id);
+                }
+            }
+        }
+    }
+    std::sort(out.begin(), out.end());
+}
@@ -0,0 +1,40 @@
+﻿// SpatialIndex.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// ==========================================================
+//  矩形空间索引（均匀网格，不依赖 wx）
+//  按 id 登记轴对齐包围盒，查询与给定矩形相交的 id
+//  一个 id 可登记多个矩形：折线按段登记，长 L 形连线不会占满整个包围盒里的格子
+//  命中测试、框选都只看附近格子里的对象，不再遍历全部元件/连线
+// ==========================================================
+
+class SpatialIndex {
+public:
+    explicit SpatialIndex(int cellSize = 128) : m_cell(cellSize > 0 ? cellSize : 128) {}
+
+    void Clear();
+    // id 需为非负整数；同一 id 可多次登记（各矩形取并），重建时先 Clear
+    void Insert(int id, int x0, int y0, int x1, int y1);
+
+    // 有矩形与 [x0,x1]x[y0,y1]（闭区间）相交的 id，去重后升序输出
+    void Query(int x0, int y0, int x1, int y1, std::vector<int>& out) const;
+
+    size_t Size() const { return m_boxes.size(); }   // 登记的矩形数
+
+private:
+    struct Box { int x0, y0, x1, y1; int id; };
+
+    static uint64_t Key(int cx, int cy) { return (uint64_t(uint32_t(cx)) << 32) | uint32_t(cy); }
+    int CellOf(int v) const;
+
+    int m_cell;
+    int m_idEnd = 0;                                        // 最大 id + 1
+    std::vector<Box> m_boxes;                               // 按登记顺序
+    std::unordered_map<uint64_t, std::vector<int>> m_cells; // 格子 → 与之相交的矩形（m_boxes 下标）
+    mutable std::vector<uint32_t> m_stamp;                  // 按 id：查询去重
+    mutable uint32_t m_stampId = 0;
+};
@@ -0,0 +1,262 @@
+﻿// Subcircuit.cpp
+#include "Subcircuit.h"
+
+#include <wx/graphics.h>
+#include <algorithm>
+#include <cmath>
+#include "Connectivity.h"
+#include "LogicKernel.h"
+
+namespace {
+    constexpr double kHalfW = 45.0;     // 方框半宽
+    constexpr double kPinLen = 15.0;    // 引脚短线长度（引脚端点 = 中心 ± 60，落在格点上）
+    constexpr double kPinPitch = 20.0;  // 引脚间距
+    constexpr int kMaxSettle = 64;      // 内部有环时的迭代上限（与仿真器一致）
+
+    // 端口排序：自上而下，同高度自左向右
+    bool PortLess(const wxPoint& a, const wxPoint& b) {
+        return a.y != b.y ? a.y < b.y : a.x < b.x;
+    }
+}
+
+// ============ 定义 ============
+std::shared_ptr<SubcircuitDef> SubcircuitDef::Create(std::string name,
+    std::vector<std::unique_ptr<Component>> parts,
+    std::vector<std::vector<wxPoint>> wires)
+{
+    std::shared_ptr<SubcircuitDef> def(new SubcircuitDef());
+    def->m_name = std::move(name);
+    def->m_parts = std::move(parts);
+    def->m_wires = std::move(wires);
+    def->Compile();
+    return def;
+}
+
+void SubcircuitDef::Compile()
+{
+    // 1) 内部几何连通性 → 局部网
+    Connectivity conn;
+    for (int i = 0; i < (int)m_parts.size(); ++i) {
+        const auto pins = m_parts[i]->GetPins();
+        for (int p = 0; p < (int)pins.size(); ++p) conn.AddPin(PinRef{ i, p }, pins[p].x, pins[p].y);
+    }
+    for (const auto& poly : m_wires) conn.AddWire(poly);
+    conn.Extract();
+    m_numNets = conn.NumNets();
+
+    std::vector<int> pinStart(m_parts.size() + 1, 0);
+    for (int k = 0; k < conn.NumPins(); ++k) ++pinStart[conn.Pin(k).compIdx + 1];
+    for (size_t i = 0; i < m_parts.size(); ++i) pinStart[i + 1] += pinStart[i];
+    auto netOf = [&](int comp, int pin) { return conn.PinNet(pinStart[comp] + pin); };   // 引脚按元件顺序加入
+
+    // 2) 端口
+    std::vector<std::pair<wxPoint, int>> ins, outs;
+    for (int i = 0; i < (int)m_parts.size(); ++i) {
+        Component* c = m_parts[i].get();
+        if (c->m_type == NODE_START) ins.push_back({ c->GetCenter(), netOf(i, 0) });
+        else if (c->m_type == NODE_END) outs.push_back({ c->GetCenter(), netOf(i, 0) });
+    }
+    auto byPos = [](const std::pair<wxPoint, int>& a, const std::pair<wxPoint, int>& b) { return PortLess(a.first, b.first); };
+    std::sort(ins.begin(), ins.end(), byPos);
+    std::sort(outs.begin(), outs.end(), byPos);
+    for (const auto& e : ins) m_inNets.push_back(e.second);
+    for (const auto& e : outs) m_outNets.push_back(e.second);
+
+    // 3) 求值元件表：结点类只参与连通，不求值
+    std::vector<Op> ops;
+    std::vector<int> opNets;
+    m_flatGates = 0;
+    for (int i = 0; i < (int)m_parts.size(); ++i) {
+        Component* c = m_parts[i].get();
+        if (c->m_type == NODE_START || c->m_type == NODE_END || c->m_type == NODE_BASIC) continue;
+        const int numPins = pinStart[i + 1] - pinStart[i];
+        Op op{ c->m_type, nullptr, (int)opNets.size(), 0, 0 };
+        if (c->m_type == SUBCIRCUIT) {
+            op.sub = static_cast<SubcircuitComp*>(c)->Def().get();
+            op.nIn = op.sub->NumInputs();
+            m_flatGates += op.sub->FlatGateCount();
+        }
+        else {
+            op.nIn = logic::InputCount(c->m_type, numPins);
+            ++m_flatGates;
+        }
+        op.nOut = std::max(0, numPins - op.nIn);
+        for (int p = 0; p < numPins; ++p) opNets.push_back(netOf(i, p));
+        ops.push_back(op);
+    }
+
+    // 4) 拓扑排序：A 的输出网是 B 的输入网则 A 在前（Kahn）
+    const int n = (int)ops.size();
+    std::vector<std::vector<int>> readers(m_numNets);
+    for (int k = 0; k < n; ++k) {
+        for (int p = 0; p < ops[k].nIn; ++p) {
+            const int net = opNets[ops[k].first + p];
+            if (net >= 0) readers[net].push_back(k);
+        }
+    }
+    std::vector<int> indeg(n, 0);
+    std::vector<std::vector<int>> succ(n);
+    for (int k = 0; k < n; ++k) {
+        for (int p = ops[k].nIn; p < ops[k].nIn + ops[k].nOut; ++p) {
+            const int net = opNets[ops[k].first + p];
+            if (net < 0) continue;
+            for (int r : readers[net]) { succ[k].push_back(r); ++indeg[r]; }
+        }
+    }
+    std::vector<int> order;
+    order.reserve(n);
+    for (int k = 0; k < n; ++k) if (indeg[k] == 0) order.push_back(k);
+    for (size_t h = 0; h < order.size(); ++h) {
+        for (int s : succ[order[h]]) if (--indeg[s] == 0) order.push_back(s);
+    }
+    m_cyclic = (int)order.size() < n;
+    if (m_cyclic) {
+        for (int k = 0; k < n; ++k) if (indeg[k] > 0) order.push_back(k);
+    }
+
+    // 5) 按拓扑序重排，引脚网紧凑存放
+    m_ops.clear();
+    m_opNets.clear();
+    m_ops.reserve(n);
+    m_opNets.reserve(opNets.size());
+    for (int k : order) {
+        Op op = ops[k];
+        const int numPins = op.nIn + op.nOut;
+        op.first = (int)m_opNets.size();
+        m_opNets.insert(m_opNets.end(), opNets.begin() + ops[k].first, opNets.begin() + ops[k].first + numPins);
+        m_ops.push_back(op);
+    }
+}
+
+void SubcircuitDef::Evaluate(const bool* in, bool* out) const
+{
+    // 局部网值：小定义用栈上缓冲，避免每次求值分配
+    bool small[256];
+    std::unique_ptr<bool[]> big;
+    bool* nets = small;
+    if (m_numNets > 256) { big.reset(new bool[m_numNets]); nets = big.get(); }
+    std::fill(nets, nets + m_numNets, false);
+    for (int k = 0; k < NumInputs(); ++k) {
+        if (m_inNets[k] >= 0) nets[m_inNets[k]] = in[k];
+    }
+
+    bool inBuf[64], outBuf[64];
+    std::unique_ptr<bool[]> inHeap, outHeap;   // 引脚超过 64 个时才分配，只增不减
+    int inCap = 0, outCap = 0;
+    const int maxPass = m_cyclic ? kMaxSettle : 1;
+    for (int pass = 0; pass < maxPass; ++pass) {
+        bool changed = false;
+        for (const Op& op : m_ops) {
+            bool* opIn = inBuf;
+            bool* opOut = outBuf;
+            if (op.nIn > 64) {
+                if (op.nIn > inCap) { inHeap.reset(new bool[op.nIn]); inCap = op.nIn; }
+                opIn = inHeap.get();
+            }
+            if (op.nOut > 64) {
+                if (op.nOut > outCap) { outHeap.reset(new bool[op.nOut]); outCap = op.nOut; }
+                opOut = outHeap.get();
+            }
+
+            const int* pn = m_opNets.data() + op.first;
+            for (int p = 0; p < op.nIn; ++p) opIn[p] = pn[p] >= 0 && nets[pn[p]];
+            if (op.sub) op.sub->Evaluate(opIn, opOut);
+            else        logic::Evaluate(op.type, opIn, op.nIn, opOut, op.nOut);
+            for (int p = 0; p < op.nOut; ++p) {
+                const int net = pn[op.nIn + p];
+                if (net >= 0 && nets[net] != opOut[p]) { nets[net] = opOut[p]; changed = true; }
+            }
+        }
+        if (!changed) break;
+    }
+
+    for (int k = 0; k < NumOutputs(); ++k) out[k] = m_outNets[k] >= 0 && nets[m_outNets[k]];
+}
+
+// ============ 实例 ============
+SubcircuitComp::SubcircuitComp(wxPoint center, std::shared_ptr<const SubcircuitDef> def)
+    : Component(center, SUBCIRCUIT), m_def(std::move(def))
+{
+    UpdateGeometry();
+}
+
+double SubcircuitComp::HalfH() const
+{
+    const int rows = m_def ? std::max(m_def->NumInputs(), m_def->NumOutputs()) : 1;
+    return (std::max(rows, 1) * kPinPitch / 2.0 + 10.0) * scale;
+}
+
+void SubcircuitComp::drawSelf(wxMemoryDC& memDC) {
+    wxGraphicsContext* gc = wxGraphicsContext::Create(memDC);
+    if (!gc) return;
+
+    gc->SetPen(wxPen(wxColour(0, 0, 0), 2));
+    gc->SetBrush(*wxWHITE_BRUSH);
+
+    const double halfW = kHalfW * scale;
+    const double halfH = HalfH();
+
+#if wxCHECK_VERSION(3,1,0)
+    gc->DrawRoundedRectangle(m_center.x - halfW, m_center.y - halfH, 2 * halfW, 2 * halfH, 4.0 * scale);
+#else
+    wxGraphicsPath rect = gc->CreatePath();
+    rect.AddRectangle(m_center.x - halfW, m_center.y - halfH, 2 * halfW, 2 * halfH);
+    gc->StrokePath(rect);
+#endif
+
+    // 引脚短线
+    const auto pins = GetPins();
+    const int nIn = m_def ? m_def->NumInputs() : 0;
+    for (int k = 0; k < (int)pins.size(); ++k) {
+        const double tipX = (k < nIn) ? m_center.x - halfW : m_center.x + halfW;
+        gc->StrokeLine(pins[k].x, pins[k].y, tipX, pins[k].y);
+    }
+
+    // 名字居中
+    if (m_def) {
+        gc->SetFont(wxFontInfo(int(std::max(6.0, 9.0 * scale))).Family(wxFONTFAMILY_DEFAULT), *wxBLACK);
+        const wxString label = wxString::FromUTF8(m_def->Name().c_str());
+        double tw = 0, th = 0, descent = 0, extlead = 0;
+        gc->GetTextExtent(label, &tw, &th, &descent, &extlead);
+        gc->DrawText(label, m_center.x - tw / 2, m_center.y - th / 2);
+    }
+
+    if (m_isSelected) {
+        gc->SetPen(wxPen(wxColour(128, 128, 128), 2));
+        for (int j = 0; j < 4; ++j)
+            gc->DrawEllipse(m_BoundaryPoints[j].x - 4, m_BoundaryPoints[j].y - 4, 8, 8);
+    }
+
+    delete gc;
+}
+
+bool SubcircuitComp::Isinside(const wxPoint& p) const {
+    const int left = m_BoundaryPoints[0].x;
+    const int top = m_BoundaryPoints[0].y;
+    const int right = m_BoundaryPoints[2].x;
+    const int bottom = m_BoundaryPoints[1].y;
+    return (p.x >= left && p.x <= right && p.y >= top && p.y <= bottom);
+}
+
+void SubcircuitComp::UpdateGeometry() {
+    const int halfW = int(kHalfW * scale);
+    const int halfH = int(HalfH());
+    m_BoundaryPoints[0] = wxPoint(m_center.x - halfW, m_center.y - halfH);
+    m_BoundaryPoints[1] = wxPoint(m_center.x - halfW, m_center.y + halfH);
+    m_BoundaryPoints[2] = wxPoint(m_center.x + halfW, m_center.y - halfH);
+    m_BoundaryPoints[3] = wxPoint(m_center.x + halfW, m_center.y + halfH);
+}
+
+std::vector<wxPoint> SubcircuitComp::GetPins() const {
+    std::vector<wxPoint> pins;
+    if (!m_def) return pins;
+    const int nIn = m_def->NumInputs(), nOut = m_def->NumOutputs();
+    pins.reserve(nIn + nOut);
+    const int inX = int(std::lround(m_center.x - (kHalfW + kPinLen) * scale));
+    const int outX = int(std::lround(m_center.x + (kHalfW + kPinLen) * scale));
+    // 一列 n 个引脚以中心为对称轴等距排列
+    auto rowY = [&](int k, int n) { return int(std::lround(m_center.y + (k - (n - 1) / 2.0) * kPinPitch * scale)); };
+    for (int k = 0; k < nIn; ++k) pins.emplace_back(inX, rowY(k, nIn));
+    for (int k = 0; k < nOut; ++k) pins.emplace_back(outX, rowY(k, nOut));
+    return pins;
+}
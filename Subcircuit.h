@@ -0,0 +1,76 @@
+﻿// Subcircuit.h
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "Component.h"
+#include "LogicKernel.h"
+
+// ==========================================================
+//  子电路（宏元件）
+//  - SubcircuitDef：内部元件/连线只存一份，所有实例共享（shared_ptr）
+//    内部 NODE_START 为输入端口、NODE_END 为输出端口，各按 (y, x) 排序
+//  - 创建时编译成模板：内部网编号 + 拓扑序的元件表；实例求值直接跑模板，
+//    不展开、不持有内部状态（只封装组合逻辑，时序元件不能放进子电路）
+//  - SubcircuitComp：画成带名字的方框（与译码器同风格），左输入右输出
+// ==========================================================
+
+class SubcircuitDef : public logic::Macro {
+public:
+    // parts / wires 为相对坐标（原点为定义框中心）；内部可以嵌套其它子电路实例
+    static std::shared_ptr<SubcircuitDef> Create(std::string name,
+        std::vector<std::unique_ptr<Component>> parts,
+        std::vector<std::vector<wxPoint>> wires);
+
+    const std::string& Name() const { return m_name; }
+    int NumInputs() const override { return (int)m_inNets.size(); }
+    int NumOutputs() const override { return (int)m_outNets.size(); }
+    const std::vector<std::unique_ptr<Component>>& Parts() const { return m_parts; }
+    const std::vector<std::vector<wxPoint>>& Wires() const { return m_wires; }
+
+    // 组合求值：in[NumInputs()] → out[NumOutputs()]
+    void Evaluate(const bool* in, bool* out) const override;
+
+    // 展开后的基本元件数（含嵌套），用于显示
+    size_t FlatGateCount() const { return m_flatGates; }
+
+private:
+    SubcircuitDef() = default;
+    void Compile();
+
+    struct Op {
+        ComponentType type;
+        const SubcircuitDef* sub;    // type == SUBCIRCUIT 时有效
+        int first;                   // m_opNets 中本元件引脚的起点
+        int nIn, nOut;
+    };
+
+    std::string m_name;
+    std::vector<std::unique_ptr<Component>> m_parts;
+    std::vector<std::vector<wxPoint>> m_wires;
+
+    // 编译结果
+    std::vector<Op> m_ops;           // 拓扑序（有环时环上元件排在最后，求值时迭代到稳定）
+    std::vector<int> m_opNets;       // 各元件引脚所在局部网（先输入后输出；-1 为悬空）
+    std::vector<int> m_inNets, m_outNets;
+    int m_numNets = 0;
+    bool m_cyclic = false;
+    size_t m_flatGates = 0;
+};
+
+class SubcircuitComp : public Component {
+public:
+    SubcircuitComp(wxPoint center, std::shared_ptr<const SubcircuitDef> def);
+
+    const std::shared_ptr<const SubcircuitDef>& Def() const { return m_def; }
+
+    void drawSelf(wxMemoryDC& memDC) override;
+    bool Isinside(const wxPoint& p) const override;
+    void UpdateGeometry() override;
+    std::vector<wxPoint> GetPins() const override;   // 输入（自上而下）+ 输出（自上而下）
+
+private:
+    double HalfH() const;
+
+    std::shared_ptr<const SubcircuitDef> m_def;
+};
@@ -0,0 +1,452 @@
+﻿// SynthBoard.cpp
+#include "SynthBoard.h"
+
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <fstream>
+#include <map>
+#include <random>
+
+#include "BookShelfExporter.h"
+#include "Connectivity.h"
+#include "LogicKernel.h"
+
+namespace synth {
+
+    namespace {
+
+        constexpr int kSlot = 10;   // 干线 / 空隙横线的间距，大于两倍连通容差
+
+        // 列 c 中心 x = c * colPitch；行 r 中心 y = r * rowPitch，奇数列下移 5：
+        // 驱动引脚（行中心）与下一列输入引脚（行中心 ±10 的倍数）永远差 5，同一通道里两种横线不会共线
+        struct Layout {
+            int slots = 1;       // 每个通道的干线位数 = 2 * rowWindow + 1，同一位上的两个网行号相差足够远
+            int colPitch = 0, rowPitch = 0;
+
+            int ColX(int c) const { return c * colPitch; }
+            int RowY(int c, int r) const { return r * rowPitch + (c & 1) * 5; }
+            // 列 c 右侧通道：先是各驱动的干线位，再是反馈边进入列 c + 1 用的竖线
+            int TrunkX(int c, int r) const { return ColX(c) + 86 + kSlot * (r % slots); }
+            int BackX(int c) const { return ColX(c) + 86 + kSlot * (slots - 1) + 20; }
+            // 行 r 上方的空隙，三条横线位按驱动列号模 3 轮换
+            int GapY(int r, int s) const { return r * rowPitch - rowPitch / 2 + 10 + kSlot * s; }
+        };
+
+        int RoundUp(int v, int m) { return (v + m - 1) / m * m; }
+
+        void AppendInt(std::string& buf, long long v)
+        {
+            char tmp[24];
+            const auto res = std::to_chars(tmp, tmp + sizeof(tmp), v);
+            buf.append(tmp, res.ptr);
+        }
+
+        bool IsBasicGate(ComponentType t)
+        {
+            return t == ANDGATE || t == ORGATE || t == NANDGATE || t == NORGATE || t == XORGATE || t == XNORGATE;
+        }
+
+        // 与 Gate::InputDy / HalfH 一致（未缩放）
+        double InputDy(int k, int n) { return (k - (n - 1) / 2.0) * 20.0; }
+        int GateInputs(const BoardCell& c) { return std::clamp(c.inputs, 2, logic::MaxInputs(c.type)); }
+    }
+
+    // ============ 元件几何（与 Component.cpp 保持一致） ============
+    void CellPins(const BoardCell& c, std::vector<BoardPoint>& pins)
+    {
+        pins.clear();
+        switch (c.type) {
+        case NODE_BASIC: pins.push_back({ c.x, c.y }); return;
+        case NODE_START: pins.push_back({ c.x + 10, c.y }); return;
+        case NODE_END:   pins.push_back({ c.x - 8, c.y }); return;
+        case NOTGATE:
+            pins.push_back({ c.x - 50, c.y });
+            pins.push_back({ c.x + 60, c.y });
+            return;
+        default: break;
+        }
+        if (!IsBasicGate(c.type)) return;
+        const int n = GateInputs(c);
+        for (int k = 0; k < n; ++k) pins.push_back({ c.x - 40, int(c.y + InputDy(k, n)) });
+        const int outDx = (c.type == NANDGATE || c.type == XNORGATE) ? 66 : (c.type == NORGATE ? 65 : 60);
+        pins.push_back({ c.x + outDx, c.y });
+    }
+
+    void CellBox(const BoardCell& c, BoardPoint& lo, BoardPoint& hi)
+    {
+        int x0 = -10, x1 = 10, half = 10;
+        switch (c.type) {
+        case NODE_BASIC: case NODE_START: break;
+        case NODE_END: x0 = -12; x1 = 12; half = 12; break;
+        case NOTGATE:  x0 = -50; x1 = 60; half = 22; break;
+        default:
+            if (IsBasicGate(c.type)) {
+                const int n = GateInputs(c);
+                half = (int)std::max(c.type == ANDGATE ? 20.0 : 22.0, std::abs(InputDy(0, n)) + 2.0);
+                x0 = c.type == XORGATE || c.type == XNORGATE ? -46 : -40;
+                x1 = (c.type == NANDGATE || c.type == XNORGATE) ? 66 : (c.type == NORGATE ? 65 : 60);
+            }
+            break;
+        }
+        lo = { c.x + x0, c.y - half };
+        hi = { c.x + x1, c.y + half };
+    }
+
+    // ============ 生成 ============
+    int GenerateBoard(const GenOptions& opt, Board& b)
+    {
+        b.cells.clear();
+        b.wires.clear();
+        std::mt19937 rng(opt.seed);
+        auto chance = [&](double p) { return p > 0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng) < p; };
+
+        const int depth = std::max(1, opt.depth);
+        const int rows = std::max(1, (std::max(1, opt.gates) + depth - 1) / depth);
+        const int win = std::clamp(opt.rowWindow, 0, 64);
+        const bool loops = opt.loopRatio > 0 && depth >= 2;
+        const int maxIn = std::clamp(opt.maxFanIn, 1, logic::MaxInputs(ANDGATE) - (loops ? 1 : 0));
+        const int minIn = std::clamp(opt.minFanIn, 1, maxIn);
+        const int maxFanOut = std::max(1, opt.maxFanOut);
+
+        Layout L;
+        L.slots = 2 * win + 1;
+        L.colPitch = RoundUp(L.BackX(0) + 20 + 50, 10);
+        const int maxPinDy = (maxIn + (loops ? 1 : 0) - 1) * 10;
+        L.rowPitch = RoundUp(2 * (maxPinDy + 45), 20);
+
+        // ---- 逻辑：列 c（1..depth）行 r 的门，输入取列 c - 1 的网；网号 = c * rows + r ----
+        const int numGates = rows * depth;
+        auto netOf = [&](int c, int r) { return c * rows + r; };
+        std::vector<ComponentType> type(numGates);
+        std::vector<int> inStart(numGates + 1, 0);
+        std::vector<int> inNet;              // 各门输入网，反馈边（若有）排最后
+        std::vector<char> hasBack(numGates, 0);
+        std::vector<int> fanOut((size_t)rows * (depth + 1), 0);
+        inNet.reserve((size_t)numGates * (minIn + maxIn + 1) / 2);
+
+        static const ComponentType kTypes[] = { ANDGATE, ORGATE, NANDGATE, NORGATE, XORGATE, XNORGATE };
+        std::vector<int> cand;
+        for (int c = 1; c <= depth; ++c) {
+            for (int r = 0; r < rows; ++r) {
+                const int g = (c - 1) * rows + r;
+                const int n = std::uniform_int_distribution<int>(minIn, maxIn)(rng);
+                type[g] = n == 1 ? NOTGATE : kTypes[rng() % 6];
+
+                const int lo = std::max(0, r - win), hi = std::min(rows - 1, r + win);
+                cand.clear();
+                for (int k = lo; k <= hi; ++k) cand.push_back(k);
+                std::shuffle(cand.begin(), cand.end(), rng);
+                // 扇出已满的候选挪到后面；候选不够时允许同一个网接两个引脚
+                std::stable_partition(cand.begin(), cand.end(), [&](int k) { return fanOut[netOf(c - 1, k)] < maxFanOut; });
+                for (int k = 0; k < n; ++k) {
+                    const int net = netOf(c - 1, cand[k % cand.size()]);
+                    inNet.push_back(net);
+                    ++fanOut[net];
+                }
+                if (loops && c < depth && type[g] != NOTGATE && chance(opt.loopRatio)) {
+                    hasBack[g] = 1;
+                    inNet.push_back(netOf(c + 1, r));
+                }
+                inStart[g + 1] = (int)inNet.size();
+            }
+        }
+
+        // ---- 单元：起始节点、各列门、终止节点（NODE_BASIC 在布线时追加） ----
+        const int numNets = rows * (depth + 1);
+        std::vector<int> pinStart{ 0 }, pinNet;
+        auto addCell = [&](ComponentType t, int inputs, int x, int y) {
+            b.cells.push_back({ t, inputs, x, y });
+            return (int)b.cells.size() - 1;
+        };
+        for (int r = 0; r < rows; ++r) {
+            addCell(NODE_START, 2, L.ColX(0), L.RowY(0, r));
+            pinNet.push_back(netOf(0, r));
+            pinStart.push_back((int)pinNet.size());
+        }
+        const int firstGate = (int)b.cells.size();
+        for (int c = 1; c <= depth; ++c) {
+            for (int r = 0; r < rows; ++r) {
+                const int g = (c - 1) * rows + r;
+                addCell(type[g], inStart[g + 1] - inStart[g], L.ColX(c), L.RowY(c, r));
+                pinNet.insert(pinNet.end(), inNet.begin() + inStart[g], inNet.begin() + inStart[g + 1]);
+                pinNet.push_back(netOf(c, r));
+                pinStart.push_back((int)pinNet.size());
+            }
+        }
+        const int numOut = std::min(rows, std::max(1, opt.maxOutputs));
+        const int firstEnd = (int)b.cells.size();
+        for (int r = 0; r < numOut; ++r) {
+            addCell(NODE_END, 2, L.ColX(depth + 1), L.RowY(depth + 1, r));
+            pinNet.push_back(netOf(depth, r));
+            pinStart.push_back((int)pinNet.size());
+        }
+
+        // ---- 布线：每个网收集负载引脚，再按形态连到驱动 ----
+        std::vector<int> loadStart(numNets + 1, 0);
+        for (int i = firstGate; i < (int)b.cells.size(); ++i) {
+            const int nIn = b.cells[i].type == NODE_END ? 1 : pinStart[i + 1] - pinStart[i] - 1;
+            const bool back = i < firstEnd && hasBack[i - firstGate];
+            for (int k = 0; k < nIn - (back ? 1 : 0); ++k) ++loadStart[pinNet[pinStart[i] + k] + 1];
+        }
+        for (int n = 0; n < numNets; ++n) loadStart[n + 1] += loadStart[n];
+        std::vector<BoardPoint> loadPt(loadStart[numNets]);
+        std::vector<int> fill(loadStart.begin(), loadStart.end() - 1);
+        std::vector<BoardPoint> backPt(numNets, BoardPoint{ INT_MIN, 0 });   // 反馈边负载（每个网至多一个：同一行左邻门）
+        std::vector<BoardPoint> pins;
+        for (int i = firstGate; i < (int)b.cells.size(); ++i) {
+            CellPins(b.cells[i], pins);
+            const int nIn = b.cells[i].type == NODE_END ? 1 : pinStart[i + 1] - pinStart[i] - 1;
+            const bool back = i < firstEnd && hasBack[i - firstGate];
+            for (int k = 0; k < nIn; ++k) {
+                const int net = pinNet[pinStart[i] + k];
+                if (back && k == nIn - 1) backPt[net] = pins[k];
+                else                      loadPt[fill[net]++] = pins[k];
+            }
+        }
+
+        auto addWire = [&](std::initializer_list<BoardPoint> pts) { b.wires.emplace_back(pts); };
+        for (int c = 0; c <= depth; ++c) {
+            for (int r = 0; r < rows; ++r) {
+                const int net = netOf(c, r);
+                const BoardPoint* ld = loadPt.data() + loadStart[net];
+                const int nLoads = loadStart[net + 1] - loadStart[net];
+                const bool back = backPt[net].x != INT_MIN;
+                if (nLoads == 0 && !back) continue;
+
+                const int drvCell = c == 0 ? r : firstGate + (c - 1) * rows + r;
+                CellPins(b.cells[drvCell], pins);
+                const BoardPoint D = pins.back();
+                const int T = L.TrunkX(c, r);
+                const BoardPoint J{ T, D.y };   // 驱动横线与干线的交点
+                // 反馈边：沿干线到行 r 上方空隙，向左到列 c - 2 右侧通道的回线，再下到负载
+                const int G = L.GapY(r, c % 3), BX = c >= 2 ? L.BackX(c - 2) : 0;
+                const BoardPoint B = backPt[net];
+
+                WireStyle style = opt.wireStyle;
+                if (style == WireStyle::Mixed) style = WireStyle(rng() % 3);
+                switch (style) {
+                case WireStyle::Star:
+                    for (int k = 0; k < nLoads; ++k) addWire({ D, J, { T, ld[k].y }, ld[k] });
+                    if (back) addWire({ D, J, { T, G }, { BX, G }, { BX, B.y }, B });
+                    break;
+                case WireStyle::Trunk: {
+                    int y0 = D.y, y1 = D.y;
+                    for (int k = 0; k < nLoads; ++k) { y0 = std::min(y0, ld[k].y); y1 = std::max(y1, ld[k].y); }
+                    if (back) y0 = std::min(y0, G);
+                    addWire({ D, J });
+                    if (y0 < y1) addWire({ { T, y0 }, { T, y1 } });
+                    for (int k = 0; k < nLoads; ++k) addWire({ { T, ld[k].y }, ld[k] });
+                    if (back) addWire({ { T, G }, { BX, G }, { BX, B.y }, B });
+                    break;
+                }
+                default: {
+                    addCell(NODE_BASIC, 2, J.x, J.y);
+                    pinNet.push_back(net);
+                    pinStart.push_back((int)pinNet.size());
+                    addWire({ D, J });
+                    for (int k = 0; k < nLoads; ++k) addWire({ J, { T, ld[k].y }, ld[k] });
+                    if (back) addWire({ J, { T, G }, { BX, G }, { BX, B.y }, B });
+                    break;
+                }
+                }
+            }
+        }
+
+        // ---- 网表：单元顺序同画布，端口名同 DrawBoard::BuildSimNetlist（按位置排序的 I<k> / O<k>） ----
+        SimNetlist& nl = b.netlist;
+        nl.Clear();
+        nl.SetNumNets(numNets);
+        int numIn = 0, numEnd = 0;
+        for (int i = 0; i < (int)b.cells.size(); ++i) {
+            const ComponentType t = b.cells[i].type;
+            std::string name;
+            if (t == NODE_START) name = "I" + std::to_string(numIn++);
+            else if (t == NODE_END) name = "O" + std::to_string(numEnd++);
+            const int cell = nl.AddCell(t, pinNet.data() + pinStart[i], pinStart[i + 1] - pinStart[i], 1, nullptr, name);
+            if (t == NODE_START) nl.AddInputPort(cell);
+            else if (t == NODE_END) nl.AddOutputPort(cell);
+        }
+        return numGates;
+    }
+
+    // ============ 画布 JSON ============
+    bool WriteBoardJson(const Board& b, const std::filesystem::path& path, std::string& err)
+    {
+        std::ofstream ofs(path, std::ios::binary);
+        if (!ofs.is_open()) { err = "无法写入: " + path.string(); return false; }
+        std::string buf;
+        buf.reserve(1 << 20);
+        auto drain = [&](bool force) {
+            if (force || buf.size() >= (1u << 20)) { ofs.write(buf.data(), (std::streamsize)buf.size()); buf.clear(); }
+        };
+
+        // 字段与 DrawBoard::GateToJson 一致
+        buf += "{\"gates\":[";
+        for (size_t i = 0; i < b.cells.size(); ++i) {
+            const BoardCell& c = b.cells[i];
+            if (i) buf += ',';
+            buf += "{\"name\":\"";
+            buf += logic::TypeName(c.type);
+            buf += "\",\"x\":"; AppendInt(buf, c.x);
+            buf += ",\"y\":"; AppendInt(buf, c.y);
+            buf += ",\"scale\":1.0";
+            if (IsBasicGate(c.type) && c.inputs != 2) { buf += ",\"inputs\":"; AppendInt(buf, c.inputs); }
+            buf += '}';
+            drain(false);
+        }
+        buf += "],\n\"wires\":[";
+        for (size_t w = 0; w < b.wires.size(); ++w) {
+            if (w) buf += ',';
+            buf += '[';
+            for (size_t k = 0; k < b.wires[w].size(); ++k) {
+                if (k) buf += ',';
+                buf += "{\"x\":"; AppendInt(buf, b.wires[w][k].x);
+                buf += ",\"y\":"; AppendInt(buf, b.wires[w][k].y);
+                buf += '}';
+            }
+            buf += ']';
+            drain(false);
+        }
+
+        // 网表节，格式同 netio::ToJson
+        const SimNetlist& nl = b.netlist;
+        buf += "],\n\"netlist\":{\"nets\":";
+        AppendInt(buf, nl.NumNets());
+        buf += ",\"cells\":[";
+        for (int i = 0; i < nl.NumCells(); ++i) {
+            const SimNetlist::Cell& c = nl.CellAt(i);
+            if (i) buf += ',';
+            buf += "{\"type\":\"";
+            buf += logic::TypeName(c.type);
+            buf += "\",\"pins\":[";
+            for (int p = 0; p < c.numPins; ++p) {
+                if (p) buf += ',';
+                AppendInt(buf, nl.PinNet(i, p));
+            }
+            buf += ']';
+            if (!c.name.empty()) { buf += ",\"name\":\""; buf += c.name; buf += '"'; }
+            buf += '}';
+            drain(false);
+        }
+        auto list = [&](const char* key, const std::vector<int>& v) {
+            buf += ",\""; buf += key; buf += "\":[";
+            for (size_t k = 0; k < v.size(); ++k) {
+                if (k) buf += ',';
+                AppendInt(buf, v[k]);
+            }
+            buf += ']';
+        };
+        buf += ']';
+        list("inputs", nl.Inputs());
+        list("outputs", nl.Outputs());
+        buf += "}}\n";
+        drain(true);
+        if (!ofs) { err = "写入失败: " + path.string(); return false; }
+        return true;
+    }
+
+    // ============ BookShelf ============
+    std::pair<std::filesystem::path, std::filesystem::path>
+        WriteBoardBookShelf(const Board& b, const std::filesystem::path& outDir, const std::string& stem)
+    {
+        using namespace bookshelf;
+        const SimNetlist& nl = b.netlist;
+        const int N = (int)b.cells.size();
+
+        // 命名与 DrawBoard::ExportAsBookShelf 一致："<带参数的类型名>_<该类型内序号>"
+        std::vector<Node> nodes(N);
+        std::map<ComponentType, int> typeCount;
+        for (int i = 0; i < N; ++i) {
+            const BoardCell& c = b.cells[i];
+            const bool terminal = c.type == NODE_START || c.type == NODE_END;
+            BoardPoint lo, hi;
+            CellBox(c, lo, hi);
+            Node& n = nodes[i];
+            n.name = logic::TypeSpecName({ c.type, 1, IsBasicGate(c.type) ? c.inputs : 2 }) + "_" + std::to_string(++typeCount[c.type]);
+            n.width = terminal ? 0.0 : double(hi.x - lo.x);
+            n.height = terminal ? 0.0 : double(hi.y - lo.y);
+            n.terminal = terminal;
+            n.x = c.x - n.width / 2.0;
+            n.y = c.y - n.height / 2.0;
+            n.fixed = terminal;
+        }
+
+        // 网内引脚按单元顺序（同画布导出时引脚下标升序）
+        std::vector<int> count(nl.NumNets() + 1, 0);
+        for (int i = 0; i < N; ++i) {
+            for (int p = 0; p < nl.CellAt(i).numPins; ++p) {
+                const int net = nl.PinNet(i, p);
+                if (net >= 0) ++count[net + 1];
+            }
+        }
+        std::vector<Net> nets;
+        std::vector<int> netSlot(nl.NumNets(), -1);
+        for (int n = 0; n < nl.NumNets(); ++n) {
+            if (count[n + 1] < 2) continue;   // 单引脚不构成网
+            netSlot[n] = (int)nets.size();
+            nets.emplace_back();
+            nets.back().name = "net_" + std::to_string(netSlot[n]);
+            nets.back().pins.reserve(count[n + 1]);
+        }
+        std::vector<BoardPoint> pins;
+        for (int i = 0; i < N; ++i) {
+            CellPins(b.cells[i], pins);
+            for (int p = 0; p < nl.CellAt(i).numPins && p < (int)pins.size(); ++p) {
+                const int net = nl.PinNet(i, p);
+                if (net < 0 || netSlot[net] < 0) continue;
+                Pin pin;
+                pin.cellName = nodes[i].name;
+                pin.pinName = "P" + std::to_string(p);
+                pin.dx = double(pins[p].x - b.cells[i].x);
+                pin.dy = double(pins[p].y - b.cells[i].y);
+                nets[netSlot[net]].pins.push_back(std::move(pin));
+            }
+        }
+
+        ExportOptions opt;
+        opt.outDir = outDir;
+        return ExportBookShelf(stem, nodes, nets, opt);
+    }
+
+    // ============ 核对 ============
+    bool CheckBoard(const Board& b, std::string& err)
+    {
+        const SimNetlist& nl = b.netlist;
+        if ((int)b.cells.size() != nl.NumCells()) { err = "单元数与网表不符"; return false; }
+
+        Connectivity conn;
+        std::vector<BoardPoint> pins;
+        size_t verts = 0;
+        for (const auto& w : b.wires) verts += w.size();
+        conn.Reserve(b.cells.size() * 3, verts);
+        for (int i = 0; i < (int)b.cells.size(); ++i) {
+            CellPins(b.cells[i], pins);
+            if ((int)pins.size() != nl.CellAt(i).numPins) { err = "单元 " + std::to_string(i) + " 引脚数与网表不符"; return false; }
+            for (int p = 0; p < (int)pins.size(); ++p) conn.AddPin(PinRef{ i, p }, pins[p].x, pins[p].y);
+        }
+        for (const auto& w : b.wires) conn.AddWire(w);
+        conn.Extract();
+
+        // 两种划分互为双射：几何网 ↔ 网表网
+        std::vector<int> toNl(conn.NumNets(), -1), toGeo(nl.NumNets(), -1);
+        for (int pin = 0; pin < conn.NumPins(); ++pin) {
+            const PinRef& ref = conn.Pin(pin);
+            const int g = conn.PinNet(pin), n = nl.PinNet(ref.compIdx, ref.pinIdx);
+            if (n < 0) continue;
+            if (toNl[g] < 0) toNl[g] = n;
+            if (toGeo[n] < 0) toGeo[n] = g;
+            const std::string where = "单元 " + std::to_string(ref.compIdx) + " 引脚 " + std::to_string(ref.pinIdx) + ": ";
+            if (toNl[g] != n) {
+                err = where + "网 " + std::to_string(toNl[g]) + " 与网 " + std::to_string(n) + " 被连线短接";
+                return false;
+            }
+            if (toGeo[n] != g) {
+                err = where + "网 " + std::to_string(n) + " 的连线断开";
+                return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace synth
@@ -0,0 +1,54 @@
+﻿// SynthBoard.h
+#pragma once
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+#include "DesignGen.h"
+#include "SimNetlist.h"
+
+// ==========================================================
+//  合成画布（不依赖 wx）：带几何的分层随机逻辑，可存为画布 JSON 与 BookShelf
+//  布局：第 0 列为起始节点，第 1..depth 列为门，最后一列为终止节点；列间为布线通道
+//    - 前向网只连相邻两列，负载取驱动所在行附近 ±rowWindow 行，每个网在通道里占一条竖直干线
+//    - 反馈边从下一列回连，走行间空隙里的横线，构成组合环
+//    - 连线形态：放射（每个负载一条折线）/ 干线 + T 形分支 / NODE_BASIC 扇出点，或逐网随机混合
+//  引脚位置与 Component.cpp 中各元件的 GetPins 一致（缩放 1），连线端点精确落在引脚上
+//  CheckBoard 用画布同一套连通性提取核对几何与网表
+// ==========================================================
+
+namespace synth {
+
+    struct BoardPoint { int x = 0, y = 0; };
+
+    struct BoardCell {
+        ComponentType type = ANDGATE;
+        int inputs = 2;       // 基本门的输入数
+        int x = 0, y = 0;     // 中心
+    };
+
+    struct Board {
+        std::vector<BoardCell> cells;                 // 与 netlist 单元一一对应（含 NODE_BASIC）
+        std::vector<std::vector<BoardPoint>> wires;
+        SimNetlist netlist;
+    };
+
+    // 元件引脚（顺序同 GetPins）与包围盒；只支持合成画布会用到的类型
+    void CellPins(const BoardCell& c, std::vector<BoardPoint>& pins);
+    void CellBox(const BoardCell& c, BoardPoint& lo, BoardPoint& hi);
+
+    // 按 opt.gates / depth / minFanIn / maxFanIn / maxFanOut / rowWindow / loopRatio / wireStyle / seed 生成；
+    // 返回实际门数（每列行数相同，按 depth 取整）
+    int GenerateBoard(const GenOptions& opt, Board& b);
+
+    // 画布 JSON（gates / wires / netlist 三节，画布与 simcli 都能直接打开）；流式写出，不经 Json::Value
+    bool WriteBoardJson(const Board& b, const std::filesystem::path& path, std::string& err);
+
+    // BookShelf .nodes/.nets/.pl/.aux，命名同画布导出（AND_IN3_5、引脚 P<k>）；失败抛异常
+    std::pair<std::filesystem::path, std::filesystem::path>
+        WriteBoardBookShelf(const Board& b, const std::filesystem::path& outDir, const std::string& stem);
+
+    // 几何提取出的网划分与 netlist 一致时返回 true
+    bool CheckBoard(const Board& b, std::string& err);
+
+} // namespace synth
@@ -1,55 +1,183 @@
 ﻿#pragma once
 #include <memory>
-#include <stack>
+#include <deque>
+#include <vector>
 #include <functional>
+#include <chrono>
+#include <cstddef>
 
 struct ICommand {
     virtual ~ICommand() = default;
     virtual void Do() = 0;
     virtual void Undo() = 0;
+    // 在历史里占用的内存估算（字节），用于历史上限；带快照的命令按数据量覆盖
+    virtual size_t MemoryBytes() const { return 64; }
+    // 合并紧随其后的同类命令（next 已执行过）：返回 true 时本命令吸收 next 的效果，next 被丢弃
+    virtual bool MergeWith(const ICommand& next) { (void)next; return false; }
+};
+
+// 组合命令：按顺序 Do，逆序 Undo（事务结束时由 CommandManager 打包）
+class CompoundCommand : public ICommand {
+public:
+    void Add(std::unique_ptr<ICommand> c) { bytes_ += c->MemoryBytes(); cmds_.push_back(std::move(c)); }
+    bool Empty() const { return cmds_.empty(); }
+    size_t Size() const { return cmds_.size(); }
+    // 只有一条子命令时直接交出，历史里不多包一层
+    std::unique_ptr<ICommand> TakeFront() { bytes_ = 0; auto c = std::move(cmds_.front()); cmds_.clear(); return c; }
+
+    void Do() override { for (auto& c : cmds_) c->Do(); }
+    void Undo() override { for (auto it = cmds_.rbegin(); it != cmds_.rend(); ++it) (*it)->Undo(); }
+    size_t MemoryBytes() const override { return 64 + bytes_; }
+
+private:
+    std::vector<std::unique_ptr<ICommand>> cmds_;
+    size_t bytes_ = 0;
 };
 
 class CommandManager {
 public:
     using OnChanged = std::function<void(bool canUndo, bool canRedo)>;
+    // 批量操作开始(true)/结束(false)：界面据此暂停重绘，结束后只重绘一次
+    using OnBatch = std::function<void(bool begin)>;
 
     void SetOnChanged(OnChanged cb) { onChanged_ = std::move(cb); }
+    void SetOnBatch(OnBatch cb) { onBatch_ = std::move(cb); }
+
+    // 历史上限：步数 / 估算字节数，0 表示不限；超出时丢弃最旧的撤销记录
+    void SetLimits(size_t maxSteps, size_t maxBytes) {
+        maxSteps_ = maxSteps;
+        maxBytes_ = maxBytes;
+        if (enforceLimits()) notify();
+    }
+    size_t HistoryBytes() const { return bytes_; }
+
+    // 之后的命令不再并入当前最后一条（例如一次连续操作明确结束时）
+    void BreakCoalescing() { canMerge_ = false; }
+
+    // 事务：其间 Execute 的命令立即执行，结束时合成一条历史记录（可嵌套，以最外层为准）
+    void BeginTransaction() {
+        if (depth_++ > 0) return;
+        group_ = std::make_unique<CompoundCommand>();
+        batch(true);
+    }
+    void EndTransaction() {
+        if (depth_ == 0 || --depth_ > 0) return;
+        std::unique_ptr<CompoundCommand> g = std::move(group_);
+        batch(false);
+        if (g->Empty()) return;
+        if (g->Size() == 1) push(g->TakeFront());
+        else                push(std::move(g));
+        canMerge_ = false;   // 事务是一个整体，后续命令不并入
+    }
+    bool InTransaction() const { return depth_ > 0; }
 
     void Execute(std::unique_ptr<ICommand> cmd) {
         if (!cmd) return;
         cmd->Do();
-        undo_.push(std::move(cmd));
-        while (!redo_.empty()) redo_.pop();
-        notify();
+        if (depth_ > 0) { group_->Add(std::move(cmd)); return; }
+        push(std::move(cmd));
     }
 
-    bool CanUndo() const { return !undo_.empty(); }
-    bool CanRedo() const { return !redo_.empty(); }
+    bool CanUndo() const { return depth_ == 0 && !undo_.empty(); }
+    bool CanRedo() const { return depth_ == 0 && !redo_.empty(); }
 
     void Undo() {
-        if (undo_.empty()) return;
-        auto cmd = std::move(undo_.top()); undo_.pop();
-        cmd->Undo();
-        redo_.push(std::move(cmd));
+        if (!CanUndo()) return;
+        Entry e = std::move(undo_.back()); undo_.pop_back();
+        batch(true);
+        e.cmd->Undo();
+        batch(false);
+        redo_.push_back(std::move(e));
+        canMerge_ = false;
         notify();
     }
 
     void Redo() {
-        if (redo_.empty()) return;
-        auto cmd = std::move(redo_.top()); redo_.pop();
-        cmd->Do();
-        undo_.push(std::move(cmd));
+        if (!CanRedo()) return;
+        Entry e = std::move(redo_.back()); redo_.pop_back();
+        batch(true);
+        e.cmd->Do();
+        batch(false);
+        undo_.push_back(std::move(e));
+        canMerge_ = false;
         notify();
     }
 
     void Clear() {
-        while (!undo_.empty()) undo_.pop();
-        while (!redo_.empty()) redo_.pop();
+        undo_.clear();
+        redo_.clear();
+        bytes_ = 0;
+        canMerge_ = false;
         notify();
     }
 
 private:
+    void push(std::unique_ptr<ICommand> cmd) {
+        const auto now = Clock::now();
+        const bool inWindow = window_.count() > 0 && now - lastPush_ <= window_;
+        lastPush_ = now;
+        if (canMerge_ && inWindow && !undo_.empty() && redo_.empty() && undo_.back().cmd->MergeWith(*cmd)) {
+            Entry& top = undo_.back();
+            bytes_ -= top.bytes;
+            top.bytes = top.cmd->MemoryBytes();
+            bytes_ += top.bytes;
+            notify();
+            return;
+        }
+        canMerge_ = true;
+
+        const size_t bytes = cmd->MemoryBytes();
+        bytes_ += bytes;
+        undo_.push_back(Entry{ std::move(cmd), bytes });
+        for (const Entry& e : redo_) bytes_ -= e.bytes;
+        redo_.clear();
+        enforceLimits();
+        notify();
+    }
+
+    // 从最旧的一端淘汰；最新的一条总是保留
+    bool enforceLimits() {
+        bool evicted = false;
+        while (undo_.size() > 1 &&
+            ((maxSteps_ && undo_.size() > maxSteps_) || (maxBytes_ && bytes_ > maxBytes_))) {
+            bytes_ -= undo_.front().bytes;
+            undo_.pop_front();
+            evicted = true;
+        }
+        return evicted;
+    }
+
+    void batch(bool begin) { if (onBatch_) onBatch_(begin); }
     void notify() { if (onChanged_) onChanged_(CanUndo(), CanRedo()); }
-    std::stack<std::unique_ptr<ICommand>> undo_, redo_;
+
+    // 入栈时记下占用估算，出入栈按同一数值加减
+    struct Entry {
+        std::unique_ptr<ICommand> cmd;
+        size_t bytes;
+    };
+    std::deque<Entry> undo_, redo_;
+
+    using Clock = std::chrono::steady_clock;
+    // 合并窗口：与上一条间隔不超过该时长、且上一条 MergeWith 接受时并成一条
+    std::chrono::milliseconds window_{ 800 };
+    Clock::time_point lastPush_{};
+    bool canMerge_ = false;
+    std::unique_ptr<CompoundCommand> group_;
+    int depth_ = 0;
+    size_t bytes_ = 0;              // undo_ + redo_ 的估算占用
+    size_t maxSteps_ = 1000;
+    size_t maxBytes_ = size_t(64) << 20;
     OnChanged onChanged_;
+    OnBatch onBatch_;
+};
+
+// 作用域事务：构造时开始，析构时结束（中途 return 也能正确收尾）
+class CommandTransaction {
+public:
+    explicit CommandTransaction(CommandManager* m) : m_(m) { if (m_) m_->BeginTransaction(); }
+    ~CommandTransaction() { if (m_) m_->EndTransaction(); }
+    CommandTransaction(const CommandTransaction&) = delete;
+    CommandTransaction& operator=(const CommandTransaction&) = delete;
+private:
+    CommandManager* m_;
 };
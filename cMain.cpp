@@ -1,16 +1,23 @@
 ﻿#include "cMain.h"
 #include "AppConfig.h"
 #include "ResourceManager.h"
+#include <algorithm>
 #include <vector>
+#include <thread>
+#include <chrono>
 
 // ★ 新增：对话框/消息框/文件系统
 #include <wx/dir.h>
 #include <wx/msgdlg.h>
+#include <wx/config.h>
 #include <filesystem>
 
 // ★ 属性面板与选择事件
 #include "PropertyPane.h"
 #include "SelectionEvents.h"
+#include "BookShelfImporter.h"
+#include "SimEngine.h"
+#include "Profiler.h"
 
 // ★ 新增：导出菜单的 ID（也会在 cMain.h 里补一个同名 ID）
 #ifndef ID_Menu_ExportBookShelf
@@ -21,6 +28,9 @@ wxBEGIN_EVENT_TABLE(cMain, wxFrame)
 EVT_MENU(wxID_EXIT, cMain::OnExit)
 EVT_MENU(wxID_UNDO, cMain::OnUndo)
 EVT_MENU(wxID_REDO, cMain::OnRedo)
+EVT_MENU(wxID_CUT, cMain::OnCut)
+EVT_MENU(wxID_COPY, cMain::OnCopy)
+EVT_MENU(wxID_PASTE, cMain::OnPaste)
 EVT_MENU(2001, cMain::OnClearTexts)
 EVT_MENU(2002, cMain::OnClearPics)
 wxEND_EVENT_TABLE()
@@ -42,23 +52,44 @@ cMain::cMain()
     simMenu->Append(ID_Menu_SimStart, "开始仿真\tF5");
     simMenu->Append(ID_Menu_SimStop, "停止仿真\tShift+F5");
     simMenu->Append(ID_Menu_SimStep, "单步\tF10");
+    simMenu->Append(ID_Menu_SimRunCycles, "连跑 100 万周期\tCtrl+F5", "不逐帧刷新地推进 1,000,000 个时钟周期");
+    simMenu->AppendSeparator();
+    simMenu->AppendRadioItem(ID_Menu_SimRateMax, "速率：尽快", "仿真线程不限速推进，界面按显示刷新率取结果");
+    simMenu->AppendRadioItem(ID_Menu_SimRate10k, "速率：10000 节拍/秒");
+    simMenu->AppendRadioItem(ID_Menu_SimRate1k, "速率：1000 节拍/秒");
+    simMenu->AppendRadioItem(ID_Menu_SimRate50, "速率：50 节拍/秒");
+    simMenu->Check(ID_Menu_SimRate50, true);
     menuBar->Append(simMenu, "仿真");
 
     fileMenu->AppendSeparator();
-    fileMenu->Append(ID_Menu_ExportBookShelf, "导出为 BookShelf...\tCtrl+E", "导出当前设计为 BookShelf (.nodes/.nets)");
-    fileMenu->Append(ID_Menu_ImportBookShelf, "导入 BookShelf...\tCtrl+I", "从 BookShelf (.nodes + .nets) 导入");
+    fileMenu->Append(ID_Menu_ExportBookShelf, "导出为 BookShelf...\tCtrl+E", "导出当前设计为 BookShelf (.nodes/.nets/.pl/.aux)");
+    fileMenu->Append(ID_Menu_ImportBookShelf, "导入 BookShelf...\tCtrl+I", "从 BookShelf (.aux 或 .nodes + .nets，含 .pl 坐标) 导入");
 
     fileMenu->AppendSeparator();
     fileMenu->Append(wxID_EXIT, "退出\tAlt+F4");
     menuBar->Append(fileMenu, "文件");
 
     editMenu = new wxMenu();
+    editMenu->Append(wxID_CUT, "剪切\tCtrl+X");
+    editMenu->Append(wxID_COPY, "复制\tCtrl+C");
+    editMenu->Append(wxID_PASTE, "粘贴\tCtrl+V");
+    editMenu->AppendSeparator();
+    editMenu->Append(ID_Menu_MakeSubckt, "从选区创建子电路...\tCtrl+G", "把选中的元件与内部连线封装成可复用的子电路");
+    editMenu->AppendSeparator();
     editMenu->Append(2001, "清空文本");
     editMenu->Append(2002, "一键清空");
     editMenu->Prepend(wxID_REDO, "重做\tCtrl+Y");
     editMenu->Prepend(wxID_UNDO, "撤销\tCtrl+Z");
     menuBar->Append(editMenu, "&编辑");
 
+    auto* toolsMenu = new wxMenu();
+    toolsMenu->Append(ID_Menu_BenchParse, "BookShelf 解析基准测试", "生成百万级引脚的 .nets 并测量解析吞吐量 (MB/s)");
+    toolsMenu->Append(ID_Menu_BenchClock, "时钟仿真基准测试", "同步计数器连跑数百万周期，测量周期/秒");
+    toolsMenu->AppendSeparator();
+    toolsMenu->AppendCheckItem(ID_Menu_ProfOverlay, "性能浮层\tCtrl+Shift+P", "显示帧率、绘制/仿真/命中测试耗时、稳定迭代与分配次数，并开始记录剖析数据");
+    toolsMenu->Append(ID_Menu_ProfTrace, "导出 Chrome 跟踪...", "把浮层打开期间记录的计时导出为 Chrome 跟踪 JSON（chrome://tracing / Perfetto）");
+    menuBar->Append(toolsMenu, "工具");
+
     SetMenuBar(menuBar);
 
     // 工具栏
@@ -90,11 +121,21 @@ cMain::cMain()
     // ★ 新增：绑定导出菜单
     Bind(wxEVT_MENU, &cMain::OnExportBookShelf, this, ID_Menu_ExportBookShelf);
     Bind(wxEVT_MENU, &cMain::OnImportBookShelf, this, ID_Menu_ImportBookShelf);
+    Bind(wxEVT_MENU, &cMain::OnBenchmarkParse, this, ID_Menu_BenchParse);
+    Bind(wxEVT_MENU, &cMain::OnBenchmarkClock, this, ID_Menu_BenchClock);
+    Bind(wxEVT_MENU, &cMain::OnSimRunCycles, this, ID_Menu_SimRunCycles);
+    Bind(wxEVT_MENU, &cMain::OnDumpTrace, this, ID_Menu_ProfTrace);
+    Bind(wxEVT_MENU, [this](wxCommandEvent& e) { if (drawBoard) drawBoard->SetProfilerOverlay(e.IsChecked()); }, ID_Menu_ProfOverlay);
+    Bind(wxEVT_MENU, &cMain::OnMakeSubcircuit, this, ID_Menu_MakeSubckt);
 
     // 绑定
     Bind(wxEVT_MENU, [this](wxCommandEvent&) { if (drawBoard) drawBoard->SimStart(); }, ID_Menu_SimStart);
     Bind(wxEVT_MENU, [this](wxCommandEvent&) { if (drawBoard) drawBoard->SimStop();  }, ID_Menu_SimStop);
     Bind(wxEVT_MENU, [this](wxCommandEvent&) { if (drawBoard) drawBoard->SimStep();  }, ID_Menu_SimStep);
+    Bind(wxEVT_MENU, [this](wxCommandEvent&) { if (drawBoard) drawBoard->SetSimRate(0);     }, ID_Menu_SimRateMax);
+    Bind(wxEVT_MENU, [this](wxCommandEvent&) { if (drawBoard) drawBoard->SetSimRate(10000); }, ID_Menu_SimRate10k);
+    Bind(wxEVT_MENU, [this](wxCommandEvent&) { if (drawBoard) drawBoard->SetSimRate(1000);  }, ID_Menu_SimRate1k);
+    Bind(wxEVT_MENU, [this](wxCommandEvent&) { if (drawBoard) drawBoard->SetSimRate(50);    }, ID_Menu_SimRate50);
 
     // ===================== 主体区域：左(树+属性) | 右(画布) =====================
     // 外层左右分割：左侧容器 + 右侧画布
@@ -105,6 +146,17 @@ cMain::cMain()
     drawBoard = new DrawBoard(m_splitter);
     drawBoard->SetCommandManager(&m_cmdMgr);  // ★ 交给画布
 
+    // 撤销历史上限取自应用配置（Windows 下为注册表 HKCU\Software\<应用名>\Undo），0 表示不限；
+    // 首次运行写入默认值，之后改配置即可生效
+    {
+        long maxSteps = 1000, maxMegabytes = 64;
+        if (wxConfigBase* cfg = wxConfigBase::Get()) {
+            if (!cfg->Read("Undo/MaxSteps", &maxSteps)) cfg->Write("Undo/MaxSteps", maxSteps);
+            if (!cfg->Read("Undo/MaxMegabytes", &maxMegabytes)) cfg->Write("Undo/MaxMegabytes", maxMegabytes);
+        }
+        m_cmdMgr.SetLimits(size_t(std::max(0L, maxSteps)), size_t(std::max(0L, maxMegabytes)) << 20);
+    }
+
     // 撤销/重做状态变化时更新工具栏按钮可用状态
     m_cmdMgr.SetOnChanged([this](bool canUndo, bool canRedo) {
         UpdateUndoRedoUI(canUndo, canRedo);
@@ -159,6 +211,39 @@ cMain::cMain()
     m_treeCtrl->AppendItem(catExt, "3-8译码器");
     m_treeCtrl->AppendItem(catExt, "2-4译码器");
 
+    // 05 子电路（创建 / 加载后填充）
+    m_catSubckt = m_treeCtrl->AppendItem(root, "05 子电路");
+
+    // 06 时序元件
+    wxTreeItemId catSeq = m_treeCtrl->AppendItem(root, "06 时序元件");
+    m_treeCtrl->AppendItem(catSeq, "时钟源");
+    m_treeCtrl->AppendItem(catSeq, "D 触发器");
+    m_treeCtrl->AppendItem(catSeq, "JK 触发器");
+    m_treeCtrl->AppendItem(catSeq, "D 锁存器");
+    m_treeCtrl->AppendItem(catSeq, "4 位寄存器");
+    m_treeCtrl->AppendItem(catSeq, "8 位寄存器");
+
+    // 07 总线（位宽可在属性面板修改）
+    wxTreeItemId catBus = m_treeCtrl->AppendItem(root, "07 总线");
+    m_treeCtrl->AppendItem(catBus, "8 位分线器");
+    m_treeCtrl->AppendItem(catBus, "8 位合线器");
+    m_treeCtrl->AppendItem(catBus, "8 位与门");
+    m_treeCtrl->AppendItem(catBus, "8 位或门");
+    m_treeCtrl->AppendItem(catBus, "8 位异或门");
+    m_treeCtrl->AppendItem(catBus, "8 位非门");
+
+    // 08 运算与多输入（输入数 / 位宽可在属性面板修改）
+    wxTreeItemId catArith = m_treeCtrl->AppendItem(root, "08 运算与多输入");
+    m_treeCtrl->AppendItem(catArith, "4 输入与门");
+    m_treeCtrl->AppendItem(catArith, "4 输入或门");
+    m_treeCtrl->AppendItem(catArith, "4 输入异或门");
+    m_treeCtrl->AppendItem(catArith, "2 选 1 选择器");
+    m_treeCtrl->AppendItem(catArith, "4 选 1 选择器");
+    m_treeCtrl->AppendItem(catArith, "8 位 2 选 1 选择器");
+    m_treeCtrl->AppendItem(catArith, "1 位全加器");
+    m_treeCtrl->AppendItem(catArith, "8 位加法器");
+    m_treeCtrl->AppendItem(catArith, "8 位比较器");
+
     // 全部展开
     m_treeCtrl->ExpandAll();
 
@@ -260,7 +345,7 @@ void cMain::SetSelectedGate(const wxString& label)
 {
     // 分类节点：不选择
     static const wxArrayString kCategories = {
-        "资源", "01 基础逻辑门", "02 复合逻辑门", "03 结点", "04 扩展元器件"
+        "资源", "01 基础逻辑门", "02 复合逻辑门", "03 结点", "04 扩展元器件", "05 子电路", "06 时序元件", "07 总线", "08 运算与多输入"
     };
     if (kCategories.Index(label) != wxNOT_FOUND) {
         selectedGateName.Clear();
@@ -282,6 +367,28 @@ void cMain::SetSelectedGate(const wxString& label)
     else if (label == "终止节点")   internal = "END_NODE";
     else if (label == "3-8译码器")  internal = "DECODER38";   // ★ 新增
     else if (label == "2-4译码器")  internal = "DECODER24";   // ★ 新增
+    else if (label == "时钟源")     internal = "CLOCK";
+    else if (label == "D 触发器")   internal = "DFF";
+    else if (label == "JK 触发器")  internal = "JKFF";
+    else if (label == "D 锁存器")   internal = "DLATCH";
+    else if (label == "4 位寄存器") internal = "REGISTER4";
+    else if (label == "8 位寄存器") internal = "REGISTER8";
+    else if (label == "8 位分线器") internal = "SPLIT8";
+    else if (label == "8 位合线器") internal = "MERGE8";
+    else if (label == "8 位与门")   internal = "AND8";
+    else if (label == "8 位或门")   internal = "OR8";
+    else if (label == "8 位异或门") internal = "XOR8";
+    else if (label == "8 位非门")   internal = "NOT8";
+    else if (label == "4 输入与门")   internal = "AND_IN4";
+    else if (label == "4 输入或门")   internal = "OR_IN4";
+    else if (label == "4 输入异或门") internal = "XOR_IN4";
+    else if (label == "2 选 1 选择器")     internal = "MUX_IN2";
+    else if (label == "4 选 1 选择器")     internal = "MUX_IN4";
+    else if (label == "8 位 2 选 1 选择器") internal = "MUX8_IN2";
+    else if (label == "1 位全加器")   internal = "ADDER1";
+    else if (label == "8 位加法器")   internal = "ADDER8";
+    else if (label == "8 位比较器")   internal = "CMP8";
+    else if (drawBoard->FindSubcircuit(std::string(label.ToUTF8()))) internal = "SUBCKT:" + label;
     else {
         selectedGateName.Clear();
         drawBoard->pSelectedGateName->Clear();
@@ -320,6 +427,8 @@ void cMain::OnLoadJson(wxCommandEvent& evt)
         wxFD_OPEN | wxFD_FILE_MUST_EXIST);
     if (dlg.ShowModal() == wxID_CANCEL) return;
     drawBoard->LoadFromJson(std::string(dlg.GetPath().mb_str()));
+    m_cmdMgr.Clear();   // 历史记录引用的是旧画布的下标
+    RefreshSubcircuitTree();
 }
 
 void cMain::UpdateUndoRedoUI(bool canUndo, bool canRedo) {
@@ -331,6 +440,41 @@ void cMain::UpdateUndoRedoUI(bool canUndo, bool canRedo) {
 void cMain::OnUndo(wxCommandEvent&) { m_cmdMgr.Undo(); }
 void cMain::OnRedo(wxCommandEvent&) { m_cmdMgr.Redo(); }
 
+void cMain::OnCut(wxCommandEvent&) { if (drawBoard) drawBoard->CutSelection(); }
+void cMain::OnCopy(wxCommandEvent&)
+{
+    if (drawBoard && drawBoard->CopySelection()) SetStatusText("已复制选中的对象");
+}
+void cMain::OnPaste(wxCommandEvent&) { if (drawBoard) drawBoard->Paste(); }
+
+void cMain::OnMakeSubcircuit(wxCommandEvent&)
+{
+    if (!drawBoard) return;
+    wxTextEntryDialog dlg(this, "子电路名称：", "从选区创建子电路",
+        wxString::Format("SUB%zu", drawBoard->GetSubcircuits().size() + 1));
+    if (dlg.ShowModal() != wxID_OK) return;
+
+    const wxString name = dlg.GetValue().Trim(true).Trim(false);
+    wxString why;
+    if (!drawBoard->CreateSubcircuitFromSelection(name, &why)) {
+        wxMessageBox(why, "创建子电路", wxOK | wxICON_WARNING, this);
+        return;
+    }
+    RefreshSubcircuitTree();
+    const auto def = drawBoard->FindSubcircuit(std::string(name.ToUTF8()));
+    SetStatusText(wxString::Format("已创建子电路 %s：%d 输入 / %d 输出，%zu 个门",
+        name, def->NumInputs(), def->NumOutputs(), def->FlatGateCount()));
+}
+
+void cMain::RefreshSubcircuitTree()
+{
+    if (!m_treeCtrl || !m_catSubckt.IsOk()) return;
+    m_treeCtrl->DeleteChildren(m_catSubckt);
+    for (const auto& def : drawBoard->GetSubcircuits())
+        m_treeCtrl->AppendItem(m_catSubckt, wxString::FromUTF8(def->Name().c_str()));
+    m_treeCtrl->Expand(m_catSubckt);
+}
+
 void cMain::OnZoomIn(wxCommandEvent&) { if (drawBoard) drawBoard->ZoomInCenter(); }
 void cMain::OnZoomOut(wxCommandEvent&) { if (drawBoard) drawBoard->ZoomOutCenter(); }
 
@@ -373,25 +517,124 @@ void cMain::OnImportBookShelf(wxCommandEvent&)
         return;
     }
 
-    // 选 .nodes
-    wxFileDialog dlgNodes(this, "Choose .nodes", "", "",
-        "BookShelf nodes (*.nodes)|*.nodes|All files (*.*)|*.*",
+    // 选 .aux（一次带出 nodes/nets/pl/scl）或 .nodes
+    wxFileDialog dlgNodes(this, "Choose .aux or .nodes", "", "",
+        "BookShelf (*.aux;*.nodes)|*.aux;*.nodes|All files (*.*)|*.*",
         wxFD_OPEN | wxFD_FILE_MUST_EXIST);
     if (dlgNodes.ShowModal() != wxID_OK) return;
 
+    std::filesystem::path firstPath = dlgNodes.GetPath().ToStdWstring();
+    if (firstPath.extension() == ".aux") {
+        bool ok = false;
+        try { ok = drawBoard->ImportBookShelfAux(firstPath); }
+        catch (const std::exception& e) {
+            wxMessageBox(wxString::FromUTF8(e.what()), "Import", wxOK | wxICON_ERROR, this);
+            return;
+        }
+        if (ok) { m_cmdMgr.Clear(); ReportPlacement(); }
+        wxMessageBox(ok ? "Imported successfully." : "Import failed.", "Import",
+            wxOK | (ok ? wxICON_INFORMATION : wxICON_ERROR), this);
+        return;
+    }
+
     // 选 .nets（默认同目录）
     wxFileDialog dlgNets(this, "Choose .nets", dlgNodes.GetDirectory(), "",
         "BookShelf nets (*.nets)|*.nets|All files (*.*)|*.*",
         wxFD_OPEN | wxFD_FILE_MUST_EXIST);
     if (dlgNets.ShowModal() != wxID_OK) return;
 
-    std::filesystem::path nodesPath = dlgNodes.GetPath().ToStdWstring();
+    std::filesystem::path nodesPath = firstPath;
     std::filesystem::path netsPath = dlgNets.GetPath().ToStdWstring();
 
     if (drawBoard->ImportBookShelf(nodesPath, netsPath)) {
+        m_cmdMgr.Clear();
+        ReportPlacement();
         wxMessageBox("Imported successfully.", "Import", wxOK | wxICON_INFORMATION, this);
     }
     else {
         wxMessageBox("Import failed.", "Import", wxOK | wxICON_ERROR, this);
     }
-}
\ No newline at end of file
+}
+
+// 导入后若跑了自动布局，在状态栏报告 HPWL 前后对比
+void cMain::ReportPlacement()
+{
+    const auto& st = drawBoard->GetLastPlaceStats();
+    if (!st) return;
+    SetStatusText(wxString::Format("自动布局: %zu 个单元, HPWL %.0f -> %.0f (%.1f%%), %.2f s",
+        st->movable, st->hpwlBefore, st->hpwlAfter,
+        st->hpwlBefore > 0 ? 100.0 * st->hpwlAfter / st->hpwlBefore : 100.0, st->seconds));
+}
+
+// 解析吞吐量基准：在临时目录生成 ~200 万引脚的合成设计，单线程与多线程各解析 3 次取最快
+void cMain::OnBenchmarkParse(wxCommandEvent&)
+{
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "zongshe_bench";
+    try {
+        wxBusyCursor busy;
+        SetStatusText("正在生成合成 BookShelf 设计...");
+        auto [nodesPath, netsPath] =
+            bookshelf::WriteSyntheticBookShelf(dir, "bench", 200000, 500000, 4);
+
+        SetStatusText("正在解析...");
+        const auto seq = bookshelf::MeasureParseThroughput(nodesPath, netsPath, 3, 1);
+        const auto r = bookshelf::MeasureParseThroughput(nodesPath, netsPath, 3, 0);
+
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+
+        const wxString msg = wxString::Format(
+            "节点: %zu\n网: %zu\n引脚: %zu\n文件大小: %.1f MB\n"
+            "单线程: %.3f s (%.1f MB/s)\n多线程 (%u 线程): %.3f s (%.1f MB/s)",
+            r.nodes, r.nets, r.pins, r.bytes / (1024.0 * 1024.0),
+            seq.bestSeconds, seq.MBps(),
+            std::max(1u, std::thread::hardware_concurrency()), r.bestSeconds, r.MBps());
+        SetStatusText(wxString::Format("BookShelf 解析吞吐量: %.1f MB/s", r.MBps()));
+        wxMessageBox(msg, "解析基准", wxOK | wxICON_INFORMATION, this);
+    }
+    catch (const std::exception& ex) {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+        wxMessageBox(wxString::FromUTF8(ex.what()), "解析基准", wxOK | wxICON_ERROR, this);
+    }
+}
+
+void cMain::OnBenchmarkClock(wxCommandEvent&)
+{
+    wxBusyCursor busy;
+    SetStatusText("正在运行时钟仿真基准...");
+    wxString msg;
+    double best = 0.0;
+    for (int bits : { 4, 16, 32 }) {
+        const ClockBenchResult r = MeasureCounterThroughput(bits, 2000000);
+        msg += wxString::Format("%d 位同步计数器（%d 个元件）：%lld 周期 / %.3f s = %.2f M 周期/s\n",
+            r.bits, r.ops, r.cycles, r.seconds, r.CyclesPerSec() / 1e6);
+        best = std::max(best, r.CyclesPerSec());
+    }
+    SetStatusText(wxString::Format("时钟仿真吞吐量: %.2f M 周期/s", best / 1e6));
+    wxMessageBox(msg, "时钟仿真基准", wxOK | wxICON_INFORMATION, this);
+}
+
+void cMain::OnSimRunCycles(wxCommandEvent&)
+{
+    if (!drawBoard) return;
+    wxBusyCursor busy;
+    const auto t0 = std::chrono::steady_clock::now();
+    const long long done = drawBoard->SimRunCycles(1000000);
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (done == 0) SetStatusText("设计中没有时钟源，未推进周期");
+    else SetStatusText(wxString::Format("已推进 %lld 个周期，用时 %.3f s（%.2f M 周期/s）", done, sec, done / sec / 1e6));
+}
+
+void cMain::OnDumpTrace(wxCommandEvent&)
+{
+    wxFileDialog dlg(this, "导出 Chrome 跟踪", "", "trace.json", "JSON files (*.json)|*.json",
+        wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (dlg.ShowModal() == wxID_CANCEL) return;
+    std::string err;
+    if (!prof::Profiler::Get().WriteChromeTrace(dlg.GetPath().ToStdWstring(), err)) {
+        wxMessageBox(wxString::FromUTF8(err.c_str()), "导出 Chrome 跟踪", wxOK | wxICON_ERROR, this);
+        return;
+    }
+    SetStatusText("已导出 Chrome 跟踪: " + dlg.GetPath());
+}
@@ -18,7 +18,17 @@ enum {
     ID_Menu_ImportBookShelf,
     ID_Menu_SimStart = wxID_HIGHEST + 2001,
     ID_Menu_SimStop,
-    ID_Menu_SimStep
+    ID_Menu_SimStep,
+    ID_Menu_SimRunCycles,
+    ID_Menu_SimRateMax,
+    ID_Menu_SimRate10k,
+    ID_Menu_SimRate1k,
+    ID_Menu_SimRate50,
+    ID_Menu_BenchParse = wxID_HIGHEST + 2101,
+    ID_Menu_BenchClock,
+    ID_Menu_ProfOverlay,
+    ID_Menu_ProfTrace,
+    ID_Menu_MakeSubckt = wxID_HIGHEST + 2201
 };
 
 // 前向声明：属性面板，避免头文件循环依赖
@@ -42,6 +52,7 @@ private:
     wxSplitterWindow* m_splitter = nullptr;
     wxPanel* m_leftPanel = nullptr;
     wxTreeCtrl* m_treeCtrl = nullptr;
+    wxTreeItemId m_catSubckt;           // "05 子电路"：条目为画布子电路库中的定义名
 
     DrawBoard* drawBoard = nullptr;
 
@@ -65,12 +76,22 @@ private:
 
     void OnUndo(wxCommandEvent&);     
     void OnRedo(wxCommandEvent&);
+    void OnCut(wxCommandEvent&);
+    void OnCopy(wxCommandEvent&);
+    void OnPaste(wxCommandEvent&);
+    void OnMakeSubcircuit(wxCommandEvent&);   // 从选区创建子电路
+    void RefreshSubcircuitTree();             // 按画布的子电路库重建 "05 子电路" 分类
     void OnZoomIn(wxCommandEvent&);
     void OnZoomOut(wxCommandEvent&);
     void UpdateUndoRedoUI(bool canUndo, bool canRedo); 
 
     void OnExportBookShelf(wxCommandEvent& evt);
     void OnImportBookShelf(wxCommandEvent&);
+    void OnBenchmarkParse(wxCommandEvent&);   // BookShelf 解析吞吐量基准
+    void OnBenchmarkClock(wxCommandEvent&);   // 时钟仿真吞吐量基准（周期/秒）
+    void OnSimRunCycles(wxCommandEvent&);     // 连跑 100 万个时钟周期
+    void OnDumpTrace(wxCommandEvent&);        // 把剖析缓冲导出为 Chrome 跟踪 JSON
+    void ReportPlacement();                   // 导入后报告自动布局的 HPWL
 
     wxAuiManager m_mgr;
     wxSplitterWindow* m_leftSplitter = nullptr;